@@ -0,0 +1,146 @@
+/***************************
+ * MPY32.H
+ * Inline math on the MPY32 hardware multiplier
+ *
+ * The projects are built with --use_hw_mpy=none, so `*` and `/` on ints and longs
+ * call the compiler's software routines (a shift-and-add loop per bit).
+ * These functions use the MPY32 peripheral instead: a multiply is a few register writes.
+ * Without MPY32 (eg. a host build) they fall back to plain C with the same results.
+ *
+ * One copy, shared by the projects through the include path ${PROJECT_LOC}/../Common (ahead of
+ * driverlib, which has an mpy32.h of its own). Include after msp430fr4133.h (which defines
+ * __MSP430_HAS_MPY32__).
+ *
+ * Functions:
+ *      MPY_Mul16(a, b): signed 16x16 -> 32 bit product
+ *      MPY_Mulu16(a, b): unsigned 16x16 -> 32 bit product
+ *      MPY_Mul32(a, b): low 32 bits of a 32x32 product (same for signed and unsigned)
+ *      MPY_Mulu32_Hi(a, b): high 32 bits of an unsigned 32x32 product
+ *      MPY_MAC16(a, b, n): sum of a[i]*b[i] (signed 16 bit), i < n, multiply-accumulate
+ *      MPY_Div(n, MPY_RECIP(d)): n/d for a constant d, by multiplying with 2^32/d
+ *
+ * The multiplier is shared: interrupts are disabled while it is in use,
+ * so these can also be called from an ISR.
+ *
+ * Result timing: a 16x16 product (started by OP2) is ready 3 cycles after OP2 is written, which
+ * the instruction that reads RESLO covers. A 32x32 product (started by OP2H) comes out over more
+ * cycles: RES0/RES1 are read after __delay_cycles(7), RES2/RES3 after __delay_cycles(11). The
+ * delays do not count the cycles of the write and read instructions themselves, so they leave
+ * some margin. Reading earlier returns a partial result. HostSim counts such reads in sim_mpy_early,
+ * and a test fails if there are any.
+ *
+ * Cycles per operation, MPY32 against the compiler's software routines (--use_hw_mpy=none).
+ * Modelled by HostSim test_mpy32 from the instruction timings, over random operands, not measured
+ * on a board:
+ *      cycles                       MPY32  software
+ *      MPY_Mulu16 (16x16)              17       163
+ *      MPY_Mul16 (signed 16x16)        17       158
+ *      MPY_Mul32 (32x32, low)          30       418
+ *      MPY_Mulu32_Hi (32x32, high)     34       677
+ *      MPY_MAC16, 8 terms              89      1312
+ *      MPY_Div, n/10                   34       496
+****************************/
+
+#ifndef MPY32_H_
+#define MPY32_H_
+
+//Reciprocal of a constant d >= 2, ceil(2^32/d), folded by the compiler
+//MPY_Div(n, MPY_RECIP(d)) == n/d for any n < 2^32/d (eg. n < 429496729 for d = 10)
+#define MPY_RECIP(d) (0xFFFFFFFFUL / (d) + 1)
+
+#ifdef __MSP430_HAS_MPY32__
+
+#define MPY_LOCK() unsigned short mpy_sr = __get_interrupt_state(); __disable_interrupt()
+#define MPY_UNLOCK() __set_interrupt_state(mpy_sr)
+
+static inline long MPY_Mul16(int a, int b){
+    long result;
+    MPY_LOCK();
+    MPYS = a;
+    OP2 = b;                    //writing OP2 starts the multiplication
+    result = RESLO | ((long)RESHI << 16);
+    MPY_UNLOCK();
+    return result;
+}
+
+static inline unsigned long MPY_Mulu16(unsigned int a, unsigned int b){
+    unsigned long result;
+    MPY_LOCK();
+    MPY = a;
+    OP2 = b;
+    result = RESLO | ((unsigned long)RESHI << 16);
+    MPY_UNLOCK();
+    return result;
+}
+
+static inline long MPY_Mul32(long a, long b){
+    long result;
+    MPY_LOCK();
+    MPY32L = (unsigned int)a;
+    MPY32H = (unsigned int)(a >> 16);
+    OP2L = (unsigned int)b;
+    OP2H = (unsigned int)(b >> 16);  //writing OP2H starts the multiplication
+    __delay_cycles(7);          //RES0/RES1 of a 32x32 product (see Result timing)
+    result = RES0 | ((long)RES1 << 16);
+    MPY_UNLOCK();
+    return result;
+}
+
+static inline unsigned long MPY_Mulu32_Hi(unsigned long a, unsigned long b){
+    unsigned long result;
+    MPY_LOCK();
+    MPY32L = (unsigned int)a;
+    MPY32H = (unsigned int)(a >> 16);
+    OP2L = (unsigned int)b;
+    OP2H = (unsigned int)(b >> 16);
+    __delay_cycles(11);         //RES2/RES3 of a 32x32 product (see Result timing)
+    result = RES2 | ((unsigned long)RES3 << 16);
+    MPY_UNLOCK();
+    return result;
+}
+
+static inline long MPY_MAC16(const int *a, const int *b, unsigned char n){
+    long result;
+    MPY_LOCK();
+    RESLO = 0;                  //MACS adds each product to RESHI:RESLO
+    RESHI = 0;
+    while(n--){
+        MACS = *a++;
+        OP2 = *b++;
+    }
+    result = RESLO | ((long)RESHI << 16);
+    MPY_UNLOCK();
+    return result;
+}
+
+#else //no MPY32: software fallback
+
+static inline long MPY_Mul16(int a, int b){
+    return (long)a * b;
+}
+
+static inline unsigned long MPY_Mulu16(unsigned int a, unsigned int b){
+    return (unsigned long)a * b;
+}
+
+static inline long MPY_Mul32(long a, long b){
+    return (long)(unsigned long)((unsigned long)a * (unsigned long)b);
+}
+
+static inline unsigned long MPY_Mulu32_Hi(unsigned long a, unsigned long b){
+    return (unsigned long)((unsigned long long)(a & 0xFFFFFFFFUL) * (b & 0xFFFFFFFFUL) >> 32);
+}
+
+static inline long MPY_MAC16(const int *a, const int *b, unsigned char n){
+    long result = 0;
+    while(n--) result += (long)*a++ * *b++;
+    return result;
+}
+
+#endif //__MSP430_HAS_MPY32__
+
+static inline unsigned long MPY_Div(unsigned long n, unsigned long recip){
+    return MPY_Mulu32_Hi(n, recip);
+}
+
+#endif /* MPY32_H_ */
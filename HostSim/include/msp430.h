@@ -0,0 +1,2 @@
+/* HostSim stand-in: the projects only use the MSP430FR4133 */
+#include "msp430fr4133.h"
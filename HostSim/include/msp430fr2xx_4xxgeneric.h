@@ -0,0 +1 @@
+/* HostSim stand-in: hw_memmap.h includes this family header; the device header has everything */
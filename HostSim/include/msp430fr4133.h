@@ -0,0 +1,1137 @@
+/***************************
+ * MSP430FR4133.H (HostSim stand-in)
+ * Register stand-ins for running the firmware on a Linux host
+ *
+ * Every peripheral register is a plain variable (sim_<name>, defined in sim.c).
+ * A firmware access like TA0CCR2 or P1OUT goes through SIM_REG(), which counts it
+ * in sim_acc, so a test can see how many register accesses an ISR makes.
+ * LCDMEM/LCDBMEM alias one byte array and are also counted in sim_lcd_acc (the projects define
+ * their own word access, LCDMEMW, on top of LCDMEM).
+ * BAKMEMx is backup RAM, not a peripheral, and is not counted (the firmware takes its address
+ * in static initialisers).
+ * The MPY32 registers are emulated: writing OP2 or OP2H starts a multiplication (see sim.c).
+ *
+ * Bit values are the ones from TI's msp430fr4133.h for the modules the projects use.
+ * Only the registers and bits the firmware in this repository touches are here.
+****************************/
+
+#ifndef __MSP430FR4133
+#define __MSP430FR4133
+
+#include <stdint.h>
+
+#define __MSP430FR4133__
+#define __MSP430_HAS_MSP430XV2_CPU__
+#define __MSP430_HAS_SFR__
+#define __MSP430_HAS_PMM_FRAM__
+#define __MSP430_HAS_SYS__
+#define __MSP430_HAS_CS__
+#define __MSP430_HAS_FRAM__
+#define __MSP430_HAS_CRC__
+#define __MSP430_HAS_WDT_A__
+#define __MSP430_HAS_PORT1_R__
+#define __MSP430_HAS_PORT2_R__
+#define __MSP430_HAS_PORT3_R__
+#define __MSP430_HAS_PORT4_R__
+#define __MSP430_HAS_PORT5_R__
+#define __MSP430_HAS_PORT6_R__
+#define __MSP430_HAS_PORT7_R__
+#define __MSP430_HAS_PORT8_R__
+#define __MSP430_HAS_PORTA_R__
+#define __MSP430_HAS_PORTB_R__
+#define __MSP430_HAS_PORTC_R__
+#define __MSP430_HAS_PORTD_R__
+#define __MSP430_HAS_TxA7__
+#define __MSP430_HAS_T0A3__
+#define __MSP430_HAS_T1A3__
+#define __MSP430_HAS_RTC__
+#define __MSP430_HAS_MPY32__
+#define __MSP430_HAS_LCD_E__
+#define __MSP430_HAS_ADC__
+#define __MSP430_HAS_TLV__
+
+/************************************************************
+* BASE ADDRESSES (only passed around as tokens by driverlib)
+************************************************************/
+#define __MSP430_BASEADDRESS_SFR__          0x0100
+#define __MSP430_BASEADDRESS_PMM_FRAM__     0x0120
+#define __MSP430_BASEADDRESS_SYS__          0x0140
+#define __MSP430_BASEADDRESS_CS__           0x0180
+#define __MSP430_BASEADDRESS_FRAM__         0x01A0
+#define __MSP430_BASEADDRESS_CRC__          0x01C0
+#define __MSP430_BASEADDRESS_WDT_A__        0x01CC
+#define __MSP430_BASEADDRESS_PORT1_R__      0x0200
+#define __MSP430_BASEADDRESS_PORT2_R__      0x0200
+#define __MSP430_BASEADDRESS_PORT3_R__      0x0220
+#define __MSP430_BASEADDRESS_PORT4_R__      0x0220
+#define __MSP430_BASEADDRESS_PORT5_R__      0x0240
+#define __MSP430_BASEADDRESS_PORT6_R__      0x0240
+#define __MSP430_BASEADDRESS_PORT7_R__      0x0260
+#define __MSP430_BASEADDRESS_PORT8_R__      0x0260
+#define __MSP430_BASEADDRESS_RTC__          0x0300
+#define __MSP430_BASEADDRESS_T0A3__         0x0380
+#define __MSP430_BASEADDRESS_T1A3__         0x03C0
+#define __MSP430_BASEADDRESS_MPY32__        0x04C0
+#define __MSP430_BASEADDRESS_LCD_E__        0x0600
+#define __MSP430_BASEADDRESS_ADC__          0x0700
+
+#define SFR_BASE            __MSP430_BASEADDRESS_SFR__
+#define PMM_BASE            __MSP430_BASEADDRESS_PMM_FRAM__
+#define SYS_BASE            __MSP430_BASEADDRESS_SYS__
+#define CS_BASE             __MSP430_BASEADDRESS_CS__
+#define FRAM_BASE           __MSP430_BASEADDRESS_FRAM__
+#define CRC_BASE            __MSP430_BASEADDRESS_CRC__
+#define WDT_A_BASE          __MSP430_BASEADDRESS_WDT_A__
+#define P1_BASE             __MSP430_BASEADDRESS_PORT1_R__
+#define P2_BASE             __MSP430_BASEADDRESS_PORT2_R__
+#define RTC_BASE            __MSP430_BASEADDRESS_RTC__
+#define TIMER_A0_BASE       __MSP430_BASEADDRESS_T0A3__
+#define TIMER_A1_BASE       __MSP430_BASEADDRESS_T1A3__
+#define MPY32_BASE          __MSP430_BASEADDRESS_MPY32__
+#define LCD_E_BASE          __MSP430_BASEADDRESS_LCD_E__
+#define ADC_BASE            __MSP430_BASEADDRESS_ADC__
+
+/************************************************************
+* STANDARD BITS
+************************************************************/
+#define BIT0                (0x0001)
+#define BIT1                (0x0002)
+#define BIT2                (0x0004)
+#define BIT3                (0x0008)
+#define BIT4                (0x0010)
+#define BIT5                (0x0020)
+#define BIT6                (0x0040)
+#define BIT7                (0x0080)
+#define BIT8                (0x0100)
+#define BIT9                (0x0200)
+#define BITA                (0x0400)
+#define BITB                (0x0800)
+#define BITC                (0x1000)
+#define BITD                (0x2000)
+#define BITE                (0x4000)
+#define BITF                (0x8000)
+
+/************************************************************
+* STATUS REGISTER BITS
+************************************************************/
+#define C                   (0x0001)
+#define Z                   (0x0002)
+#define N                   (0x0004)
+#define V                   (0x0100)
+#define GIE                 (0x0008)
+#define CPUOFF              (0x0010)
+#define OSCOFF              (0x0020)
+#define SCG0                (0x0040)
+#define SCG1                (0x0080)
+
+#define LPM0_bits           (CPUOFF)
+#define LPM1_bits           (SCG0+CPUOFF)
+#define LPM2_bits           (SCG1+CPUOFF)
+#define LPM3_bits           (SCG1+SCG0+CPUOFF)
+#define LPM4_bits           (SCG1+SCG0+OSCOFF+CPUOFF)
+
+/************************************************************
+* INTRINSICS (sim.c keeps the status register in sim_sr)
+************************************************************/
+extern volatile uint16_t sim_sr;
+extern uint32_t sim_delay;          //__delay_cycles total
+extern uint32_t sim_wakes;          //__bic_SR_register_on_exit calls
+extern uint32_t sim_sleeps;         //__bis_SR_register calls that enter a low power mode
+extern uint32_t sim_acc;            //register accesses
+extern uint32_t sim_lcd_acc;        //LCD memory accesses
+extern void sim_mpy_access(int reg);
+extern void sim_enter_lpm(uint16_t bits);
+
+//A function call, so two accesses in one expression (RESLO | RESHI << 16) are not unsequenced
+static inline volatile void *sim_reg_acc(volatile void *r) { sim_acc++; return r; }
+static inline volatile void *sim_lcd_reg_acc(volatile void *r) { sim_acc++; sim_lcd_acc++; return r; }
+
+#define SIM_REG(r)                      (*(__typeof__(&(r)))sim_reg_acc(&(r)))
+#define SIM_MPY_REG(r, id)              (*(sim_mpy_access(id), (__typeof__(&(r)))sim_reg_acc(&(r))))
+#define SIM_LCD_REG(r)                  (*(__typeof__(&(r)))sim_lcd_reg_acc(&(r)))
+
+#define __delay_cycles(n)               (sim_delay += (n))
+#define __no_operation()                ((void)0)
+#define __enable_interrupt()            (sim_sr |= GIE)
+#define __disable_interrupt()           (sim_sr &= ~GIE)
+#define __get_interrupt_state()         (sim_sr & GIE)
+#define __set_interrupt_state(s)        (sim_sr = (sim_sr & ~GIE) | ((s) & GIE))
+#define __get_SR_register()             (sim_sr)
+#define __bis_SR_register(x)            sim_enter_lpm(x)
+#define __bic_SR_register(x)            (sim_sr &= ~(x))
+#define __bis_SR_register_on_exit(x)    (sim_sr |= (x))
+#define __bic_SR_register_on_exit(x)    (sim_wakes++, sim_sr &= ~(x))
+#define __even_in_range(x, y)           (x)
+#define __interrupt
+#define interrupt(vector)               /* GCC style: __attribute__((interrupt(vector))) */
+#define _EINT()                         __enable_interrupt()
+#define _DINT()                         __disable_interrupt()
+#define _NOP()                          __no_operation()
+
+#define LPM0                __bis_SR_register(LPM0_bits)
+#define LPM0_EXIT           __bic_SR_register_on_exit(LPM0_bits)
+#define LPM3                __bis_SR_register(LPM3_bits)
+#define LPM3_EXIT           __bic_SR_register_on_exit(LPM3_bits)
+#define LPM4                __bis_SR_register(LPM4_bits)
+#define LPM4_EXIT           __bic_SR_register_on_exit(LPM4_bits)
+
+/************************************************************
+* REGISTER STORAGE
+************************************************************/
+typedef union { uint8_t b[64]; uint16_t w[32]; uint8_t page[4096]; } sim_lcd_t;    //own page, see sim_lcd_watch()
+typedef union { uint16_t w; uint8_t b[2]; } sim_bak_t;
+extern volatile sim_lcd_t sim_LCD;
+extern volatile sim_bak_t sim_BAKMEM[16];
+extern uint8_t sim_TLV[256];          //device descriptors 0x1A00..0x1AFF (types.sed redirects reads by address)
+
+enum {
+    SIM_MPY_MPY, SIM_MPY_MPYS, SIM_MPY_MAC, SIM_MPY_MACS, SIM_MPY_OP2, SIM_MPY_RESLO, SIM_MPY_RESHI, SIM_MPY_SUMEXT,
+    SIM_MPY_MPY32L, SIM_MPY_MPY32H, SIM_MPY_MPYS32L, SIM_MPY_MPYS32H, SIM_MPY_MAC32L, SIM_MPY_MAC32H,
+    SIM_MPY_MACS32L, SIM_MPY_MACS32H, SIM_MPY_OP2L, SIM_MPY_OP2H, SIM_MPY_RES0, SIM_MPY_RES1, SIM_MPY_RES2, SIM_MPY_RES3
+};
+
+/* registers */
+extern volatile uint16_t sim_SFRIE1;
+extern volatile uint16_t sim_SFRIFG1;
+extern volatile uint16_t sim_SFRRPCR;
+extern volatile uint16_t sim_PMMCTL0;
+extern volatile uint16_t sim_PMMCTL1;
+extern volatile uint16_t sim_PMMCTL2;
+extern volatile uint16_t sim_PMMIFG;
+extern volatile uint16_t sim_PM5CTL0;
+extern volatile uint16_t sim_SYSCTL;
+extern volatile uint16_t sim_SYSBSLC;
+extern volatile uint16_t sim_SYSJMBC;
+extern volatile uint16_t sim_SYSJMBI0;
+extern volatile uint16_t sim_SYSJMBI1;
+extern volatile uint16_t sim_SYSJMBO0;
+extern volatile uint16_t sim_SYSJMBO1;
+extern volatile uint16_t sim_SYSUNIV;
+extern volatile uint16_t sim_SYSSNIV;
+extern volatile uint16_t sim_SYSRSTIV;
+extern volatile uint16_t sim_SYSCFG0;
+extern volatile uint16_t sim_SYSCFG1;
+extern volatile uint16_t sim_SYSCFG2;
+extern volatile uint16_t sim_CSCTL0;
+extern volatile uint16_t sim_CSCTL1;
+extern volatile uint16_t sim_CSCTL2;
+extern volatile uint16_t sim_CSCTL3;
+extern volatile uint16_t sim_CSCTL4;
+extern volatile uint16_t sim_CSCTL5;
+extern volatile uint16_t sim_CSCTL6;
+extern volatile uint16_t sim_CSCTL7;
+extern volatile uint16_t sim_CSCTL8;
+extern volatile uint16_t sim_FRCTL0;
+extern volatile uint16_t sim_GCCTL0;
+extern volatile uint16_t sim_GCCTL1;
+extern volatile uint16_t sim_CRCDI;
+extern volatile uint16_t sim_CRCDIRB;
+extern volatile uint16_t sim_CRCINIRES;
+extern volatile uint16_t sim_CRCRESR;
+extern volatile uint16_t sim_WDTCTL;
+extern volatile uint16_t sim_P1IV;
+extern volatile uint16_t sim_P2IV;
+extern volatile uint16_t sim_TA0CTL;
+extern volatile uint16_t sim_TA0CCTL0;
+extern volatile uint16_t sim_TA0CCTL1;
+extern volatile uint16_t sim_TA0CCTL2;
+extern volatile uint16_t sim_TA0R;
+extern volatile uint16_t sim_TA0CCR0;
+extern volatile uint16_t sim_TA0CCR1;
+extern volatile uint16_t sim_TA0CCR2;
+extern volatile uint16_t sim_TA0EX0;
+extern volatile uint16_t sim_TA0IV;
+extern volatile uint16_t sim_TA1CTL;
+extern volatile uint16_t sim_TA1CCTL0;
+extern volatile uint16_t sim_TA1CCTL1;
+extern volatile uint16_t sim_TA1CCTL2;
+extern volatile uint16_t sim_TA1R;
+extern volatile uint16_t sim_TA1CCR0;
+extern volatile uint16_t sim_TA1CCR1;
+extern volatile uint16_t sim_TA1CCR2;
+extern volatile uint16_t sim_TA1EX0;
+extern volatile uint16_t sim_TA1IV;
+extern volatile uint16_t sim_RTCCTL;
+extern volatile uint16_t sim_RTCIV;
+extern volatile uint16_t sim_RTCMOD;
+extern volatile uint16_t sim_RTCCNT;
+extern volatile uint16_t sim_LCDCTL0;
+extern volatile uint16_t sim_LCDCTL1;
+extern volatile uint16_t sim_LCDBLKCTL;
+extern volatile uint16_t sim_LCDMEMCTL;
+extern volatile uint16_t sim_LCDVCTL;
+extern volatile uint16_t sim_LCDPCTL0;
+extern volatile uint16_t sim_LCDPCTL1;
+extern volatile uint16_t sim_LCDPCTL2;
+extern volatile uint16_t sim_LCDCSSEL0;
+extern volatile uint16_t sim_LCDCSSEL1;
+extern volatile uint16_t sim_LCDCSSEL2;
+extern volatile uint16_t sim_LCDIV;
+extern volatile uint16_t sim_ADCCTL0;
+extern volatile uint16_t sim_ADCCTL1;
+extern volatile uint16_t sim_ADCCTL2;
+extern volatile uint16_t sim_ADCLO;
+extern volatile uint16_t sim_ADCHI;
+extern volatile uint16_t sim_ADCMCTL0;
+extern volatile uint16_t sim_ADCMEM0;
+extern volatile uint16_t sim_ADCIE;
+extern volatile uint16_t sim_ADCIFG;
+extern volatile uint16_t sim_ADCIV;
+extern volatile uint16_t sim_MPY32CTL0;
+extern volatile uint8_t sim_P1IN;
+extern volatile uint8_t sim_P1OUT;
+extern volatile uint8_t sim_P1DIR;
+extern volatile uint8_t sim_P1REN;
+extern volatile uint8_t sim_P1SEL0;
+extern volatile uint8_t sim_P1SEL1;
+extern volatile uint8_t sim_P2IN;
+extern volatile uint8_t sim_P2OUT;
+extern volatile uint8_t sim_P2DIR;
+extern volatile uint8_t sim_P2REN;
+extern volatile uint8_t sim_P2SEL0;
+extern volatile uint8_t sim_P2SEL1;
+extern volatile uint8_t sim_P3IN;
+extern volatile uint8_t sim_P3OUT;
+extern volatile uint8_t sim_P3DIR;
+extern volatile uint8_t sim_P3REN;
+extern volatile uint8_t sim_P3SEL0;
+extern volatile uint8_t sim_P3SEL1;
+extern volatile uint8_t sim_P4IN;
+extern volatile uint8_t sim_P4OUT;
+extern volatile uint8_t sim_P4DIR;
+extern volatile uint8_t sim_P4REN;
+extern volatile uint8_t sim_P4SEL0;
+extern volatile uint8_t sim_P4SEL1;
+extern volatile uint8_t sim_P5IN;
+extern volatile uint8_t sim_P5OUT;
+extern volatile uint8_t sim_P5DIR;
+extern volatile uint8_t sim_P5REN;
+extern volatile uint8_t sim_P5SEL0;
+extern volatile uint8_t sim_P5SEL1;
+extern volatile uint8_t sim_P6IN;
+extern volatile uint8_t sim_P6OUT;
+extern volatile uint8_t sim_P6DIR;
+extern volatile uint8_t sim_P6REN;
+extern volatile uint8_t sim_P6SEL0;
+extern volatile uint8_t sim_P6SEL1;
+extern volatile uint8_t sim_P7IN;
+extern volatile uint8_t sim_P7OUT;
+extern volatile uint8_t sim_P7DIR;
+extern volatile uint8_t sim_P7REN;
+extern volatile uint8_t sim_P7SEL0;
+extern volatile uint8_t sim_P7SEL1;
+extern volatile uint8_t sim_P8IN;
+extern volatile uint8_t sim_P8OUT;
+extern volatile uint8_t sim_P8DIR;
+extern volatile uint8_t sim_P8REN;
+extern volatile uint8_t sim_P8SEL0;
+extern volatile uint8_t sim_P8SEL1;
+extern volatile uint8_t sim_P1IES;
+extern volatile uint8_t sim_P1IE;
+extern volatile uint8_t sim_P1IFG;
+extern volatile uint8_t sim_P2IES;
+extern volatile uint8_t sim_P2IE;
+extern volatile uint8_t sim_P2IFG;
+extern volatile uint16_t sim_MPY;
+extern volatile uint16_t sim_MPYS;
+extern volatile uint16_t sim_MAC;
+extern volatile uint16_t sim_MACS;
+extern volatile uint16_t sim_OP2;
+extern volatile uint16_t sim_RESLO;
+extern volatile uint16_t sim_RESHI;
+extern volatile uint16_t sim_SUMEXT;
+extern volatile uint16_t sim_MPY32L;
+extern volatile uint16_t sim_MPY32H;
+extern volatile uint16_t sim_MPYS32L;
+extern volatile uint16_t sim_MPYS32H;
+extern volatile uint16_t sim_MAC32L;
+extern volatile uint16_t sim_MAC32H;
+extern volatile uint16_t sim_MACS32L;
+extern volatile uint16_t sim_MACS32H;
+extern volatile uint16_t sim_OP2L;
+extern volatile uint16_t sim_OP2H;
+extern volatile uint16_t sim_RES0;
+extern volatile uint16_t sim_RES1;
+extern volatile uint16_t sim_RES2;
+extern volatile uint16_t sim_RES3;
+
+#define SFRIE1          SIM_REG(sim_SFRIE1)
+#define SFRIFG1         SIM_REG(sim_SFRIFG1)
+#define SFRRPCR         SIM_REG(sim_SFRRPCR)
+#define PMMCTL0         SIM_REG(sim_PMMCTL0)
+#define PMMCTL1         SIM_REG(sim_PMMCTL1)
+#define PMMCTL2         SIM_REG(sim_PMMCTL2)
+#define PMMIFG          SIM_REG(sim_PMMIFG)
+#define PM5CTL0         SIM_REG(sim_PM5CTL0)
+#define SYSCTL          SIM_REG(sim_SYSCTL)
+#define SYSBSLC         SIM_REG(sim_SYSBSLC)
+#define SYSJMBC         SIM_REG(sim_SYSJMBC)
+#define SYSJMBI0        SIM_REG(sim_SYSJMBI0)
+#define SYSJMBI1        SIM_REG(sim_SYSJMBI1)
+#define SYSJMBO0        SIM_REG(sim_SYSJMBO0)
+#define SYSJMBO1        SIM_REG(sim_SYSJMBO1)
+#define SYSUNIV         SIM_REG(sim_SYSUNIV)
+#define SYSSNIV         SIM_REG(sim_SYSSNIV)
+#define SYSRSTIV        SIM_REG(sim_SYSRSTIV)
+#define SYSCFG0         SIM_REG(sim_SYSCFG0)
+#define SYSCFG1         SIM_REG(sim_SYSCFG1)
+#define SYSCFG2         SIM_REG(sim_SYSCFG2)
+#define CSCTL0          SIM_REG(sim_CSCTL0)
+#define CSCTL1          SIM_REG(sim_CSCTL1)
+#define CSCTL2          SIM_REG(sim_CSCTL2)
+#define CSCTL3          SIM_REG(sim_CSCTL3)
+#define CSCTL4          SIM_REG(sim_CSCTL4)
+#define CSCTL5          SIM_REG(sim_CSCTL5)
+#define CSCTL6          SIM_REG(sim_CSCTL6)
+#define CSCTL7          SIM_REG(sim_CSCTL7)
+#define CSCTL8          SIM_REG(sim_CSCTL8)
+#define FRCTL0          SIM_REG(sim_FRCTL0)
+#define GCCTL0          SIM_REG(sim_GCCTL0)
+#define GCCTL1          SIM_REG(sim_GCCTL1)
+#define CRCDI           SIM_REG(sim_CRCDI)
+#define CRCDIRB         SIM_REG(sim_CRCDIRB)
+#define CRCINIRES       SIM_REG(sim_CRCINIRES)
+#define CRCRESR         SIM_REG(sim_CRCRESR)
+#define WDTCTL          SIM_REG(sim_WDTCTL)
+#define P1IV            SIM_REG(sim_P1IV)
+#define P2IV            SIM_REG(sim_P2IV)
+#define TA0CTL          SIM_REG(sim_TA0CTL)
+#define TA0CCTL0        SIM_REG(sim_TA0CCTL0)
+#define TA0CCTL1        SIM_REG(sim_TA0CCTL1)
+#define TA0CCTL2        SIM_REG(sim_TA0CCTL2)
+#define TA0R            SIM_REG(sim_TA0R)
+#define TA0CCR0         SIM_REG(sim_TA0CCR0)
+#define TA0CCR1         SIM_REG(sim_TA0CCR1)
+#define TA0CCR2         SIM_REG(sim_TA0CCR2)
+#define TA0EX0          SIM_REG(sim_TA0EX0)
+#define TA0IV           SIM_REG(sim_TA0IV)
+#define TA1CTL          SIM_REG(sim_TA1CTL)
+#define TA1CCTL0        SIM_REG(sim_TA1CCTL0)
+#define TA1CCTL1        SIM_REG(sim_TA1CCTL1)
+#define TA1CCTL2        SIM_REG(sim_TA1CCTL2)
+#define TA1R            SIM_REG(sim_TA1R)
+#define TA1CCR0         SIM_REG(sim_TA1CCR0)
+#define TA1CCR1         SIM_REG(sim_TA1CCR1)
+#define TA1CCR2         SIM_REG(sim_TA1CCR2)
+#define TA1EX0          SIM_REG(sim_TA1EX0)
+#define TA1IV           SIM_REG(sim_TA1IV)
+#define RTCCTL          SIM_REG(sim_RTCCTL)
+#define RTCIV           SIM_REG(sim_RTCIV)
+#define RTCMOD          SIM_REG(sim_RTCMOD)
+#define RTCCNT          SIM_REG(sim_RTCCNT)
+#define LCDCTL0         SIM_REG(sim_LCDCTL0)
+#define LCDCTL1         SIM_REG(sim_LCDCTL1)
+#define LCDBLKCTL       SIM_REG(sim_LCDBLKCTL)
+#define LCDMEMCTL       SIM_REG(sim_LCDMEMCTL)
+#define LCDVCTL         SIM_REG(sim_LCDVCTL)
+#define LCDPCTL0        SIM_REG(sim_LCDPCTL0)
+#define LCDPCTL1        SIM_REG(sim_LCDPCTL1)
+#define LCDPCTL2        SIM_REG(sim_LCDPCTL2)
+#define LCDCSSEL0       SIM_REG(sim_LCDCSSEL0)
+#define LCDCSSEL1       SIM_REG(sim_LCDCSSEL1)
+#define LCDCSSEL2       SIM_REG(sim_LCDCSSEL2)
+#define LCDIV           SIM_REG(sim_LCDIV)
+#define ADCCTL0         SIM_REG(sim_ADCCTL0)
+#define ADCCTL1         SIM_REG(sim_ADCCTL1)
+#define ADCCTL2         SIM_REG(sim_ADCCTL2)
+#define ADCLO           SIM_REG(sim_ADCLO)
+#define ADCHI           SIM_REG(sim_ADCHI)
+#define ADCMCTL0        SIM_REG(sim_ADCMCTL0)
+#define ADCMEM0         SIM_REG(sim_ADCMEM0)
+#define ADCIE           SIM_REG(sim_ADCIE)
+#define ADCIFG          SIM_REG(sim_ADCIFG)
+#define ADCIV           SIM_REG(sim_ADCIV)
+#define MPY32CTL0       SIM_REG(sim_MPY32CTL0)
+#define P1IN            SIM_REG(sim_P1IN)
+#define P1OUT           SIM_REG(sim_P1OUT)
+#define P1DIR           SIM_REG(sim_P1DIR)
+#define P1REN           SIM_REG(sim_P1REN)
+#define P1SEL0          SIM_REG(sim_P1SEL0)
+#define P1SEL1          SIM_REG(sim_P1SEL1)
+#define P2IN            SIM_REG(sim_P2IN)
+#define P2OUT           SIM_REG(sim_P2OUT)
+#define P2DIR           SIM_REG(sim_P2DIR)
+#define P2REN           SIM_REG(sim_P2REN)
+#define P2SEL0          SIM_REG(sim_P2SEL0)
+#define P2SEL1          SIM_REG(sim_P2SEL1)
+#define P3IN            SIM_REG(sim_P3IN)
+#define P3OUT           SIM_REG(sim_P3OUT)
+#define P3DIR           SIM_REG(sim_P3DIR)
+#define P3REN           SIM_REG(sim_P3REN)
+#define P3SEL0          SIM_REG(sim_P3SEL0)
+#define P3SEL1          SIM_REG(sim_P3SEL1)
+#define P4IN            SIM_REG(sim_P4IN)
+#define P4OUT           SIM_REG(sim_P4OUT)
+#define P4DIR           SIM_REG(sim_P4DIR)
+#define P4REN           SIM_REG(sim_P4REN)
+#define P4SEL0          SIM_REG(sim_P4SEL0)
+#define P4SEL1          SIM_REG(sim_P4SEL1)
+#define P5IN            SIM_REG(sim_P5IN)
+#define P5OUT           SIM_REG(sim_P5OUT)
+#define P5DIR           SIM_REG(sim_P5DIR)
+#define P5REN           SIM_REG(sim_P5REN)
+#define P5SEL0          SIM_REG(sim_P5SEL0)
+#define P5SEL1          SIM_REG(sim_P5SEL1)
+#define P6IN            SIM_REG(sim_P6IN)
+#define P6OUT           SIM_REG(sim_P6OUT)
+#define P6DIR           SIM_REG(sim_P6DIR)
+#define P6REN           SIM_REG(sim_P6REN)
+#define P6SEL0          SIM_REG(sim_P6SEL0)
+#define P6SEL1          SIM_REG(sim_P6SEL1)
+#define P7IN            SIM_REG(sim_P7IN)
+#define P7OUT           SIM_REG(sim_P7OUT)
+#define P7DIR           SIM_REG(sim_P7DIR)
+#define P7REN           SIM_REG(sim_P7REN)
+#define P7SEL0          SIM_REG(sim_P7SEL0)
+#define P7SEL1          SIM_REG(sim_P7SEL1)
+#define P8IN            SIM_REG(sim_P8IN)
+#define P8OUT           SIM_REG(sim_P8OUT)
+#define P8DIR           SIM_REG(sim_P8DIR)
+#define P8REN           SIM_REG(sim_P8REN)
+#define P8SEL0          SIM_REG(sim_P8SEL0)
+#define P8SEL1          SIM_REG(sim_P8SEL1)
+#define P1IES           SIM_REG(sim_P1IES)
+#define P1IE            SIM_REG(sim_P1IE)
+#define P1IFG           SIM_REG(sim_P1IFG)
+#define P2IES           SIM_REG(sim_P2IES)
+#define P2IE            SIM_REG(sim_P2IE)
+#define P2IFG           SIM_REG(sim_P2IFG)
+#define MPY             SIM_MPY_REG(sim_MPY, SIM_MPY_MPY)
+#define MPYS            SIM_MPY_REG(sim_MPYS, SIM_MPY_MPYS)
+#define MAC             SIM_MPY_REG(sim_MAC, SIM_MPY_MAC)
+#define MACS            SIM_MPY_REG(sim_MACS, SIM_MPY_MACS)
+#define OP2             SIM_MPY_REG(sim_OP2, SIM_MPY_OP2)
+#define RESLO           SIM_MPY_REG(sim_RESLO, SIM_MPY_RESLO)
+#define RESHI           SIM_MPY_REG(sim_RESHI, SIM_MPY_RESHI)
+#define SUMEXT          SIM_MPY_REG(sim_SUMEXT, SIM_MPY_SUMEXT)
+#define MPY32L          SIM_MPY_REG(sim_MPY32L, SIM_MPY_MPY32L)
+#define MPY32H          SIM_MPY_REG(sim_MPY32H, SIM_MPY_MPY32H)
+#define MPYS32L         SIM_MPY_REG(sim_MPYS32L, SIM_MPY_MPYS32L)
+#define MPYS32H         SIM_MPY_REG(sim_MPYS32H, SIM_MPY_MPYS32H)
+#define MAC32L          SIM_MPY_REG(sim_MAC32L, SIM_MPY_MAC32L)
+#define MAC32H          SIM_MPY_REG(sim_MAC32H, SIM_MPY_MAC32H)
+#define MACS32L         SIM_MPY_REG(sim_MACS32L, SIM_MPY_MACS32L)
+#define MACS32H         SIM_MPY_REG(sim_MACS32H, SIM_MPY_MACS32H)
+#define OP2L            SIM_MPY_REG(sim_OP2L, SIM_MPY_OP2L)
+#define OP2H            SIM_MPY_REG(sim_OP2H, SIM_MPY_OP2H)
+#define RES0            SIM_MPY_REG(sim_RES0, SIM_MPY_RES0)
+#define RES1            SIM_MPY_REG(sim_RES1, SIM_MPY_RES1)
+#define RES2            SIM_MPY_REG(sim_RES2, SIM_MPY_RES2)
+#define RES3            SIM_MPY_REG(sim_RES3, SIM_MPY_RES3)
+#define LCDM0           SIM_LCD_REG(sim_LCD.b[0])
+#define LCDM1           SIM_LCD_REG(sim_LCD.b[1])
+#define LCDM2           SIM_LCD_REG(sim_LCD.b[2])
+#define LCDM3           SIM_LCD_REG(sim_LCD.b[3])
+#define LCDM4           SIM_LCD_REG(sim_LCD.b[4])
+#define LCDM5           SIM_LCD_REG(sim_LCD.b[5])
+#define LCDM6           SIM_LCD_REG(sim_LCD.b[6])
+#define LCDM7           SIM_LCD_REG(sim_LCD.b[7])
+#define LCDM8           SIM_LCD_REG(sim_LCD.b[8])
+#define LCDM9           SIM_LCD_REG(sim_LCD.b[9])
+#define LCDM10          SIM_LCD_REG(sim_LCD.b[10])
+#define LCDM11          SIM_LCD_REG(sim_LCD.b[11])
+#define LCDM12          SIM_LCD_REG(sim_LCD.b[12])
+#define LCDM13          SIM_LCD_REG(sim_LCD.b[13])
+#define LCDM14          SIM_LCD_REG(sim_LCD.b[14])
+#define LCDM15          SIM_LCD_REG(sim_LCD.b[15])
+#define LCDM16          SIM_LCD_REG(sim_LCD.b[16])
+#define LCDM17          SIM_LCD_REG(sim_LCD.b[17])
+#define LCDM18          SIM_LCD_REG(sim_LCD.b[18])
+#define LCDM19          SIM_LCD_REG(sim_LCD.b[19])
+#define LCDM20          SIM_LCD_REG(sim_LCD.b[20])
+#define LCDM21          SIM_LCD_REG(sim_LCD.b[21])
+#define LCDM22          SIM_LCD_REG(sim_LCD.b[22])
+#define LCDM23          SIM_LCD_REG(sim_LCD.b[23])
+#define LCDM24          SIM_LCD_REG(sim_LCD.b[24])
+#define LCDM25          SIM_LCD_REG(sim_LCD.b[25])
+#define LCDM26          SIM_LCD_REG(sim_LCD.b[26])
+#define LCDM27          SIM_LCD_REG(sim_LCD.b[27])
+#define LCDM28          SIM_LCD_REG(sim_LCD.b[28])
+#define LCDM29          SIM_LCD_REG(sim_LCD.b[29])
+#define LCDM30          SIM_LCD_REG(sim_LCD.b[30])
+#define LCDM31          SIM_LCD_REG(sim_LCD.b[31])
+#define LCDM32          SIM_LCD_REG(sim_LCD.b[32])
+#define LCDM33          SIM_LCD_REG(sim_LCD.b[33])
+#define LCDM34          SIM_LCD_REG(sim_LCD.b[34])
+#define LCDM35          SIM_LCD_REG(sim_LCD.b[35])
+#define LCDM36          SIM_LCD_REG(sim_LCD.b[36])
+#define LCDM37          SIM_LCD_REG(sim_LCD.b[37])
+#define LCDM38          SIM_LCD_REG(sim_LCD.b[38])
+#define LCDM39          SIM_LCD_REG(sim_LCD.b[39])
+#define LCDBM0          SIM_LCD_REG(sim_LCD.b[32])
+#define LCDBM1          SIM_LCD_REG(sim_LCD.b[33])
+#define LCDBM2          SIM_LCD_REG(sim_LCD.b[34])
+#define LCDBM3          SIM_LCD_REG(sim_LCD.b[35])
+#define LCDBM4          SIM_LCD_REG(sim_LCD.b[36])
+#define LCDBM5          SIM_LCD_REG(sim_LCD.b[37])
+#define LCDBM6          SIM_LCD_REG(sim_LCD.b[38])
+#define LCDBM7          SIM_LCD_REG(sim_LCD.b[39])
+#define LCDBM8          SIM_LCD_REG(sim_LCD.b[40])
+#define LCDBM9          SIM_LCD_REG(sim_LCD.b[41])
+#define LCDBM10         SIM_LCD_REG(sim_LCD.b[42])
+#define LCDBM11         SIM_LCD_REG(sim_LCD.b[43])
+#define LCDBM12         SIM_LCD_REG(sim_LCD.b[44])
+#define LCDBM13         SIM_LCD_REG(sim_LCD.b[45])
+#define LCDBM14         SIM_LCD_REG(sim_LCD.b[46])
+#define LCDBM15         SIM_LCD_REG(sim_LCD.b[47])
+#define LCDBM16         SIM_LCD_REG(sim_LCD.b[48])
+#define LCDBM17         SIM_LCD_REG(sim_LCD.b[49])
+#define LCDBM18         SIM_LCD_REG(sim_LCD.b[50])
+#define LCDBM19         SIM_LCD_REG(sim_LCD.b[51])
+#define PMMCTL0_L       SIM_REG(((volatile uint8_t *)&sim_PMMCTL0)[0])
+#define PMMCTL0_H       SIM_REG(((volatile uint8_t *)&sim_PMMCTL0)[1])
+#define BAKMEM0         (sim_BAKMEM[0].w)
+#define BAKMEM0_L        (sim_BAKMEM[0].b[0])
+#define BAKMEM0_H        (sim_BAKMEM[0].b[1])
+#define BAKMEM1         (sim_BAKMEM[1].w)
+#define BAKMEM1_L        (sim_BAKMEM[1].b[0])
+#define BAKMEM1_H        (sim_BAKMEM[1].b[1])
+#define BAKMEM2         (sim_BAKMEM[2].w)
+#define BAKMEM2_L        (sim_BAKMEM[2].b[0])
+#define BAKMEM2_H        (sim_BAKMEM[2].b[1])
+#define BAKMEM3         (sim_BAKMEM[3].w)
+#define BAKMEM3_L        (sim_BAKMEM[3].b[0])
+#define BAKMEM3_H        (sim_BAKMEM[3].b[1])
+#define BAKMEM4         (sim_BAKMEM[4].w)
+#define BAKMEM4_L        (sim_BAKMEM[4].b[0])
+#define BAKMEM4_H        (sim_BAKMEM[4].b[1])
+#define BAKMEM5         (sim_BAKMEM[5].w)
+#define BAKMEM5_L        (sim_BAKMEM[5].b[0])
+#define BAKMEM5_H        (sim_BAKMEM[5].b[1])
+#define BAKMEM6         (sim_BAKMEM[6].w)
+#define BAKMEM6_L        (sim_BAKMEM[6].b[0])
+#define BAKMEM6_H        (sim_BAKMEM[6].b[1])
+#define BAKMEM7         (sim_BAKMEM[7].w)
+#define BAKMEM7_L        (sim_BAKMEM[7].b[0])
+#define BAKMEM7_H        (sim_BAKMEM[7].b[1])
+#define BAKMEM8         (sim_BAKMEM[8].w)
+#define BAKMEM8_L        (sim_BAKMEM[8].b[0])
+#define BAKMEM8_H        (sim_BAKMEM[8].b[1])
+#define BAKMEM9         (sim_BAKMEM[9].w)
+#define BAKMEM9_L        (sim_BAKMEM[9].b[0])
+#define BAKMEM9_H        (sim_BAKMEM[9].b[1])
+#define BAKMEM10        (sim_BAKMEM[10].w)
+#define BAKMEM10_L        (sim_BAKMEM[10].b[0])
+#define BAKMEM10_H        (sim_BAKMEM[10].b[1])
+#define BAKMEM11        (sim_BAKMEM[11].w)
+#define BAKMEM11_L        (sim_BAKMEM[11].b[0])
+#define BAKMEM11_H        (sim_BAKMEM[11].b[1])
+#define BAKMEM12        (sim_BAKMEM[12].w)
+#define BAKMEM12_L        (sim_BAKMEM[12].b[0])
+#define BAKMEM12_H        (sim_BAKMEM[12].b[1])
+#define BAKMEM13        (sim_BAKMEM[13].w)
+#define BAKMEM13_L        (sim_BAKMEM[13].b[0])
+#define BAKMEM13_H        (sim_BAKMEM[13].b[1])
+#define BAKMEM14        (sim_BAKMEM[14].w)
+#define BAKMEM14_L        (sim_BAKMEM[14].b[0])
+#define BAKMEM14_H        (sim_BAKMEM[14].b[1])
+#define BAKMEM15        (sim_BAKMEM[15].w)
+#define BAKMEM15_L        (sim_BAKMEM[15].b[0])
+#define BAKMEM15_H        (sim_BAKMEM[15].b[1])
+
+#define LCDMEM              ((volatile uint8_t *)sim_lcd_reg_acc(sim_LCD.b))
+#define LCDBMEM             ((volatile uint8_t *)sim_lcd_reg_acc(sim_LCD.b + 32))
+
+/************************************************************
+* SFR / PMM / SYS
+************************************************************/
+#define WDTIE               (0x0001)
+#define OFIE                (0x0002)
+#define VMAIE               (0x0008)
+#define NMIIE               (0x0010)
+#define WDTIFG              (0x0001)
+#define OFIFG               (0x0002)
+#define VMAIFG              (0x0008)
+#define NMIIFG              (0x0010)
+
+#define PMMPW               (0xA500)
+#define PMMPW_H             (0xA5)
+#define PMMSWBOR            (0x0004)
+#define PMMSWPOR            (0x0008)
+#define PMMREGOFF           (0x0010)
+#define SVSHE               (0x0040)
+#define INTREFEN            (0x0001)
+#define EXTREFEN            (0x0002)
+#define TSENSOREN           (0x0008)
+#define REFGENACT           (0x0100)
+#define REFBGACT            (0x0200)
+#define BGMODE              (0x0800)
+#define REFGENRDY           (0x1000)
+#define REFBGRDY            (0x2000)
+#define PMMBORIFG           (0x0100)
+#define PMMRSTIFG           (0x0200)
+#define PMMPORIFG           (0x0400)
+#define SVSHIFG             (0x2000)
+#define PMMLPM5IFG          (0x8000)
+#define LOCKLPM5            (0x0001)
+#define LPM5SW              (0x0010)
+#define SYSRSTIV_NONE       (0x0000)
+#define SYSRSTIV_BOR        (0x0002)
+#define SYSRSTIV_RSTNMI     (0x0004)
+#define SYSRSTIV_DOBOR      (0x0006)
+#define SYSRSTIV_LPM5WU     (0x0008)
+
+#define PFWP                (0x0001)
+#define DFWP                (0x0002)
+#define FRWPPW              (0xA500)
+#define IREN                (0x0001)
+#define IRPSEL              (0x0002)
+#define IRMSEL              (0x0004)
+#define IRDSSEL             (0x0008)
+#define IRDATA              (0x0010)
+#define ADCPCTL0            (0x0001)
+#define ADCPCTL1            (0x0002)
+#define ADCPCTL2            (0x0004)
+#define ADCPCTL3            (0x0008)
+#define ADCPCTL4            (0x0010)
+#define ADCPCTL5            (0x0020)
+#define ADCPCTL6            (0x0040)
+#define ADCPCTL7            (0x0080)
+#define ADCPCTL8            (0x0100)
+#define ADCPCTL9            (0x0200)
+#define LCDPCTL             (0x1000)
+
+#define FRCTLPW             (0xA500)
+#define NWAITS_0            (0x0000)
+#define NWAITS_1            (0x0010)
+
+/************************************************************
+* CS
+************************************************************/
+#define DISMOD              (0x0001)
+#define DCORSEL_0           (0x0000)
+#define DCORSEL_1           (0x0002)
+#define DCORSEL_2           (0x0004)
+#define DCORSEL_3           (0x0006)
+#define DCORSEL_4           (0x0008)
+#define DCORSEL_5           (0x000A)
+#define DCORSEL_6           (0x000C)
+#define DCORSEL_7           (0x000E)
+#define DCOFTRIMEN          (0x0080)
+#define FLLD_0              (0x0000)
+#define FLLD_1              (0x1000)
+#define FLLD__1             (0x0000)
+#define FLLD__2             (0x1000)
+#define SELREF_0            (0x0000)
+#define SELREF_1            (0x0010)
+#define SELREF__XT1CLK      (0x0000)
+#define SELREF__REFOCLK     (0x0010)
+#define SELMS_0             (0x0000)
+#define SELMS__DCOCLKDIV    (0x0000)
+#define SELMS__REFOCLK      (0x0001)
+#define SELMS__XT1CLK       (0x0002)
+#define SELMS__VLOCLK       (0x0003)
+#define SELA                (0x0100)
+#define SELA__XT1CLK        (0x0000)
+#define SELA__REFOCLK       (0x0100)
+#define DIVM_0              (0x0000)
+#define DIVM_1              (0x0001)
+#define DIVM__1             (0x0000)
+#define DIVM__2             (0x0001)
+#define DIVS_0              (0x0000)
+#define DIVS_1              (0x0010)
+#define DIVS__1             (0x0000)
+#define DIVS__2             (0x0010)
+#define XT1AUTOOFF          (0x0001)
+#define XT1AGCOFF           (0x0002)
+#define XT1BYPASS           (0x0010)
+#define XTS                 (0x0020)
+#define XT1DRIVE_0          (0x0000)
+#define XT1DRIVE_1          (0x0040)
+#define XT1DRIVE_2          (0x0080)
+#define XT1DRIVE_3          (0x00C0)
+#define DCOFFG              (0x0001)
+#define XT1OFFG             (0x0002)
+#define FLLULIFG            (0x0010)
+#define FLLUNLOCK0          (0x0100)
+#define FLLUNLOCK1          (0x0200)
+
+/************************************************************
+* WATCHDOG TIMER A
+************************************************************/
+#define WDTPW               (0x5A00)
+#define WDTHOLD             (0x0080)
+#define WDTSSEL_0           (0x0000)
+#define WDTSSEL_1           (0x0020)
+#define WDTSSEL_2           (0x0040)
+#define WDTSSEL__SMCLK      (0x0000)
+#define WDTSSEL__ACLK       (0x0020)
+#define WDTSSEL__VLO        (0x0040)
+#define WDTTMSEL            (0x0010)
+#define WDTCNTCL            (0x0008)
+#define WDTIS_0             (0x0000)
+#define WDTIS_1             (0x0001)
+#define WDTIS_2             (0x0002)
+#define WDTIS_3             (0x0003)
+#define WDTIS_4             (0x0004)
+#define WDTIS_5             (0x0005)
+#define WDTIS_6             (0x0006)
+#define WDTIS_7             (0x0007)
+
+/************************************************************
+* DIGITAL I/O
+************************************************************/
+#define P1IV_NONE           (0x0000)
+#define P1IV_P1IFG0         (0x0002)
+#define P1IV_P1IFG1         (0x0004)
+#define P1IV_P1IFG2         (0x0006)
+#define P1IV_P1IFG3         (0x0008)
+#define P1IV_P1IFG4         (0x000A)
+#define P1IV_P1IFG5         (0x000C)
+#define P1IV_P1IFG6         (0x000E)
+#define P1IV_P1IFG7         (0x0010)
+#define P2IV_NONE           (0x0000)
+#define P2IV_P2IFG0         (0x0002)
+#define P2IV_P2IFG1         (0x0004)
+#define P2IV_P2IFG2         (0x0006)
+#define P2IV_P2IFG3         (0x0008)
+#define P2IV_P2IFG4         (0x000A)
+#define P2IV_P2IFG5         (0x000C)
+#define P2IV_P2IFG6         (0x000E)
+#define P2IV_P2IFG7         (0x0010)
+
+/************************************************************
+* TIMER A
+************************************************************/
+#define TASSEL_0            (0x0000)
+#define TASSEL_1            (0x0100)
+#define TASSEL_2            (0x0200)
+#define TASSEL_3            (0x0300)
+#define TASSEL__TACLK       (0x0000)
+#define TASSEL__ACLK        (0x0100)
+#define TASSEL__SMCLK       (0x0200)
+#define TASSEL__INCLK       (0x0300)
+#define ID_0                (0x0000)
+#define ID_1                (0x0040)
+#define ID_2                (0x0080)
+#define ID_3                (0x00C0)
+#define ID__1               (0x0000)
+#define ID__2               (0x0040)
+#define ID__4               (0x0080)
+#define ID__8               (0x00C0)
+#define MC_0                (0x0000)
+#define MC_1                (0x0010)
+#define MC_2                (0x0020)
+#define MC_3                (0x0030)
+#define MC__STOP            (0x0000)
+#define MC__UP              (0x0010)
+#define MC__CONTINUOUS      (0x0020)
+#define MC__CONTINOUS       (0x0020)
+#define MC__UPDOWN          (0x0030)
+#define TACLR               (0x0004)
+#define TAIE                (0x0002)
+#define TAIFG               (0x0001)
+
+#define CM_0                (0x0000)
+#define CM_1                (0x4000)
+#define CM_2                (0x8000)
+#define CM_3                (0xC000)
+#define CM__NONE            (0x0000)
+#define CM__RISING          (0x4000)
+#define CM__FALLING         (0x8000)
+#define CM__BOTH            (0xC000)
+#define CCIS_0              (0x0000)
+#define CCIS_1              (0x1000)
+#define CCIS_2              (0x2000)
+#define CCIS_3              (0x3000)
+#define CCIS__CCIA          (0x0000)
+#define CCIS__CCIB          (0x1000)
+#define CCIS__GND           (0x2000)
+#define CCIS__VCC           (0x3000)
+#define SCS                 (0x0800)
+#define SCCI                (0x0400)
+#define CAP                 (0x0100)
+#define OUTMOD_0            (0x0000)
+#define OUTMOD_1            (0x0020)
+#define OUTMOD_2            (0x0040)
+#define OUTMOD_3            (0x0060)
+#define OUTMOD_4            (0x0080)
+#define OUTMOD_5            (0x00A0)
+#define OUTMOD_6            (0x00C0)
+#define OUTMOD_7            (0x00E0)
+#define CCIE                (0x0010)
+#define CCI                 (0x0008)
+#define OUT                 (0x0004)
+#define COV                 (0x0002)
+#define CCIFG               (0x0001)
+#define TAIDEX_0            (0x0000)
+#define TAIDEX_1            (0x0001)
+#define TAIDEX_2            (0x0002)
+#define TAIDEX_3            (0x0003)
+#define TAIDEX_4            (0x0004)
+#define TAIDEX_5            (0x0005)
+#define TAIDEX_6            (0x0006)
+#define TAIDEX_7            (0x0007)
+
+#define TAIV_NONE           (0x0000)
+#define TAIV_TACCR1         (0x0002)
+#define TAIV_TACCR2         (0x0004)
+#define TAIV_TAIFG          (0x000E)
+#define TA0IV_NONE          (0x0000)
+#define TA0IV_TACCR1        (0x0002)
+#define TA0IV_TACCR2        (0x0004)
+#define TA0IV_TAIFG         (0x000E)
+#define TA1IV_NONE          (0x0000)
+#define TA1IV_TACCR1        (0x0002)
+#define TA1IV_TACCR2        (0x0004)
+#define TA1IV_TAIFG         (0x000E)
+
+/************************************************************
+* RTC
+************************************************************/
+#define RTCSS_0             (0x0000)
+#define RTCSS_1             (0x1000)
+#define RTCSS_2             (0x2000)
+#define RTCSS_3             (0x3000)
+#define RTCSS__DISABLED     (0x0000)
+#define RTCSS__SMCLK        (0x1000)
+#define RTCSS__XT1CLK       (0x2000)
+#define RTCSS__VLOCLK       (0x3000)
+#define RTCPS_0             (0x0000)
+#define RTCPS_1             (0x0100)
+#define RTCPS_2             (0x0200)
+#define RTCPS_3             (0x0300)
+#define RTCPS_4             (0x0400)
+#define RTCPS_5             (0x0500)
+#define RTCPS_6             (0x0600)
+#define RTCPS_7             (0x0700)
+#define RTCPS__1            (0x0000)
+#define RTCPS__10           (0x0100)
+#define RTCPS__100          (0x0200)
+#define RTCPS__1000         (0x0300)
+#define RTCPS__16           (0x0400)
+#define RTCPS__64           (0x0500)
+#define RTCPS__256          (0x0600)
+#define RTCPS__1024         (0x0700)
+#define RTCSR               (0x0040)
+#define RTCIE               (0x0002)
+#define RTCIF               (0x0001)
+#define RTCIFG              (0x0001)
+#define RTCIV_NONE          (0x0000)
+#define RTCIV_RTCIF         (0x0002)
+#define RTCIV_RTCIFG        (0x0002)
+
+/************************************************************
+* LCD_E
+************************************************************/
+#define LCDON               (0x0001)
+#define LCDLP               (0x0002)
+#define LCDSON              (0x0004)
+#define LCDMX0              (0x0008)
+#define LCDMX1              (0x0010)
+#define LCDMX2              (0x0020)
+#define LCDSSEL0            (0x0040)
+#define LCDSSEL1            (0x0080)
+#define LCDSSEL_0           (0x0000)
+#define LCDSSEL_1           (0x0040)
+#define LCDSSEL_2           (0x0080)
+#define LCDSSEL_3           (0x00C0)
+#define LCDSSEL__XTCLK      (0x0000)
+#define LCDSSEL__ACLK       (0x0040)
+#define LCDSSEL__VLOCLK     (0x0080)
+#define LCDSTATIC           (0x0000)
+#define LCD2MUX             (LCDMX0)
+#define LCD3MUX             (LCDMX1)
+#define LCD4MUX             (LCDMX1+LCDMX0)
+#define LCD5MUX             (LCDMX2)
+#define LCD6MUX             (LCDMX2+LCDMX0)
+#define LCD7MUX             (LCDMX2+LCDMX1)
+#define LCD8MUX             (LCDMX2+LCDMX1+LCDMX0)
+#define LCDDIV_0            (0x0000)
+#define LCDDIV_1            (0x0800)
+#define LCDDIV_2            (0x1000)
+#define LCDDIV_3            (0x1800)
+#define LCDDIV_4            (0x2000)
+#define LCDDIV_5            (0x2800)
+#define LCDDIV_6            (0x3000)
+#define LCDDIV_7            (0x3800)
+#define LCDFRMIFG           (0x0001)
+#define LCDBLKOFFIFG        (0x0002)
+#define LCDBLKONIFG         (0x0004)
+#define LCDFRMIE            (0x0100)
+#define LCDBLKOFFIE         (0x0200)
+#define LCDBLKONIE          (0x0400)
+#define LCDBLKMOD_0         (0x0000)
+#define LCDBLKMOD_1         (0x0001)
+#define LCDBLKMOD_2         (0x0002)
+#define LCDBLKMOD_3         (0x0003)
+#define LCDBLKPRE0          (0x0004)
+#define LCDBLKPRE1          (0x0008)
+#define LCDBLKPRE2          (0x0010)
+#define LCDDISP             (0x0001)
+#define LCDCLRM             (0x0002)
+#define LCDCLRBM            (0x0004)
+#define LCDREFMODE          (0x0001)
+#define LCDSELVDD           (0x0020)
+#define LCDREFEN            (0x0040)
+#define LCDCPEN             (0x0080)
+#define VLCD_0              (0x0000)
+#define VLCD_1              (0x0200)
+#define VLCD_2              (0x0400)
+#define VLCD_3              (0x0600)
+#define VLCD_4              (0x0800)
+#define VLCD_5              (0x0A00)
+#define VLCD_6              (0x0C00)
+#define VLCD_7              (0x0E00)
+#define VLCD_8              (0x1000)
+#define VLCD_9              (0x1200)
+#define VLCD_10             (0x1400)
+#define VLCD_11             (0x1600)
+#define VLCD_12             (0x1800)
+#define VLCD_13             (0x1A00)
+#define VLCD_14             (0x1C00)
+#define VLCD_15             (0x1E00)
+#define VLCD0               (0x0200)
+#define VLCD1               (0x0400)
+#define VLCD2               (0x0800)
+#define VLCD3               (0x1000)
+#define LCDCPFSEL0          (0x1000)
+#define LCDCPFSEL1          (0x2000)
+#define LCDCPFSEL2          (0x4000)
+#define LCDCPFSEL3          (0x8000)
+
+/************************************************************
+* ADC
+************************************************************/
+#define ADCSC               (0x0001)
+#define ADCENC              (0x0002)
+#define ADCON               (0x0010)
+#define ADCMSC              (0x0080)
+#define ADCSHT_0            (0x0000)
+#define ADCSHT_1            (0x0100)
+#define ADCSHT_2            (0x0200)
+#define ADCSHT_3            (0x0300)
+#define ADCSHT_4            (0x0400)
+#define ADCSHT_5            (0x0500)
+#define ADCSHT_6            (0x0600)
+#define ADCSHT_7            (0x0700)
+#define ADCSHT_8            (0x0800)
+#define ADCSHT_15           (0x0F00)
+#define ADCBUSY             (0x0001)
+#define ADCCONSEQ_0         (0x0000)
+#define ADCCONSEQ_1         (0x0002)
+#define ADCCONSEQ_2         (0x0004)
+#define ADCCONSEQ_3         (0x0006)
+#define ADCSSEL_0           (0x0000)
+#define ADCSSEL_1           (0x0008)
+#define ADCSSEL_2           (0x0010)
+#define ADCSSEL_3           (0x0018)
+#define ADCDIV_0            (0x0000)
+#define ADCDIV_1            (0x0020)
+#define ADCDIV_7            (0x00E0)
+#define ADCISSH             (0x0100)
+#define ADCSHP              (0x0200)
+#define ADCSHS_0            (0x0000)
+#define ADCSHS_1            (0x0400)
+#define ADCSHS_2            (0x0800)
+#define ADCSHS_3            (0x0C00)
+#define ADCSR               (0x0004)
+#define ADCDF               (0x0008)
+#define ADCRES              (0x0010)
+#define ADCRES_0            (0x0000)
+#define ADCRES_1            (0x0010)
+#define ADCPDIV_0           (0x0000)
+#define ADCPDIV_1           (0x0100)
+#define ADCPDIV_2           (0x0200)
+#define ADCINCH_0           (0x0000)
+#define ADCINCH_1           (0x0001)
+#define ADCINCH_2           (0x0002)
+#define ADCINCH_3           (0x0003)
+#define ADCINCH_4           (0x0004)
+#define ADCINCH_5           (0x0005)
+#define ADCINCH_6           (0x0006)
+#define ADCINCH_7           (0x0007)
+#define ADCINCH_8           (0x0008)
+#define ADCINCH_9           (0x0009)
+#define ADCINCH_10          (0x000A)
+#define ADCINCH_11          (0x000B)
+#define ADCINCH_12          (0x000C)
+#define ADCINCH_13          (0x000D)
+#define ADCINCH_14          (0x000E)
+#define ADCINCH_15          (0x000F)
+#define ADCSREF0            (0x0010)
+#define ADCSREF1            (0x0020)
+#define ADCSREF2            (0x0040)
+#define ADCSREF_0           (0x0000)
+#define ADCSREF_1           (0x0010)
+#define ADCSREF_2           (0x0020)
+#define ADCSREF_3           (0x0030)
+#define ADCSREF_4           (0x0040)
+#define ADCSREF_5           (0x0050)
+#define ADCSREF_6           (0x0060)
+#define ADCSREF_7           (0x0070)
+#define ADCIE0              (0x0001)
+#define ADCINIE             (0x0002)
+#define ADCLOIE             (0x0004)
+#define ADCHIIE             (0x0008)
+#define ADCOVIE             (0x0010)
+#define ADCTOVIE            (0x0020)
+#define ADCIFG0             (0x0001)
+#define ADCINIFG            (0x0002)
+#define ADCLOIFG            (0x0004)
+#define ADCHIIFG            (0x0008)
+#define ADCOVIFG            (0x0010)
+#define ADCTOVIFG           (0x0020)
+#define ADCIV_NONE          (0x0000)
+#define ADCIV_ADCOVIFG      (0x0002)
+#define ADCIV_ADCTOVIFG     (0x0004)
+#define ADCIV_ADCHIIFG      (0x0006)
+#define ADCIV_ADCLOIFG      (0x0008)
+#define ADCIV_ADCINIFG      (0x000A)
+#define ADCIV_ADCIFG        (0x000C)
+
+/************************************************************
+* MPY32
+************************************************************/
+#define MPYC                (0x0001)
+#define MPYFRAC             (0x0004)
+#define MPYSAT              (0x0008)
+#define MPYM0               (0x0010)
+#define MPYM1               (0x0020)
+#define MPYOP1_32           (0x0040)
+#define MPYOP2_32           (0x0080)
+#define MPYDLYWRTEN         (0x0100)
+#define MPYDLY32            (0x0200)
+
+/************************************************************
+* TLV
+************************************************************/
+#define TLV_START           (0x1A08)
+#define TLV_END             (0x1AFF)
+#define TLV_LDTAG           (0x01)
+#define TLV_PDTAG           (0x02)
+#define TLV_Reserved3       (0x03)
+#define TLV_Reserved4       (0x04)
+#define TLV_BLANK           (0x05)
+#define TLV_Reserved6       (0x06)
+#define TLV_Reserved7       (0x07)
+#define TLV_TAGEXT          (0x08)
+#define TLV_TAGEND          (0xFF)
+#define TLV_DIERECORD       (0x08)
+#define TLV_ADCCAL          (0x11)
+#define TLV_ADC12CAL        (0x11)
+#define TLV_REFCAL          (0x12)
+#define TLV_ADC10CAL        (0x13)
+#define TLV_TIMERDCAL       (0x15)
+#define TLV_CTSD16CAL       (0x1D)
+
+/************************************************************
+* INTERRUPT VECTORS (the host ignores #pragma vector)
+************************************************************/
+#define LCD_E_VECTOR        (42)
+#define PORT2_VECTOR        (43)
+#define PORT1_VECTOR        (44)
+#define ADC_VECTOR          (45)
+#define USCI_B0_VECTOR      (46)
+#define USCI_A0_VECTOR      (47)
+#define WDT_VECTOR          (48)
+#define RTC_VECTOR          (49)
+#define TIMER1_A1_VECTOR    (50)
+#define TIMER1_A0_VECTOR    (51)
+#define TIMER0_A1_VECTOR    (52)
+#define TIMER0_A0_VECTOR    (53)
+#define UNMI_VECTOR         (54)
+#define SYSNMI_VECTOR       (55)
+#define RESET_VECTOR        ("reset")
+
+#endif /* #ifndef __MSP430FR4133 */
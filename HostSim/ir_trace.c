@@ -0,0 +1,153 @@
+/***************************
+ * IR_TRACE.C
+ * IR frames as edge intervals, for the codec and protocol tests (see ir_trace.h)
+ *
+ * Timings, in us:
+ *      NEC/NECX: 9000 mark, 4500 space, 32 bits LSB first of 560 mark + 560 (0) / 1690 (1) space,
+ *                560 trailer mark
+ *      SIRC:     2400 mark, then per bit LSB first 600 space + 600 (0) / 1200 (1) mark
+ *      RC5:      889 half bits, 14 bits MSB first (1, field, toggle, address, command), 1 = space, mark
+ *      RC6:      444.4 half bits, 6T mark + 2T space leader, start bit 1, 3 mode bits,
+ *                toggle (2T halves), 8 bit address, 8 bit command, 1 = mark, space
+****************************/
+
+#include "ir_trace.h"
+
+#define US(us)          ((us) * 4.0)            //SMCLK ticks at 4MHz
+#define RC5_T           US(888.9)
+#define RC6_T           US(444.4)
+
+static const char *const names[IR_TRACE_PROTOCOLS] = {
+    "NEC", "NECX", "SIRC12", "SIRC15", "SIRC20", "RC5", "RC6"
+};
+
+//Levels are added one at a time and merged into intervals; leading and trailing spaces are dropped
+typedef struct
+{
+    uint16_t    *out;
+    unsigned    n;
+    int         level;
+    double      at;                             //end of the last level, in ticks
+} frame_t;
+
+static void level(frame_t *f, int mark, double ticks)
+{
+    double end = f->at + ticks;
+
+    if(f->n || mark){
+        if(!f->n || mark != f->level){
+            f->out[f->n++] = 0;
+            f->level = mark;
+        }
+        //each edge is rounded on its own, so the rounding does not add up along the frame
+        f->out[f->n - 1] += (uint16_t)((uint32_t)(end + 0.5) - (uint32_t)(f->at + 0.5));
+    }
+    f->at = end;
+}
+
+static unsigned finish(frame_t *f)
+{
+    if(f->n && !f->level)
+        f->n--;                                 //the trailing space is the gap
+    return f->n;
+}
+
+const char *ir_trace_name(int protocol)
+{
+    return names[protocol];
+}
+
+unsigned ir_trace_ideal(int protocol, const ir_fields_t *d, uint16_t *out)
+{
+    frame_t f = { out, 0, 0, 0 };
+    uint32_t val;
+    int i, bits;
+
+    switch(protocol){
+    case IR_TRACE_NEC:
+    case IR_TRACE_NECX:
+        val = protocol == IR_TRACE_NEC ? (d->address & 0xFF) | ((uint32_t)(~d->address & 0xFF) << 8)
+                                       : d->address;
+        val |= ((uint32_t)d->command << 16) | ((uint32_t)(uint8_t)~d->command << 24);
+        level(&f, 1, US(9000));
+        level(&f, 0, US(4500));
+        for(i = 0; i < 32; i++){
+            level(&f, 1, US(560));
+            level(&f, 0, (val >> i) & 1 ? US(1690) : US(560));
+        }
+        level(&f, 1, US(560));
+        break;
+    case IR_TRACE_SIRC12:
+    case IR_TRACE_SIRC15:
+    case IR_TRACE_SIRC20:
+        bits = protocol == IR_TRACE_SIRC12 ? 12 : protocol == IR_TRACE_SIRC15 ? 15 : 20;
+        val = (d->command & 0x7F) | ((uint32_t)d->address << 7);
+        level(&f, 1, US(2400));
+        for(i = 0; i < bits; i++){
+            level(&f, 0, US(600));
+            level(&f, 1, (val >> i) & 1 ? US(1200) : US(600));
+        }
+        break;
+    case IR_TRACE_RC5:
+        val = 0x2000 | (d->command & 0x40 ? 0 : 0x1000) | ((uint32_t)(d->toggle & 1) << 11)
+            | ((uint32_t)(d->address & 0x1F) << 6) | (d->command & 0x3F);
+        for(i = 13; i >= 0; i--){
+            level(&f, !((val >> i) & 1), RC5_T);
+            level(&f, (val >> i) & 1, RC5_T);
+        }
+        break;
+    case IR_TRACE_RC6:
+        level(&f, 1, 6 * RC6_T);
+        level(&f, 0, 2 * RC6_T);
+        level(&f, 1, RC6_T);
+        level(&f, 0, RC6_T);
+        for(i = 2; i >= 0; i--){
+            level(&f, (d->mode >> i) & 1, RC6_T);
+            level(&f, !((d->mode >> i) & 1), RC6_T);
+        }
+        level(&f, d->toggle & 1, 2 * RC6_T);
+        level(&f, !(d->toggle & 1), 2 * RC6_T);
+        val = ((uint32_t)(d->address & 0xFF) << 8) | d->command;
+        for(i = 15; i >= 0; i--){
+            level(&f, (val >> i) & 1, RC6_T);
+            level(&f, !((val >> i) & 1), RC6_T);
+        }
+        break;
+    }
+    return finish(&f);
+}
+
+void ir_trace_fields(int protocol, ir_fields_t *f, uint32_t (*rnd)(void))
+{
+    f->command = rnd() & 0xFF;
+    f->toggle = rnd() & 1;
+    f->mode = 0;
+    switch(protocol){
+    case IR_TRACE_NEC:      f->address = rnd() & 0xFF; break;
+    case IR_TRACE_NECX:
+        do
+            f->address = rnd() & 0xFFFF;
+        while((f->address >> 8) == (uint8_t)~f->address);      //that would be NEC
+        break;
+    case IR_TRACE_SIRC12:   f->address = rnd() & 0x1F; f->command &= 0x7F; break;
+    case IR_TRACE_SIRC15:   f->address = rnd() & 0xFF; f->command &= 0x7F; break;
+    case IR_TRACE_SIRC20:   f->address = rnd() & 0x1FFF; f->command &= 0x7F; break;
+    case IR_TRACE_RC5:      f->address = rnd() & 0x1F; f->command &= 0x7F; break;
+    case IR_TRACE_RC6:      f->address = rnd() & 0xFF; f->mode = rnd() & 7; break;
+    }
+}
+
+void ir_trace_receive(const uint16_t *ideal, unsigned n, uint16_t *out, double stretch, double jitter,
+                      uint32_t (*rnd)(void))
+{
+    double t = 0, edge = 0, last = 0;
+    unsigned i;
+
+    for(i = 0; i < n; i++){
+        t += ideal[i];
+        //the edge that ends interval i: a falling edge (end of a mark) comes late
+        edge = t + (i & 1 ? 0 : US(stretch)) + US(jitter) * ((double)(rnd() % 2001) / 1000 - 1);
+        out[i] = (uint16_t)(edge - last + 0.5);
+        last = edge;
+    }
+}
@@ -0,0 +1,50 @@
+/***************************
+ * IR_TRACE.H
+ * IR frames as edge intervals, for the codec and protocol tests
+ *
+ * The frames are built from the protocol timings (not from IR_Protocol.c), as SMCLK ticks at
+ * 4MHz, mark first and ending on a mark, the way the Data Collection capture sees them.
+ * ir_trace_receive() turns an ideal frame into what a demodulating receiver (TSOP) records:
+ * each mark comes out longer by `stretch` us and the space after it as much shorter, and every
+ * edge moves by up to `jitter` us. No captures of real remotes are kept in the tree.
+****************************/
+
+#ifndef IR_TRACE_H_
+#define IR_TRACE_H_
+
+#include <stdint.h>
+
+#define IR_TRACE_MAX    256
+
+enum {
+    IR_TRACE_NEC,               //address, ~address, command, ~command
+    IR_TRACE_NECX,              //16 bit address, command, ~command
+    IR_TRACE_SIRC12,            //7 bit command, 5 bit address
+    IR_TRACE_SIRC15,            //7 bit command, 8 bit address
+    IR_TRACE_SIRC20,            //7 bit command, 13 bit address
+    IR_TRACE_RC5,               //5 bit address, 7 bit command (field bit), toggle
+    IR_TRACE_RC6,               //mode 0..7, toggle, 8 bit address, 8 bit command
+    IR_TRACE_PROTOCOLS
+};
+
+typedef struct
+{
+    uint16_t    address;
+    uint8_t     command;
+    uint8_t     toggle;
+    uint8_t     mode;           //RC6
+} ir_fields_t;
+
+const char *ir_trace_name(int protocol);
+
+//Ideal frame of protocol with fields f into out (IR_TRACE_MAX), returns the number of intervals
+unsigned ir_trace_ideal(int protocol, const ir_fields_t *f, uint16_t *out);
+
+//Random fields valid for protocol
+void ir_trace_fields(int protocol, ir_fields_t *f, uint32_t (*rnd)(void));
+
+//The frame as a receiver records it (see above), seeded by rnd
+void ir_trace_receive(const uint16_t *ideal, unsigned n, uint16_t *out, double stretch, double jitter,
+                      uint32_t (*rnd)(void));
+
+#endif /* IR_TRACE_H_ */
@@ -0,0 +1,96 @@
+/***************************
+ * LCD_LETTER_BASELINE.C
+ * LCD_Letter of the LCD.c copies before the glyph[] table, for test_lcd_glyph.c
+ *
+ * The digit/alphabet tables and the switch as they were, renamed with a baseline_ prefix.
+ * FRAM and Keypad Test and LCD and ADC Test had no digit case (build with BASELINE_NO_DIGITS).
+****************************/
+
+#include "msp430fr4133.h"
+
+//LCD digit display table
+const char baseline_digit[10] =
+{
+		0xFC,  /* "0" */
+		0x60,  /* "1" */
+		0xDB,  /* "2" */
+		0xF3,  /* "3" */
+		0x67,  /* "4" */
+		0xB7,  /* "5" */
+		0xBF,  /* "6" */
+		0xE4,  /* "7" */
+		0xFF,  /* "8" */
+		0xF7   /* "9" */
+};
+
+//LCD alphabet display table
+const char baseline_alphabet[28][2] =
+{
+		{0xEF, 0x00},  /* "A" */ //0
+		{0xF1, 0x50},  /* "B" */ //1
+		{0x9C, 0x00},  /* "C" */ //2
+		{0xF0, 0x50},  /* "D" */ //3
+		{0x9F, 0x00},  /* "E" */ //4
+		{0x8F, 0x00},  /* "F" */ //5
+		{0xBD, 0x00},  /* "G" */ //6
+		{0x6F, 0x00},  /* "H" */ //7
+		{0x90, 0x50},  /* "I" */ //8
+		{0x78, 0x00},  /* "J" */ //9
+		{0x0E, 0x22},  /* "K" */ //10
+		{0x1C, 0x00},  /* "L" */ //11
+		{0x6C, 0xA0},  /* "M" */ //12
+		{0x6C, 0x82},  /* "N" */ //13
+		{0xFC, 0x00},  /* "O" */ //14
+		{0xCF, 0x00},  /* "P" */ //15
+		{0xFC, 0x02},  /* "Q" */ //16
+		{0xCF, 0x02},  /* "R" */ //17
+		{0xB7, 0x00},  /* "S" */ //18
+		{0x80, 0x50},  /* "T" */ //19
+		{0x7C, 0x00},  /* "U" */ //20
+		{0x0C, 0x28},  /* "V" */ //21
+		{0x6C, 0x0A},  /* "W" */ //22
+		{0x00, 0xAA},  /* "X" */ //23
+		{0x00, 0xB0},  /* "Y" */ //24
+		{0x90, 0x28},  /* "Z" */ //25
+		{0x03, 0x50},  /* "+" */ //26
+		{0x03, 0x00}   /* "-" */ //27
+};
+
+// LCD letter display function
+void baseline_LCD_Letter(char ch, unsigned char pos)
+{
+    switch(ch){
+        case ' ':
+            LCDMEM[pos] = 0x00;
+            LCDMEM[pos+1] = 0x00;
+            break;
+        case '.':
+            LCDMEM[pos+1] = 0x01;
+            break;
+        case '+':
+            LCDMEM[pos]   = baseline_alphabet[26][0];
+            LCDMEM[pos+1] = baseline_alphabet[26][1];
+            break;
+        case '-':
+            LCDMEM[pos]   = baseline_alphabet[27][0];
+            LCDMEM[pos+1] = baseline_alphabet[27][1];
+            break;
+        case 'a': case 'b': case 'c': case 'd': case 'e': case 'f': case 'g': case 'h': case 'i': case 'j': case 'k': case 'l': case 'm': case 'n': case 'o': case 'p': case 'q': case 'r': case 's': case 't': case 'u': case 'v': case 'w': case 'x': case 'y': case 'z':
+            LCDMEM[pos]   = baseline_alphabet[ch-'a'][0];
+            LCDMEM[pos+1] = baseline_alphabet[ch-'a'][1];
+            break;
+        case 'A': case 'B': case 'C': case 'D': case 'E': case 'F': case 'G': case 'H': case 'I': case 'J': case 'K': case 'L': case 'M': case 'N': case 'O': case 'P': case 'Q': case 'R': case 'S': case 'T': case 'U': case 'V': case 'W': case 'X': case 'Y': case 'Z':
+            LCDMEM[pos]   = baseline_alphabet[ch-'A'][0];
+            LCDMEM[pos+1] = baseline_alphabet[ch-'A'][1];
+            break;
+#ifndef BASELINE_NO_DIGITS
+        case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
+            LCDMEM[pos] = baseline_digit[ch-'0'];
+            break;
+#endif
+        default:
+            LCDMEM[pos] = 0x00;
+            LCDMEM[pos+1] = 0x00;
+            break;
+    }
+}
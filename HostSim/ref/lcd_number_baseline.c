@@ -0,0 +1,80 @@
+/***************************
+ * LCD_NUMBER_BASELINE.C
+ * LCD_Number of the LCD.c copies before the powers of ten, for test_lcd_glyph.c
+ *
+ * LCD_Number and INT_LEN as they were, renamed with a baseline_ prefix. The old code had no
+ * decimal point: callers put it in by hand (LCD and ADC Test showed 0.xx by adding 100 and
+ * writing the 0 over the 1). baseline_LCD_Fixed_Point is the same %10 and /10 loop padded to
+ * dp+1 digits, with the point after digit len-dp, which is what those callers did.
+ * The LCD_Clear/LCD_Digit/LCD_Letter/LCD_Negative_Sign/LCD_Decimal_Point of the copy are used.
+****************************/
+
+#include "msp430fr4133.h"
+#include "LCD.h"
+
+#define INT_LEN(n) (n>-10 && n<10)?1:\
+				   	(n>-100 && n<100)?2:\
+					(n>-1000 && n<1000)?3:\
+					(n>-10000 && n<10000)?4:\
+					(n>-100000 && n<100000)?5:\
+					(n>-1000000 && n<1000000)?6:\
+					(n>-10000000 && n<10000000)?7:\
+					(n>-100000000 && n<100000000)?8:\
+					(n>-1000000000 && n<100000000)?9:\
+					(n>-10000000000 && n<10000000000)?10:0\
+
+static const unsigned char POS[7] = {0, pos1, pos2, pos3, pos4, pos5, pos6};
+
+void baseline_LCD_Number(long n){
+	LCD_Clear();
+
+	if(n<0){
+		LCD_Negative_Sign();
+		n = -n;
+	}
+
+	unsigned int len = INT_LEN(n);
+
+	if(len==0 || len>6){
+		LCD_Letter('I',pos1);
+		LCD_Letter('N',pos2);
+		LCD_Letter('F',pos3);
+		return;
+	}
+
+	unsigned int i = len;
+	unsigned char lastDigit;
+	while(i--){
+		lastDigit = (unsigned char)(n%10);
+		LCD_Digit(lastDigit,POS[i+1]);
+		n/=10;
+	}
+}
+
+void baseline_LCD_Fixed_Point(long n, unsigned char dp){
+	LCD_Clear();
+
+	if(n<0){
+		LCD_Negative_Sign();
+		n = -n;
+	}
+
+	unsigned int len = INT_LEN(n);
+	if(len < dp+1u) len = dp+1;     //the zeros up to the one in front of the point
+
+	if(len==0 || len>6){
+		LCD_Letter('I',pos1);
+		LCD_Letter('N',pos2);
+		LCD_Letter('F',pos3);
+		return;
+	}
+
+	unsigned int i = len;
+	unsigned char lastDigit;
+	while(i--){
+		lastDigit = (unsigned char)(n%10);
+		LCD_Digit(lastDigit,POS[i+1]);
+		n/=10;
+	}
+	if(dp) LCD_Decimal_Point(POS[len-dp]);
+}
@@ -0,0 +1,96 @@
+/***************************
+ * REMOTE_BASELINE.C
+ * Universal IR Remote before the playback plan (IR_Code_Plan), for test_remote_tx.c
+ *
+ * CODE_GET_COUNT_OR_TIME and TIMER0_A0_ISR as they were, renamed with a baseline_ prefix and
+ * with their own state, so both versions can run in one test.
+****************************/
+
+#include "main.h"
+#include "IR_Codes.h"
+#include "IR_Board.h"
+
+enum MODES baseline_mode;
+enum KEYPAD baseline_button_num;
+unsigned char baseline_tx_cnt = 0;
+const unsigned char *baseline_FRAM_ptr;
+unsigned char baseline_remote_status;
+
+unsigned int baseline_CODE_GET_COUNT_OR_TIME(enum MODES curr_mode, enum KEYPAD curr_num, unsigned char time){
+    switch(curr_mode){
+        case AIRCON:
+            break;
+        case TV1:
+            switch(curr_num){
+                case KEY_0: case KEY_1: case KEY_2: case KEY_3: case KEY_4: case KEY_5: case KEY_6: case KEY_7: case KEY_8: case KEY_9:
+                    switch(time){
+                        case 0: return 35; //count
+                        case 1: return 740; //actual time from coded 1...
+                        case 2: return 855;
+                        case 3: return 1030;
+                        case 4: return 1585;
+                        case 5: return 1855;
+                        case 6: return 2260;
+                        case 7: return 2940;
+                        default: return 0;
+                    }
+                case POWER:
+                    switch(time){
+                        case 0: return 26; //count
+                        case 1: return 2212; //actual time from coded 1...
+                        case 2: return 2568;
+                        case 3: return 4967;
+                        case 4: return 9748;
+                        case 5: return 36712;
+                        default: return 0;
+                    }
+                default: break; //will return 0 anyway
+            }
+            break;
+        case TV2:
+            break;
+    }
+
+    return 0;
+}
+
+//Key press: what IR_Mode_Setting did for TV1
+void baseline_Start(enum KEYPAD key){
+    baseline_mode = TV1;
+    baseline_button_num = key;
+    baseline_tx_cnt = baseline_CODE_GET_COUNT_OR_TIME(baseline_mode, baseline_button_num, 0); //get count
+    if(key == POWER)
+        baseline_FRAM_ptr = &CODES_TV1_POWER[0];
+    else
+        baseline_FRAM_ptr = &CODES_TV1_NUMBERS[index_to_keypad_num((unsigned char)(key))][0];
+    baseline_remote_status = 1;
+}
+
+void baseline_TIMER0_A0_ISR (void)
+{
+    switch( TA0IV )
+    {
+        case TA0IV_NONE:
+            if(baseline_tx_cnt>0){ //Transmitting
+                P4OUT |= BIT0;
+
+                TA0CCTL2 ^= OUT;
+
+                TA0CCR0 = baseline_CODE_GET_COUNT_OR_TIME(baseline_mode,baseline_button_num,*baseline_FRAM_ptr); //Emit appropriate IR code
+                baseline_FRAM_ptr++;
+
+                baseline_tx_cnt--;
+            }
+            else{ //Complete
+                P4OUT &= ~BIT0;
+
+                TA0CCTL0 &= ~CCIE;      // disable timer_A0 interrupt
+                baseline_tx_cnt = 0;
+
+                baseline_remote_status = 0;   //disable IR
+                __bic_SR_register_on_exit(LPM3_bits);                // Exit LPM3
+            }
+            break;
+        default: break;
+    }
+}
@@ -0,0 +1,54 @@
+/***************************
+ * SCROLL_BASELINE.C
+ * OutOfBox hal_LCD.c displayScrollText before the WDT interval and LPM3, for test_scroll_text.c
+ *
+ * As it was, renamed with a baseline_ prefix: one frame every __delay_cycles(200000), drawn with
+ * the current showChar. __delay_cycles is redefined here to also call baseline_frame_shown() (the
+ * test's), so the test sees each frame while the old code busy-waits on it.
+****************************/
+
+#include <string.h>
+#include "hal_LCD.h"
+#include "main.h"
+
+void baseline_frame_shown(void);
+
+#undef __delay_cycles
+#define __delay_cycles(n)   (sim_delay += (n), baseline_frame_shown())
+
+/*
+ * Scrolls input string across LCD screen from left to right
+ */
+void baseline_displayScrollText(char *msg)
+{
+    int length = strlen(msg);
+    int oldmode = *mode;
+    int i;
+    int s = 5;
+    char buffer[6] = "      ";
+    for (i=0; i<length+7; i++)
+    {
+        if (*mode != oldmode)
+            break;
+
+        int t;
+        for (t=0; t<6; t++)
+            buffer[t] = ' ';
+        int j;
+        for (j=0; j<length; j++)
+        {
+            if (((s+j) >= 0) && ((s+j) < 6))
+                buffer[s+j] = msg[j];
+        }
+        s--;
+
+        showChar(buffer[0], pos1);
+        showChar(buffer[1], pos2);
+        showChar(buffer[2], pos3);
+        showChar(buffer[3], pos4);
+        showChar(buffer[4], pos5);
+        showChar(buffer[5], pos6);
+
+        __delay_cycles(200000);
+    }
+}
@@ -0,0 +1,78 @@
+/***************************
+ * SHOWCHAR_BASELINE.C
+ * OutOfBox hal_LCD.c showChar before the lcdChar[] table, for test_lcd_glyph.c
+ *
+ * The digit/alphabetBig tables and the if/else chain as they were, renamed with a baseline_ prefix.
+ * digit[][0] | digit[][1] << 8 relies on plain char being unsigned (as IAR has it): with a signed char,
+ * 0xFC would extend to 0xFFFC and light the whole high byte. The Makefile builds this with -funsigned-char.
+****************************/
+
+#include "hal_LCD.h"
+
+const char baseline_digit[10][2] =
+{
+    {0xFC, 0x28},  /* "0" LCD segments a+b+c+d+e+f+k+q */
+    {0x60, 0x20},  /* "1" */
+    {0xDB, 0x00},  /* "2" */
+    {0xF3, 0x00},  /* "3" */
+    {0x67, 0x00},  /* "4" */
+    {0xB7, 0x00},  /* "5" */
+    {0xBF, 0x00},  /* "6" */
+    {0xE4, 0x00},  /* "7" */
+    {0xFF, 0x00},  /* "8" */
+    {0xF7, 0x00}   /* "9" */
+};
+
+const char baseline_alphabetBig[26][2] =
+{
+    {0xEF, 0x00},  /* "A" LCD segments a+b+c+e+f+g+m */
+    {0xF1, 0x50},  /* "B" */
+    {0x9C, 0x00},  /* "C" */
+    {0xF0, 0x50},  /* "D" */
+    {0x9F, 0x00},  /* "E" */
+    {0x8F, 0x00},  /* "F" */
+    {0xBD, 0x00},  /* "G" */
+    {0x6F, 0x00},  /* "H" */
+    {0x90, 0x50},  /* "I" */
+    {0x78, 0x00},  /* "J" */
+    {0x0E, 0x22},  /* "K" */
+    {0x1C, 0x00},  /* "L" */
+    {0x6C, 0xA0},  /* "M" */
+    {0x6C, 0x82},  /* "N" */
+    {0xFC, 0x00},  /* "O" */
+    {0xCF, 0x00},  /* "P" */
+    {0xFC, 0x02},  /* "Q" */
+    {0xCF, 0x02},  /* "R" */
+    {0xB7, 0x00},  /* "S" */
+    {0x80, 0x50},  /* "T" */
+    {0x7C, 0x00},  /* "U" */
+    {0x0C, 0x28},  /* "V" */
+    {0x6C, 0x0A},  /* "W" */
+    {0x00, 0xAA},  /* "X" */
+    {0x00, 0xB0},  /* "Y" */
+    {0x90, 0x28}   /* "Z" */
+};
+
+void baseline_showChar(char c, int position)
+{
+    if (c == ' ')
+    {
+        // Display space
+        LCDMEMW[position/2] = 0;
+    }
+    else if (c >= '0' && c <= '9')
+    {
+        // Display digit
+        LCDMEMW[position/2] = baseline_digit[c-48][0] | (baseline_digit[c-48][1] << 8);
+    }
+    else if (c >= 'A' && c <= 'Z')
+    {
+        // Display alphabet
+        LCDMEMW[position/2] = baseline_alphabetBig[c-65][0] | (baseline_alphabetBig[c-65][1] << 8);
+    }
+    else
+    {
+        // Turn all segments on if character is not a space, digit, or uppercase letter
+        LCDMEMW[position/2] = 0xFFFF;
+    }
+}
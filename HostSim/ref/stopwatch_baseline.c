@@ -0,0 +1,108 @@
+/***************************
+ * STOPWATCH_BASELINE.C
+ * OutOfBox StopWatchMode.c Inc_RTC/displayTime before the LCD shadow, for test_stopwatch_lcd.c
+ *
+ * As they were, renamed with a baseline_ prefix. They keep the time in the same backup memory
+ * as StopWatchMode.c and draw with the current showChar (test_lcd_glyph checks it against the old one).
+****************************/
+
+#include "StopWatchMode.h"
+#include "hal_LCD.h"
+#include "main.h"
+
+extern volatile unsigned char * Centiseconds;
+extern volatile unsigned char * Seconds;
+extern volatile unsigned char * Minutes;
+extern volatile unsigned char * Hours;
+
+void baseline_displayTime(void);
+
+// Increment Real Time Counter
+void baseline_Inc_RTC()
+{
+    // Clock increment logic
+    // Handles maximum 100 hours, then wraps over to 00:00:00
+    (*Centiseconds)++;
+    (*Centiseconds) %= 100;
+    if ((*Centiseconds) == 0)
+    {
+        (*Seconds)++;
+        (*Seconds) %= 60;
+        if ((*Seconds) == 0)
+        {
+            (*Minutes)++;
+            (*Minutes) %= 60;
+            if ((*Minutes) == 0)
+            {
+                ++(*Hours);
+                (*Hours) %= 100;
+            }
+        }
+    }
+
+    // Update LCD with new time
+    baseline_displayTime();
+}
+
+void baseline_displayTime()
+{
+    // Display Minute, Second, Centiseconds if below 1 hour mark.
+    if ((*Hours) == 0)
+    {
+        showChar((*Centiseconds) % 10 + '0',pos6);
+        showChar((*Centiseconds) / 10 + '0',pos5);
+        showChar((*Seconds) % 10 + '0',pos4);
+        showChar((*Seconds) / 10 + '0',pos3);
+        showChar((*Minutes) % 10 + '0',pos2);
+        showChar((*Minutes) / 10 + '0',pos1);
+    }
+    // Otherwise, display Hour, Minute, Second
+    else
+    {
+        showChar((*Seconds) % 10 + '0',pos6);
+        showChar((*Seconds) / 10 + '0',pos5);
+        showChar((*Minutes) % 10 + '0',pos4);
+        showChar((*Minutes) / 10 + '0',pos3);
+        showChar((*Hours) % 10 + '0',pos2);
+        showChar((*Hours) / 10 + '0',pos1);
+    }
+
+// Workaround LCDBMEM definition bug in IAR header file
+#ifdef __IAR_SYSTEMS_ICC__
+    if ((*Centiseconds) == 0)
+    {
+        LCDMEM[12] |= 0x08;
+        LCDBM12 |= 0x08;
+    }
+    if ((*Centiseconds) == 50)
+    {
+        LCDMEM[12] &= ~0x08;
+        LCDBM12 &= ~0x08;
+    }
+
+    // Display the 2 colons
+    LCDMEM[7] |= 0x04;
+    LCDM39 |= 0x04;
+
+    LCDMEM[11] |= 0x04;
+    LCDBM11 |= 0x04;
+#else    
+    // Blink Stopwatch symbol
+    if ((*Centiseconds) == 0)
+    {
+        LCDMEM[12] |= 0x08;
+        LCDBMEM[12] |= 0x08;
+    }
+    if ((*Centiseconds) == 50)
+    {
+        LCDMEM[12] &= ~0x08;
+        LCDBMEM[12] &= ~0x08;
+    }
+
+    // Display the 2 colons
+    LCDMEM[7] |= 0x04;
+    LCDBMEM[7] |= 0x04;
+    LCDMEM[11] |= 0x04;
+    LCDBMEM[11] |= 0x04;
+#endif
+}
@@ -0,0 +1,20 @@
+/***************************
+ * TEMPCAL_BASELINE.C
+ * OutOfBox TempSensorMode.c temperature conversion before the TLV precomputation, for test_tempcal.c
+ *
+ * As it was in tempSensor(), on every 10-bit conversion, made a function with a baseline_ prefix.
+ * The calibration is read from the TLV addresses (sim_TLV on the host). The one cast does what the
+ * 16-bit unsigned arithmetic of `(*degC) * 9` did on the MSP430.
+****************************/
+
+#include <msp430fr4133.h>
+
+#define CALADC_15V_30C  *((unsigned int *)0x1A1A)       // Temperature Sensor Calibration-30 C
+#define CALADC_15V_85C  *((unsigned int *)0x1A1C)       // Temperature Sensor Calibration-85 C
+
+void baseline_tempConvert(unsigned int adc, unsigned short *degC, unsigned short *degF)
+{
+    signed short temp = (adc - CALADC_15V_30C);
+    *degC = ((long)temp * 10 * (85-30) * 10)/((CALADC_15V_85C-CALADC_15V_30C)*10) + 300;
+    *degF = (unsigned int)((*degC) * 9) / 5 + 320;
+}
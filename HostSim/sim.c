@@ -0,0 +1,481 @@
+/***************************
+ * SIM.C
+ * Register storage, MPY32 emulation, ISR measurement and waveform checks for the host simulator
+ *
+ * Instruction counting:
+ *      sim_init() forks. The child runs the test and asks to be traced, the parent is the tracer.
+ *      SIM_RUN() puts an int3 before and after the measured call. At the first one the parent
+ *      single-steps the child until the next instruction is the second int3, skips it, and writes
+ *      the number of steps to a shared counter that sim_end() reads.
+ *      The overhead of an empty SIM_RUN() is measured once and taken off every count.
+****************************/
+
+#define _GNU_SOURCE                             //REG_EFL
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/ptrace.h>
+#include <sys/user.h>
+#include <sys/wait.h>
+#include <ucontext.h>
+
+#include "msp430fr4133.h"
+#include "sim.h"
+
+/************************************************************
+* REGISTERS
+* Kept in their own section so sim_reset() can clear them all at once
+************************************************************/
+#define SIM_R16(n)  volatile uint16_t sim_##n __attribute__((section("sim_regs")));
+#define SIM_R8(n)   volatile uint8_t sim_##n __attribute__((section("sim_regs")));
+
+SIM_R16(SFRIE1) SIM_R16(SFRIFG1) SIM_R16(SFRRPCR) SIM_R16(PMMCTL0) SIM_R16(PMMCTL1)
+SIM_R16(PMMCTL2) SIM_R16(PMMIFG) SIM_R16(PM5CTL0) SIM_R16(SYSCTL) SIM_R16(SYSBSLC) SIM_R16(SYSJMBC)
+SIM_R16(SYSJMBI0) SIM_R16(SYSJMBI1) SIM_R16(SYSJMBO0) SIM_R16(SYSJMBO1) SIM_R16(SYSUNIV)
+SIM_R16(SYSSNIV) SIM_R16(SYSRSTIV) SIM_R16(SYSCFG0) SIM_R16(SYSCFG1) SIM_R16(SYSCFG2)
+SIM_R16(CSCTL0) SIM_R16(CSCTL1) SIM_R16(CSCTL2) SIM_R16(CSCTL3) SIM_R16(CSCTL4) SIM_R16(CSCTL5)
+SIM_R16(CSCTL6) SIM_R16(CSCTL7) SIM_R16(CSCTL8) SIM_R16(FRCTL0) SIM_R16(GCCTL0) SIM_R16(GCCTL1)
+SIM_R16(CRCDI) SIM_R16(CRCDIRB) SIM_R16(CRCINIRES) SIM_R16(CRCRESR) SIM_R16(WDTCTL) SIM_R16(P1IV)
+SIM_R16(P2IV) SIM_R16(TA0CTL) SIM_R16(TA0CCTL0) SIM_R16(TA0CCTL1) SIM_R16(TA0CCTL2) SIM_R16(TA0R)
+SIM_R16(TA0CCR0) SIM_R16(TA0CCR1) SIM_R16(TA0CCR2) SIM_R16(TA0EX0) SIM_R16(TA0IV) SIM_R16(TA1CTL)
+SIM_R16(TA1CCTL0) SIM_R16(TA1CCTL1) SIM_R16(TA1CCTL2) SIM_R16(TA1R) SIM_R16(TA1CCR0)
+SIM_R16(TA1CCR1) SIM_R16(TA1CCR2) SIM_R16(TA1EX0) SIM_R16(TA1IV) SIM_R16(RTCCTL) SIM_R16(RTCIV)
+SIM_R16(RTCMOD) SIM_R16(RTCCNT) SIM_R16(LCDCTL0) SIM_R16(LCDCTL1) SIM_R16(LCDBLKCTL)
+SIM_R16(LCDMEMCTL) SIM_R16(LCDVCTL) SIM_R16(LCDPCTL0) SIM_R16(LCDPCTL1) SIM_R16(LCDPCTL2)
+SIM_R16(LCDCSSEL0) SIM_R16(LCDCSSEL1) SIM_R16(LCDCSSEL2) SIM_R16(LCDIV) SIM_R16(ADCCTL0)
+SIM_R16(ADCCTL1) SIM_R16(ADCCTL2) SIM_R16(ADCLO) SIM_R16(ADCHI) SIM_R16(ADCMCTL0) SIM_R16(ADCMEM0)
+SIM_R16(ADCIE) SIM_R16(ADCIFG) SIM_R16(ADCIV) SIM_R16(MPY32CTL0) SIM_R8(P1IN) SIM_R8(P1OUT)
+SIM_R8(P1DIR) SIM_R8(P1REN) SIM_R8(P1SEL0) SIM_R8(P1SEL1) SIM_R8(P2IN) SIM_R8(P2OUT) SIM_R8(P2DIR)
+SIM_R8(P2REN) SIM_R8(P2SEL0) SIM_R8(P2SEL1) SIM_R8(P3IN) SIM_R8(P3OUT) SIM_R8(P3DIR) SIM_R8(P3REN)
+SIM_R8(P3SEL0) SIM_R8(P3SEL1) SIM_R8(P4IN) SIM_R8(P4OUT) SIM_R8(P4DIR) SIM_R8(P4REN) SIM_R8(P4SEL0)
+SIM_R8(P4SEL1) SIM_R8(P5IN) SIM_R8(P5OUT) SIM_R8(P5DIR) SIM_R8(P5REN) SIM_R8(P5SEL0) SIM_R8(P5SEL1)
+SIM_R8(P6IN) SIM_R8(P6OUT) SIM_R8(P6DIR) SIM_R8(P6REN) SIM_R8(P6SEL0) SIM_R8(P6SEL1) SIM_R8(P7IN)
+SIM_R8(P7OUT) SIM_R8(P7DIR) SIM_R8(P7REN) SIM_R8(P7SEL0) SIM_R8(P7SEL1) SIM_R8(P8IN) SIM_R8(P8OUT)
+SIM_R8(P8DIR) SIM_R8(P8REN) SIM_R8(P8SEL0) SIM_R8(P8SEL1) SIM_R8(P1IES) SIM_R8(P1IE) SIM_R8(P1IFG)
+SIM_R8(P2IES) SIM_R8(P2IE) SIM_R8(P2IFG) SIM_R16(MPY) SIM_R16(MPYS) SIM_R16(MAC) SIM_R16(MACS)
+SIM_R16(OP2) SIM_R16(RESLO) SIM_R16(RESHI) SIM_R16(SUMEXT) SIM_R16(MPY32L) SIM_R16(MPY32H)
+SIM_R16(MPYS32L) SIM_R16(MPYS32H) SIM_R16(MAC32L) SIM_R16(MAC32H) SIM_R16(MACS32L) SIM_R16(MACS32H)
+SIM_R16(OP2L) SIM_R16(OP2H) SIM_R16(RES0) SIM_R16(RES1) SIM_R16(RES2) SIM_R16(RES3)
+
+volatile sim_lcd_t sim_LCD __attribute__((aligned(4096)));
+volatile sim_bak_t sim_BAKMEM[16];
+uint8_t sim_TLV[256] __attribute__((aligned(2)));
+
+extern volatile uint8_t __start_sim_regs[];
+extern volatile uint8_t __stop_sim_regs[];
+
+volatile uint16_t sim_sr;
+uint32_t sim_delay;
+uint32_t sim_wakes;
+uint32_t sim_sleeps;
+uint32_t sim_acc;
+uint32_t sim_lcd_acc;
+uint32_t sim_lcd_writes;
+uint32_t sim_mpy_early;
+void (*sim_lpm_hook)(void);
+
+int sim_traced;
+unsigned sim_checks;
+unsigned sim_failures;
+
+sim_seg_t sim_wave[SIM_WAVE_MAX];
+unsigned sim_wave_n;
+
+static volatile uint32_t *sim_shared;   //step count written by the tracer
+static uint32_t sim_overhead;           //steps of an empty SIM_RUN()
+static uint32_t sim_acc_start;
+static uint32_t sim_delay_start;
+
+void sim_reset(void)
+{
+    volatile uint8_t *r;
+
+    for(r = __start_sim_regs; r < __stop_sim_regs; r++)
+        *r = 0;
+    sim_lcd_watch(0);
+    memset((void *)&sim_LCD, 0, sizeof(sim_LCD));
+    memset((void *)sim_BAKMEM, 0, sizeof(sim_BAKMEM));
+    sim_sr = 0;
+    sim_delay = 0;
+    sim_wakes = 0;
+    sim_sleeps = 0;
+    sim_acc = 0;
+    sim_lcd_acc = 0;
+    sim_lcd_writes = 0;
+    sim_lpm_hook = 0;
+}
+
+void sim_enter_lpm(uint16_t bits)
+{
+    sim_sr |= bits;
+    if(bits & CPUOFF){
+        sim_sleeps++;
+        if(sim_lpm_hook)
+            sim_lpm_hook();
+    }
+}
+
+/************************************************************
+* MPY32
+* Writing OP2 (16 bit) or OP2H (32 bit) starts a multiplication with the first operand
+* register written last. It is worked out at the next access to any MPY32 register,
+* which is before that access reads or writes it.
+* Reading a result needs the __delay_cycles that MPY32.h documents after OP2H:
+* RES0/RES1 7 cycles, RES2/RES3 11. Earlier reads are counted in sim_mpy_early.
+************************************************************/
+static int mpy_op1 = SIM_MPY_MPY;       //first operand register
+static int mpy_pending;                 //0, 16 (OP2) or 32 (OP2H)
+static int mpy_wide;                    //last multiplication had a 32 bit second operand
+static uint32_t mpy_started;            //sim_delay when it started
+
+static volatile uint16_t *const mpy_op1_lo[] = {
+    &sim_MPY, &sim_MPYS, &sim_MAC, &sim_MACS, &sim_MPY32L, &sim_MPYS32L, &sim_MAC32L, &sim_MACS32L
+};
+static volatile uint16_t *const mpy_op1_hi[] = {
+    0, 0, 0, 0, &sim_MPY32H, &sim_MPYS32H, &sim_MAC32H, &sim_MACS32H
+};
+
+static void mpy_run(void)
+{
+    int op = mpy_op1 < SIM_MPY_MPY32L ? mpy_op1 - SIM_MPY_MPY : 4 + (mpy_op1 - SIM_MPY_MPY32L) / 2;
+    int sign = op & 1;
+    int acc = op & 2;
+    int64_t a, b, p;
+    uint64_t res;
+
+    if(op < 4)
+        a = sign ? (int64_t)(int16_t)*mpy_op1_lo[op] : (int64_t)*mpy_op1_lo[op];
+    else{
+        uint32_t u = *mpy_op1_lo[op] | ((uint32_t)*mpy_op1_hi[op] << 16);
+        a = sign ? (int64_t)(int32_t)u : (int64_t)u;
+    }
+    if(mpy_pending == 32){
+        uint32_t u = sim_OP2L | ((uint32_t)sim_OP2H << 16);
+        b = sign ? (int64_t)(int32_t)u : (int64_t)u;
+    }
+    else
+        b = sign ? (int64_t)(int16_t)sim_OP2 : (int64_t)sim_OP2;
+    p = a * b;
+
+    if(op < 4 && mpy_pending == 16){     //16x16: RESHI:RESLO, SUMEXT
+        uint32_t sum = (uint32_t)p;
+        if(acc){
+            uint32_t old = sim_RESLO | ((uint32_t)sim_RESHI << 16);
+            uint64_t wide = (uint64_t)old + sum;
+            sum = (uint32_t)wide;
+            sim_SUMEXT = sign ? (((int32_t)sum < 0) ? 0xFFFF : 0) : (uint16_t)(wide >> 32);
+        }
+        else
+            sim_SUMEXT = sign ? ((p < 0) ? 0xFFFF : 0) : 0;
+        res = sign ? (uint64_t)(int64_t)(int32_t)sum : sum;
+    }
+    else{
+        res = (uint64_t)p;
+        if(acc)
+            res += sim_RES0 | ((uint64_t)sim_RES1 << 16) | ((uint64_t)sim_RES2 << 32) | ((uint64_t)sim_RES3 << 48);
+        sim_SUMEXT = sign ? (((int64_t)res < 0) ? 0xFFFF : 0) : 0;
+    }
+    sim_RES0 = sim_RESLO = (uint16_t)res;
+    sim_RES1 = sim_RESHI = (uint16_t)(res >> 16);
+    sim_RES2 = (uint16_t)(res >> 32);
+    sim_RES3 = (uint16_t)(res >> 48);
+
+    mpy_wide = mpy_pending == 32;
+    mpy_pending = 0;
+}
+
+void sim_mpy_access(int reg)
+{
+    static const uint8_t ready[] = { 7, 7, 11, 11 };     //RES0..RES3 after OP2H
+
+    if(mpy_pending)
+        mpy_run();
+
+    switch(reg){
+    case SIM_MPY_MPY: case SIM_MPY_MPYS: case SIM_MPY_MAC: case SIM_MPY_MACS:
+    case SIM_MPY_MPY32L: case SIM_MPY_MPY32H: case SIM_MPY_MPYS32L: case SIM_MPY_MPYS32H:
+    case SIM_MPY_MAC32L: case SIM_MPY_MAC32H: case SIM_MPY_MACS32L: case SIM_MPY_MACS32H:
+        mpy_op1 = reg;
+        break;
+    case SIM_MPY_OP2:
+        mpy_pending = 16;
+        mpy_started = sim_delay;
+        break;
+    case SIM_MPY_OP2H:
+        mpy_pending = 32;
+        mpy_started = sim_delay;
+        break;
+    case SIM_MPY_RES0: case SIM_MPY_RES1: case SIM_MPY_RES2: case SIM_MPY_RES3:
+        if(mpy_wide && sim_delay - mpy_started < ready[reg - SIM_MPY_RES0])
+            sim_mpy_early++;
+        break;
+    default:
+        break;
+    }
+}
+
+/************************************************************
+* LCD WRITES
+* sim_lcd_watch(1) makes the page of sim_LCD read-only. A write to it faults: the SIGSEGV handler
+* counts it in sim_lcd_writes, makes the page writable and sets the trap flag, so the write is
+* done and the SIGTRAP right after it makes the page read-only again. Reads are not counted.
+* Do not watch inside SIM_RUN(): the tracer single-steps the test and would not see the faults.
+************************************************************/
+static int lcd_watching;
+
+static void lcd_protect(int ro)
+{
+    mprotect((void *)&sim_LCD, sizeof(sim_LCD), ro ? PROT_READ : PROT_READ | PROT_WRITE);
+}
+
+static void lcd_fault(int sig, siginfo_t *si, void *ctx)
+{
+    ucontext_t *uc = ctx;
+    uint8_t *at = si->si_addr;
+
+    if(!lcd_watching || at < (uint8_t *)&sim_LCD || at >= (uint8_t *)&sim_LCD + sizeof(sim_LCD)){
+        signal(SIGSEGV, SIG_DFL);               //a real fault: runs again and stops the test
+        return;
+    }
+    sim_lcd_writes++;
+    lcd_protect(0);
+    uc->uc_mcontext.gregs[REG_EFL] |= 0x100;    //TF
+}
+
+static void lcd_step(int sig, siginfo_t *si, void *ctx)
+{
+    ucontext_t *uc = ctx;
+
+    uc->uc_mcontext.gregs[REG_EFL] &= ~0x100;
+    if(lcd_watching)
+        lcd_protect(1);
+}
+
+void sim_lcd_watch(int on)
+{
+    static int installed;
+    struct sigaction sa;
+
+    if(on && !installed){
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_flags = SA_SIGINFO;
+        sa.sa_sigaction = lcd_fault;
+        sigaction(SIGSEGV, &sa, 0);
+        sa.sa_sigaction = lcd_step;
+        sigaction(SIGTRAP, &sa, 0);
+        installed = 1;
+    }
+    if(on != lcd_watching){
+        lcd_watching = on;
+        lcd_protect(on);
+    }
+}
+
+/************************************************************
+* INSTRUCTION COUNTING
+************************************************************/
+static void sim_tracer(pid_t child)
+{
+    int status;
+    struct user_regs_struct regs;
+
+    for(;;){
+        if(waitpid(child, &status, 0) < 0)
+            exit(1);
+        if(WIFEXITED(status))
+            exit(WEXITSTATUS(status));
+        if(WIFSIGNALED(status)){
+            fprintf(stderr, "test killed by signal %d\n", WTERMSIG(status));
+            exit(1);
+        }
+        if(!WIFSTOPPED(status))
+            continue;
+
+        if(WSTOPSIG(status) == SIGSTOP){        //the child stopping itself to be traced
+            ptrace(PTRACE_SETOPTIONS, child, 0, PTRACE_O_EXITKILL);
+            ptrace(PTRACE_CONT, child, 0, 0);
+            continue;
+        }
+        if(WSTOPSIG(status) != SIGTRAP){        //pass other signals on
+            ptrace(PTRACE_CONT, child, 0, WSTOPSIG(status));
+            continue;
+        }
+        siginfo_t si;
+        ptrace(PTRACE_GETSIGINFO, child, 0, &si);
+        if(si.si_code != SI_KERNEL){            //not an int3: the trap flag of sim_lcd_watch()
+            ptrace(PTRACE_CONT, child, 0, SIGTRAP);
+            continue;
+        }
+
+        //start marker: step up to the end marker
+        uint32_t steps = 0;
+        for(;;){
+            ptrace(PTRACE_GETREGS, child, 0, &regs);
+            long word = ptrace(PTRACE_PEEKTEXT, child, regs.rip, 0);
+            if((word & 0xFF) == 0xCC)
+                break;
+            if(ptrace(PTRACE_SINGLESTEP, child, 0, 0) < 0)
+                exit(1);
+            if(waitpid(child, &status, 0) < 0 || !WIFSTOPPED(status))
+                exit(1);
+            steps++;
+        }
+        regs.rip++;                             //skip the end marker
+        ptrace(PTRACE_SETREGS, child, 0, &regs);
+        *sim_shared = steps;
+        ptrace(PTRACE_CONT, child, 0, 0);
+    }
+}
+
+void sim_init(void)
+{
+    pid_t child;
+
+    setvbuf(stdout, 0, _IOLBF, 0);
+    sim_reset();
+    if(getenv("SIM_NOTRACE"))
+        return;
+
+    sim_shared = mmap(0, sizeof(uint32_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(sim_shared == MAP_FAILED)
+        return;
+
+    child = fork();
+    if(child < 0)
+        return;
+    if(child > 0)
+        sim_tracer(child);                      //does not return
+
+    if(ptrace(PTRACE_TRACEME, 0, 0, 0) < 0)
+        return;                                 //already traced (debugger): no counts
+    raise(SIGSTOP);
+    sim_traced = 1;
+
+    //overhead of SIM_RUN() itself
+    sim_stat_t cal = SIM_STAT("calibration");
+    int i;
+    for(i = 0; i < 8; i++)
+        SIM_RUN(cal, (void)0);
+    sim_overhead = cal.instr_min;
+}
+
+void sim_begin(void)
+{
+    sim_acc_start = sim_acc;
+    sim_delay_start = sim_delay;
+}
+
+void sim_end(sim_stat_t *stat)
+{
+    uint32_t acc = sim_acc - sim_acc_start;
+    uint32_t delay = sim_delay - sim_delay_start;
+
+    stat->calls++;
+    stat->acc_sum += acc;
+    if(acc > stat->acc_max)
+        stat->acc_max = acc;
+    if(delay > stat->delay_max)
+        stat->delay_max = delay;
+    if(sim_traced){
+        uint32_t steps = *sim_shared;
+        steps = steps > sim_overhead ? steps - sim_overhead : 0;
+        stat->traced++;
+        stat->instr_sum += steps;
+        if(steps < stat->instr_min)
+            stat->instr_min = steps;
+        if(steps > stat->instr_max)
+            stat->instr_max = steps;
+    }
+}
+
+//Adds the calls in from to to, eg. to sort calls by what they turned out to do
+void sim_merge(sim_stat_t *to, const sim_stat_t *from)
+{
+    to->calls += from->calls;
+    to->traced += from->traced;
+    to->instr_sum += from->instr_sum;
+    if(from->traced && from->instr_min < to->instr_min)
+        to->instr_min = from->instr_min;
+    if(from->instr_max > to->instr_max)
+        to->instr_max = from->instr_max;
+    to->acc_sum += from->acc_sum;
+    if(from->acc_max > to->acc_max)
+        to->acc_max = from->acc_max;
+    if(from->delay_max > to->delay_max)
+        to->delay_max = from->delay_max;
+}
+
+void sim_report_header(void)
+{
+    printf("%-34s %7s %26s %15s %8s\n", "", "calls", "x86 instr min/avg/max", "reg acc avg/max", "delay");
+}
+
+void sim_report(const sim_stat_t *s)
+{
+    char instr[32] = "n/a";
+
+    if(s->traced)
+        snprintf(instr, sizeof(instr), "%u/%llu/%u", s->instr_min,
+                 (unsigned long long)(s->instr_sum / s->traced), s->instr_max);
+    printf("%-34s %7u %26s %7.1f/%-7u %8u\n", s->name, s->calls, instr,
+           s->calls ? (double)s->acc_sum / s->calls : 0.0, s->acc_max, s->delay_max);
+}
+
+int sim_done(void)
+{
+    SIM_CHECK(!sim_mpy_early, "%lu MPY32 results read before they were ready", (unsigned long)sim_mpy_early);
+    printf("%u checks, %u failed\n", sim_checks, sim_failures);
+    return sim_failures ? 1 : 0;
+}
+
+/************************************************************
+* WAVEFORMS
+************************************************************/
+void sim_wave_reset(void)
+{
+    sim_wave_n = 0;
+}
+
+void sim_wave_add(uint8_t level, uint32_t ticks)
+{
+    if(ticks == 0)
+        return;
+    if(sim_wave_n && sim_wave[sim_wave_n - 1].level == level)
+        sim_wave[sim_wave_n - 1].ticks += ticks;
+    else if(sim_wave_n < SIM_WAVE_MAX){
+        sim_wave[sim_wave_n].level = level;
+        sim_wave[sim_wave_n].ticks = ticks;
+        sim_wave_n++;
+    }
+}
+
+//Compares the recorded waveform with ref and returns the largest error in us
+//Prints the result when name is given
+double sim_wave_check(const char *name, const sim_ref_t *ref, unsigned n, double tick_us)
+{
+    unsigned i;
+    double err, max_err = 0, sum_err = 0;
+    int quiet = name == 0;
+
+    if(quiet)
+        name = "waveform";
+
+    SIM_CHECK(sim_wave_n == n, "%s: %u segments, expected %u", name, sim_wave_n, n);
+    if(sim_wave_n < n)
+        n = sim_wave_n;
+    for(i = 0; i < n; i++){
+        SIM_CHECK(sim_wave[i].level == ref[i].level, "%s: segment %u level %u, expected %u",
+                  name, i, sim_wave[i].level, ref[i].level);
+        err = sim_wave[i].ticks * tick_us - ref[i].us;
+        if(err < 0)
+            err = -err;
+        sum_err += err;
+        if(err > max_err)
+            max_err = err;
+    }
+    if(!quiet)
+        printf("%s: %u segments, error max %.2f us, mean %.2f us\n", name, n, max_err, n ? sum_err / n : 0.0);
+    return max_err;
+}
@@ -0,0 +1,112 @@
+/***************************
+ * SIM.H
+ * Host simulator for the MSP430FR4133 projects
+ *
+ * The firmware sources are compiled for Linux against the register stand-ins in include/
+ * (see the Makefile for how the 16 bit int types are kept). A test calls the ISRs and
+ * functions directly, after setting the registers the way the hardware would.
+ *
+ * Measurements:
+ *      SIM_RUN(stat, call) runs call and adds it to stat: host x86-64 instructions
+ *      (counted by single-stepping the test under ptrace), register accesses and __delay_cycles.
+ *      The instruction count is not an MSP430 cycle count, but code that takes the same path
+ *      takes the same number of instructions, so it shows whether an ISR is constant-time and
+ *      compares two versions of the same code. The register accesses are the same as on target.
+ *      Set SIM_NOTRACE=1 (or run under a debugger) to skip the instruction count.
+ *
+ * Waveforms:
+ *      sim_wave_add() records an output as (level, ticks) segments, sim_wave_check() compares
+ *      it with the timings of a protocol and prints the largest error in us.
+****************************/
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+//Per-call statistics of one ISR or function
+typedef struct
+{
+    const char      *name;
+    uint32_t        calls;
+    uint32_t        traced;         //calls with an instruction count
+    uint64_t        instr_sum;
+    uint32_t        instr_min;
+    uint32_t        instr_max;
+    uint64_t        acc_sum;        //register accesses
+    uint32_t        acc_max;
+    uint32_t        delay_max;      //__delay_cycles
+} sim_stat_t;
+
+#define SIM_STAT(name)  { (name), 0, 0, 0, UINT32_MAX, 0, 0, 0, 0 }
+
+//One part of a recorded or expected waveform
+typedef struct
+{
+    uint8_t         level;
+    uint32_t        ticks;
+} sim_seg_t;
+
+typedef struct
+{
+    uint8_t         level;
+    double          us;
+} sim_ref_t;
+
+#define SIM_WAVE_MAX    4096
+
+extern int          sim_traced;     //instruction counting is available
+extern unsigned     sim_checks;
+extern unsigned     sim_failures;
+extern uint32_t     sim_mpy_early;  //MPY32 results read before they were ready (sim_done fails if any)
+extern void         (*sim_lpm_hook)(void);   //called when the firmware enters a low power mode
+
+//sim_driverlib.c (OutOfBox tests)
+extern uint16_t     sim_tlv_adccal[8];      //returned by TLV_getInfo(TLV_TAG_ADCCAL) if sim_tlv_adccal_len is set
+extern uint8_t      sim_tlv_adccal_len;
+extern uint32_t     sim_fram_writes;        //bytes written by FRAMCtl_write8/16/32
+extern uint32_t     sim_fram_cut;           //power loss: FRAM writes stop once sim_fram_writes gets there (0: never)
+
+extern uint32_t     sim_lcd_writes;         //LCD memory writes while sim_lcd_watch(1)
+
+extern sim_seg_t    sim_wave[SIM_WAVE_MAX];
+extern unsigned     sim_wave_n;
+
+#define SIM_MARK()  __asm__ volatile("int3" ::: "memory")
+
+#define SIM_RUN(stat, call) do {                \
+        sim_begin();                            \
+        if(sim_traced) SIM_MARK();              \
+        call;                                   \
+        if(sim_traced) SIM_MARK();              \
+        sim_end(&(stat));                       \
+    } while(0)
+
+#define SIM_CHECK(cond, ...) do {               \
+        sim_checks++;                           \
+        if(!(cond)){                            \
+            sim_failures++;                     \
+            if(sim_failures <= 20){             \
+                printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+                printf(__VA_ARGS__);            \
+                printf("\n");                   \
+            }                                   \
+        }                                       \
+    } while(0)
+
+void sim_init(void);
+int sim_done(void);
+void sim_reset(void);
+void sim_begin(void);
+void sim_end(sim_stat_t *stat);
+void sim_merge(sim_stat_t *to, const sim_stat_t *from);
+void sim_report_header(void);
+void sim_report(const sim_stat_t *stat);
+void sim_lcd_watch(int on);
+
+void sim_wave_reset(void);
+void sim_wave_add(uint8_t level, uint32_t ticks);
+double sim_wave_check(const char *name, const sim_ref_t *ref, unsigned n, double tick_us);
+
+#endif /* SIM_H_ */
@@ -0,0 +1,105 @@
+/***************************
+ * SIM_DRIVERLIB.C
+ * Stand-ins for the MSP430FR2xx_4xx driverlib calls of the OutOfBox demo
+ *
+ * The real driverlib writes registers through HWREG(base + offset), which are MSP430 addresses,
+ * so it cannot run on the host. These do what the tests need and nothing else:
+ *      FRAMCtl_write8/16/32: copy, as on target (counted in sim_fram_writes); a power loss is
+ *          simulated with sim_fram_cut: once sim_fram_writes reaches it, no more bytes are written
+ *      TLV_getInfo: TLV_TAG_ADCCAL returns sim_tlv_adccal, if sim_tlv_adccal_len is set
+ *      PMM/ADC: the reference, sensor and ADC enable bits
+ * Everything else (clocks, GPIO, LCD_E setup, RTC, WDT, SFR) does nothing.
+****************************/
+
+#include <string.h>
+#include "driverlib.h"
+#include "sim.h"
+
+uint16_t sim_tlv_adccal[8];
+uint8_t  sim_tlv_adccal_len;
+uint32_t sim_fram_writes;
+uint32_t sim_fram_cut;                  //0: no power loss
+
+static void fram_copy(void *to, const void *from, uint32_t bytes)
+{
+    if(sim_fram_cut && sim_fram_writes + bytes > sim_fram_cut)
+        bytes = sim_fram_cut > sim_fram_writes ? sim_fram_cut - sim_fram_writes : 0;
+    memmove(to, from, bytes);
+    sim_fram_writes += bytes;
+}
+
+const LCD_E_initParam LCD_E_INIT_PARAM = { 0 };
+
+void FRAMCtl_write8(uint8_t *dataPtr, uint8_t *framPtr, uint16_t numberOfBytes)
+{
+    fram_copy(framPtr, dataPtr, numberOfBytes);
+}
+
+void FRAMCtl_write16(uint16_t *dataPtr, uint16_t *framPtr, uint16_t numberOfWords)
+{
+    fram_copy(framPtr, dataPtr, numberOfWords * 2);
+}
+
+void FRAMCtl_write32(uint32_t *dataPtr, uint32_t *framPtr, uint16_t count)
+{
+    fram_copy(framPtr, dataPtr, count * 4);
+}
+
+void TLV_getInfo(uint8_t tag, uint8_t instance, uint8_t *length, uint16_t **data_address)
+{
+    if(tag == TLV_TAG_ADCCAL && instance == 0 && sim_tlv_adccal_len){
+        *length = sim_tlv_adccal_len;
+        *data_address = sim_tlv_adccal;
+    }
+    else{
+        *length = 0;
+        *data_address = 0;
+    }
+}
+
+void PMM_disableInternalReference(void)     { PMMCTL2 &= ~INTREFEN; }
+void PMM_disableTempSensor(void)            { PMMCTL2 &= ~TSENSOREN; }
+void PMM_turnOffRegulator(void)             { PMMCTL0 |= PMMREGOFF; }
+void PMM_unlockLPM5(void)                   { PM5CTL0 &= ~LOCKLPM5; }
+
+void ADC_clearInterrupt(uint16_t baseAddress, uint8_t interruptFlagMask)   { ADCIFG &= ~interruptFlagMask; }
+void ADC_disable(uint16_t baseAddress)                                      { ADCCTL0 &= ~ADCON; }
+void ADC_disableConversions(uint16_t baseAddress, bool preempt)             { ADCCTL0 &= ~ADCENC; }
+
+void CS_turnOnXT1LF(uint16_t xt1Drive) {}
+
+void GPIO_clearInterrupt(uint8_t selectedPort, uint16_t selectedPins) {}
+void GPIO_enableInterrupt(uint8_t selectedPort, uint16_t selectedPins) {}
+void GPIO_selectInterruptEdge(uint8_t selectedPort, uint16_t selectedPins, uint8_t edgeSelect) {}
+void GPIO_setAsInputPin(uint8_t selectedPort, uint16_t selectedPins) {}
+void GPIO_setAsInputPinWithPullUpResistor(uint8_t selectedPort, uint16_t selectedPins) {}
+void GPIO_setAsOutputPin(uint8_t selectedPort, uint16_t selectedPins) {}
+void GPIO_setAsPeripheralModuleFunctionInputPin(uint8_t selectedPort, uint16_t selectedPins, uint8_t mode) {}
+void GPIO_setOutputLowOnPin(uint8_t selectedPort, uint16_t selectedPins) {}
+
+void LCD_E_clearAllMemory(uint16_t baseAddress) {}
+void LCD_E_enableChargePump(uint16_t baseAddress) {}
+void LCD_E_init(uint16_t baseAddress, LCD_E_initParam *initParams) {}
+void LCD_E_on(uint16_t baseAddress) {}
+void LCD_E_selectDisplayMemory(uint16_t baseAddress, uint16_t displayMemory) {}
+void LCD_E_setChargePumpFreq(uint16_t baseAddress, uint16_t freq) {}
+void LCD_E_setPinAsCOM(uint16_t baseAddress, uint8_t pin, uint8_t com) {}
+void LCD_E_setPinAsLCDFunctionEx(uint16_t baseAddress, uint8_t startPin, uint8_t endPin) {}
+void LCD_E_setVLCDSource(uint16_t baseAddress, uint16_t r13Source, uint16_t r33Source) {}
+void LCD_E_setVLCDVoltage(uint16_t baseAddress, uint16_t voltage) {}
+
+void RTC_enableInterrupt(uint16_t baseAddress, uint8_t interruptMask) {}
+void RTC_setModulo(uint16_t baseAddress, uint16_t modulo) {}
+void RTC_start(uint16_t baseAddress, uint16_t clockSource) {}
+void RTC_stop(uint16_t baseAddress) {}
+
+void SFR_clearInterrupt(uint8_t interruptFlagMask) {}
+void SFR_disableInterrupt(uint8_t interruptMask) {}
+void SFR_enableInterrupt(uint8_t interruptMask) {}
+
+void Timer_A_initUpMode(uint16_t baseAddress, Timer_A_initUpModeParam *param) {}
+void Timer_A_stop(uint16_t baseAddress) {}
+
+void WDT_A_hold(uint16_t baseAddress) {}
+void WDT_A_initIntervalTimer(uint16_t baseAddress, uint8_t clockSelect, uint8_t clockDivider) {}
+void WDT_A_start(uint16_t baseAddress) {}
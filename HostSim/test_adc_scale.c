@@ -0,0 +1,382 @@
+/***************************
+ * TEST_ADC_SCALE.C
+ * LCD and ADC Test: fixed point ADC scaling (main.c, TempSensor.c) and the per channel reference (ADC_Scan.c)
+ *
+ * Checks:
+ *      Init_Temp enables the internal reference and the temperature sensor (PMMCTL2)
+ *      ADC_Scan_ISR loads each channel's reference with its input: A3 against AVCC, A12 against 1.5V
+ *      Voltage: Q16 scaling of every 12-bit value against the exact 3.3V * adc / ADC_FULL_SCALE
+ *      Temperature: Temp_DegC of every 13-bit value, for a grid of TLV calibrations (CALADC_15V_30C/85C),
+ *          against the exact two point line
+ *      Temp_Alarm: the 10-bit window of a band in 0.1C is the conversion nearest to that temperature
+ *      Volt_Alarm: the same for every band 0.00..4.00V in 0.01V (above 3.30V `hi` is ADC_MAX)
+ *      Hysteresis of both: the window after ADCLOIFG/ADCHIIFG moves by the conversions nearest to `hyst`
+ *      S1: PORT1_ISR only flags alarm_toggle and wakes main up; the bands are set by Alarm_Toggle, in main
+ * Both scalings must be within 0.1 display units (0.01V, 0.1C) before rounding, so within 0.6 after;
+ * a value that is not the nearest display unit is then one whose exact value is near a .5.
+ * Then compares the cost with the old double arithmetic, and of PORT1_ISR with the Alarm_Toggle it leaves to main. There is no FPU on the MSP430, so the old code
+ * is built with __float128 here, which libgcc also does in software: the counts show the shape of
+ * the difference, not MSP430 cycles or bytes.
+****************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "msp430fr4133.h"
+#include "sim.h"
+#include "main.h"
+#include "ADC_Scan.h"
+#include "MPY32.h"
+
+void Init_Temp(void);
+int32_t Temp_DegC(uint16_t adc);
+void Temp_Alarm(int32_t lo, int32_t hi, int32_t hyst);
+void ADC_Scan_ISR(void);
+void ADC_ISR(void);
+void PORT1_ISR(void);
+
+extern unsigned char alarm_mode;
+extern volatile unsigned char alarm_toggle;
+
+#define OLD_ADC_TO_V_REF_3V3    0.322580645     //old main.h: 0.01V per 10-bit conversion
+#define OLD_ADC_TO_TEMP         4.54            //old main.h
+
+static sim_stat_t volt_old = SIM_STAT("voltage, double");
+static sim_stat_t volt_new = SIM_STAT("voltage, Q16");
+static sim_stat_t temp_old = SIM_STAT("temperature, double");
+static sim_stat_t temp_new = SIM_STAT("Temp_DegC, Q16");
+static sim_stat_t port1_isr = SIM_STAT("PORT1_ISR, S1");
+static sim_stat_t toggle = SIM_STAT("Alarm_Toggle, in main");
+
+static volatile int32_t sink;
+
+int32_t old_volt(uint16_t adc)
+{
+    return (int32_t)(adc * (__float128)OLD_ADC_TO_V_REF_3V3);
+}
+
+int32_t old_temp(uint16_t adc)
+{
+    return (int32_t)(300 + adc * (__float128)OLD_ADC_TO_TEMP);
+}
+
+int32_t new_volt(uint16_t adc)
+{
+    return Q16_ROUND(MPY_Mulu16(adc, ADC_TO_V_REF_3V3));
+}
+
+static void set_cal(uint16_t cal30, uint16_t cal85)
+{
+    memcpy(&sim_TLV[0x1A], &cal30, 2);
+    memcpy(&sim_TLV[0x1C], &cal85, 2);
+}
+
+//One TA1 compare, on time: the conversion it starts is done at once and returns `volt` or `temp` (10 bit)
+//Returns the ADCMCTL0 of the conversion, 0 if none was started
+static uint16_t scan_tick(uint16_t volt, uint16_t temp)
+{
+    uint16_t mctl = 0;
+
+    sim_TA1R = sim_TA1CCR0;
+    sim_ADCCTL0 &= ~ADCSC;
+    ADC_Scan_ISR();
+    if(sim_ADCCTL0 & ADCSC){
+        mctl = sim_ADCMCTL0;
+        sim_ADCMEM0 = (mctl & ADCINCH_15) == ADCINCH_12 ? temp : volt;
+        sim_ADCIV = ADCIV_ADCIFG;
+        ADC_ISR();
+    }
+    return mctl;
+}
+
+//Runs the scan until `input` (ADCINCH_3, ADCINCH_12) has been converted once: its window was then in ADCLO/ADCHI
+static void scan_until(uint16_t input)
+{
+    unsigned n;
+    for(n = 0; n < 1000; n++)
+        if((scan_tick(0, 0) & ADCINCH_15) == input)
+            return;
+    SIM_CHECK(0, "input %u is never converted", input);
+}
+
+//Window of `input` after a conversion left it through `flag` (ADCIV_ADCLOIFG, ADCIV_ADCHIIFG)
+static void scan_leave(uint16_t input, uint16_t flag)
+{
+    scan_until(input);
+    sim_ADCIV = flag;
+    ADC_ISR();
+    scan_until(input);
+}
+
+//Conversions `set` moves the window by for a hysteresis of `hyst`, out of the band lo..hi and back
+//Returns how far that is from `hyst` (in display units, both ways the larger)
+static double hysteresis(void (*set)(int32_t, int32_t, int32_t), uint16_t input, int32_t lo, int32_t hi,
+                         int32_t hyst, double step)
+{
+    uint16_t lo_adc, hi_adc;
+    double e1, e2;
+
+    set(lo, hi, hyst);
+    scan_until(input);
+    lo_adc = sim_ADCLO;
+    hi_adc = sim_ADCHI;
+    scan_leave(input, ADCIV_ADCLOIFG);              //below lo: window 0..lo+hyst
+    SIM_CHECK(sim_ADCLO == 0, "input %u: low alarm window starts at %u", input, sim_ADCLO);
+    e1 = (sim_ADCHI - lo_adc) * step - hyst;
+    set(lo, hi, hyst);
+    scan_leave(input, ADCIV_ADCHIIFG);              //above hi: window hi-hyst..ADC_MAX
+    SIM_CHECK(sim_ADCHI == ADC_MAX, "input %u: high alarm window ends at %u", input, sim_ADCHI);
+    e2 = (hi_adc - sim_ADCLO) * step - hyst;
+    if(e1 < 0) e1 = -e1;
+    if(e2 < 0) e2 = -e2;
+    return e1 > e2 ? e1 : e2;
+}
+
+static void references(void)
+{
+    unsigned t, volt = 0, temp = 0;
+
+    printf("--- reference per channel ---\n");
+    set_cal(538, 643);
+    sim_PMMCTL2 = 0;
+    Init_Temp();
+    SIM_CHECK((sim_PMMCTL2 & (INTREFEN | TSENSOREN)) == (INTREFEN | TSENSOREN),
+              "PMMCTL2 0x%04x: internal reference or sensor off", sim_PMMCTL2);
+    SIM_CHECK(sim_PMMCTL0 >> 8 != PMMPW_H, "PMM registers left unlocked");
+
+    //2s of conversions: 1.65V on A3, 25.3C on the sensor (529: 300 + (529 - 538) * 550/105 = 252.9)
+    for(t = 0; t < 2 * (32768 / ADC_VOLT_INTERVAL + 32768 / ADC_TEMP_INTERVAL); t++){
+        uint16_t mctl = scan_tick(512, 529);
+        if(!mctl)
+            continue;
+        if((mctl & ADCINCH_15) == ADCINCH_12){
+            temp++;
+            SIM_CHECK((mctl & ADCSREF_7) == ADCSREF_1, "A12 converted with ADCMCTL0 0x%04x, not against 1.5V", mctl);
+        }
+        else{
+            volt++;
+            SIM_CHECK(mctl == (ADCSREF_0 | ADCINCH_3), "A3 converted with ADCMCTL0 0x%04x, not against AVCC", mctl);
+        }
+    }
+    printf("conversions: A3 %u, A12 %u\n", volt, temp);
+    SIM_CHECK(volt > 1000 && temp > 100, "too few conversions");
+    SIM_CHECK(new_volt(ADC_Scan_Last(ADC_VOLT)) == 165, "1.65V shows as %ld", (long)new_volt(ADC_Scan_Last(ADC_VOLT)));
+    SIM_CHECK(Temp_DegC(ADC_Scan_Last(ADC_TEMP)) == 253, "25.3C shows as %ld", (long)Temp_DegC(ADC_Scan_Last(ADC_TEMP)));
+}
+
+static void voltage(void)
+{
+    unsigned adc;
+    double fixed_err = 0, err = 0, old_err = 0;
+
+    printf("--- voltage, every %u-bit value ---\n", 10 + ADC_VOLT_BITS);
+    for(adc = 0; adc <= ADC_FULL_SCALE(ADC_VOLT_BITS); adc++){
+        double exact = 330.0 * adc / ADC_FULL_SCALE(ADC_VOLT_BITS);
+        double e = (double)adc * ADC_TO_V_REF_3V3 / 65536 - exact;
+        if(e < 0) e = -e;
+        if(e > fixed_err) fixed_err = e;
+        e = new_volt(adc) - exact;
+        if(e < 0) e = -e;
+        if(e > err) err = e;
+        if(!(adc & ((1 << ADC_VOLT_BITS) - 1))){
+            e = old_volt(adc >> ADC_VOLT_BITS) - exact;
+            if(e < 0) e = -e;
+            if(e > old_err) old_err = e;
+        }
+    }
+    printf("largest error in 0.01V: Q16 %.4f, rounded %.4f (old double, truncated: %.4f)\n", fixed_err, err, old_err);
+    SIM_CHECK(fixed_err <= 0.1, "voltage scale is off by %.4f", fixed_err);
+    SIM_CHECK(err <= 0.6, "voltage is off by %.4f", err);
+}
+
+static void temperature(void)
+{
+    unsigned cal30, span, adc, cals = 0, off = 0, values = 0;
+    double err = 0, alarm_err = 0;
+
+    printf("--- temperature, every %u-bit value, TLV calibrations ---\n", 10 + ADC_TEMP_BITS);
+    for(cal30 = 450; cal30 <= 650; cal30 += 25)
+        for(span = 80; span <= 140; span += 10){    //about 105 (1.5V, ~2.8mV/C)
+            double step = 550.0 / span;     //0.1C per 10-bit conversion
+            int32_t lo, hi;
+
+            set_cal(cal30, cal30 + span);
+            Init_Temp();
+            cals++;
+            for(adc = 0; adc <= ADC_FULL_SCALE(ADC_TEMP_BITS); adc++){
+                double exact = 300 + ((double)adc / (1 << ADC_TEMP_BITS) - cal30) * step;
+                double e = Temp_DegC(adc) - exact;
+                if(e < 0) e = -e;
+                if(e > err) err = e;
+                if(Temp_DegC(adc) != (int32_t)floor(exact + 0.5))
+                    off++;                  //the exact value is near a rounding boundary
+                values++;
+            }
+
+            //alarm bands: the window is the conversion nearest to each limit, on the same calibration
+            //(against AVCC the sensor would read 2.2 times fewer conversions)
+            for(lo = 0; lo <= 500; lo += 50){
+                hi = lo + 100;
+                Temp_Alarm(lo, hi, 5);
+                scan_until(ADCINCH_12);
+                double e1 = 300 + (sim_ADCLO - (double)cal30) * step - lo;
+                double e2 = 300 + (sim_ADCHI - (double)cal30) * step - hi;
+                if(e1 < 0) e1 = -e1;
+                if(e2 < 0) e2 = -e2;
+                SIM_CHECK(e1 <= step / 2 + 0.01 && e2 <= step / 2 + 0.01,
+                          "cal %u/%u: band %ld..%ld is window %u..%u", cal30, cal30 + span, (long)lo, (long)hi,
+                          sim_ADCLO, sim_ADCHI);
+                if(e1 / step > alarm_err) alarm_err = e1 / step;
+                if(e2 / step > alarm_err) alarm_err = e2 / step;
+            }
+        }
+    printf("%u calibrations: largest error %.4f (0.1C), %u of %u values not the nearest; alarm window off by %.2f conversions\n",
+           cals, err, off, values, alarm_err);
+    SIM_CHECK(err <= 0.6, "temperature is off by %.4f", err);
+}
+
+static void alarms(void)
+{
+    double step = 330.0 / ADC_MAX, err = 0, hyst_err = 0, e;
+    int32_t v, h;
+
+    printf("--- Volt_Alarm: every band 0.00..4.00V ---\n");
+    for(v = 0; v <= 400; v++){
+        Volt_Alarm(v, v, 0);
+        scan_until(ADCINCH_3);
+        e = sim_ADCLO * step - v;
+        if(e < 0) e = -e;
+        if(e > err) err = e;
+        SIM_CHECK(e <= step / 2 + 1e-9, "%ld: window starts at %u", (long)v, sim_ADCLO);
+        if(v <= 330)
+            SIM_CHECK(sim_ADCHI == sim_ADCLO, "%ld: window %u..%u", (long)v, sim_ADCLO, sim_ADCHI);
+        else
+            SIM_CHECK(sim_ADCHI == ADC_MAX, "%ld: window ends at %u, above ADC_MAX", (long)v, sim_ADCHI);
+    }
+    for(h = 0; h <= 50; h++){
+        e = hysteresis(Volt_Alarm, ADCINCH_3, VOLT_ALARM_LO, VOLT_ALARM_HI, h, step);
+        SIM_CHECK(e <= step / 2 + 1e-9, "hysteresis %ld: off by %.3f", (long)h, e);
+        if(e > hyst_err) hyst_err = e;
+    }
+    printf("largest error in 0.01V: window %.3f, hysteresis %.3f (a conversion is %.3f)\n", err, hyst_err, step);
+
+    printf("--- Temp_Alarm hysteresis ---\n");
+    set_cal(538, 643);
+    Init_Temp();
+    step = 550.0 / 105;
+    hyst_err = 0;
+    for(h = 0; h <= 50; h++){
+        e = hysteresis(Temp_Alarm, ADCINCH_12, TEMP_ALARM_LO, TEMP_ALARM_HI, h, step);
+        SIM_CHECK(e <= step / 2 + 1e-9, "hysteresis %ld: off by %.3f", (long)h, e);
+        if(e > hyst_err) hyst_err = e;
+    }
+    printf("largest error in 0.1C: hysteresis %.3f (a conversion is %.3f)\n", hyst_err, step);
+}
+
+//S1 turns alarm mode on and off: PORT1_ISR only flags it, main (Alarm_Toggle) sets the bands
+static void alarm_mode_switch(void)
+{
+    uint32_t wakes;
+
+    printf("--- S1: alarm mode ---\n");
+    ADC_Scan_Alarm_Off(ADC_VOLT);
+    ADC_Scan_Alarm_Off(ADC_TEMP);
+    alarm_mode = FALSE;
+    alarm_toggle = FALSE;
+
+    wakes = sim_wakes;
+    sim_P1IV = P1IV_P1IFG2;
+    PORT1_ISR();
+    SIM_CHECK(alarm_toggle && !alarm_mode, "PORT1_ISR: alarm_toggle %u, alarm_mode %u", alarm_toggle, alarm_mode);
+    SIM_CHECK(sim_wakes == wakes + 1, "PORT1_ISR does not wake main up");
+    scan_until(ADCINCH_3);
+    SIM_CHECK(sim_ADCLO == 0 && sim_ADCHI == ADC_MAX, "PORT1_ISR set the voltmeter band %u..%u", sim_ADCLO, sim_ADCHI);
+
+    alarm_toggle = FALSE;
+    Alarm_Toggle();
+    SIM_CHECK(alarm_mode, "Alarm_Toggle: alarm mode still off");
+    scan_until(ADCINCH_3);
+    SIM_CHECK(sim_ADCLO == (uint16_t)floor(VOLT_ALARM_LO * ADC_MAX / 330.0 + 0.5) &&
+              sim_ADCHI == (uint16_t)floor(VOLT_ALARM_HI * ADC_MAX / 330.0 + 0.5),
+              "voltmeter band %u..%u", sim_ADCLO, sim_ADCHI);
+    scan_until(ADCINCH_12);
+    SIM_CHECK(sim_ADCLO != 0 && sim_ADCHI != ADC_MAX, "temperature band %u..%u", sim_ADCLO, sim_ADCHI);
+
+    Alarm_Toggle();
+    SIM_CHECK(!alarm_mode, "Alarm_Toggle: alarm mode still on");
+    scan_until(ADCINCH_3);
+    SIM_CHECK(sim_ADCLO == 0 && sim_ADCHI == ADC_MAX, "voltmeter band %u..%u after alarm mode", sim_ADCLO, sim_ADCHI);
+    scan_until(ADCINCH_12);
+    SIM_CHECK(sim_ADCLO == 0 && sim_ADCHI == ADC_MAX, "temperature band %u..%u after alarm mode", sim_ADCLO, sim_ADCHI);
+}
+
+//x86 bytes of the functions, and of the libgcc software float routines they call (__*tf*)
+static void sizes(void)
+{
+    char line[256], name[128], exe[200];
+    unsigned long addr, size, old_bytes = 0, new_bytes = 0, lib_bytes = 0;
+    ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    FILE *nm;
+
+    if(n <= 0)
+        return;
+    exe[n] = 0;
+    snprintf(line, sizeof(line), "nm -S --defined-only '%s' 2>/dev/null", exe);
+    if(!(nm = popen(line, "r")))
+        return;
+    while(fgets(line, sizeof(line), nm)){
+        char type;
+        if(sscanf(line, "%lx %lx %c %127s", &addr, &size, &type, name) != 4)
+            continue;
+        if(!strcmp(name, "old_volt") || !strcmp(name, "old_temp"))
+            old_bytes += size;
+        else if(!strcmp(name, "new_volt") || !strcmp(name, "Temp_DegC"))
+            new_bytes += size;
+        else if(!strncmp(name, "__", 2) && strstr(name, "tf") && (type == 'T' || type == 't'))
+            lib_bytes += size;
+    }
+    pclose(nm);
+    printf("x86 code: double %lu bytes + %lu bytes of software float; Q16 %lu bytes (with the MPY32 stand-in calls)\n",
+           old_bytes, lib_bytes, new_bytes);
+}
+
+int main(void)
+{
+    unsigned adc;
+
+    sim_init();
+
+    references();
+    voltage();
+    temperature();
+    alarms();
+    alarm_mode_switch();
+
+    printf("--- cost of one conversion ---\n");
+    set_cal(538, 643);
+    Init_Temp();
+    for(adc = 0; adc < 4096; adc += 37){
+        SIM_RUN(volt_old, sink = old_volt(adc >> 2));
+        SIM_RUN(volt_new, sink = new_volt(adc));
+        SIM_RUN(temp_old, sink = old_temp(adc >> 3));
+        SIM_RUN(temp_new, sink = Temp_DegC(adc + 2048));
+    }
+    sim_report_header();
+    sim_report(&volt_old);
+    sim_report(&volt_new);
+    sim_report(&temp_old);
+    sim_report(&temp_new);
+    sizes();
+
+    printf("--- cost of S1 (the ISR used to set the bands itself) ---\n");
+    for(adc = 0; adc < 50; adc++){
+        SIM_RUN(port1_isr, (sim_P1IV = P1IV_P1IFG2, PORT1_ISR()));
+        SIM_RUN(toggle, Alarm_Toggle());
+    }
+    sim_report_header();
+    sim_report(&port1_isr);
+    sim_report(&toggle);
+
+    return sim_done();
+}
@@ -0,0 +1,171 @@
+/***************************
+ * TEST_ADC_SCHED.C
+ * LCD and ADC Test: the TA1 timeline of the ADC scan scheduler (ADC_Scan_ISR), with late ISRs
+ *
+ * TA1 is simulated as a 32 bit ACLK time, of which TA1R is the low 16 bits. The CCR0 compare matches
+ * when TA1R counts up to TA1CCR0, and its ISR then runs `latency` ticks later: mostly at once, but
+ * one in 20 behind another interrupt (up to 3ms), and one in 500 very late (20ms, past
+ * the next conversion of both channels). A conversion takes ADC_TICKS ticks (ADCBUSY), and its ADC
+ * ISR runs when it is done. For 20s (10 TA1 wraps):
+ *      every compare the ISR sets is ADC_SCAN_MIN_WAIT..ADC_TEMP_INTERVAL ticks after TA1R, never
+ *          in the past (which would only match after TA1 wraps, 2s later)
+ *      each channel keeps its rate (1024 and 64 conversions/s), with reference and input in ADCMCTL0
+ *      no conversion starts early, or more than 2 very late ISRs behind its channel's schedule
+ *          (due = first + n * interval: a channel that fell behind catches up, one tick apart)
+ *      main is only woken up by the channel it waits for (ADC_VOLT, 64 values/s)
+****************************/
+
+#include "msp430fr4133.h"
+#include "sim.h"
+#include "main.h"
+#include "ADC_Scan.h"
+
+void ADC_Scan_ISR(void);
+void ADC_ISR(void);
+
+#define SECONDS         20
+#define ADC_TICKS       2               //~40us sample and convert, in ACLK ticks
+#define LATE_MAX        100             //3ms: behind another interrupt
+#define VERY_LATE       655             //20ms
+
+typedef struct
+{
+    const char  *name;
+    uint16_t    mctl;                   //ADCMCTL0 of its conversions
+    uint16_t    interval;
+    uint32_t    conversions;
+    uint32_t    last;                   //time of the last conversion
+    uint32_t    max_gap;
+    uint32_t    max_behind;             //ticks after its due time
+    uint32_t    wakes;
+} channel_t;
+
+static channel_t ch[ADC_SCAN_CNT] = {
+    { "ADC_VOLT (A3, AVCC)", ADCSREF_0 | ADCINCH_3,  ADC_VOLT_INTERVAL },
+    { "ADC_TEMP (A12, 1.5V)", ADCSREF_1 | ADCINCH_12, ADC_TEMP_INTERVAL }
+};
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static channel_t *channel_of(uint16_t mctl)
+{
+    unsigned i;
+    for(i = 0; i < ADC_SCAN_CNT; i++)
+        if(ch[i].mctl == mctl)
+            return &ch[i];
+    return 0;
+}
+
+int main(void)
+{
+    uint32_t t = 0, end = SECONDS * 32768u, done = 0, isrs = 0, late = 0, very_late = 0;
+    uint32_t max_latency = 0, min_ahead = 0xFFFF, max_ahead = 0;
+    channel_t *busy = 0;
+    unsigned i;
+
+    sim_init();
+    printf("--- %us of TA1, late ISRs ---\n", SECONDS);
+
+    sim_TA1R = 0;
+    ADC_Scan_Init();
+    ADC_Scan_Wake(ADC_VOLT, 1);
+    ADC_Scan_Wake(ADC_TEMP, 0);
+
+    while(t < end){
+        uint32_t d = (uint16_t)(sim_TA1CCR0 - (uint16_t)t), latency = 0, fire;
+
+        if(!d)
+            d = 0x10000;                //TA1R is already there: it matches after the wrap
+        fire = t + d;
+
+        //the conversion in progress ends first
+        if(busy && done <= fire){
+            uint32_t wakes = sim_wakes;
+            t = done;
+            sim_ADCCTL1 &= ~ADCBUSY;
+            sim_ADCMEM0 = 512;
+            sim_ADCIV = ADCIV_ADCIFG;
+            ADC_ISR();
+            busy->wakes += sim_wakes - wakes;
+            busy = 0;
+        }
+
+        if(rnd() % 20 == 0){
+            latency = rnd() % (LATE_MAX + 1);
+            late++;
+        }
+        if(rnd() % 500 == 0){
+            latency = VERY_LATE;
+            very_late++;
+        }
+        if(latency > max_latency)
+            max_latency = latency;
+        t = fire + latency;
+        sim_TA1R = (uint16_t)t;
+        if(busy)
+            sim_ADCCTL1 |= ADCBUSY;
+
+        sim_ADCCTL0 &= ~ADCSC;
+        ADC_Scan_ISR();
+        isrs++;
+
+        d = (uint16_t)(sim_TA1CCR0 - (uint16_t)t);
+        if(d < min_ahead) min_ahead = d;
+        if(d > max_ahead) max_ahead = d;
+        SIM_CHECK(d >= ADC_SCAN_MIN_WAIT && d <= ADC_TEMP_INTERVAL,
+                  "t %lu (latency %lu): next compare %lu ticks after TA1R", (unsigned long)t,
+                  (unsigned long)latency, (unsigned long)d);
+
+        if(sim_ADCCTL0 & ADCSC){
+            channel_t *c = channel_of(sim_ADCMCTL0);
+
+            SIM_CHECK(!busy, "t %lu: conversion started while ADCBUSY", (unsigned long)t);
+            SIM_CHECK(c != 0, "t %lu: conversion with ADCMCTL0 0x%04x", (unsigned long)t, sim_ADCMCTL0);
+            if(!c)
+                break;
+            uint32_t due = ADC_SCAN_MIN_WAIT + (c - ch) + c->conversions * c->interval;
+
+            SIM_CHECK((int32_t)(t - due) >= 0, "t %lu: %s converted before it is due", (unsigned long)t, c->name);
+            if(t - due > c->max_behind)
+                c->max_behind = t - due;
+            if(c->conversions && t - c->last > c->max_gap)
+                c->max_gap = t - c->last;
+            c->conversions++;
+            c->last = t;
+            busy = c;
+            done = t + ADC_TICKS;
+        }
+    }
+
+    printf("%lu compares, %lu late (up to %lu ticks), %lu very late (%u ticks)\n", (unsigned long)isrs,
+           (unsigned long)late, (unsigned long)max_latency, (unsigned long)very_late, VERY_LATE);
+    printf("next compare after TA1R: %lu..%lu ticks\n", (unsigned long)min_ahead, (unsigned long)max_ahead);
+    SIM_CHECK(very_late > 0, "no very late ISR");
+
+    for(i = 0; i < ADC_SCAN_CNT; i++){
+        channel_t *c = &ch[i];
+        uint32_t expect = SECONDS * 32768u / c->interval;
+        uint32_t values = c->conversions >> (2 * (i == ADC_VOLT ? ADC_VOLT_BITS : ADC_TEMP_BITS));
+
+        printf("%-22s %6.1f conversions/s, interval %3u: longest gap %4lu, up to %4lu ticks behind, %lu wakes\n",
+               c->name, (double)c->conversions / SECONDS, c->interval, (unsigned long)c->max_gap,
+               (unsigned long)c->max_behind, (unsigned long)c->wakes);
+        SIM_CHECK(c->conversions + 2 >= expect && c->conversions <= expect + 2,
+                  "%s: %lu conversions in %us, expected %lu", c->name, (unsigned long)c->conversions, SECONDS,
+                  (unsigned long)expect);
+        SIM_CHECK(c->max_behind <= 2 * VERY_LATE, "%s: %lu ticks behind", c->name, (unsigned long)c->max_behind);
+        if(i == ADC_VOLT)
+            SIM_CHECK(c->wakes == values, "%s: %lu wakes for %lu values", c->name, (unsigned long)c->wakes,
+                      (unsigned long)values);
+        else
+            SIM_CHECK(c->wakes == 0, "%s: %lu wakes, main does not wait for it", c->name, (unsigned long)c->wakes);
+    }
+
+    return sim_done();
+}
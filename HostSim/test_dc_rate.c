@@ -0,0 +1,244 @@
+/***************************
+ * TEST_DC_RATE.C
+ * Universal IR (Data Collection), main.c: how fast the edges can come before the capture ring loses one
+ *
+ * Bursts of edges at a given spacing (+-10%, any timer phase) are fed to TIMER0_A1_ISR as TA0.2
+ * captures, with the TA0.1 gap compare and the TA0 overflows raised in between as in test_dc_repeat.c.
+ * TA0.2 is modelled as the hardware does it: an edge latches TA0R into TA0CCR2 and sets CCIFG; an
+ * edge while CCIFG is still set overwrites TA0CCR2 and sets COV, so the earlier edge is lost.
+ * The ISR clears CCIFG when it reads TA0IV, and reads TA0CCR2 a few instructions later; an edge in
+ * between is stored twice (once here, once by its own ISR).
+ * The CPU is modelled in MSP430 cycles (MCLK 8MHz, 2 per SMCLK tick), not measured: it sleeps in
+ * LPM3 between edges and takes WAKE_US to wake, unless an interrupt is already pending when the last
+ * one returns. The ISR times are counted by hand from the instructions of the paths (below).
+ * A burst is captured without loss if ir_buf holds every edge once, in order, at its capture time.
+ * Reports the spacing (edge rate) at which edges are first lost, against RC6, the fastest protocol
+ * learned (444us half bits). Much faster than that, the next edge is pending before the ISR returns,
+ * the CPU stops going back to sleep, and fewer edges are lost than where it just has time to sleep.
+****************************/
+
+#include "main.h"
+#include "IR_Codec.h"
+#include "sim.h"
+
+#define TICK_US         0.25            //SMCLK 4MHz
+#define CYCLES(c)       ((c) / 2.0)     //MCLK 8MHz, in SMCLK ticks
+#define WAKE_US         10.0            //LPM3 to active
+#define EDGES           200             //per burst, within the 255 of the ring
+#define BURSTS          20
+#define RC6_HALF_US     444.4
+
+/*
+ * TA0.2 path of TIMER0_A1_ISR, MCLK cycles: interrupt 6, PUSHM/POPM of the registers IR_End_Capture
+ * needs 14, ADD &TA0IV,PC and the jump 5, IR_status 6, rx_gap_open 6, rx_head != 1 6, the ir_buf
+ * store from TA0CCR2 10, TA0CCR1 = ... + IR_FRAME_GAP 9, TA0CCTL1 5, ++rx_head and its test 6,
+ * RETI 5. TA0IV is read after 6 + 7 + 3, TA0CCR2 after that, IR_status and the index (10 more).
+ * IR_Frame_Start (the first edge after a gap): the call, the 32-bit gap sum and store, rx_frame,
+ * rx_frames, rx_gap_open. The overflow and the compare: the same entry and exit, and what they do.
+ */
+#define ISR_EDGE        80
+#define ISR_IV_AT       16
+#define ISR_READ_AT     26
+#define ISR_FRAME_START 60
+#define ISR_TIMER       60
+
+//main.c (unsigned int is 16 bit there)
+extern uint16_t ir_buf[256];
+extern unsigned char rx_head, rx_frames, rx_frame[], carrier_cnt;
+extern uint16_t rx_ovf;
+extern boolean rx_gap_open, rx_carrier;
+extern int IR_status;
+extern IR_CODE ir_codes[3][14];
+extern IR_CODE *rx_code;
+void TIMER0_A1_ISR(void);
+
+enum { TRANSMITTING, RECEIVING, DISABLED };
+
+static double cpu_free;                 //SMCLK ticks: the CPU is done with the last ISR
+static uint32_t timer_at;               //last TA0 compare or overflow handled
+static uint32_t cap_read;               //last TA0CCR2 the ISR read, as an absolute time
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+//An ISR asked for at `at`: when it starts (the CPU may be asleep, or busy with another)
+static double isr_start(double at)
+{
+    return at > cpu_free ? at + WAKE_US / TICK_US : cpu_free;
+}
+
+//Next TA0.1 compare or TA0 overflow, UINT32_MAX if none; its TA0IV in *iv
+//(TA0CCR1 is armed from an edge or a compare, neither more than 0xFFFF ticks before it fires)
+static uint32_t next_timer(uint16_t *iv)
+{
+    uint32_t ovf = (timer_at | 0xFFFF) + 1;
+    uint32_t ref = cap_read > timer_at ? cap_read : timer_at;
+
+    if((sim_TA0CCTL1 & (CAP | CCIE)) == CCIE){
+        uint32_t cmp = ref + (uint16_t)(sim_TA0CCR1 - (uint16_t)ref);
+        if(cmp <= ovf){
+            *iv = TA0IV_TACCR1;
+            return cmp;
+        }
+    }
+    if(!(sim_TA0CTL & TAIE))
+        return UINT32_MAX;
+    *iv = TA0IV_TAIFG;
+    return ovf;
+}
+
+static void timer_isr(uint32_t at, double start, uint16_t iv)
+{
+    timer_at = at;
+    cpu_free = start + CYCLES(ISR_TIMER);
+    sim_TA0IV = iv;
+    TIMER0_A1_ISR();
+}
+
+static void capture_start(void)
+{
+    ir_buf[0] = 0;
+    rx_head = 1;
+    rx_ovf = 0;
+    rx_gap_open = FALSE;
+    rx_frames = 1;
+    rx_frame[0] = 1;
+    carrier_cnt = 0;
+    rx_carrier = TRUE;
+    rx_code = &ir_codes[0][0];
+    IR_status = RECEIVING;
+    sim_TA0CTL = TASSEL_2 | MC__CONTINUOUS | TAIE;
+    sim_TA0CCTL1 = CM_2 | SCS | CCIS_0 | CAP | CCIE;
+    sim_TA0CCTL2 = CM_3 | SCS | CCIS_0 | CAP | CCIE;
+    timer_at = 0;
+    cap_read = 0;
+    cpu_free = 0;
+}
+
+/* Feeds the edges at the absolute times edge[0..n-1] (ticks) and lets the capture end.
+ * When the CPU is free, it takes what TA0IV gives first: TA0.1, then TA0.2, then the overflow.
+ * Returns the edges lost, and in *wrong what was stored that is not an edge (a time read late).
+ */
+static unsigned burst(const uint32_t *edge, unsigned n, unsigned *wrong)
+{
+    unsigned i = 0, k, got, matched;
+    int pending = 0;                    //TA0.2 CCIFG
+    uint32_t cap = 0, cap_at = 0;       //TA0CCR2, and when CCIFG was set
+    uint32_t t;
+    uint16_t iv = 0;
+
+    capture_start();
+    while(IR_status == RECEIVING && (i < n || pending)){
+        double first, at, until;
+        int capture;
+
+        t = next_timer(&iv);
+        first = pending && cap_at < t ? cap_at : t;
+        at = first == UINT32_MAX ? 1e18 : isr_start(first);
+        capture = pending && cap_at <= at && !(t <= at && iv == TA0IV_TACCR1);
+        until = capture ? at + CYCLES(ISR_IV_AT) : at;
+
+        if(i < n && edge[i] < until){
+            if(!pending)
+                cap_at = edge[i];
+            pending = 1;                //set already: COV, the last capture is overwritten
+            cap = edge[i++];
+        }
+        else if(!capture)
+            timer_isr(t, at, iv);
+        else{
+            double read_at = at + CYCLES(ISR_READ_AT);
+            int frame_start = rx_gap_open;
+
+            pending = 0;                //TA0IV read
+            while(i < n && edge[i] < read_at){
+                if(!pending)
+                    cap_at = edge[i];
+                pending = 1;
+                cap = edge[i++];
+            }
+            cap_read = cap;
+            cpu_free = at + CYCLES(ISR_EDGE + (frame_start ? ISR_FRAME_START : 0));
+            sim_TA0CCR2 = (uint16_t)cap;
+            sim_TA0IV = TA0IV_TACCR2;
+            TIMER0_A1_ISR();
+        }
+    }
+    //the gap compare and the overflows end the capture
+    while(IR_status == RECEIVING && (t = next_timer(&iv)) != UINT32_MAX)
+        timer_isr(t, isr_start(t), iv);
+    SIM_CHECK(IR_status == DISABLED, "capture did not end");
+    sim_TA0CTL = 0;
+    sim_TA0CCTL1 = 0;
+    sim_TA0CCTL2 = 0;
+
+    //each stored time is one of the next few edges (those in between were lost), or wrong
+    got = rx_head ? rx_head - 1u : 255u;
+    for(k = 1, i = 0, matched = 0; k <= got; k++){
+        unsigned j;
+
+        for(j = i; j < n && j < i + 8 && ir_buf[k] != (uint16_t)edge[j]; j++)
+            ;
+        if(j < n && j < i + 8){
+            matched++;
+            i = j + 1;
+        }
+        else
+            (*wrong)++;
+    }
+    return n - matched;
+}
+
+//Edges lost over BURSTS bursts, `spacing` us apart +-10%, and in *wrong the times stored wrong
+static unsigned rate(double spacing, unsigned *wrong)
+{
+    static uint32_t edge[EDGES];
+    unsigned b, i, lost = 0;
+
+    *wrong = 0;
+    for(b = 0; b < BURSTS; b++){
+        double t = 1000 + rnd() % 65536;
+
+        for(i = 0; i < EDGES; i++){
+            edge[i] = (uint32_t)(t + 0.5);
+            t += spacing / TICK_US * (0.9 + 0.2 * (double)(rnd() % 1001) / 1000);
+        }
+        lost += burst(edge, EDGES, wrong);
+    }
+    return lost;
+}
+
+int main(void)
+{
+    static const double show[] = { RC6_HALF_US, 100, 50, 30, 25, 22, 20, 18, 16, 14, 13, 12, 11, 10, 8 };
+    double spacing, first_loss = 0;
+    unsigned i, lost, wrong;
+
+    sim_init();
+
+    printf("--- edge bursts: %u bursts of %u edges, +-10%% spacing ---\n", BURSTS, EDGES);
+    printf("(TA0.2 ISR %u MCLK cycles at 8MHz, %u more on a frame start, %.0fus LPM3 wake-up)\n", ISR_EDGE,
+           ISR_FRAME_START, WAKE_US);
+    printf("%10s %10s %14s %12s\n", "spacing us", "edges/s", "edges lost", "stored wrong");
+    for(i = 0; i < sizeof(show) / sizeof(show[0]); i++){
+        lost = rate(show[i], &wrong);
+        printf("%10.1f %10.0f %6u of %u %12u\n", show[i], 1e6 / show[i], lost, BURSTS * EDGES, wrong);
+    }
+
+    for(spacing = 100; spacing > 1; spacing -= 0.25)
+        if(rate(spacing, &wrong) || wrong){
+            first_loss = spacing;
+            break;
+        }
+    printf("first loss at %.2fus spacing (%.0f edges/s), %.0f times the edge rate of RC6's half bits\n",
+           first_loss, 1e6 / first_loss, RC6_HALF_US / first_loss);
+    SIM_CHECK(first_loss > 0, "no loss down to 1us, the CPU model is not limiting");
+    SIM_CHECK(first_loss < RC6_HALF_US / 10, "edges lost at %.2fus spacing, within 10 times RC6's edge rate",
+              first_loss);
+
+    return sim_done();
+}
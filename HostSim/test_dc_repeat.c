@@ -0,0 +1,322 @@
+/***************************
+ * TEST_DC_REPEAT.C
+ * Universal IR (Data Collection), main.c: learning a held key and playing it back
+ *
+ * A held NEC remote sends the frame once, then an NEC repeat code (9ms mark, 2.25ms space,
+ * 560us mark) every 108ms. Other remotes (eg. Samsung) send the whole frame again.
+ * The edges are fed to TIMER0_A1_ISR as TA0.2 captures of a continuous 4MHz TA0, with the TA0.1
+ * carrier captures (during the first mark), the TA0.1 gap compare and the TA0 overflows raised in
+ * time order, until the capture ends. IR_Commit then has to fold the repeats into `repeat` and
+ * `gap` and work out the carrier, and IR_Tx_Load + TIMER0_A0_ISR have to play back the same
+ * envelope: the frame, then the repeat codes (or frames) with the learned timing.
+****************************/
+
+#include <string.h>
+#include "main.h"
+#include "IR_Codec.h"
+#include "sim.h"
+
+#define TICK_US         0.25            //SMCLK 4MHz
+#define NEC_PERIOD      108000.0        //us, start to start
+#define CARRIER_MIN     66              //main.c: carrier periods accepted, in ticks
+#define CARRIER_MAX     200
+
+//main.c (unsigned int is 16 bit there)
+extern uint16_t ir_buf[256];
+extern uint16_t *ir_ptr;
+extern unsigned char rx_head, rx_frames, rx_frame[], carrier_cnt, tx_cnt, ir_cnt;
+extern uint16_t rx_ovf;
+extern boolean rx_gap_open, rx_carrier;
+extern uint32_t rx_gap[];
+extern int IR_status;
+extern IR_CODE ir_codes[3][14];
+extern IR_CODE *rx_code;
+void IR_Commit(void);
+void IR_Tx_Load(const IR_CODE *);
+void TIMER0_A0_ISR(void);
+void TIMER0_A1_ISR(void);
+
+enum { TRANSMITTING, RECEIVING, DISABLED };
+
+static sim_stat_t isr_tx = SIM_STAT("TIMER0_A0_ISR interval");
+static sim_stat_t isr_gap = SIM_STAT("TIMER0_A0_ISR gap");
+
+static uint32_t now;                    //absolute time in SMCLK ticks
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+//Runs TA0 up to the absolute time `to`, raising the TA0.1 compare and the overflows on the way
+static void run_until(uint32_t to)
+{
+    while(IR_status == RECEIVING){
+        uint32_t ovf = (now | 0xFFFF) + 1;
+        uint32_t cmp = UINT32_MAX;
+
+        if((sim_TA0CCTL1 & (CAP | CCIE)) == CCIE)
+            cmp = now + (uint16_t)(sim_TA0CCR1 - (uint16_t)now);
+        if(cmp <= ovf && cmp <= to){
+            now = cmp;
+            sim_TA0IV = TA0IV_TACCR1;
+        }
+        else if(ovf <= to && (sim_TA0CTL & TAIE)){
+            now = ovf;
+            sim_TA0IV = TA0IV_TAIFG;
+        }
+        else
+            break;
+        TIMER0_A1_ISR();
+    }
+    now = to;
+}
+
+//Captures an edge at the absolute time t (us since the start of the burst)
+static void edge_at(uint32_t start, double t)
+{
+    run_until(start + (uint32_t)(t / TICK_US + 0.5));
+    if(IR_status != RECEIVING || !(sim_TA0CCTL2 & CCIE))
+        return;
+    sim_TA0CCR2 = (uint16_t)now;
+    sim_TA0IV = TA0IV_TACCR2;
+    TIMER0_A1_ISR();
+}
+
+//Envelope of an NEC frame (address 0x55 0xaa, code, ~code), from its first edge, in us
+//(560us/1690us, the timings IR_Synth uses, so the learned period is all that can be off on playback)
+static unsigned nec_frame(sim_ref_t *ref, unsigned char code, int samsung)
+{
+    unsigned char data[4] = { 0x55, 0xaa, code, (unsigned char)~code };
+    unsigned n = 0, b;
+
+    ref[n].level = 1; ref[n++].us = samsung ? 4500 : 9000;
+    ref[n].level = 0; ref[n++].us = 4500;
+    for(b = 0; b < 32; b++){
+        ref[n].level = 1; ref[n++].us = 560;
+        ref[n].level = 0; ref[n++].us = ((data[b / 8] >> (b % 8)) & 1) ? 1690 : 560;
+    }
+    ref[n].level = 1; ref[n++].us = 560;
+    return n;
+}
+
+static unsigned nec_repeat(sim_ref_t *ref)
+{
+    ref[0].level = 1; ref[0].us = 9000;
+    ref[1].level = 0; ref[1].us = 2250;
+    ref[2].level = 1; ref[2].us = 560;
+    return 3;
+}
+
+static double length(const sim_ref_t *ref, unsigned n)
+{
+    double us = 0;
+    while(n--) us += ref[n].us;
+    return us;
+}
+
+/* Carrier on TA0.1 from the absolute time `at`: `cycles` pulses of period p (ticks), 1/3 on,
+ * seen by an active low detector (falling edge = carrier on)
+ */
+static void carrier_edge(uint32_t at, unsigned cm)
+{
+    run_until(at);
+    if((sim_TA0CCTL1 & (CAP | CCIE)) == (CAP | CCIE) && (sim_TA0CCTL1 & CM_3) == cm){
+        sim_TA0CCR1 = (uint16_t)now;
+        sim_TA0IV = TA0IV_TACCR1;
+        TIMER0_A1_ISR();
+    }
+}
+
+static void carrier_at(uint32_t at, unsigned p, unsigned cycles)
+{
+    unsigned k;
+
+    for(k = 0; k < cycles; k++){
+        carrier_edge(at + k * p, CM_2);
+        carrier_edge(at + k * p + p / 3, CM_1);
+    }
+}
+
+//As main() starts a capture
+static void capture_start(void)
+{
+    ir_buf[0] = 0;
+    rx_head = 1;
+    rx_ovf = 0;
+    rx_gap_open = FALSE;
+    rx_frames = 1;
+    rx_frame[0] = 1;
+    carrier_cnt = 0;
+    rx_carrier = TRUE;
+    rx_code = &ir_codes[0][0];
+    IR_status = RECEIVING;
+    sim_TA0CTL = TASSEL_2 | MC__CONTINUOUS | TAIE;
+    sim_TA0CCTL1 = CM_2 | SCS | CCIS_0 | CAP | CCIE;
+    sim_TA0CCTL2 = CM_3 | SCS | CCIS_0 | CAP | CCIE;
+    now = 0;
+}
+
+//Waits for the capture to end on its own, and commits it as main() does
+static void capture_end(void)
+{
+    run_until(now + 40 * 65536);
+    SIM_CHECK(IR_status == DISABLED, "capture did not end");
+
+    sim_TA0CTL = 0;
+    sim_TA0CCTL1 = 0;
+    sim_TA0CCTL2 = 0;
+    IR_Commit();
+}
+
+/* Sends a held key: `frame`, then `reps` times `rep`, `period` us apart (start to start),
+ * with +-jitter percent on every interval and a carrier of period `carrier` ticks (0: none),
+ * and commits the capture. Builds the envelope sent into ref, and returns its length.
+ */
+static unsigned hold_key(sim_ref_t *ref, const sim_ref_t *frame, unsigned nf, const sim_ref_t *rep, unsigned nr,
+                         unsigned reps, double period, unsigned jitter, unsigned carrier)
+{
+    unsigned n = 0, r, i;
+    uint32_t start;
+    double t;
+
+    capture_start();
+    start = 20000 + rnd() % 65536;      //a little idle first, any timer phase
+    for(r = 0; r <= reps; r++){
+        const sim_ref_t *f = r ? rep : frame;
+        unsigned nn = r ? nr : nf;
+
+        t = r * period;
+        edge_at(start, t);
+        if(r == 0 && carrier)
+            carrier_at(now + 2, carrier, 24);
+        for(i = 0; i < nn; i++){
+            double j = jitter ? ((double)(rnd() % (2 * jitter * 10 + 1)) / 10.0 - jitter) / 100.0 : 0;
+            t += f[i].us * (1.0 + j);
+            edge_at(start, t);
+        }
+
+        memcpy(&ref[n], f, nn * sizeof(*f));
+        n += nn;
+        if(r < reps){
+            ref[n].level = 0;
+            ref[n++].us = period - length(f, nn);
+        }
+    }
+    capture_end();
+    return n;
+}
+
+//Plays back `code` as main() does, and records the envelope
+static void play(const IR_CODE *code, int measure)
+{
+    unsigned guard = 0, first = 1;
+
+    IR_Tx_Load(code);
+    IR_status = TRANSMITTING;
+    sim_TA0CCTL0 = CCIE;
+    sim_TA0CCTL2 = OUTMOD_0;
+    sim_TA0CCR0 = 640;
+
+    sim_wave_reset();
+    while((sim_TA0CCTL0 & CCIE) && guard++ < 10000){
+        int gap = tx_cnt >= ir_cnt;
+        if(!first)
+            sim_wave_add((sim_TA0CCTL2 & OUT) ? 1 : 0, (uint32_t)sim_TA0CCR0 + 1);
+        first = 0;
+        if(measure)
+            SIM_RUN(*(gap ? &isr_gap : &isr_tx), TIMER0_A0_ISR());
+        else
+            TIMER0_A0_ISR();
+    }
+    if(sim_wave_n && sim_wave[sim_wave_n - 1].level == 0)
+        sim_wave_n--;                   //space after the last mark: main() stops the timers
+    SIM_CHECK(IR_status == DISABLED, "playback not finished");
+}
+
+int main(void)
+{
+    static sim_ref_t ref[1024], frame[80], rep[80];
+    static const sim_ref_t not_rep[3] = { { 1, 9000 }, { 0, 4500 }, { 1, 560 } };
+    static const unsigned reps[] = { 0, 1, 2, 4, 7 };
+    unsigned code, i, n, nf, nr;
+    double err, worst = 0;
+
+    sim_init();
+
+    printf("--- NEC frame + repeat codes, +-3%% jitter ---\n");
+    nr = nec_repeat(rep);
+    for(code = 0; code < 256; code += 15)
+        for(i = 0; i < sizeof(reps) / sizeof(reps[0]); i++){
+            nf = nec_frame(frame, (unsigned char)code, 0);
+            n = hold_key(ref, frame, nf, rep, nr, reps[i], NEC_PERIOD, 3, 0);
+            SIM_CHECK(rx_code->repeat == (reps[i] ? (reps[i] | IR_REPEAT_NEC) : 0),
+                      "0x%02x x%u: repeat 0x%02x", code, reps[i], rx_code->repeat);
+            if(reps[i])
+                SIM_CHECK(rx_code->gap * 4 > NEC_PERIOD - 50 && rx_code->gap * 4 < NEC_PERIOD + 50,
+                          "0x%02x x%u: period %u us", code, reps[i], rx_code->gap * 4);
+            play(rx_code, code < 64);
+            err = sim_wave_check(code == 0x5a && reps[i] == 2 ? "NEC 0x5a + 2 repeat codes" : 0, ref, n, TICK_US);
+            if(err > worst) worst = err;
+        }
+    printf("largest playback error: %.2f us\n", worst);
+    SIM_CHECK(worst < 10, "NEC repeat playback is off by %.2f us", worst);
+
+    printf("--- Samsung: the whole frame repeated (3 frames fill the capture ring) ---\n");
+    worst = 0;
+    for(code = 0; code < 256; code += 15){
+        nf = nec_frame(frame, (unsigned char)code, 1);
+        n = hold_key(ref, frame, nf, frame, nf, 2, NEC_PERIOD, 0, 0);
+        SIM_CHECK(rx_code->repeat == 2, "Samsung 0x%02x: repeat 0x%02x", code, rx_code->repeat);
+        play(rx_code, 0);
+        err = sim_wave_check(code == 0x5a ? "Samsung 0x5a + 2 repeats" : 0, ref, n, TICK_US);
+        if(err > worst) worst = err;
+    }
+    printf("largest playback error: %.2f us\n", worst);
+    SIM_CHECK(worst < 10, "frame repeat playback is off by %.2f us", worst);
+
+    //something else after the frame (a 4.5ms space: not a repeat code) is dropped
+    nf = nec_frame(frame, 0x42, 0);
+    hold_key(ref, frame, nf, not_rep, 3, 2, NEC_PERIOD, 0, 0);
+    SIM_CHECK(rx_code->repeat == 0, "not a repeat code, but repeat 0x%02x", rx_code->repeat);
+
+    printf("--- carrier on TA0.1 (P1.7) during the first mark ---\n");
+    for(i = 0; i < 64; i++){
+        unsigned p = CARRIER_MIN + i * (CARRIER_MAX - CARRIER_MIN) / 63;
+        nf = nec_frame(frame, (unsigned char)(i * 4), 0);
+        hold_key(ref, frame, nf, rep, nr, 1, NEC_PERIOD, 0, p);
+        SIM_CHECK(rx_code->carrier == p - 1 && rx_code->carrier_duty == p / 3,
+                  "carrier %u/%u learned as %u/%u", p, p / 3, rx_code->carrier + 1, rx_code->carrier_duty);
+        SIM_CHECK(rx_code->repeat == (1 | IR_REPEAT_NEC), "carrier %u: repeat 0x%02x", p, rx_code->repeat);
+    }
+    hold_key(ref, frame, nf, rep, nr, 1, NEC_PERIOD, 0, 0);
+    SIM_CHECK(rx_code->carrier == 0, "no carrier, but %u learned", rx_code->carrier);
+
+    //a lone edge (the first mark never ends): the first overflow after it times the gap from it,
+    //whether or not IR_FRAME_GAP has already gone by, and the gap to the next frame is measured from it
+    for(i = 0; i < 2; i++){
+        uint32_t first = i ? 1000 : 40000, t;
+
+        capture_start();
+        edge_at(first, 0);
+        nf = nec_frame(frame, 0x24, 0);
+        t = 0;
+        for(n = 0; n < nf + 1; n++){
+            edge_at(first, 100000 + t);
+            if(n < nf)
+                t += frame[n].us;
+        }
+        SIM_CHECK(rx_frames == 2 && rx_gap[1] == 100000 / TICK_US, "lone edge at %u: %u frames, gap %u ticks",
+                  first, rx_frames, rx_gap[1]);
+        capture_end();
+    }
+
+    printf("--- TIMER0_A0_ISR cost ---\n");
+    sim_report_header();
+    sim_report(&isr_tx);
+    sim_report(&isr_gap);
+
+    return sim_done();
+}
@@ -0,0 +1,203 @@
+/***************************
+ * TEST_IR_CODEC.C
+ * Universal IR (Data Collection), IR_Codec.c: encoding captures and decoding them back
+ *
+ * Each capture goes through every format that takes it: IR_Encode (a known protocol first),
+ * IR_Encode_Dict and IR_Encode_Unit. The decoded intervals must be:
+ *      protocol: the ideal frame (within a tick of rounding; the capture itself is off by the receiver)
+ *      dictionary: the center of the interval's cluster, within 1/2^IR_DICT_TOL of the interval
+ *          plus the drift of the running mean (reported)
+ *      unit: the interval rounded to the learned unit, within unit/2 (above the largest multiple of
+ *          the unit that fits 16 bits: that multiple)
+ * The captures are NEC, SIRC and RC5 frames as a receiver records them (ir_trace.c: marks 60us
+ * long, 15us jitter), and random ones: a few durations with 3% jitter (as unknown protocols),
+ * and any durations at all.
+ * Then reports the bytes of data[] (IR_CODE_BYTES) each format uses per code, against the raw
+ * ring (2 bytes per interval, IR_RING_SIZE 256 in main.c). Every format takes sizeof(IR_CODE) in FRAM.
+ *
+ * IR_Codec.c is included, so its static encoders can be called one at a time.
+****************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "IR_Codec.c"
+#include "ir_trace.h"
+#include "sim.h"
+
+#define STRETCH         60.0            //us
+#define JITTER          15.0
+#define FRAMES          300             //per protocol
+#define RANDOM          3000
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+typedef struct
+{
+    const char  *name;
+    unsigned    codes, cnt, stored;         //intervals captured, and stored by the unit format
+    unsigned    dict, unit, proto;      //codes each format took
+    unsigned    dict_bytes, unit_bytes, proto_bytes;
+    double      dict_err, unit_err;     //largest, as a fraction of the interval (dict) or of unit/2
+} row_t;
+
+static uint16_t out[MAX_IR_CNT + 1];
+
+//Dictionary: every interval comes back as a duration near it
+static void check_dict(row_t *r, const uint16_t *in, unsigned cnt, const char *what)
+{
+    IR_CODE code;
+    unsigned i, n;
+
+    memset(&code, 0, sizeof(code));
+    if(!IR_Encode_Dict(in, cnt, &code))
+        return;
+    n = IR_Decode(&code, out);
+    SIM_CHECK(n == cnt && code.len == (cnt * 3 + 7) / 8, "%s: dict %u of %u intervals, %u bytes", what, n, cnt,
+              code.len);
+    for(i = 0; i < n && i < cnt; i++){
+        double e = (double)abs((int)out[i] - in[i]) / in[i];
+        if(e > r->dict_err) r->dict_err = e;
+        SIM_CHECK(e <= 2.0 / (1 << IR_DICT_TOL), "%s: dict interval %u: %u -> %u", what, i, in[i], out[i]);
+    }
+    r->dict++;
+    r->dict_bytes += code.len + 2 * code.dict_cnt;
+}
+
+//Unit: every interval comes back within half a unit, unless data[] ran out
+static void check_unit(row_t *r, const uint16_t *in, unsigned cnt, const char *what)
+{
+    IR_CODE code;
+    unsigned i, n, stored;
+
+    memset(&code, 0, sizeof(code));
+    stored = IR_Encode_Unit(in, cnt, &code);
+    n = IR_Decode(&code, out);
+    SIM_CHECK(n == stored && code.len <= IR_CODE_BYTES, "%s: unit %u of %u intervals", what, n, stored);
+    SIM_CHECK(stored == cnt || code.len >= IR_CODE_BYTES - 1, "%s: unit stored %u of %u with %u bytes left", what,
+              stored, cnt, IR_CODE_BYTES - code.len);
+    for(i = 0; i < n; i++){
+        uint16_t top = 0xFFFF / code.unit * code.unit;      //q is capped so decode does not overflow
+        double e = (double)abs((int)out[i] - in[i]) / (code.unit / 2.0);
+
+        if(in[i] > top){
+            SIM_CHECK(out[i] == top, "%s: unit %u, interval %u: %u -> %u, not capped", what, code.unit, i, in[i],
+                      out[i]);
+            continue;
+        }
+        if(e > r->unit_err) r->unit_err = e;
+        SIM_CHECK(e <= 1.0, "%s: unit %u, interval %u: %u -> %u", what, code.unit, i, in[i], out[i]);
+    }
+    r->unit++;
+    r->stored += stored;
+    r->unit_bytes += code.len + 2;
+}
+
+static void protocols(void)
+{
+    static const int proto[] = { IR_TRACE_NEC, IR_TRACE_SIRC12, IR_TRACE_SIRC15, IR_TRACE_SIRC20, IR_TRACE_RC5 };
+    uint16_t ideal[IR_TRACE_MAX], rec[IR_TRACE_MAX];
+    unsigned p, k, i, n;
+    row_t rows[5];
+
+    printf("--- protocol frames, as received ---\n");
+    memset(rows, 0, sizeof(rows));
+    for(p = 0; p < 5; p++){
+        row_t *r = &rows[p];
+        r->name = ir_trace_name(proto[p]);
+        for(k = 0; k < FRAMES; k++){
+            ir_fields_t f;
+            IR_CODE code;
+
+            ir_trace_fields(proto[p], &f, rnd);
+            n = ir_trace_ideal(proto[p], &f, ideal);
+            ir_trace_receive(ideal, n, rec, STRETCH, JITTER, rnd);
+            r->codes++;
+            r->cnt += n;
+
+            memset(&code, 0, sizeof(code));
+            SIM_CHECK(IR_Encode(rec, n, &code) == n && code.fmt >= IR_FMT_NEC, "%s frame %u: not recognized (fmt %u)",
+                      r->name, k, code.fmt);
+            if(code.fmt >= IR_FMT_NEC){
+                SIM_CHECK(IR_Decode(&code, out) == n, "%s frame %u: %u intervals back", r->name, k, code.cnt);
+                for(i = 0; i < n; i++)
+                    SIM_CHECK(abs((int)out[i] - ideal[i]) <= 1, "%s frame %u, interval %u: %u, ideal %u", r->name,
+                              k, i, out[i], ideal[i]);
+                r->proto++;
+                r->proto_bytes += code.len;
+            }
+            check_dict(r, rec, n, r->name);
+            check_unit(r, rec, n, r->name);
+        }
+    }
+
+    printf("%-8s %9s %9s %14s %14s %14s\n", "", "intervals", "raw ring", "protocol", "dictionary", "unit");
+    for(p = 0; p < 5; p++){
+        row_t *r = &rows[p];
+        printf("%-8s %9.1f %9.1f %8.1f (%3u) %8.1f (%3u) %8.1f (%3u)\n", r->name, (double)r->cnt / r->codes,
+               2.0 * r->cnt / r->codes, r->proto ? (double)r->proto_bytes / r->proto : 0, r->proto,
+               r->dict ? (double)r->dict_bytes / r->dict : 0, r->dict,
+               r->unit ? (double)r->unit_bytes / r->unit : 0, r->unit);
+        printf("%-8s largest error: dictionary %.1f%% of the interval, unit %.2f of unit/2\n", "", 100 * r->dict_err,
+               r->unit_err);
+    }
+    printf("(bytes of data[] per code, with the dictionary or unit; (n) codes that fit the format)\n");
+}
+
+static void random_traces(void)
+{
+    uint16_t in[MAX_IR_CNT];
+    row_t few = { "few durations" }, any = { "any" };
+    unsigned k, i;
+
+    printf("--- random captures ---\n");
+    for(k = 0; k < RANDOM; k++){
+        unsigned cnt = 3 + rnd() % (MAX_IR_CNT - 2);
+        unsigned durations = 2 + rnd() % 10;
+        uint16_t dur[12];
+        row_t *r = (k & 1) ? &any : &few;
+        char what[32];
+
+        for(i = 0; i < durations; i++)
+            dur[i] = 400 + rnd() % 30000;
+        for(i = 0; i < cnt; i++){
+            if(k & 1)
+                in[i] = 40 + rnd() % (0xFFFF - 40);
+            else{
+                uint16_t d = dur[rnd() % durations];
+                in[i] = d + (int)(d * 0.03 * ((double)(rnd() % 2001) / 1000 - 1));
+            }
+        }
+        snprintf(what, sizeof(what), "random %u", k);
+        r->codes++;
+        r->cnt += cnt;
+        check_dict(r, in, cnt, what);
+        check_unit(r, in, cnt, what);
+    }
+    for(k = 0; k < 2; k++){
+        row_t *r = k ? &any : &few;
+        printf("%-14s %5u codes, %5.1f intervals (%5.1f raw ring bytes): dictionary %3u codes %5.1f bytes,"
+               " unit %4u codes %5.1f bytes (%.0f%% of the intervals)\n", r->name, r->codes, (double)r->cnt / r->codes,
+               2.0 * r->cnt / r->codes, r->dict, r->dict ? (double)r->dict_bytes / r->dict : 0, r->unit,
+               (double)r->unit_bytes / r->unit, 100.0 * r->stored / r->cnt);
+        printf("%-14s largest error: dictionary %.1f%% of the interval, unit %.2f of unit/2\n", "", 100 * r->dict_err,
+               r->unit_err);
+    }
+}
+
+int main(void)
+{
+    sim_init();
+
+    protocols();
+    random_traces();
+    printf("sizeof(IR_CODE) = %u, IR_CODE_BYTES = %u\n", (unsigned)sizeof(IR_CODE), IR_CODE_BYTES);
+
+    return sim_done();
+}
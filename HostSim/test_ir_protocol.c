@@ -0,0 +1,266 @@
+/***************************
+ * TEST_IR_PROTOCOL.C
+ * Universal IR (Data Collection), IR_Protocol.c: recognizing captures (IR_Classify) and rebuilding them (IR_Synth)
+ *
+ * A corpus of frames per protocol (NEC, NECX, SIRC 12/15/20, RC5, RC6) with random fields, ideal and
+ * as a receiver records them (ir_trace.c: marks 60us long, 15us jitter). Each one must be:
+ *      classified as its protocol, with the address, command, toggle, mode and length it was sent with
+ *      synthesized back to the ideal frame: the same intervals, within a tick plus 0.1% (ir_trace.c
+ *          rounds the us timings to ticks edge by edge, IR_Protocol.c uses whole ticks per half bit)
+ * And rejected (left to the dictionary/unit formats):
+ *      frames cut short by a space and mark pair or two
+ *      NEC/NECX with the command inverse broken, or a mark 40% off; SIRC with a space 40% off (a SIRC
+ *          mark 40% off can be the other bit; the Manchester protocols round edge times to half bits,
+ *          so a single long interval moves nothing there)
+ *      random captures of any length
+ * Then sweeps the receiver jitter to show where each protocol stops being recognized, and whether
+ * anything is ever recognized with the wrong fields before that.
+ * Reports the bytes each protocol takes: the intervals in the raw ring (2 bytes each, as the raw
+ * FRAM storage took), data[] as a recognized protocol (IR_PROTO_BYTES), and data[] with the
+ * dictionary and unit formats it would otherwise get. Every format takes sizeof(IR_CODE) in FRAM.
+ *
+ * IR_Codec.c is included, so its static dictionary and unit encoders can be called for the sizes.
+****************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "IR_Codec.c"
+#include "ir_trace.h"
+#include "sim.h"
+
+#define STRETCH         60.0            //us
+#define JITTER          15.0
+#define FRAMES          500             //per protocol
+#define RANDOM          20000
+#define SWEEP_FRAMES    200
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static const unsigned char fmt_of[IR_TRACE_PROTOCOLS] = {
+    IR_FMT_NEC, IR_FMT_NECX, IR_FMT_SIRC, IR_FMT_SIRC, IR_FMT_SIRC, IR_FMT_RC5, IR_FMT_RC6
+};
+
+//data[] of IR_CODE for a protocol's fields (see IR_Codec.h)
+static void expected(int p, const ir_fields_t *f, unsigned char *d)
+{
+    d[0] = f->address & 0xFF;
+    d[1] = f->address >> 8;
+    d[2] = f->command;
+    d[3] = 0;
+    switch(p){
+    case IR_TRACE_NEC:      d[1] = (unsigned char)~f->address; break;
+    case IR_TRACE_SIRC12:   d[3] = 12; break;
+    case IR_TRACE_SIRC15:   d[3] = 15; break;
+    case IR_TRACE_SIRC20:   d[3] = 20; break;
+    case IR_TRACE_RC5:      d[3] = f->toggle & 1; break;
+    case IR_TRACE_RC6:      d[3] = f->mode | (f->toggle & 1) << 3; break;
+    }
+}
+
+/* Classifies in[0..n-1]: 0 if not recognized, 1 if recognized as protocol p with fields f, -1 if
+ * recognized as anything else
+ */
+static int classify(int p, const ir_fields_t *f, const uint16_t *in, unsigned n, IR_CODE *code)
+{
+    unsigned char d[4];
+
+    memset(code, 0, sizeof(*code));
+    if(!IR_Classify(in, n, code))
+        return 0;
+    expected(p, f, d);
+    return code->fmt == fmt_of[p] && !memcmp(code->data, d, 4) && code->cnt == n && code->len == IR_PROTO_BYTES
+         ? 1 : -1;
+}
+
+typedef struct
+{
+    unsigned    cnt, codes;
+    unsigned    dict, unit, dict_bytes, unit_bytes;
+} size_row_t;
+
+static size_row_t sizes[IR_TRACE_PROTOCOLS];
+
+static void corpus(void)
+{
+    uint16_t ideal[IR_TRACE_MAX], rec[IR_TRACE_MAX], syn[IR_TRACE_MAX];
+    unsigned p, k, i, n;
+
+    printf("--- %u frames per protocol, ideal and received ---\n", FRAMES);
+    for(p = 0; p < IR_TRACE_PROTOCOLS; p++){
+        const char *name = ir_trace_name(p);
+        unsigned ok = 0;
+
+        for(k = 0; k < FRAMES; k++){
+            ir_fields_t f;
+            IR_CODE code;
+            int r;
+
+            ir_trace_fields(p, &f, rnd);
+            n = ir_trace_ideal(p, &f, ideal);
+            ir_trace_receive(ideal, n, rec, STRETCH, JITTER, rnd);
+
+            r = classify(p, &f, ideal, n, &code);
+            SIM_CHECK(r == 1, "%s %u: ideal frame %s (fmt %u, data %02x %02x %02x %02x)", name, k,
+                      r ? "decoded wrong" : "not recognized", code.fmt, code.data[0], code.data[1], code.data[2],
+                      code.data[3]);
+            r = classify(p, &f, rec, n, &code);
+            SIM_CHECK(r == 1, "%s %u: received frame %s (fmt %u, data %02x %02x %02x %02x)", name, k,
+                      r ? "decoded wrong" : "not recognized", code.fmt, code.data[0], code.data[1], code.data[2],
+                      code.data[3]);
+            if(r != 1)
+                continue;
+
+            SIM_CHECK(IR_Synth(&code, syn) == n, "%s %u: %u intervals synthesized, %u sent", name, k,
+                      IR_Synth(&code, syn), n);
+            for(i = 0; i < n; i++)
+                SIM_CHECK(abs((int)syn[i] - ideal[i]) <= 1 + ideal[i] / 1000, "%s %u, interval %u: %u, ideal %u",
+                          name, k, i, syn[i], ideal[i]);
+            ok++;
+
+            //what the capture would take without the protocol
+            sizes[p].codes++;
+            sizes[p].cnt += n;
+            memset(&code, 0, sizeof(code));
+            if(IR_Encode_Dict(rec, n, &code)){
+                sizes[p].dict++;
+                sizes[p].dict_bytes += code.len + 2 * code.dict_cnt;
+            }
+            memset(&code, 0, sizeof(code));
+            if(IR_Encode_Unit(rec, n, &code) == n){
+                sizes[p].unit++;
+                sizes[p].unit_bytes += code.len + 2;
+            }
+        }
+        printf("%-8s %3u of %u recognized with their fields and synthesized back\n", name, ok, FRAMES);
+    }
+}
+
+static void rejected(void)
+{
+    uint16_t ideal[IR_TRACE_MAX], in[IR_TRACE_MAX];
+    unsigned p, k, i, n, cuts = 0, broken = 0, noise = 0;
+    IR_CODE code;
+
+    printf("--- captures that must not be recognized ---\n");
+    for(p = 0; p < IR_TRACE_PROTOCOLS; p++)
+        for(k = 0; k < FRAMES; k++){
+            ir_fields_t f;
+            unsigned cut = 2 + 2 * (k & 1);
+
+            ir_trace_fields(p, &f, rnd);
+            n = ir_trace_ideal(p, &f, ideal);
+            ir_trace_receive(ideal, n, in, STRETCH, JITTER, rnd);
+
+            //still ending on a mark: one or two space and mark pairs less
+            SIM_CHECK(!IR_Classify(in, n - cut, &code), "%s %u: recognized with %u intervals of %u",
+                      ir_trace_name(p), k, n - cut, n);
+            cuts++;
+
+            if(p == IR_TRACE_NEC || p == IR_TRACE_NECX){
+                memcpy(in, ideal, n * sizeof(in[0]));
+                i = 2 + 2 * (24 + rnd() % 8) + 1;           //a space of ~command
+                in[i] = in[i] > 4000 ? 2240 : 6760;
+                SIM_CHECK(!IR_Classify(in, n, &code), "%s %u: recognized with ~command broken", ir_trace_name(p), k);
+                broken++;
+            }
+            if(p != IR_TRACE_RC5 && p != IR_TRACE_RC6){
+                memcpy(in, ideal, n * sizeof(in[0]));
+                i = (p == IR_TRACE_NEC || p == IR_TRACE_NECX) ? 2 + 2 * (rnd() % 32) : 1 + 2 * (rnd() % (n / 2));
+                in[i] = (uint16_t)(in[i] * ((k & 2) ? 1.4 : 0.6));
+                SIM_CHECK(!IR_Classify(in, n, &code), "%s %u: recognized with interval %u at %u", ir_trace_name(p),
+                          k, i, in[i]);
+                broken++;
+            }
+        }
+
+    for(k = 0; k < RANDOM; k++){
+        unsigned cnt = 3 + rnd() % 80;
+        unsigned durations = 2 + rnd() % 6;
+        uint16_t dur[8];
+
+        for(i = 0; i < durations; i++)
+            dur[i] = 1000 + rnd() % 40000;
+        for(i = 0; i < cnt; i++)
+            in[i] = (k & 1) ? 400 + rnd() % 40000 : dur[rnd() % durations];
+        SIM_CHECK(!IR_Classify(in, cnt, &code), "random capture %u (%u intervals): recognized as fmt %u", k, cnt,
+                  code.fmt);
+        noise++;
+    }
+    printf("%u cut short, %u with a broken pulse or checksum, %u random: none recognized\n", cuts, broken, noise);
+}
+
+//Where each protocol stops being recognized as the receiver gets worse
+static void sweep(void)
+{
+    static const double jitter[] = { 0, 25, 50, 75, 100, 125, 150, 200, 250, 300 };
+    uint16_t ideal[IR_TRACE_MAX], rec[IR_TRACE_MAX];
+    unsigned p, j, k, n, wrong = 0;
+    IR_CODE code;
+
+    printf("--- recognized (%%) against the receiver's jitter (us), marks %.0fus long ---\n", STRETCH);
+    printf("%-8s", "");
+    for(j = 0; j < sizeof(jitter) / sizeof(jitter[0]); j++)
+        printf(" %5.0f", jitter[j]);
+    printf("\n");
+    for(p = 0; p < IR_TRACE_PROTOCOLS; p++){
+        printf("%-8s", ir_trace_name(p));
+        for(j = 0; j < sizeof(jitter) / sizeof(jitter[0]); j++){
+            unsigned ok = 0;
+
+            for(k = 0; k < SWEEP_FRAMES; k++){
+                ir_fields_t f;
+                int r;
+
+                ir_trace_fields(p, &f, rnd);
+                n = ir_trace_ideal(p, &f, ideal);
+                ir_trace_receive(ideal, n, rec, STRETCH, jitter[j], rnd);
+                r = classify(p, &f, rec, n, &code);
+                if(r == 1)
+                    ok++;
+                else if(r < 0)
+                    wrong++;
+            }
+            printf(" %5.1f", 100.0 * ok / SWEEP_FRAMES);
+        }
+        printf("\n");
+    }
+    printf("recognized with the wrong fields: %u\n", wrong);
+}
+
+static void report(void)
+{
+    unsigned p;
+
+    printf("--- bytes per code ---\n");
+    printf("%-8s %9s %9s %9s %14s %14s\n", "", "intervals", "raw ring", "protocol", "dictionary", "unit");
+    for(p = 0; p < IR_TRACE_PROTOCOLS; p++){
+        size_row_t *r = &sizes[p];
+
+        if(!r->codes)
+            continue;
+        printf("%-8s %9.1f %9.1f %9u %8.1f (%3u) %8.1f (%3u)\n", ir_trace_name(p), (double)r->cnt / r->codes,
+               2.0 * r->cnt / r->codes, IR_PROTO_BYTES, r->dict ? (double)r->dict_bytes / r->dict : 0, r->dict,
+               r->unit ? (double)r->unit_bytes / r->unit : 0, r->unit);
+    }
+    printf("(data[] bytes, with the dictionary or unit; (n) captures the format takes; sizeof(IR_CODE) = %u)\n",
+           (unsigned)sizeof(IR_CODE));
+}
+
+int main(void)
+{
+    sim_init();
+
+    corpus();
+    rejected();
+    sweep();
+    report();
+
+    return sim_done();
+}
@@ -0,0 +1,146 @@
+/***************************
+ * TEST_IR_RX.C
+ * IR_Emitter_and_Receiver, FR4133_IR_BP_RX.c: NEC decoding in TIMER0_A1_ISR
+ *
+ * The receiver output is fed to the ISR as TA0.2 captures of a continuous 4MHz TA0:
+ * each edge sets TA0CCR2 to the (16 bit, wrapping) timer value and TA0IV to CCR2.
+ * Checks every command code, with timing jitter and random timer phase, and that the ISR
+ * wakes main once per code, also after noise and NEC repeat codes. Then finds how far the timing can be off (eg. a wrong clock)
+ * before codes are lost, and reports the ISR cost per edge.
+****************************/
+
+#include <string.h>
+#include "msp430fr4133.h"
+#include "sim.h"
+
+#define TICK_US         0.25            //SMCLK 4MHz
+
+extern unsigned char rx_data[4];
+extern unsigned char IR_state;
+void TIMER0_A1_ISR(void);
+
+static sim_stat_t isr_edge = SIM_STAT("TIMER0_A1_ISR edge");
+static sim_stat_t isr_bit = SIM_STAT("TIMER0_A1_ISR data bit");
+static sim_stat_t isr_done = SIM_STAT("TIMER0_A1_ISR code complete");
+
+static uint32_t now;                    //absolute time in SMCLK ticks
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+//Waits us (scaled and with +-jitter percent), then captures an edge
+static void edge(double us, double scale, unsigned jitter, sim_stat_t *stat)
+{
+    double j = jitter ? ((double)(rnd() % (2 * jitter * 10 + 1)) / 10.0 - jitter) / 100.0 : 0;
+
+    now += (uint32_t)(us * scale * (1.0 + j) / TICK_US + 0.5);
+    sim_TA0CCR2 = (uint16_t)now;
+    sim_TA0IV = TA0IV_TACCR2;
+    if(stat)
+        SIM_RUN(*stat, TIMER0_A1_ISR());
+    else
+        TIMER0_A1_ISR();
+}
+
+//Sends one NEC frame: address 0x55 0xaa, command code, ~code
+//Returns the number of wakes, and whether the last one came at the end of the data
+static int send_nec(unsigned char code, double scale, unsigned jitter, int measure)
+{
+    unsigned char data[4] = { 0x55, 0xaa, code, (unsigned char)~code };
+    uint32_t wakes = sim_wakes;
+    int bit, woke_at_end = 0;
+
+    now += 40000 * 4 + rnd() % 65536;                           //idle gap, any timer phase
+    edge(0, 1, 0, measure ? &isr_edge : 0);                     //start of 9ms mark
+    edge(9000, scale, jitter, measure ? &isr_edge : 0);
+    edge(4500, scale, jitter, measure ? &isr_edge : 0);
+    for(bit = 0; bit < 32; bit++){
+        int one = (data[bit / 8] >> (bit % 8)) & 1;
+        edge(562.5, scale, jitter, measure ? &isr_edge : 0);
+        if(bit == 31){
+            uint32_t before = sim_wakes;
+            edge(one ? 1687.5 : 562.5, scale, jitter, measure ? &isr_done : 0);
+            woke_at_end = sim_wakes == before + 1;
+        }
+        else
+            edge(one ? 1687.5 : 562.5, scale, jitter, measure ? &isr_bit : 0);
+    }
+    edge(562.5, scale, jitter, measure ? &isr_edge : 0);        //end of the trailer
+    return (int)(sim_wakes - wakes) * 2 + woke_at_end;
+}
+
+static int decoded(unsigned char code)
+{
+    return rx_data[0] == 0x55 && rx_data[1] == 0xaa && rx_data[2] == code && rx_data[3] == (unsigned char)~code;
+}
+
+//Fraction of codes decoded with all intervals scaled by scale
+static unsigned decode_rate(double scale)
+{
+    unsigned code, ok = 0;
+
+    for(code = 0; code < 256; code++)
+        if(send_nec((unsigned char)code, scale, 0, 0) == 3 && decoded((unsigned char)code))
+            ok++;
+    return ok;
+}
+
+int main(void)
+{
+    unsigned code, round;
+    double lo, hi;
+
+    sim_init();
+    IR_state = 0;
+
+    printf("--- NEC decoding, every code, +-5%% jitter ---\n");
+    for(round = 0; round < 2; round++)
+        for(code = 0; code < 256; code++){
+            int r = send_nec((unsigned char)code, 1.0, 5, round == 0 && code < 64);
+            SIM_CHECK(r == 3, "code 0x%02x: wakes/end %d", code, r);
+            SIM_CHECK(decoded((unsigned char)code), "code 0x%02x: rx_data %02x %02x %02x %02x", code,
+                      rx_data[0], rx_data[1], rx_data[2], rx_data[3]);
+        }
+
+    //a burst of noise between frames must not leave the decoder stuck
+    for(round = 0; round < 20; round++){
+        unsigned k, n = 1 + rnd() % 7;
+        now += 100000;
+        for(k = 0; k < n; k++)
+            edge(50 + rnd() % 3000, 1.0, 0, 0);
+        send_nec(0x3c, 1.0, 0, 0);                              //may be lost to the noise
+        SIM_CHECK(send_nec(0xc3, 1.0, 0, 0) == 3 && decoded(0xc3), "no recovery after %u noise edges", n);
+    }
+
+    //NEC repeat codes (9ms mark, 2.25ms space, 0.56ms mark) between frames are ignored
+    for(round = 0; round < 20; round++){
+        unsigned k, n = rnd() % 4;
+        SIM_CHECK(send_nec(0x11 * (round % 16), 1.0, 5, 0) == 3, "frame before repeat codes");
+        for(k = 0; k < n; k++){
+            now += 40000 * 4 + rnd() % 65536;
+            edge(0, 1, 0, 0);
+            edge(9000, 1.0, 5, 0);
+            edge(2250, 1.0, 5, 0);
+            edge(562.5, 1.0, 5, 0);
+        }
+        SIM_CHECK(send_nec(0x5a, 1.0, 5, 0) == 3 && decoded(0x5a), "frame lost after %u repeat codes", n);
+    }
+
+    printf("--- timing tolerance (all intervals scaled) ---\n");
+    for(lo = 1.0; lo > 0.5 && decode_rate(lo - 0.01) == 256; lo -= 0.01);
+    for(hi = 1.0; hi < 1.5 && decode_rate(hi + 0.01) == 256; hi += 0.01);
+    printf("every code decoded for timings x%.2f .. x%.2f (%+.0f%% .. %+.0f%%)\n", lo, hi, (lo - 1) * 100, (hi - 1) * 100);
+    SIM_CHECK(lo <= 0.90 && hi >= 1.10, "tolerance x%.2f..x%.2f is under +-10%%", lo, hi);
+
+    printf("--- ISR cost per captured edge ---\n");
+    sim_report_header();
+    sim_report(&isr_edge);
+    sim_report(&isr_bit);
+    sim_report(&isr_done);
+
+    return sim_done();
+}
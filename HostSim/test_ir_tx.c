@@ -0,0 +1,133 @@
+/***************************
+ * TEST_IR_TX.C
+ * IR_Emitter_and_Receiver, FR4133_IR_BP_TX.c: IR envelope from TIMER1_A0_ISR
+ *
+ * TA1 runs in up mode with TA1.2 in reset/set mode, so every TA1 period is a mark of
+ * TA1CCR2+1 ticks and a space of TA1CCR0-TA1CCR2 ticks. TIMER1_A0_ISR runs at the end of a
+ * period and loads the registers for the next one.
+ * The test sets up a code as main() does, then records one period per ISR call until IR_stop,
+ * and compares the envelope with the protocol timings (NEC, Samsung, Sony SIRC 12 bit).
+ * The data bits are built here from each protocol's layout: NEC and Samsung address 0x55, ~address,
+ * code, ~code; SIRC the 7-bit code, then address 1 (TV) in 5 bits.
+ * The first period (TA1CCR0 = 640 from main()) is before the first symbol and is not compared.
+****************************/
+
+#include "msp430fr4133.h"
+#include "sim.h"
+
+#define TICK_US         0.25            //SMCLK 4MHz
+
+//Layout of IR_SYMBOL and IR_PROTOCOL in FR4133_IR_BP_TX.c (unsigned int is 16 bit there)
+typedef struct { uint16_t period, mark; } ir_symbol;
+typedef struct {
+    ir_symbol header, zero, one, trailer;
+    unsigned char bits, msb_first, carrier_period, carrier_duty, layout, address;
+} ir_protocol;
+
+extern const ir_protocol IR_NEC, IR_SAMSUNG, IR_SIRC12;
+extern const ir_protocol *tx_proto;
+extern const ir_symbol *tx_next;
+extern unsigned char tx_bit, tx_mask, IR_stop;
+extern unsigned char *send_addr;
+void IR_Load_Data(unsigned char code);
+const ir_symbol *IR_Next_Symbol(void);
+void TIMER1_A0_ISR(void);
+
+static sim_stat_t isr_stat[3] = { SIM_STAT("TIMER1_A0_ISR NEC"), SIM_STAT("TIMER1_A0_ISR Samsung"),
+                                  SIM_STAT("TIMER1_A0_ISR SIRC12") };
+
+//Expected envelope: header, bits LSB first, trailer (a mark), all in us
+static unsigned expect(sim_ref_t *ref, double hm, double hs, double zm, double zs, double om, double os,
+                       double tm, unsigned bits, const unsigned char *data)
+{
+    unsigned n = 0, b;
+
+    ref[n].level = 1; ref[n++].us = hm;
+    ref[n].level = 0; ref[n++].us = hs;
+    for(b = 0; b < bits; b++){
+        int one = (data[b / 8] >> (b % 8)) & 1;
+        ref[n].level = 1; ref[n++].us = one ? om : zm;
+        ref[n].level = 0; ref[n++].us = one ? os : zs;
+    }
+    if(tm){
+        ref[n].level = 1; ref[n++].us = tm;
+    }
+    else
+        n--;                            //the last space runs into idle
+    return n;
+}
+
+//Sends code with proto, as main() sets it up, and records the envelope
+//The ISR calls are measured into stat, if given
+static void send(const ir_protocol *proto, unsigned char code, sim_stat_t *stat)
+{
+    unsigned first = 1, guard = 0;
+
+    tx_proto = proto;
+    IR_Load_Data(code);
+    tx_bit = 0;
+    tx_mask = proto->msb_first ? 0x80 : 0x01;
+    tx_next = proto->header.period ? &proto->header : IR_Next_Symbol();
+    sim_TA1CCR0 = 640;
+    sim_TA1CCR2 = 320;
+    sim_TA1CCTL0 = CCIE;
+    IR_stop = 0;
+
+    sim_wave_reset();
+    while(!IR_stop && guard++ < 1000){
+        if(!first){
+            sim_wave_add(1, sim_TA1CCR2 + 1);
+            sim_wave_add(0, sim_TA1CCR0 - sim_TA1CCR2);
+        }
+        first = 0;
+        if(stat)
+            SIM_RUN(*stat, TIMER1_A0_ISR());
+        else
+            TIMER1_A0_ISR();
+    }
+    if(sim_wave_n && sim_wave[sim_wave_n - 1].level == 0)
+        sim_wave_n--;                   //space after the last mark: main() stops the timers
+    SIM_CHECK(IR_stop && !(sim_TA1CCTL0 & CCIE), "code 0x%02x not stopped", code);
+}
+
+int main(void)
+{
+    static sim_ref_t ref[80];
+    unsigned char nec[4] = { 0x55, 0xaa }, sirc[2];
+    unsigned code, n;
+    double err, worst[3] = { 0, 0, 0 };
+
+    sim_init();
+
+    for(code = 0; code < 256; code++){
+        nec[2] = code;
+        nec[3] = ~code;
+        sirc[0] = (code & 0x7F) | 0x80;         //address 1 from bit 7
+        sirc[1] = 0;
+
+        send(&IR_NEC, code, code < 64 ? &isr_stat[0] : 0);
+        n = expect(ref, 9000, 4500, 562.5, 562.5, 562.5, 1687.5, 562.5, 32, nec);
+        err = sim_wave_check(code == 0x5a ? "NEC 0x5a" : 0, ref, n, TICK_US);
+        if(err > worst[0]) worst[0] = err;
+
+        send(&IR_SAMSUNG, code, code < 64 ? &isr_stat[1] : 0);
+        n = expect(ref, 4500, 4500, 562.5, 562.5, 562.5, 1687.5, 562.5, 32, nec);
+        err = sim_wave_check(code == 0x5a ? "Samsung 0x5a" : 0, ref, n, TICK_US);
+        if(err > worst[1]) worst[1] = err;
+
+        send(&IR_SIRC12, code, code < 64 ? &isr_stat[2] : 0);
+        n = expect(ref, 2400, 600, 600, 600, 1200, 600, 0, 12, sirc);
+        err = sim_wave_check(code == 0x5a ? "SIRC12 0x5a" : 0, ref, n, TICK_US);
+        if(err > worst[2]) worst[2] = err;
+    }
+    printf("largest envelope error over all codes: NEC %.2f us, Samsung %.2f us, SIRC12 %.2f us\n",
+           worst[0], worst[1], worst[2]);
+    SIM_CHECK(worst[0] < 1 && worst[1] < 1 && worst[2] < 1, "envelope is off by more than 1us");
+
+    printf("--- ISR cost per symbol ---\n");
+    sim_report_header();
+    for(n = 0; n < 3; n++)
+        sim_report(&isr_stat[n]);
+
+    return sim_done();
+}
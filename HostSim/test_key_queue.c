@@ -0,0 +1,178 @@
+/***************************
+ * TEST_KEY_QUEUE.C
+ * IR_Board.c event queue (Universal IR Remote and Data Collection copies): Key_Post from an ISR
+ * landing in the middle of Key_Get_Event in main
+ *
+ * The queue has no lock: main only writes key_tail, ISRs only write key_head. To check that, an
+ * "ISR" posts an event between every two memory accesses Key_Get_Event makes. The pages that hold
+ * the queue are made inaccessible while Key_Get_Event runs: each access faults, the SIGSEGV handler
+ * opens the pages, posts (at the chosen access), and single-steps the access (trap flag) before
+ * closing them again. So a post lands before every read and write of key_head, key_tail and
+ * key_queue[], as the RTC or port ISR could on the MSP430.
+ * For every fill level from empty to full, and for every access, every event posted must come out
+ * once, in order. Only the injected event may be dropped, and only when the queue was full and
+ * Key_Get_Event had not yet freed its slot.
+ *
+ * x86-64 Linux only (the trap flag in the signal context).
+****************************/
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include "main.h"
+#include "IR_Board.h"
+#include "sim.h"
+
+#ifndef PROJECT
+#define PROJECT         "?"
+#endif
+
+#define TRAP_FLAG       0x100
+#define MAX_POINTS      32
+#define ALL             0xFF                    //inject at every access
+
+//Used by the handlers while the queue's pages are closed, so kept on a page of its own
+static struct
+{
+    uint8_t     *pages;
+    size_t      len;
+    int         armed;
+    unsigned    point, inject;                  //accesses so far, the one to post at
+    uint8_t     seq;                            //next event to post (as its key)
+    uint8_t     injected;                       //seq of the injected event, 0 if none yet
+} __attribute__((aligned(4096))) st;
+static char st_pad[4096 - sizeof(st)] __attribute__((used));
+
+static void on_segv(int sig, siginfo_t *si, void *ctx)
+{
+    ucontext_t *uc = ctx;
+    uint8_t *addr = si->si_addr;
+
+    (void)sig;
+    if(addr < st.pages || addr >= st.pages + st.len){
+        signal(SIGSEGV, SIG_DFL);               //a real crash: let it happen
+        return;
+    }
+    mprotect(st.pages, st.len, PROT_READ | PROT_WRITE);
+    if(st.inject == ALL || st.point == st.inject){
+        if(!st.injected) st.injected = st.seq;
+        Key_Post(KEY_DOWN, st.seq++);           //the ISR
+    }
+    st.point++;
+    uc->uc_mcontext.gregs[REG_EFL] |= TRAP_FLAG;
+}
+
+static void on_trap(int sig, siginfo_t *si, void *ctx)
+{
+    ucontext_t *uc = ctx;
+
+    (void)sig;
+    (void)si;
+    uc->uc_mcontext.gregs[REG_EFL] &= ~TRAP_FLAG;
+    if(st.armed)
+        mprotect(st.pages, st.len, PROT_NONE);
+}
+
+//Key_Get_Event with a post at access `inject`; returns the number of accesses it made
+static unsigned get_preempted(KEY_EVENT *ev, unsigned inject, unsigned char *got)
+{
+    st.point = 0;
+    st.inject = inject;
+    st.injected = 0;
+    st.armed = 1;
+    mprotect(st.pages, st.len, PROT_NONE);
+    *got = Key_Get_Event(ev);
+    mprotect(st.pages, st.len, PROT_READ | PROT_WRITE);
+    st.armed = 0;
+    return st.point;
+}
+
+static unsigned drain(uint8_t *out, unsigned n)
+{
+    KEY_EVENT ev;
+
+    while(Key_Get_Event(&ev))
+        out[n++] = ev.key;
+    return n;
+}
+
+//One run: `fill` events queued, then Key_Get_Event with a post at access `inject`
+static unsigned run(unsigned fill, unsigned inject, unsigned *dropped)
+{
+    uint8_t out[KEY_QUEUE_SIZE * 4];
+    KEY_EVENT ev;
+    unsigned char got;
+    unsigned i, n = 0, points, posted;
+
+    drain(out, 0);
+    st.seq = 1;
+    for(i = 0; i < fill; i++)
+        Key_Post(KEY_DOWN, st.seq++);
+
+    points = get_preempted(&ev, inject, &got);
+    if(got)
+        out[n++] = ev.key;
+    n = drain(out, n);
+    posted = st.seq - 1;
+
+    //everything queued before comes out once and in order, then what the ISR posted that fit
+    for(i = 0; i < n; i++)
+        SIM_CHECK(out[i] == i + 1, "fill %u, post at access %u: event %u is %u, expected %u", fill, inject, i,
+                  out[i], i + 1);
+    SIM_CHECK(n >= fill && n <= posted, "fill %u, post at access %u: %u of %u events", fill, inject, n, posted);
+    if(n < posted){
+        //dropped: only if the queue was full when the ISR posted
+        SIM_CHECK(n >= KEY_QUEUE_SIZE - 1, "fill %u, post at access %u: %u posted, %u came out, queue was not full",
+                  fill, inject, posted, n);
+        (*dropped)++;
+    }
+    return points;
+}
+
+int main(void)
+{
+    struct sigaction sa;
+    unsigned fill, k, points, min_points = MAX_POINTS, max_points = 0, dropped_full = 0, dropped = 0, dropped_all = 0;
+    long page = sysconf(_SC_PAGESIZE);
+
+    sim_init();
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sa.sa_sigaction = on_segv;
+    sigaction(SIGSEGV, &sa, 0);
+    sa.sa_sigaction = on_trap;
+    sigaction(SIGTRAP, &sa, 0);
+
+    //IR_Board.c's data is one block; key_map is in it, the queue within a few hundred bytes
+    st.pages = (uint8_t *)(((uintptr_t)&key_map - 512) & ~(uintptr_t)(page - 1));
+    st.len = ((((uintptr_t)&key_map + 512) | (page - 1)) + 1) - (uintptr_t)st.pages;
+    SIM_CHECK((uint8_t *)&st < st.pages || (uint8_t *)&st >= st.pages + st.len, "test state shares the queue's pages");
+
+    printf("--- %s: Key_Post from an ISR inside Key_Get_Event ---\n", PROJECT);
+    for(fill = 0; fill < KEY_QUEUE_SIZE; fill++){
+        unsigned d = 0;
+
+        points = run(fill, MAX_POINTS, &d);         //no post: counts the accesses
+        if(points < min_points) min_points = points;
+        if(points > max_points) max_points = points;
+        for(k = 0; k < points; k++)
+            run(fill, k, &d);
+        run(fill, ALL, &dropped_all);
+        if(fill == KEY_QUEUE_SIZE - 1)
+            dropped_full += d;
+        else
+            dropped += d;
+    }
+    SIM_CHECK(min_points >= 2 && max_points >= 4, "Key_Get_Event made %u..%u accesses to the queue", min_points,
+              max_points);
+    SIM_CHECK(dropped == 0, "%u events dropped with room in the queue", dropped);
+    printf("fill 0..%u of %u: a post before each of Key_Get_Event's %u (empty) to %u accesses, and at all of them\n",
+           KEY_QUEUE_SIZE - 1, KEY_QUEUE_SIZE - 1, min_points, max_points);
+    printf("nothing lost or duplicated; posts dropped because the queue was full: %u of the single posts at fill %u,"
+           " %u of the runs posting at every access\n", dropped_full, KEY_QUEUE_SIZE - 1, dropped_all);
+
+    return sim_done();
+}
@@ -0,0 +1,351 @@
+/***************************
+ * TEST_KEYPAD.C
+ * IR_Board.c keypad scan (Universal IR Remote and Simple Calc copies): Keypad_Scan_Step,
+ * Keypad_Ghost and the per-key debounce integrators, driven through the port and RTC ISRs
+ *
+ * The 4x4 matrix has no diodes: a row reads low when a chain of closed keys joins it to a driven
+ * column, so three corners of a rectangle also pull the fourth corner's row, as on the board.
+ * Time runs in RTC ticks (KEY_SCAN_TICKS of ACLK, 0.49ms). Every tick the test sets P1IN/P2IN
+ * from the keys closed and the columns driven, then calls PORT1_ISR/PORT2_ISR if the scan is
+ * idle and a row with its interrupt on is low, else RTC_ISR if the RTC is on. Then it takes
+ * every event out as main does (Key_Get_Event), with the tick it was posted at.
+ * A bouncing key is closed or open at random each tick for the bounce time after it is pressed
+ * and after it is released.
+ *      clean presses: every key gives one KEY_DOWN and one KEY_UP, and main is woken for the DOWN
+ *      bounces: one KEY_DOWN and one KEY_UP per press, for bounces up to BOUNCE_OK
+ *      ghost triples: every rectangle of 3 keys: the 3rd key and the ghost corner never go down
+ *      OK+digit chords: the digit's KEY_DOWN has both keys in `map`, and a chord never repeats
+ *      repeat: KEY_REPEAT after KEY_REPEAT_DELAY passes, then sooner each time down to KEY_REPEAT_MIN
+ * Reports the latency from contact to event and the share of presses read right per bounce time.
+****************************/
+
+#include "main.h"
+#include "IR_Board.h"
+#include "sim.h"
+
+#ifndef PROJECT
+#define PROJECT         "?"
+#endif
+
+#define TICK_MS         (KEY_SCAN_TICKS * 1000.0 / 32768)
+#define PASS            KEYPAD_COLS             //ticks per pass
+#define MS(ms)          ((unsigned)((ms) / TICK_MS + 0.5))
+
+#define KEY_OK          1                       //keys as numbered by scan_key() (enum KEYPAD of the Remote)
+static const uint8_t digits[10] = { 9, 16, 12, 8, 15, 11, 7, 14, 10, 6 };
+
+#define MAX_EVENTS      512
+#define BOUNCE_OK       8.0                     //ms of bounce that must always read right
+
+void PORT1_ISR(void);
+void PORT2_ISR(void);
+void RTC_ISR(void);
+
+typedef struct
+{
+    uint8_t     key;
+    unsigned    down, up;                       //ticks
+    unsigned    bounce;                         //ticks
+} press_t;
+
+typedef struct
+{
+    KEY_EVENT   ev;
+    unsigned    tick;
+    int         woke;                           //the ISR that posted it woke main
+} event_t;
+
+static event_t events[MAX_EVENTS];
+static unsigned n_events;
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+//Keys closed at tick t, bit (key-1)
+static uint16_t contacts(const press_t *p, unsigned n, unsigned t)
+{
+    uint16_t map = 0;
+    unsigned i;
+
+    for(i = 0; i < n; i++, p++){
+        int closed;
+
+        if(t < p->down || t >= p->up + p->bounce)
+            closed = 0;
+        else if(t < p->down + p->bounce || t >= p->up)
+            closed = rnd() & 1;
+        else
+            closed = 1;
+        if(closed)
+            map |= KEY_BIT(p->key);
+    }
+    return map;
+}
+
+//Columns driven low (DIR set, OUT low): 0 = P8.1, 1 = P1.1, 2 = P8.0, 3 = P2.5
+static uint8_t driven(void)
+{
+    return ((sim_P8DIR & BIT1) ? 1 : 0) | ((sim_P1DIR & BIT1) ? 2 : 0) | ((sim_P8DIR & BIT0) ? 4 : 0)
+         | ((sim_P2DIR & BIT5) ? 8 : 0);
+}
+
+//Rows pulled low through the closed keys (key k is column (k-1)/4, row (k-1)%4), bit 0 = P1.3
+static uint8_t low_rows(uint16_t closed)
+{
+    uint8_t cols = driven(), rows = 0, last;
+    unsigned c;
+
+    do{
+        last = rows;
+        for(c = 0; c < KEYPAD_COLS; c++)
+            if(cols & (1 << c))
+                rows |= (closed >> (4 * c)) & 0x0F;
+        for(c = 0; c < KEYPAD_COLS; c++)
+            if(rows & (closed >> (4 * c)) & 0x0F)
+                cols |= 1 << c;
+    } while(rows != last);
+    return rows;
+}
+
+//Runs `ticks` ticks of the presses, collecting the events
+static void run(const press_t *p, unsigned n, unsigned ticks)
+{
+    unsigned t;
+
+    n_events = 0;
+    for(t = 0; t < ticks; t++){
+        uint8_t rows = low_rows(contacts(p, n, t));
+        uint32_t wakes = sim_wakes;
+        KEY_EVENT ev;
+        int woke;
+
+        sim_P1IN = (uint8_t)~((rows & 0x07) << 3);
+        sim_P2IN = (rows & 0x08) ? (uint8_t)~BIT7 : 0xFF;
+
+        if(!sim_RTCCTL){
+            if(rows & 0x07 & (sim_P1IE >> 3)){
+                sim_P1IV = (rows & 1) ? P1IV_P1IFG3 : (rows & 2) ? P1IV_P1IFG4 : P1IV_P1IFG5;
+                PORT1_ISR();
+            }
+            else if((rows & 0x08) && (sim_P2IE & BIT7)){
+                sim_P2IV = P2IV_P2IFG7;
+                PORT2_ISR();
+            }
+        }
+        else{
+            sim_RTCIV = RTCIV_RTCIF;
+            RTC_ISR();
+        }
+
+        woke = sim_wakes != wakes;
+        while(Key_Get_Event(&ev) && n_events < MAX_EVENTS){
+            events[n_events].ev = ev;
+            events[n_events].tick = t;
+            events[n_events].woke = woke;
+            n_events++;
+        }
+    }
+    SIM_CHECK(!sim_RTCCTL && (sim_P1IE & (BIT3 | BIT4 | BIT5)) == (BIT3 | BIT4 | BIT5) && (sim_P2IE & BIT7),
+              "the scan did not stop after %u ticks", ticks);
+}
+
+static unsigned count(uint8_t type, uint8_t key)
+{
+    unsigned i, c = 0;
+
+    for(i = 0; i < n_events; i++)
+        if(events[i].ev.type == type && events[i].ev.key == key)
+            c++;
+    return c;
+}
+
+static const event_t *find(uint8_t type, uint8_t key)
+{
+    unsigned i;
+
+    for(i = 0; i < n_events; i++)
+        if(events[i].ev.type == type && events[i].ev.key == key)
+            return &events[i];
+    return 0;
+}
+
+typedef struct
+{
+    unsigned    n;
+    double      sum, max;
+} latency_t;
+
+static void latency(latency_t *l, unsigned from, unsigned to)
+{
+    double ms = (to - from) * TICK_MS;
+
+    l->n++;
+    l->sum += ms;
+    if(ms > l->max) l->max = ms;
+}
+
+static void clean_presses(void)
+{
+    latency_t down = { 0 }, up = { 0 };
+    unsigned key;
+
+    for(key = 1; key <= TOTAL_KEYS; key++){
+        press_t p = { (uint8_t)key, MS(5), MS(105), 0 };
+        const event_t *d, *u;
+
+        run(&p, 1, MS(150));
+        d = find(KEY_DOWN, key);
+        u = find(KEY_UP, key);
+        SIM_CHECK(n_events == 2 && d && u && d < u, "key %u: %u events", key, n_events);
+        if(d && u){
+            SIM_CHECK(d->woke && !u->woke, "key %u: main woken for DOWN %d, UP %d", key, d->woke, u->woke);
+            SIM_CHECK(d->ev.map == KEY_BIT(key) && u->ev.map == 0, "key %u: map 0x%04x, then 0x%04x", key, d->ev.map,
+                      u->ev.map);
+            latency(&down, p.down, d->tick);
+            latency(&up, p.up, u->tick);
+        }
+    }
+    printf("clean presses, 16 keys: KEY_DOWN %.1f ms avg, %.1f max after contact; KEY_UP %.1f avg, %.1f max"
+           " after release\n", down.sum / down.n, down.max, up.sum / up.n, up.max);
+}
+
+static void bounces(void)
+{
+    unsigned b;
+
+    printf("bounces, 200 presses per bounce time (random closed/open each tick for that long):\n");
+    for(b = 0; b <= MS(20); b += 4){
+        latency_t down = { 0 }, settled = { 0 };
+        unsigned i, right = 0;
+
+        for(i = 0; i < 200; i++){
+            press_t p = { (uint8_t)(1 + rnd() % TOTAL_KEYS), 2, 2 + b + MS(60 + rnd() % 100), b };
+            const event_t *d;
+
+            run(&p, 1, p.up + b + MS(40));
+            d = find(KEY_DOWN, p.key);
+            if(n_events == 2 && d && count(KEY_UP, p.key) == 1){
+                right++;
+                latency(&down, p.down, d->tick);
+                latency(&settled, p.down + b, d->tick > p.down + b ? d->tick : p.down + b);
+            }
+            if(b * TICK_MS <= BOUNCE_OK)
+                SIM_CHECK(n_events == 2 && d, "key %u, %.1f ms bounce: %u events", p.key, b * TICK_MS, n_events);
+        }
+        printf("    %4.1f ms: %5.1f%% read right; KEY_DOWN %4.1f ms avg, %4.1f max after the first contact,"
+               " %4.1f avg after the bouncing\n", b * TICK_MS, right / 2.0, right ? down.sum / down.n : 0, down.max,
+               right ? settled.sum / settled.n : 0);
+    }
+}
+
+static void ghosts(void)
+{
+    unsigned c1, c2, r1, r2, missing, cases = 0;
+
+    for(c1 = 0; c1 < KEYPAD_COLS; c1++)
+        for(c2 = c1 + 1; c2 < KEYPAD_COLS; c2++)
+            for(r1 = 0; r1 < KEYPAD_ROWS; r1++)
+                for(r2 = r1 + 1; r2 < KEYPAD_ROWS; r2++)
+                    for(missing = 0; missing < 4; missing++){
+                        uint8_t corner[4] = { (uint8_t)(c1 * 4 + r1 + 1), (uint8_t)(c1 * 4 + r2 + 1),
+                                              (uint8_t)(c2 * 4 + r1 + 1), (uint8_t)(c2 * 4 + r2 + 1) };
+                        press_t p[3];
+                        unsigned i, k;
+
+                        //pressed 20ms apart, released last first
+                        for(i = 0, k = 0; i < 4; i++)
+                            if(i != missing){
+                                p[k].key = corner[i];
+                                p[k].down = MS(5 + 20 * k);
+                                p[k].up = MS(200 - 20 * k);
+                                p[k].bounce = 0;
+                                k++;
+                            }
+                        run(p, 3, MS(250));
+                        cases++;
+
+                        SIM_CHECK(count(KEY_DOWN, corner[missing]) == 0, "ghost key %u went down", corner[missing]);
+                        SIM_CHECK(count(KEY_DOWN, p[2].key) == 0, "3rd key %u of a rectangle went down", p[2].key);
+                        for(k = 0; k < 2; k++)
+                            SIM_CHECK(count(KEY_DOWN, p[k].key) == 1 && count(KEY_UP, p[k].key) == 1,
+                                      "key %u of a rectangle: %u down, %u up", p[k].key, count(KEY_DOWN, p[k].key),
+                                      count(KEY_UP, p[k].key));
+                        SIM_CHECK(count(KEY_REPEAT, p[0].key) == 0 && count(KEY_REPEAT, p[1].key) == 0,
+                                  "a chord repeated");
+                    }
+    printf("ghost triples: %u rectangles, the ghost corner and the 3rd key never went down\n", cases);
+}
+
+static void chords(void)
+{
+    unsigned d;
+
+    for(d = 0; d < 10; d++){
+        press_t p[2] = { { KEY_OK, MS(5), MS(1000), 0 }, { digits[d], MS(50), MS(900), MS(2) } };
+        const event_t *ok, *dg;
+
+        run(p, 2, MS(1050));
+        ok = find(KEY_DOWN, KEY_OK);
+        dg = find(KEY_DOWN, digits[d]);
+        SIM_CHECK(ok && dg && ok < dg, "OK+%u: KEY_DOWN missing", d);
+        if(ok && dg)
+            SIM_CHECK(ok->ev.map == KEY_BIT(KEY_OK) && dg->ev.map == (KEY_BIT(KEY_OK) | KEY_BIT(digits[d])),
+                      "OK+%u: map 0x%04x, then 0x%04x", d, ok->ev.map, dg->ev.map);
+        SIM_CHECK(count(KEY_REPEAT, KEY_OK) == 0 && count(KEY_REPEAT, digits[d]) == 0, "OK+%u repeated", d);
+        SIM_CHECK(n_events == 4, "OK+%u: %u events", d, n_events);
+    }
+    printf("OK+digit chords: the digit's KEY_DOWN carries both keys, no KEY_REPEAT while both are held\n");
+}
+
+static void repeats(void)
+{
+    press_t p = { digits[5], MS(5), MS(5000), 0 };
+    const event_t *d;
+    unsigned i, n = 0, last = 0, step = KEY_REPEAT_START, expect = KEY_REPEAT_DELAY - 1;
+
+    run(&p, 1, MS(5050));
+    d = find(KEY_DOWN, p.key);
+    SIM_CHECK(d != 0, "held key did not go down");
+    if(!d)
+        return;
+
+    printf("repeat, key held 5s: KEY_REPEAT after");
+    last = d->tick;
+    for(i = 0; i < n_events; i++){
+        if(events[i].ev.type != KEY_REPEAT)
+            continue;
+        //counted in passes from the pass that posted KEY_DOWN (or the last KEY_REPEAT)
+        SIM_CHECK(events[i].tick - last == expect * PASS && events[i].woke, "repeat %u: %u ticks, expected %u", n,
+                  events[i].tick - last, expect * PASS);
+        if(n < 4 || step == KEY_REPEAT_MIN)
+            printf(n < 4 ? " %.0f" : "", (events[i].tick - last) * TICK_MS);
+        last = events[i].tick;
+        expect = step;
+        step -= step >> KEY_REPEAT_ACCEL;
+        if(step < KEY_REPEAT_MIN) step = KEY_REPEAT_MIN;
+        n++;
+    }
+    printf(" ... %.0f ms; %u repeats\n", expect * PASS * TICK_MS, n);
+    SIM_CHECK(expect == KEY_REPEAT_MIN, "repeat did not reach KEY_REPEAT_MIN in 5s");
+}
+
+int main(void)
+{
+    sim_init();
+    Init_KeypadIO();
+    sim_sr |= GIE;
+
+    printf("--- %s: keypad scan, one tick = %.2f ms ---\n", PROJECT, TICK_MS);
+    clean_presses();
+    bounces();
+    ghosts();
+    chords();
+    repeats();
+
+    return sim_done();
+}
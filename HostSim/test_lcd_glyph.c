@@ -0,0 +1,273 @@
+/***************************
+ * TEST_LCD_GLYPH.C
+ * LCD character tables: LCD_Letter (glyph[]) of the LCD.c copies and OutOfBox showChar (lcdChar[])
+ *
+ * Built once per LCD.c copy, and with -DOUTOFBOX for hal_LCD.c. Every character 0..255 is shown at
+ * every position by the old code (ref/lcd_letter_baseline.c, ref/showchar_baseline.c) and the new.
+ * The old code is run twice, over LCD memory filled with random bytes and with their complement,
+ * so the bytes it writes are told apart from the ones it leaves. The new code does one word write:
+ *      bytes the old code wrote must be the same
+ *      bytes the old code left at pos/pos+1 are now cleared (the digits and '.' of LCD_Letter)
+ *      nothing outside pos/pos+1 changes
+ * FRAM and Keypad Test and LCD and ADC Test had no digit case, so a digit showed blank there and
+ * now shows the digit (BASELINE_NO_DIGITS). Then reports the cost of one character, old and new.
+ *
+ * The LCD.c copies also get LCD_Number and LCD_Fixed_Point checked against the old %10 and /10
+ * code (ref/lcd_number_baseline.c) for every n in -999999..999999 and dp 0..5, and past the
+ * edges (INF): the LCD memory must be the same byte for byte, decimal point and sign included.
+ * Their cost is modelled in MSP430 cycles, as in test_mpy32.c: the compiler has no hardware
+ * divider to use (--use_hw_mpy=none), so the old code makes a call to the 32 bit divide for
+ * n%10 and another for n/=10 per digit, 32 steps of 15 cycles + 16 each. The new code subtracts
+ * powers of ten, counted below per subtraction from the digits of n. The LCD writes are the same
+ * on both sides (checked) and left out.
+****************************/
+
+#include <string.h>
+#include "msp430fr4133.h"
+#include "sim.h"
+
+#ifdef OUTOFBOX
+#include "hal_LCD.h"
+
+void baseline_showChar(char c, int16_t position);
+#define OLD(c, p)       baseline_showChar((c), (p))
+#define NEW(c, p)       showChar((c), (p))
+#define OLD_NAME        "showChar if/else"
+#define NEW_NAME        "showChar lcdChar[]"
+#define OLD_TABLES      (sizeof(baseline_digit) + sizeof(baseline_alphabetBig))
+#define NEW_TABLES      (sizeof(baseline_digit) + sizeof(baseline_alphabetBig) + 128 * 2)   //digit/alphabetBig are kept
+extern const char baseline_digit[10][2];
+extern const char baseline_alphabetBig[26][2];
+#else
+#include "LCD.h"
+
+void baseline_LCD_Letter(char ch, unsigned char pos);
+#define OLD(c, p)       baseline_LCD_Letter((c), (p))
+#define NEW(c, p)       LCD_Letter((c), (p))
+#define OLD_NAME        "LCD_Letter switch"
+#define NEW_NAME        "LCD_Letter glyph[]"
+#define OLD_TABLES      (sizeof(baseline_digit) + sizeof(baseline_alphabet))
+#define NEW_TABLES      (sizeof(baseline_digit) + 128 * 2)      //digit[] is kept for LCD_Digit
+extern const char baseline_digit[10];
+extern const char baseline_alphabet[28][2];
+
+void baseline_LCD_Number(long n);
+void baseline_LCD_Fixed_Point(long n, unsigned char dp);
+#endif
+
+#ifndef PROJECT
+#define PROJECT         "?"
+#endif
+
+static const uint8_t positions[6] = { pos1, pos2, pos3, pos4, pos5, pos6 };
+
+static sim_stat_t old_stat = SIM_STAT(OLD_NAME);
+static sim_stat_t new_stat = SIM_STAT(NEW_NAME);
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static void fill(uint8_t *to, const uint8_t *from, int invert)
+{
+    unsigned i;
+    for(i = 0; i < sizeof(sim_LCD.b); i++)
+        sim_LCD.b[i] = to[i] = invert ? (uint8_t)~from[i] : from[i];
+}
+
+#ifndef OUTOFBOX
+/*
+ * Cycle models of the digit loops. Old, per digit: __mspabi_remli and __mspabi_divli, each the
+ * restoring divide (test_mpy32.c: 16 + 32 * 15) plus 8 to take the signs, and 6 for the loop;
+ * INT_LEN is two 32 bit compares (CMP, JNE, CMP, JLO: 7 each) per digit. New, per power of ten:
+ * a subtraction is CMP and SUB+SUBC with the table entry (indexed, 3 each), INC, JMP: 16 for the
+ * 32 bit ones, 11 for the 16 bit ones; the compare that stops is 8 / 5; storing the digit is 6.
+ */
+#define OLD_DIGIT       (2 * (16 + 32 * 15 + 8) + 6)
+#define OLD_LEN         14
+#define NEW_SUB_HI      16
+#define NEW_SUB_LO      11
+#define NEW_STOP        (2 * 8 + 4 * 5)
+#define NEW_DIGIT       6
+
+typedef struct
+{
+    uint32_t    calls;
+    uint64_t    old_sum, new_sum;
+    unsigned    old_max, new_max;
+} number_cost_t;
+
+static void number_cost(number_cost_t *c, long n, unsigned dp)
+{
+    uint32_t v = n < 0 ? -(uint32_t)n : (uint32_t)n;
+    unsigned len = 0, digits = 0, old, new, k;
+
+    if(v > 999999 || dp > 5)
+        return;
+    for(k = 0, new = NEW_STOP; k < 6; k++, v /= 10){
+        new += (v % 10) * (k < 4 ? NEW_SUB_LO : NEW_SUB_HI);
+        if(v) len = k + 1;
+    }
+    if(!len) len = 1;
+    digits = len > dp + 1 ? len : dp + 1;
+    old = len * OLD_LEN + digits * OLD_DIGIT;
+    new += digits * NEW_DIGIT;
+
+    c->calls++;
+    c->old_sum += old;
+    c->new_sum += new;
+    if(old > c->old_max) c->old_max = old;
+    if(new > c->new_max) c->new_max = new;
+}
+
+//Shows n both ways over the same LCD memory, with LCD_Number if dp is NUMBER; 1 if they match
+#define NUMBER          0xFF
+
+static int number_same(long n, unsigned dp, const uint8_t *fill_with)
+{
+    uint8_t old_lcd[sizeof(sim_LCD.b)];
+    uint32_t old_acc, new_acc = sim_acc;
+
+    memcpy((void *)sim_LCD.b, fill_with, sizeof(old_lcd));
+    if(dp == NUMBER)
+        baseline_LCD_Number(n);
+    else
+        baseline_LCD_Fixed_Point(n, (unsigned char)dp);
+    memcpy(old_lcd, (const void *)sim_LCD.b, sizeof(old_lcd));
+    old_acc = sim_acc - new_acc;
+
+    memcpy((void *)sim_LCD.b, fill_with, sizeof(old_lcd));
+    new_acc = sim_acc;
+    if(dp == NUMBER)
+        LCD_Number(n);
+    else
+        LCD_Fixed_Point(n, (unsigned char)dp);
+    new_acc = sim_acc - new_acc;
+
+    return memcmp(old_lcd, (const void *)sim_LCD.b, sizeof(old_lcd)) == 0 && old_acc == new_acc;
+}
+
+static void numbers(void)
+{
+    static const long edge[] = { 1000000, -1000000, 9999999, 2147483647L, -2147483647L };
+    uint8_t fill_with[sizeof(sim_LCD.b)];
+    number_cost_t cost[6], small;
+    unsigned dp, i, failed = 0;
+    long n;
+
+    for(i = 0; i < sizeof(fill_with); i++)
+        fill_with[i] = (uint8_t)rnd();
+    memset(cost, 0, sizeof(cost));
+    memset(&small, 0, sizeof(small));
+
+    //dp 6 is LCD_Number
+    for(dp = 0; dp <= 6; dp++){
+        unsigned d = dp < 6 ? dp : NUMBER;
+
+        for(n = -999999; n <= 999999; n++){
+            if(!number_same(n, d, fill_with) && ++failed <= 10)
+                SIM_CHECK(0, "%s(%ld, %u) differs from the old code", dp < 6 ? "LCD_Fixed_Point" : "LCD_Number", n,
+                          dp);
+            if(dp < 6)
+                number_cost(&cost[dp], n, dp);
+            if(dp == 0 && n > -1000 && n < 1000)
+                number_cost(&small, n, dp);
+        }
+        for(i = 0; i < sizeof(edge) / sizeof(edge[0]); i++)
+            SIM_CHECK(number_same(edge[i], d, fill_with), "%ld (dp %u) is not INF as before", edge[i], dp);
+    }
+    for(n = -12; n <= 12; n++)
+        for(dp = 6; dp < 10; dp++)
+            SIM_CHECK(number_same(n, dp, fill_with), "LCD_Fixed_Point(%ld, %u) is not INF as before", n, dp);
+    SIM_CHECK(failed == 0, "%u numbers differ from the old code", failed);
+
+    printf("--- LCD_Number / LCD_Fixed_Point: -999999..999999, dp 0..5, as the old code ---\n");
+    printf("digit loops, modelled MSP430 cycles per call: old avg/max, new avg/max\n");
+    for(dp = 0; dp < 6; dp++)
+        printf("    dp %u: %6.0f / %5u   %4.0f / %3u\n", dp, (double)cost[dp].old_sum / cost[dp].calls,
+               cost[dp].old_max, (double)cost[dp].new_sum / cost[dp].calls, cost[dp].new_max);
+    printf("    dp 0, -999..999: %6.0f / %5u   %4.0f / %3u\n", (double)small.old_sum / small.calls, small.old_max,
+           (double)small.new_sum / small.calls, small.new_max);
+}
+#endif
+
+int main(void)
+{
+    uint8_t a[sizeof(sim_LCD.b)], na[sizeof(sim_LCD.b)], old_a[sizeof(sim_LCD.b)], old_na[sizeof(sim_LCD.b)];
+    unsigned ch, k, i, cleared = 0;
+    char cleared_list[64] = "";
+
+    sim_init();
+    printf("--- %s: every character at every position, against the old code ---\n", PROJECT);
+
+    for(ch = 0; ch < 256; ch++){
+        int newly_cleared = 0;
+
+        for(k = 0; k < 6; k++){
+            uint8_t p = positions[k];
+
+            for(i = 0; i < sizeof(a); i++)
+                a[i] = (uint8_t)rnd();
+            fill(a, a, 0);
+            OLD((char)ch, p);
+            memcpy(old_a, (const void *)sim_LCD.b, sizeof(a));
+            fill(na, a, 1);
+            OLD((char)ch, p);
+            memcpy(old_na, (const void *)sim_LCD.b, sizeof(a));
+
+            fill(a, a, 0);
+            NEW((char)ch, p);
+
+            for(i = 0; i < sizeof(a); i++){
+                int written = old_a[i] != a[i] || old_na[i] != na[i];
+                uint8_t expect;
+
+                if(written){
+                    SIM_CHECK(old_a[i] == old_na[i], "old code: 0x%02x at %u wrote LCDMEM[%u] from what was there", ch, p, i);
+                    expect = old_a[i];
+                }
+                else if(i == p || i == p + 1u){
+                    expect = 0;
+                    newly_cleared = 1;
+                }
+                else
+                    expect = a[i];
+#if defined(BASELINE_NO_DIGITS)
+                if(ch >= '0' && ch <= '9' && (i == p || i == p + 1u))
+                    expect = i == p ? (uint8_t)baseline_digit[ch - '0'] : 0;
+#endif
+                if(i != p && i != p + 1u)
+                    SIM_CHECK(!written, "old code: 0x%02x at %u wrote LCDMEM[%u]", ch, p, i);
+                SIM_CHECK(sim_LCD.b[i] == expect, "0x%02x at %u: LCDMEM[%u] is 0x%02x, expected 0x%02x",
+                          ch, p, i, sim_LCD.b[i], expect);
+            }
+        }
+        if(newly_cleared){
+            cleared++;
+            if(strlen(cleared_list) < sizeof(cleared_list) - 2)
+                cleared_list[strlen(cleared_list)] = ch >= 32 && ch < 127 ? (char)ch : '?';
+        }
+    }
+    printf("characters whose unused byte is now cleared: %u (%s)\n", cleared, cleared_list);
+
+    for(ch = 32; ch < 127; ch++)
+        for(k = 0; k < 6; k++){
+            SIM_RUN(old_stat, OLD((char)ch, positions[k]));
+            SIM_RUN(new_stat, NEW((char)ch, positions[k]));
+        }
+    printf("--- cost of one printable character (old tables %u bytes, new %u bytes) ---\n",
+           (unsigned)OLD_TABLES, (unsigned)NEW_TABLES);
+    sim_report_header();
+    sim_report(&old_stat);
+    sim_report(&new_stat);
+
+#ifndef OUTOFBOX
+    numbers();
+#endif
+
+    return sim_done();
+}
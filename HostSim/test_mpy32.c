@@ -0,0 +1,179 @@
+/***************************
+ * TEST_MPY32.C
+ * Common/MPY32.h: results on the emulated MPY32 registers, result timing, and cycles per operation
+ *
+ * Every function is checked against plain C on edge and random operands, MPY_Div(n, MPY_RECIP(d))
+ * for every d below 2000 up to n = (2^32-1)/d. sim_done() fails if a result was read before it was
+ * ready (see Result timing in MPY32.h).
+ *
+ * Then prints the benchmark table of MPY32.h, in MSP430 cycles, modelled rather than measured:
+ *      MPY32: each MPY32 register access is a MOV between a CPU register and an absolute address,
+ *          3 cycles, plus the __delay_cycles, plus 5 for MPY_LOCK/MPY_UNLOCK (MOV SR, DINT, NOP,
+ *          MOV to SR, NOP), plus 3 per MPY_MAC16 term for the loop. Accesses and delays are counted.
+ *      software: the compiler's routines are shift-and-add loops that stop when the multiplier runs
+ *          out of bits, and a restoring divide of 32 steps. The cycles of one loop step are counted
+ *          from the instructions it needs (below), the steps from the operands.
+****************************/
+
+#include <stdlib.h>
+#include "msp430fr4133.h"
+#include "sim.h"
+#include "MPY32.h"
+
+#define RANDOM          20000
+#define BENCH           1000
+#define MAC_TERMS       8
+
+/*
+ * Software routine models, cycles: per multiplier bit, extra when the bit is set, and the call
+ * with its setup. One step of 16x16 -> 32: CLRC, RRC multiplier, JNC (4); ADD+ADDC (2, set);
+ * RLA+RLC multiplicand (2); TST+JNZ (3). 32x32 -> 32: two RRC, the multiplier test is MOV+BIS+JNZ.
+ * 32x32 -> 64 (the high word needs a long long multiply): four words each. Divide: RLA/RLC the
+ * dividend into the remainder (4), compare (6), SUB+SUBC (2), count (3), always 32 steps.
+ */
+typedef struct
+{
+    unsigned step, set, call;
+} sw_model_t;
+
+static const sw_model_t sw_mul16 = { 9, 2, 12 };        //signed: +6 to negate and fix the sign
+static const sw_model_t sw_mul32 = { 12, 2, 14 };
+static const sw_model_t sw_mul64 = { 19, 4, 24 };
+static const sw_model_t sw_div32 = { 15, 0, 16 };
+
+static uint32_t seed = 1;
+
+//16 random bits
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 16;
+}
+
+static uint32_t rnd32(void)
+{
+    uint32_t hi = rnd();
+    return (hi << 16) | rnd();
+}
+
+//Software cycles of a shift-and-add multiply over the bits of m
+static unsigned sw_mul(const sw_model_t *s, uint32_t m)
+{
+    unsigned cycles = s->call;
+    for(; m; m >>= 1)
+        cycles += s->step + ((m & 1) ? s->set : 0);
+    return cycles;
+}
+
+static void results(void)
+{
+    static const uint32_t edge[] = { 0, 1, 2, 0x7FFF, 0x8000, 0xFFFF, 0x10000, 0x7FFFFFFF, 0x80000000,
+                                     0xFFFFFFFE, 0xFFFFFFFF };
+    unsigned i, j, d;
+
+    printf("--- results ---\n");
+    for(i = 0; i < RANDOM + 11 * 11; i++){
+        uint32_t a = i < 121 ? edge[i / 11] : rnd32();
+        uint32_t b = i < 121 ? edge[i % 11] : rnd32();
+
+        SIM_CHECK(MPY_Mul16((int16_t)a, (int16_t)b) == (int32_t)(int16_t)a * (int16_t)b,
+                  "MPY_Mul16(%d, %d)", (int16_t)a, (int16_t)b);
+        SIM_CHECK(MPY_Mulu16((uint16_t)a, (uint16_t)b) == (uint32_t)(uint16_t)a * (uint16_t)b,
+                  "MPY_Mulu16(%u, %u)", (uint16_t)a, (uint16_t)b);
+        SIM_CHECK((uint32_t)MPY_Mul32((int32_t)a, (int32_t)b) == a * b, "MPY_Mul32(0x%08x, 0x%08x)", a, b);
+        SIM_CHECK(MPY_Mulu32_Hi(a, b) == (uint32_t)((uint64_t)a * b >> 32), "MPY_Mulu32_Hi(0x%08x, 0x%08x)", a, b);
+    }
+
+    for(i = 0; i < RANDOM / MAC_TERMS; i++){
+        int16_t x[MAC_TERMS], y[MAC_TERMS];
+        int32_t sum = 0;
+
+        for(j = 0; j < MAC_TERMS; j++){
+            x[j] = i ? (int16_t)rnd() : INT16_MIN;
+            y[j] = i ? (int16_t)rnd() : INT16_MIN + (j & 1);
+            sum = (int32_t)((uint32_t)sum + (uint32_t)((int32_t)x[j] * y[j]));
+        }
+        SIM_CHECK(MPY_MAC16(x, y, MAC_TERMS) == sum, "MPY_MAC16: %d, expected %d", MPY_MAC16(x, y, MAC_TERMS), sum);
+    }
+
+    for(d = 2; d < 2000; d++){
+        uint32_t max = 0xFFFFFFFFu / d;
+
+        for(i = 0; i < 40; i++){
+            uint32_t n = i < 4 ? (uint32_t[]){ 0, d - 1, max - 1, max }[i] : rnd32() % (max + 1);
+            SIM_CHECK(MPY_Div(n, MPY_RECIP(d)) == n / d, "MPY_Div(%u, MPY_RECIP(%u)): %u", n, d,
+                      MPY_Div(n, MPY_RECIP(d)));
+        }
+    }
+}
+
+typedef struct
+{
+    const char  *name;
+    uint32_t    acc, delay, extra;          //MPY32 side, summed over BENCH calls
+    uint32_t    sw;                         //software side
+} bench_t;
+
+static void bench_row(const bench_t *b)
+{
+    printf(" *      %-28s %5lu %9lu\n", b->name,
+           (unsigned long)((3 * b->acc + b->delay + b->extra) / BENCH + 5), (unsigned long)(b->sw / BENCH));
+}
+
+#define BENCH_RUN(b, call) do {                                 \
+        uint32_t acc = sim_acc, delay = sim_delay;              \
+        (void)(call);                                           \
+        (b).acc += sim_acc - acc;                               \
+        (b).delay += sim_delay - delay;                         \
+    } while(0)
+
+static void benchmark(void)
+{
+    bench_t mulu16 = { "MPY_Mulu16 (16x16)" }, mul16 = { "MPY_Mul16 (signed 16x16)" };
+    bench_t mul32 = { "MPY_Mul32 (32x32, low)" }, hi32 = { "MPY_Mulu32_Hi (32x32, high)" };
+    bench_t mac = { "MPY_MAC16, 8 terms" }, div10 = { "MPY_Div, n/10" };
+    unsigned i, j;
+
+    for(i = 0; i < BENCH; i++){
+        uint32_t a = rnd32(), b = rnd32();
+        int16_t x[MAC_TERMS], y[MAC_TERMS];
+
+        BENCH_RUN(mulu16, MPY_Mulu16((uint16_t)a, (uint16_t)b));
+        mulu16.sw += sw_mul(&sw_mul16, (uint16_t)b);
+        BENCH_RUN(mul16, MPY_Mul16((int16_t)a, (int16_t)b));
+        mul16.sw += sw_mul(&sw_mul16, (uint16_t)abs((int16_t)b)) + 6;
+        BENCH_RUN(mul32, MPY_Mul32((int32_t)a, (int32_t)b));
+        mul32.sw += sw_mul(&sw_mul32, b);
+        BENCH_RUN(hi32, MPY_Mulu32_Hi(a, b));
+        hi32.sw += sw_mul(&sw_mul64, b);
+        BENCH_RUN(div10, MPY_Div(a / 10, MPY_RECIP(10)));
+        div10.sw += sw_div32.call + 32 * sw_div32.step;
+
+        for(j = 0; j < MAC_TERMS; j++){
+            x[j] = (int16_t)rnd();
+            y[j] = (int16_t)rnd();
+            mac.sw += sw_mul(&sw_mul16, (uint16_t)abs(y[j])) + 6 + 2 + 3;   //+ the 32 bit add and the loop
+        }
+        BENCH_RUN(mac, MPY_MAC16(x, y, MAC_TERMS));
+        mac.extra += 3 * MAC_TERMS;
+    }
+
+    printf("--- cycles per operation, random operands ---\n");
+    printf(" *      %-28s %5s %9s\n", "cycles", "MPY32", "software");
+    bench_row(&mulu16);
+    bench_row(&mul16);
+    bench_row(&mul32);
+    bench_row(&hi32);
+    bench_row(&mac);
+    bench_row(&div10);
+}
+
+int main(void)
+{
+    sim_init();
+
+    results();
+    benchmark();
+
+    return sim_done();
+}
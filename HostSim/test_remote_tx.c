@@ -0,0 +1,182 @@
+/***************************
+ * TEST_REMOTE_TX.C
+ * Universal IR Remote: TA0.0 playback ISR, before and after the playback plan
+ *
+ * Before (ref/remote_baseline.c): the ISR looked up every edge time with
+ * CODE_GET_COUNT_OR_TIME(mode, key, symbol), a switch on all three.
+ * After (main.c): IR_Mode_Setting expands the code with IR_Code_Plan once per key press,
+ * and the ISR only loads the next CCR0 value.
+ * For every TV1 key both versions are run to the end of the code: the TA0CCR0 values and
+ * TA0.2 toggles must be the same, and the ISR cost per edge is reported. The claim to check is
+ * that the new ISR takes the same path, so the same time, for every edge of every code.
+ *
+ * The lookups on their own: for every mode and key, IR_Code_Get must find a code exactly where
+ * CODE_GET_COUNT_OR_TIME has a count, and IR_Code_Plan must give the duration it returns for
+ * every symbol. Reports the cost of a key press (IR_Code_Get + IR_Code_Plan, against a switch
+ * lookup for the count and for every edge) and the size of the tables, in MSP430 bytes: the
+ * durations were immediates in the switch, they are now dict[] arrays plus an IR_CODE per key
+ * (the symbol arrays are the same in both).
+****************************/
+
+#include <string.h>
+#include "main.h"
+#include "IR_Codes.h"
+#include "sim.h"
+
+#define MAX_EDGES   80
+
+extern enum MODES mode;
+extern enum KEYPAD button_num;
+extern unsigned int button_map;
+extern enum { IDLE_, TRANSMITTING_ } remote_status;
+void TIMER0_A0_ISR(void);
+
+extern unsigned char baseline_remote_status;
+extern const unsigned char *baseline_FRAM_ptr;
+unsigned int baseline_CODE_GET_COUNT_OR_TIME(enum MODES curr_mode, enum KEYPAD curr_num, unsigned char time);
+void baseline_Start(enum KEYPAD key);
+void baseline_TIMER0_A0_ISR(void);
+
+static sim_stat_t old_edge = SIM_STAT("before: ISR per edge");
+static sim_stat_t old_end = SIM_STAT("before: ISR end of code");
+static sim_stat_t new_edge = SIM_STAT("after: ISR per edge");
+static sim_stat_t new_end = SIM_STAT("after: ISR end of code");
+static sim_stat_t new_plan = SIM_STAT("after: IR_Mode_Setting (key press)");
+static sim_stat_t old_lookup = SIM_STAT("before: CODE_GET_COUNT_OR_TIME");
+static sim_stat_t new_get = SIM_STAT("after: IR_Code_Get");
+static sim_stat_t new_expand = SIM_STAT("after: IR_Code_Plan");
+
+//MSP430 sizes (small data model: 2 byte pointers and ints)
+#define MSP_IR_CODE     6               //dict, sym, cnt, padding
+#define MSP_DICT        (8 * 2)
+
+//Runs one version of the ISR to the end of the code; returns the number of edges
+static unsigned play(int baseline, uint16_t *ccr0)
+{
+    unsigned n = 0;
+
+    sim_TA0CCTL0 = CCIE;
+    sim_TA0CCTL2 = 0;
+    sim_TA0IV = TA0IV_NONE;
+    while(n < MAX_EDGES){
+        sim_stat_t call = SIM_STAT("");
+        uint16_t out = sim_TA0CCTL2 & OUT;
+        uint32_t wakes = sim_wakes;
+
+        if(baseline)
+            SIM_RUN(call, baseline_TIMER0_A0_ISR());
+        else
+            SIM_RUN(call, TIMER0_A0_ISR());
+        if(sim_wakes != wakes){
+            sim_merge(baseline ? &old_end : &new_end, &call);
+            break;
+        }
+        sim_merge(baseline ? &old_edge : &new_edge, &call);
+        SIM_CHECK((sim_TA0CCTL2 & OUT) != out, "edge %u did not toggle TA0.2", n);
+        ccr0[n++] = sim_TA0CCR0;
+    }
+    SIM_CHECK(!(sim_TA0CCTL0 & CCIE), "TA0.0 interrupt still on after %u edges", n);
+    return n;
+}
+
+//Every mode and key: IR_Code_Get + IR_Code_Plan against the switch, value for value
+static void lookups(void)
+{
+    uint16_t plan[MAX_IR_CNT + 1], immediate[32];
+    uint32_t old_press = 0, new_press = 0;
+    unsigned m, key, i, j, codes = 0, immediates = 0;
+
+    for(m = AIRCON; m < TOTAL_MODES; m++)
+        for(key = NONE; key <= KEY_1; key++){
+            const IR_CODE *code;
+            unsigned count;
+            sim_stat_t old_call = SIM_STAT(""), get_call = SIM_STAT(""), plan_call = SIM_STAT("");
+
+            //the constants the switch holds (the digits share theirs)
+            for(i = 0; i < 8; i++){
+                uint16_t t = baseline_CODE_GET_COUNT_OR_TIME(m, key, i);
+                for(j = 0; j < immediates && immediate[j] != t; j++);
+                if(t && j == immediates)
+                    immediate[immediates++] = t;
+            }
+
+            SIM_RUN(old_call, count = baseline_CODE_GET_COUNT_OR_TIME(m, key, 0));
+            SIM_RUN(get_call, code = IR_Code_Get(m, key));
+            SIM_CHECK((code ? code->cnt : 0) == count, "mode %u key %u: %u edges, %u before", m, key,
+                      code ? code->cnt : 0, count);
+            if(!code || !count)
+                continue;
+
+            codes++;
+            SIM_RUN(plan_call, IR_Code_Plan(code, plan));
+            baseline_Start(key);                        //picks the symbols, as IR_Mode_Setting did
+            for(i = 0; i < count; i++){
+                uint16_t t;
+
+                SIM_RUN(old_call, t = baseline_CODE_GET_COUNT_OR_TIME(m, key, baseline_FRAM_ptr[i]));
+                SIM_CHECK(plan[i] == t, "mode %u key %u edge %u: %u, %u before", m, key, i, plan[i], t);
+            }
+            SIM_CHECK(plan[count] == 0, "mode %u key %u: plan not ended", m, key);
+            sim_merge(&old_lookup, &old_call);
+            sim_merge(&new_get, &get_call);
+            sim_merge(&new_expand, &plan_call);
+            old_press += old_call.instr_sum;
+            new_press += get_call.instr_sum + plan_call.instr_sum;
+        }
+
+    printf("--- code lookup, every mode and key (%u codes) ---\n", codes);
+    printf("tables: before %u immediates in the switch (%u bytes), after %u dict[] (%u bytes) + %u IR_CODE (%u bytes)"
+           " + plan (%u bytes RAM)\n", immediates, 2 * immediates, 2, 2 * MSP_DICT, codes, codes * MSP_IR_CODE,
+           (unsigned)(2 * (MAX_IR_CNT + 1)));
+    if(sim_traced)
+        printf("per key press: before %.0f host instructions (a lookup for the count and per edge),"
+               " after %.0f (IR_Code_Get + IR_Code_Plan)\n", (double)old_press / codes, (double)new_press / codes);
+}
+
+int main(void)
+{
+    static const enum KEYPAD keys[] = { KEY_0, KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6, KEY_7, KEY_8, KEY_9, POWER };
+    uint16_t old_ccr0[MAX_EDGES], new_ccr0[MAX_EDGES];
+    unsigned k, n_old, n_new, round;
+
+    sim_init();
+
+    lookups();
+    for(round = 0; round < 4; round++)
+        for(k = 0; k < sizeof(keys) / sizeof(keys[0]); k++){
+            baseline_Start(keys[k]);
+            n_old = play(1, old_ccr0);
+
+            mode = TV1;
+            button_num = keys[k];
+            button_map = 0;
+            remote_status = IDLE_;
+            SIM_RUN(new_plan, IR_Mode_Setting());
+            SIM_CHECK(remote_status == TRANSMITTING_, "key %u did not start", keys[k]);
+            n_new = play(0, new_ccr0);
+
+            SIM_CHECK(n_old == n_new && n_new == (keys[k] == POWER ? 26 : 35), "key %u: %u edges before, %u after",
+                      keys[k], n_old, n_new);
+            SIM_CHECK(memcmp(old_ccr0, new_ccr0, n_new * sizeof(uint16_t)) == 0, "key %u: TA0CCR0 values differ", keys[k]);
+        }
+
+    printf("--- TA0.0 ISR, all TV1 keys ---\n");
+    sim_report_header();
+    sim_report(&old_edge);
+    sim_report(&old_end);
+    sim_report(&new_edge);
+    sim_report(&new_end);
+    sim_report(&new_plan);
+    sim_report(&old_lookup);
+    sim_report(&new_get);
+    sim_report(&new_expand);
+    if(sim_traced){
+        printf("spread per edge: before %u, after %u host instructions\n",
+               old_edge.instr_max - old_edge.instr_min, new_edge.instr_max - new_edge.instr_min);
+        SIM_CHECK(new_edge.instr_max == new_edge.instr_min, "the per-edge ISR is not constant-time");
+        SIM_CHECK(new_edge.instr_max < old_edge.instr_min, "the per-edge ISR is not faster than before");
+    }
+    SIM_CHECK(new_edge.acc_max == 2, "per-edge ISR makes %u register accesses", new_edge.acc_max);
+
+    return sim_done();
+}
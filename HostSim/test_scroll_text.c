@@ -0,0 +1,192 @@
+/***************************
+ * TEST_SCROLL_TEXT.C
+ * OutOfBox hal_LCD.c displayScrollText: active time, old (__delay_cycles) and new (WDT interval and LPM3)
+ *
+ * Both versions scroll the messages the demo shows. The old one (ref/scroll_baseline.c) is seen at
+ * each of its __delay_cycles(200000); the new one at each LPM3 entry (sim_lpm_hook), where the WDT
+ * step is run by calling WDT_ISR. Each must show the same frames on the LCD, in order: the old from
+ * LCDMEM, the new from the memory LCDMEMCTL selects. Then:
+ *      the new one never busy-waits, sleeps and is woken once per frame
+ *      other interrupts waking it between two steps (the RTC, a button) do not step the scroll
+ *      a mode change (S1 and S2) stops both after the same frame
+ *      both leave the last frame (blank) in LCDMEM, shown from LCDMEM
+ * Reports, per message, the time spent active. The busy-wait is measured (sim_delay), the rest is
+ * modelled in MSP430 cycles (MCLK is the default ~1MHz, so a cycle is ~1us), counted by hand from
+ * the instructions of the paths (below), not measured.
+****************************/
+
+#include <string.h>
+#include "msp430fr4133.h"
+#include "hal_LCD.h"
+#include "sim.h"
+
+extern volatile unsigned char *mode;
+void WDT_ISR(void);
+void baseline_displayScrollText(char *msg);
+
+#define MCLK_HZ         1000000.0
+#define FRAMES_MAX      64
+#define MODE            2               //any mode: only a change matters
+
+/*
+ * MSP430 cycles:
+ *      OLD_FRAME: the *mode check 6, clearing buffer[] 6 x 7, 6 showChar (arguments 4, CALL 5, the
+ *          < 128 test and lcdChar[] lookup 11, the store to LCDMEMW[position/2] 6, RET 4) 180, s-- and
+ *          the loop 6
+ *      SCROLL_CHAR: one character of the j loop, in both: s+j, its two range tests, the copy 16
+ *      NEW_FRAME: scrollFrame (CALL and RET 9, buffer[] 11, 6 showCharBack: showChar's 30 and the
+ *          LCDMEMCTL & LCDDISP test 6), then the step: scrollTick = 0 4, DINT 2, the while test 10,
+ *          the BIS to LPM3 2, after it DINT and EINT 4, the *mode and i tests 10, flipLCD 14, the loop 4
+ *      NEW_SETUP: the WDT and SFR driverlib calls 90, beginLCDBack and endLCDBack (10 words) 2 x 115
+ *      WAKE: every LPM3 exit: the wake-up (~10us from LPM3, counted as active) and the while test 12
+ *      WDT_ISR: interrupt 6, scrollTick = 1 4, the BIC on exit 5, RETI 5
+ */
+#define OLD_FRAME       234
+#define SCROLL_CHAR     16
+#define NEW_FRAME       286
+#define NEW_SETUP       320
+#define WAKE            22
+#define ISR_WDT         20
+
+static const char *const messages[] = {
+    "WELCOME TO THE FR4133 LAUNCHPAD", "HOLD S1 AND S2 TO SWITCH MODES", "STOPWATCH MODE", "TEMPSENSOR MODE"
+};
+
+static const unsigned char POS[6] = { pos1, pos2, pos3, pos4, pos5, pos6 };
+
+typedef struct
+{
+    unsigned    shown;
+    uint16_t    frame[FRAMES_MAX][6];   //digits pos1..pos6, as on the LCD
+    uint16_t    end[6];                 //in LCDMEM once done
+    uint32_t    delay, sleeps, wakes;
+} run_t;
+
+static run_t *cur;
+static unsigned mode_at;                //change the mode once this many frames were shown (0: never)
+static int extra;                       //another interrupt before every WDT step
+
+//The digits of LCDMEM (or LCDBMEM), read past the access counts
+static void digits(int bmem, uint16_t *d)
+{
+    unsigned k, at;
+
+    for(k = 0; k < 6; k++){
+        at = (bmem ? 32 : 0) + POS[k];
+        d[k] = sim_LCD.b[at] | sim_LCD.b[at + 1] << 8;
+    }
+}
+
+static void shown(void)
+{
+    if(cur->shown < FRAMES_MAX)
+        digits(sim_LCDMEMCTL & LCDDISP, cur->frame[cur->shown]);
+    cur->shown++;
+}
+
+//The old version's __delay_cycles
+void baseline_frame_shown(void)
+{
+    shown();
+    if(cur->shown == mode_at)
+        *mode ^= 1;
+}
+
+//The new version in LPM3: the WDT step, or first another interrupt that only wakes it up
+static void lpm3(void)
+{
+    if(extra && (sim_sleeps & 1)){
+        __bic_SR_register_on_exit(LPM3_bits);
+        return;
+    }
+    shown();
+    if(cur->shown == mode_at){
+        *mode ^= 1;                     //the port ISR
+        __bic_SR_register_on_exit(LPM3_bits);
+        return;
+    }
+    WDT_ISR();
+}
+
+static void run(int new_version, const char *msg, run_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    cur = r;
+    sim_reset();
+    *mode = MODE;
+    if(new_version){
+        sim_lpm_hook = lpm3;
+        displayScrollText((char *)msg);
+    }
+    else
+        baseline_displayScrollText((char *)msg);
+    SIM_CHECK(!(sim_LCDMEMCTL & LCDDISP), "%s: %s left the LCD showing LCDBMEM", msg, new_version ? "new" : "old");
+    digits(0, r->end);
+    r->delay = sim_delay;
+    r->sleeps = sim_sleeps;
+    r->wakes = sim_wakes;
+}
+
+//Old and new show the same frames and end the same
+static void compare(const char *msg, const char *how, const run_t *o, const run_t *n, unsigned frames)
+{
+    unsigned k;
+
+    SIM_CHECK(o->shown == frames, "%s, %s: old showed %u frames, expected %u", msg, how, o->shown, frames);
+    SIM_CHECK(n->shown == frames, "%s, %s: new showed %u frames, expected %u", msg, how, n->shown, frames);
+    for(k = 0; k < frames && k < o->shown && k < n->shown && k < FRAMES_MAX; k++)
+        SIM_CHECK(!memcmp(o->frame[k], n->frame[k], sizeof(o->frame[k])), "%s, %s: frame %u differs", msg, how, k);
+    SIM_CHECK(!memcmp(o->end, n->end, sizeof(o->end)), "%s, %s: LCDMEM differs once done", msg, how);
+    SIM_CHECK(n->delay == 0, "%s, %s: new busy-waited %u cycles", msg, how, n->delay);
+}
+
+int main(void)
+{
+    static run_t o, n;
+    unsigned m;
+
+    sim_init();
+    printf("--- displayScrollText, old: __delay_cycles(200000), new: WDT interval (250ms) and LPM3 ---\n");
+    printf("%-34s %6s %10s %10s %9s %10s\n", "", "frames", "old ms", "new ms", "saved ms", "new active");
+    for(m = 0; m < sizeof(messages) / sizeof(messages[0]); m++){
+        const char *msg = messages[m];
+        unsigned length = strlen(msg), frames = length + 7;
+        double old_cycles, new_cycles;
+
+        mode_at = 0;
+        extra = 0;
+        run(0, msg, &o);
+        run(1, msg, &n);
+        compare(msg, "scrolled", &o, &n, frames);
+        SIM_CHECK(o.delay == 200000u * frames, "%s: old busy-waited %u cycles", msg, o.delay);
+        SIM_CHECK(n.sleeps == frames && n.wakes == frames, "%s: new slept %u times, woken %u, for %u frames", msg,
+                  n.sleeps, n.wakes, frames);
+        SIM_CHECK(!memcmp(n.end, n.frame[frames - 1], sizeof(n.end)), "%s: the last frame is not what is left", msg);
+
+        old_cycles = o.delay + frames * (OLD_FRAME + length * SCROLL_CHAR);
+        new_cycles = NEW_SETUP + frames * (NEW_FRAME + length * SCROLL_CHAR) + n.sleeps * WAKE + n.wakes * ISR_WDT;
+        printf("%-34s %6u %10.1f %10.2f %9.1f %9.2f%%\n", msg, frames, 1e3 * old_cycles / MCLK_HZ,
+               1e3 * new_cycles / MCLK_HZ, 1e3 * (old_cycles - new_cycles) / MCLK_HZ,
+               100.0 * new_cycles / (frames * 0.25 * MCLK_HZ));
+
+        //the RTC or a button waking it up between the steps
+        extra = 1;
+        run(0, msg, &o);
+        run(1, msg, &n);
+        compare(msg, "other interrupts", &o, &n, frames);
+        SIM_CHECK(n.sleeps == 2 * frames, "%s: new slept %u times with other interrupts, for %u frames", msg,
+                  n.sleeps, frames);
+
+        //S1 and S2 held a few frames in
+        extra = 0;
+        mode_at = 3 + m;
+        run(0, msg, &o);
+        run(1, msg, &n);
+        compare(msg, "mode change", &o, &n, mode_at);
+    }
+    printf("(old: the frames and the measured busy-wait; new: the frames, %u cycles more for the WDT and\n"
+           " the LCD memories, a wake-up and WDT_ISR per frame; modelled MSP430 cycles at ~1MHz. The new\n"
+           " frames are 250ms instead of ~200ms; new active is its share of the scroll)\n", NEW_SETUP);
+
+    return sim_done();
+}
@@ -0,0 +1,133 @@
+/***************************
+ * TEST_STOPWATCH_LCD.C
+ * OutOfBox stopwatch: LCD memory writes of Inc_RTC, old (showChar every position) and new (LCD shadow)
+ *
+ * Both versions run the same stopwatch in lockstep, one 10ms tick (Inc_RTC) at a time, each on its own
+ * copy of the LCD memory and of the time in backup memory. After every tick both LCD memories (LCDMEM
+ * and LCDBMEM) must be the same. The writes to them are counted with sim_lcd_watch() and reported per
+ * stopwatch second, for mm:ss:cc, across the hour mark, for hh:mm:ss and across the wrap at 100 hours.
+ * (Every counted write stops the test twice, so the runs are kept short.)
+ * Then reports the cost of one tick.
+****************************/
+
+#include <string.h>
+#include "msp430fr4133.h"
+#include "sim.h"
+
+extern volatile uint8_t *Centiseconds, *Seconds, *Minutes, *Hours;
+void Inc_RTC(void);
+void baseline_Inc_RTC(void);
+void loadLCDShadow(void);
+
+typedef struct
+{
+    const char      *name;
+    void            (*tick)(void);
+    uint8_t         lcd[64];        //LCDMEM and LCDBMEM
+    uint8_t         time[4];        //centiseconds, seconds, minutes, hours
+    uint32_t        writes;         //this second
+    uint32_t        seconds;
+    uint64_t        writes_sum;
+    uint32_t        writes_max;
+} version_t;
+
+static version_t old_v = { "old: showChar", baseline_Inc_RTC };
+static version_t new_v = { "new: LCD shadow", Inc_RTC };
+
+static sim_stat_t old_stat = SIM_STAT("Inc_RTC showChar");
+static sim_stat_t new_stat = SIM_STAT("Inc_RTC LCD shadow");
+
+static void set_time(version_t *v, unsigned h, unsigned m, unsigned s, unsigned cs)
+{
+    v->time[0] = cs; v->time[1] = s; v->time[2] = m; v->time[3] = h;
+}
+
+//Swaps v in: its LCD memory and time
+static void load(const version_t *v)
+{
+    memcpy((void *)sim_LCD.b, v->lcd, sizeof(v->lcd));
+    *Centiseconds = v->time[0]; *Seconds = v->time[1]; *Minutes = v->time[2]; *Hours = v->time[3];
+}
+
+static void save(version_t *v)
+{
+    memcpy(v->lcd, (const void *)sim_LCD.b, sizeof(v->lcd));
+    v->time[0] = *Centiseconds; v->time[1] = *Seconds; v->time[2] = *Minutes; v->time[3] = *Hours;
+}
+
+//One tick of v, counting its LCD writes
+static void tick(version_t *v, sim_stat_t *stat)
+{
+    load(v);
+    if(v == &new_v)
+        loadLCDShadow();                //as stopWatch() does; RAM does not survive the swap
+    if(stat)
+        SIM_RUN(*stat, v->tick());
+    else{
+        sim_lcd_writes = 0;
+        sim_lcd_watch(1);
+        v->tick();
+        sim_lcd_watch(0);
+        v->writes += sim_lcd_writes;
+    }
+    save(v);
+    if(v->time[0] == 0){                //a stopwatch second is over
+        if(v->writes > v->writes_max)
+            v->writes_max = v->writes;
+        v->writes_sum += v->writes;
+        v->seconds++;
+        v->writes = 0;
+    }
+}
+
+//Runs both versions for seconds from h:m:s.00 and prints the writes per second
+static void run(const char *what, unsigned h, unsigned m, unsigned s, unsigned seconds)
+{
+    version_t *v[2] = { &old_v, &new_v };
+    unsigned t, k, mismatch = 0;
+
+    for(k = 0; k < 2; k++){
+        memset(v[k]->lcd, 0, sizeof(v[k]->lcd));
+        set_time(v[k], h, m, s, 0);
+        v[k]->writes = v[k]->seconds = v[k]->writes_max = 0;
+        v[k]->writes_sum = 0;
+    }
+    for(t = 0; t < seconds * 100; t++){
+        tick(&old_v, 0);
+        tick(&new_v, 0);
+        if(memcmp(old_v.lcd, new_v.lcd, sizeof(old_v.lcd)) && mismatch++ < 5)
+            SIM_CHECK(0, "%s: tick %u: LCD memory differs", what, t);
+        SIM_CHECK(!memcmp(old_v.time, new_v.time, 4), "%s: tick %u: time differs", what, t);
+    }
+    SIM_CHECK(!mismatch, "%s: LCD memory differs at %u ticks", what, mismatch);
+
+    printf("%-26s", what);
+    for(k = 0; k < 2; k++)
+        printf("  %s %6.1f/%-5u", v[k]->name, (double)v[k]->writes_sum / v[k]->seconds, v[k]->writes_max);
+    printf("\n");
+    SIM_CHECK(new_v.writes_max < old_v.writes_sum / old_v.seconds, "%s: shadow writes as much as before", what);
+}
+
+int main(void)
+{
+    unsigned t;
+
+    sim_init();
+
+    printf("--- LCD memory writes per stopwatch second, avg/max ---\n");
+    run("00:00 .. 00:10", 0, 0, 0, 10);
+    run("59:55 .. 1:00:05", 0, 59, 55, 10);
+    run("1:00:05 .. 1:00:15", 1, 0, 5, 10);
+    run("99:59:55 .. 00:00:05", 99, 59, 55, 10);
+
+    for(t = 0; t < 200; t++){
+        tick(&old_v, &old_stat);
+        tick(&new_v, &new_stat);
+    }
+    printf("--- cost of one 10ms tick ---\n");
+    sim_report_header();
+    sim_report(&old_stat);
+    sim_report(&new_stat);
+
+    return sim_done();
+}
@@ -0,0 +1,161 @@
+/***************************
+ * TEST_TEMP_OVERSAMPLE.C
+ * OutOfBox temperature sensor mode: oversampling in the ADC ISR (tempSensorAccumulate), with noisy samples
+ *
+ * tempSensor() runs as on target. Each time it sleeps in LPM3 (sim_lpm_hook), ADC conversions are
+ * fed to ADC_ISR (ADCMEM0, ADCIV_ADCIFG) until one wakes it up: a fixed temperature plus gaussian
+ * noise of a few ADC counts, rounded to 10 bits. The hook then reads the value that wake-up
+ * displayed (*degC). For each noise level:
+ *      every wake-up comes after exactly TEMP_OVERSAMPLE_CNT conversions, and nothing else wakes it
+ *      the displayed values average to the temperature fed in, to the 0.1C shown
+ *      their variance is about TEMP_OVERSAMPLE_CNT times less than that of one conversion per value
+ *          (each sample through tempConvert on its own, as if there were no oversampling)
+ * The typical TLV calibration of test_tempcal.c is used: 538 at 30C, 643 at 85C (0.52C per count).
+****************************/
+
+#include <math.h>
+#include <string.h>
+#include "msp430fr4133.h"
+#include "sim.h"
+#include "TempSensorMode.h"
+
+extern volatile unsigned char *mode, *tempSensorRunning, *tempUnit;
+extern volatile uint16_t *degC;
+void ADC_ISR(void);
+
+#define CAL30           538
+#define CAL85           643
+#define TEMP            24.37           //C, between two ADC counts
+#define UPDATES         400             //displayed values per noise level (100s)
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+//Gaussian, mean 0, standard deviation 1 (Box-Muller)
+static double gauss(void)
+{
+    double u = (rnd() % 0xFFFFFF + 1) / (double)0x1000000;
+    double v = (rnd() % 0xFFFFFF) / (double)0x1000000;
+
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+static double noise;                    //ADC counts
+static double adc_temp;                 //TEMP in ADC counts
+
+static uint16_t sample(void)
+{
+    double s = floor(adc_temp + noise * gauss() + 0.5);
+
+    return s < 0 ? 0 : s > 1023 ? 1023 : (uint16_t)s;
+}
+
+typedef struct
+{
+    unsigned    n;
+    double      sum, sum2;
+} stat_t;
+
+static void add(stat_t *s, double x)
+{
+    s->n++;
+    s->sum += x;
+    s->sum2 += x * x;
+}
+
+static double mean(const stat_t *s) { return s->sum / s->n; }
+static double var(const stat_t *s) { return s->sum2 / s->n - mean(s) * mean(s); }
+
+static unsigned sleeps;                 //LPM3 entries of the measuring loop
+static unsigned per_wake_bad;           //wake-ups not after TEMP_OVERSAMPLE_CNT conversions
+static uint32_t conversions;
+static stat_t shown;                    //*degC, 0.1C
+
+//tempSensor() in LPM3: conversions until one wakes it up, or the mode's end
+static void lpm3(void)
+{
+    unsigned k = 0;
+
+    if(!*tempSensorRunning)
+        return;                         //the LPM4 on the way out
+    if(sleeps++)
+        add(&shown, (int16_t)*degC);    //from the last wake-up
+    if(shown.n == UPDATES){
+        *tempSensorRunning = 0;         //S1 (PORT1_ISR)
+        __bic_SR_register_on_exit(LPM3_bits);
+        return;
+    }
+    while(sim_sr & CPUOFF){
+        sim_ADCMEM0 = sample();
+        sim_ADCIV = ADCIV_ADCIFG;
+        ADC_ISR();
+        k++;
+    }
+    conversions += k;
+    if(k != TEMP_OVERSAMPLE_CNT)
+        per_wake_bad++;
+}
+
+int main(void)
+{
+    static const double levels[] = { 0.5, 1, 2, 4, 8 };
+    unsigned l, k;
+
+    sim_init();
+    adc_temp = CAL30 + (TEMP - 30) * (CAL85 - CAL30) / 55.0;
+    printf("--- %.2fC (%.2f ADC counts), %u displayed values of %u conversions each ---\n", TEMP, adc_temp, UPDATES,
+           TEMP_OVERSAMPLE_CNT);
+    printf("%9s %12s %12s %12s %12s %9s\n", "noise", "one: mean C", "sigma C", "oversampled", "sigma C", "var/var");
+    for(l = 0; l < sizeof(levels) / sizeof(levels[0]); l++){
+        stat_t one;
+        double ratio;
+
+        noise = levels[l];
+        memset(&shown, 0, sizeof(shown));
+        sleeps = per_wake_bad = conversions = 0;
+
+        sim_reset();
+        memcpy(&sim_TLV[0x1A], &(uint16_t){ CAL30 }, 2);
+        memcpy(&sim_TLV[0x1C], &(uint16_t){ CAL85 }, 2);
+        sim_tlv_adccal[2] = CAL30;
+        sim_tlv_adccal[3] = CAL85;
+        sim_tlv_adccal_len = 16;
+        *mode = TEMPSENSOR_MODE;
+        *tempSensorRunning = 1;
+        *tempUnit = 0;
+        sim_lpm_hook = lpm3;
+        tempSensor();
+
+        SIM_CHECK(shown.n == UPDATES, "noise %.1f: %u values displayed", noise, shown.n);
+        SIM_CHECK(per_wake_bad == 0, "noise %.1f: %u of %u wake-ups not after %u conversions", noise, per_wake_bad,
+                  shown.n, TEMP_OVERSAMPLE_CNT);
+        SIM_CHECK(conversions == (uint32_t)UPDATES * TEMP_OVERSAMPLE_CNT, "noise %.1f: %u conversions", noise,
+                  conversions);
+        //one per value, and S1's at the end
+        SIM_CHECK(sim_wakes == UPDATES + 1, "noise %.1f: woken %u times for %u values", noise, sim_wakes, UPDATES);
+        SIM_CHECK(fabs(mean(&shown) - 10 * TEMP) <= 1, "noise %.1f: averages %.2fC", noise, mean(&shown) / 10);
+
+        //the same conversions one at a time
+        memset(&one, 0, sizeof(one));
+        for(k = 0; k < UPDATES * 4; k++){
+            tempConvert(sample() << TEMP_OVERSAMPLE_BITS);
+            add(&one, (int16_t)*degC);
+        }
+        ratio = var(&one) / var(&shown);
+        printf("%6.1f LSB %12.2f %12.3f %12.2f %12.3f %9.1f\n", noise, mean(&one) / 10, sqrt(var(&one)) / 10,
+               mean(&shown) / 10, sqrt(var(&shown)) / 10, ratio);
+        if(noise >= 1)
+            SIM_CHECK(ratio > TEMP_OVERSAMPLE_CNT / 2 && ratio < TEMP_OVERSAMPLE_CNT * 2,
+                      "noise %.1f: variance %.1f times less, oversampling %u", noise, ratio, TEMP_OVERSAMPLE_CNT);
+    }
+    printf("(one wake-up per %u conversions: 4 a second instead of 256; var/var: one conversion per value\n"
+           " against the oversampled values. Below 1 LSB of noise, one conversion is mostly the same count\n"
+           " and the 0.1C display step is most of the oversampled variance)\n", TEMP_OVERSAMPLE_CNT);
+
+    return sim_done();
+}
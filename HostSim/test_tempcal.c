@@ -0,0 +1,245 @@
+/***************************
+ * TEST_TEMPCAL.C
+ * OutOfBox temperature conversion: tempCalInit/tempCalSegments (TLV calibration, Q16 segments) and tempConvert
+ *
+ * For a grid of TLV calibrations (CALADC_15V_30C/85C, given to TLV_getInfo as sim_tlv_adccal and
+ * to the old code as sim_TLV), every adcOut (10+TEMP_OVERSAMPLE_BITS bits) is converted to 0.1C and 0.1F:
+ *      against the exact two point line: within 0.6 (rounded to nearest, plus the Q16 scale)
+ *      against the old formula (ref/tempcal_baseline.c) on the same 10-bit conversion: within 1 for C,
+ *          which truncated toward 0, and 2 for F, which truncated twice; below 0C the old F wrapped
+ *          (16-bit unsigned) and is only counted
+ *      never decreasing from one adcOut to the next, across the segment boundaries too
+ * A TLV without ADC calibration, or with CALADC_15V_85C <= CALADC_15V_30C, gives the typical calibration.
+ * Then reports the MSP430 cycles of a conversion, old and new, and of tempCalInit, modelled rather than
+ * measured, as in test_mpy32.c (--use_hw_mpy=none):
+ *      old: a software 32x32 multiply by 5500, a signed software 32-bit divide and an unsigned 16-bit
+ *          one per sample, with the models of test_mpy32.c; the *10 and *9 are shifts and adds
+ *      new: 3 cycles per MPY32 register access (counted) plus the __delay_cycles, 5 per MPY_LOCK/MPY_UNLOCK
+ *      tempCalInit: its software divides and multiplies over the operands it gets
+ * Loads, stores, adds and the call are counted by hand for each (OLD_GLUE, NEW_GLUE).
+****************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "msp430fr4133.h"
+#include "sim.h"
+#include "TempSensorMode.h"
+
+extern volatile uint16_t *degC, *degF;
+void baseline_tempConvert(uint16_t adc, uint16_t *degC, uint16_t *degF);
+
+#define ADC_OUT_MAX     ((1024 << TEMP_OVERSAMPLE_BITS) - 1)
+
+/*
+ * Software routine models, cycles: per operand bit, extra when the bit is set, and the call with its
+ * setup (test_mpy32.c). The 16-bit divide is the 32-bit one on single words: 16 steps of 10.
+ */
+typedef struct
+{
+    unsigned step, set, call;
+} sw_model_t;
+
+static const sw_model_t sw_mul32 = { 12, 2, 14 };
+static const sw_model_t sw_div32 = { 15, 0, 16 };
+static const sw_model_t sw_div16 = { 10, 0, 12 };
+
+#define SIGN_FIX        6               //signed divide: negate the operands and the quotient
+/*
+ * Old, by hand: adc - CALADC_15V_30C and the sign extension (6), the TLV loads and the *10 by shifts
+ * (11), +300 and +320 (4), storing *degC and *degF through the pointers (14), reading *degC back (6),
+ * the *9 by shifts (5), call and return (8)
+ */
+#define OLD_GLUE        54
+/*
+ * New: adc >> TEMP_PWL_SHIFT and the index into the long tables (6), the two 32-bit offset adds from
+ * the tables (12), storing *degC and *degF (14), call and return (8)
+ */
+#define NEW_GLUE        40
+#define LOCK            5
+
+static uint32_t sw_mul(const sw_model_t *s, uint32_t m)
+{
+    uint32_t cycles = s->call;
+    for(; m; m >>= 1)
+        cycles += s->step + ((m & 1) ? s->set : 0);
+    return cycles;
+}
+
+static uint32_t sw_div(const sw_model_t *s, unsigned bits)
+{
+    return s->call + bits * s->step;
+}
+
+//Old formula: (long)temp * 5500 / ((cal85 - cal30) * 10), then *9 / 5
+static uint32_t old_cycles(void)
+{
+    return OLD_GLUE + sw_mul(&sw_mul32, 10 * (85 - 30) * 10) + sw_div(&sw_div32, 32) + SIGN_FIX
+         + sw_div(&sw_div16, 16);
+}
+
+//tempConvert, from the MPY32 accesses and delays it made
+static uint32_t new_cycles(unsigned adc)
+{
+    uint32_t acc = sim_acc, delay = sim_delay;
+
+    tempConvert(adc);
+    return NEW_GLUE + 2 * LOCK + 3 * (sim_acc - acc) + (sim_delay - delay);
+}
+
+//tempCalInit: two unsigned divides for the scales, then per segment of C and of F the divides for
+//the correction and its slope (signed), the corrections' multiplies by num and the two products
+//of the offset (multiplier scale and slope, 0 without a correction)
+static uint32_t init_cycles(uint16_t cal30, uint16_t cal85)
+{
+    static const unsigned num[2] = { 1, 9 };
+    uint32_t span = (uint32_t)(cal85 - cal30) << TEMP_OVERSAMPLE_BITS;
+    uint32_t scale[2] = { ((550UL << 16) + span / 2) / span, ((990UL << 16) + span / 2) / span };
+    uint32_t cycles = 2 * sw_div(&sw_div32, 32);
+    unsigned k;
+
+    for(k = 0; k < 2; k++)
+        cycles += TEMP_PWL_SEGMENTS * (2 * (sw_div(&sw_div32, 32) + SIGN_FIX) + 2 * sw_mul(&sw_mul32, num[k])
+                                       + sw_mul(&sw_mul32, scale[k]) + sw_mul(&sw_mul32, 0));
+    return cycles;
+}
+
+static void set_cal(uint16_t cal30, uint16_t cal85, uint8_t len)
+{
+    memcpy(&sim_TLV[0x1A], &cal30, 2);
+    memcpy(&sim_TLV[0x1C], &cal85, 2);
+    memset(sim_tlv_adccal, 0, sizeof(sim_tlv_adccal));
+    sim_tlv_adccal[2] = cal30;              //adc_ref15_30_temp
+    sim_tlv_adccal[3] = cal85;              //adc_ref15_85_temp
+    sim_tlv_adccal_len = len;
+}
+
+static void convert(uint16_t adc, int16_t *c, int16_t *f)
+{
+    tempConvert(adc);
+    *c = (int16_t)*degC;
+    *f = (int16_t)*degF;
+}
+
+static void calibrations(void)
+{
+    unsigned cal30, span, adc, cals = 0, old_c_off = 0, old_f_off = 0, old_f_wrapped = 0, values = 0;
+    double err_c = 0, err_f = 0;
+    int old_c_max = 0, old_f_max = 0;
+
+    printf("--- every adcOut, TLV calibrations ---\n");
+    for(cal30 = 450; cal30 <= 650; cal30 += 25)
+        for(span = 80; span <= 140; span += 10){
+            int16_t c, f, last_c = INT16_MIN, last_f = INT16_MIN;
+
+            set_cal(cal30, cal30 + span, 16);
+            tempCalInit();
+            cals++;
+            for(adc = 0; adc <= ADC_OUT_MAX; adc++){
+                double exact_c = 300 + ((double)adc / (1 << TEMP_OVERSAMPLE_BITS) - cal30) * 550 / span;
+                double exact_f = 320 + exact_c * 9 / 5;
+                double e;
+
+                convert(adc, &c, &f);
+                values++;
+                e = fabs(c - exact_c);
+                if(e > err_c) err_c = e;
+                SIM_CHECK(e <= 0.6, "cal %u/%u, adcOut %u: %d.%dC, exact %.2f", cal30, cal30 + span, adc,
+                          c / 10, abs(c % 10), exact_c / 10);
+                e = fabs(f - exact_f);
+                if(e > err_f) err_f = e;
+                SIM_CHECK(e <= 0.6, "cal %u/%u, adcOut %u: %dF (0.1), exact %.2f", cal30, cal30 + span, adc, f,
+                          exact_f);
+                SIM_CHECK(c >= last_c && f >= last_f, "cal %u/%u, adcOut %u: goes down", cal30, cal30 + span, adc);
+                last_c = c;
+                last_f = f;
+
+                if(!(adc & ((1 << TEMP_OVERSAMPLE_BITS) - 1))){
+                    uint16_t oc, of;
+                    int d;
+
+                    baseline_tempConvert(adc >> TEMP_OVERSAMPLE_BITS, &oc, &of);
+                    d = abs(c - (int16_t)oc);
+                    if(d) old_c_off++;
+                    if(d > old_c_max) old_c_max = d;
+                    SIM_CHECK(d <= 1, "cal %u/%u, %u: %d, old %d", cal30, cal30 + span, adc >> TEMP_OVERSAMPLE_BITS,
+                              c, (int16_t)oc);
+                    if((int16_t)oc < 0){
+                        if(fabs((int16_t)of - exact_f) > 2)
+                            old_f_wrapped++;
+                        continue;
+                    }
+                    d = abs(f - (int16_t)of);
+                    if(d) old_f_off++;
+                    if(d > old_f_max) old_f_max = d;
+                    SIM_CHECK(d <= 2, "cal %u/%u, %u: %dF, old %d", cal30, cal30 + span, adc >> TEMP_OVERSAMPLE_BITS,
+                              f, (int16_t)of);
+                }
+            }
+        }
+    printf("%u calibrations, %u values: largest error C %.3f, F %.3f (0.1 degree)\n", cals, values, err_c, err_f);
+    printf("against the old formula on 10-bit conversions: C differs in %u (by up to %d), F in %u (by up to %d);"
+           " old F wrong below 0C in %u\n", old_c_off, old_c_max, old_f_off, old_f_max, old_f_wrapped);
+}
+
+//Without a usable TLV calibration, 30C and 85C are at the typical conversions
+static void fallback(void)
+{
+    static const struct { uint16_t cal30, cal85; uint8_t len; const char *what; } tlv[] = {
+        { 538, 643, 0,  "no ADC calibration" },
+        { 538, 643, 6,  "ADC calibration too short" },
+        { 643, 538, 16, "CALADC_15V_85C below CALADC_15V_30C" },
+        { 600, 600, 16, "CALADC_15V_85C = CALADC_15V_30C" },
+    };
+    unsigned i;
+    int16_t c30, f30, c85, f85;
+
+    printf("--- no usable TLV calibration ---\n");
+    for(i = 0; i < sizeof(tlv) / sizeof(tlv[0]); i++){
+        set_cal(tlv[i].cal30, tlv[i].cal85, tlv[i].len);
+        tempCalInit();
+        convert(TEMP_CAL_30C_TYP << TEMP_OVERSAMPLE_BITS, &c30, &f30);
+        convert(TEMP_CAL_85C_TYP << TEMP_OVERSAMPLE_BITS, &c85, &f85);
+        SIM_CHECK(c30 == 300 && f30 == 860 && c85 == 850 && f85 == 1850,
+                  "%s: typical 30C/85C read %d/%d (0.1C), %d/%d (0.1F)", tlv[i].what, c30, c85, f30, f85);
+    }
+}
+
+static void cost(void)
+{
+    unsigned adc, n = 0;
+    uint32_t new_min = UINT32_MAX, new_max = 0, new_sum = 0, old = old_cycles();
+
+    set_cal(538, 643, 16);
+    tempCalInit();
+    for(adc = 0; adc <= ADC_OUT_MAX; adc++){
+        uint32_t c = new_cycles(adc);
+
+        if(c < new_min) new_min = c;
+        if(c > new_max) new_max = c;
+        new_sum += c;
+        n++;
+    }
+    SIM_CHECK(new_max < old, "tempConvert %u cycles, the old formula %u", new_max, old);
+
+    printf("--- MSP430 cycles per conversion, modelled ---\n");
+    printf("old formula (software multiply and divides): %u\n", old);
+    if(new_min == new_max)
+        printf("tempConvert (two MPY_Mul32): %u for every adcOut\n", new_max);
+    else
+        printf("tempConvert (two MPY_Mul32): %u..%u, %.1f on average\n", new_min, new_max, (double)new_sum / n);
+    printf("tempCalInit (once per entry to the mode): %u with the typical calibration, %u with 450/590,"
+           " the old formula's cost after %.1f samples\n", init_cycles(538, 643), init_cycles(450, 590),
+           (double)init_cycles(538, 643) / (old - (double)new_sum / n));
+}
+
+int main(void)
+{
+    sim_init();
+
+    calibrations();
+    fallback();
+    cost();
+
+    return sim_done();
+}
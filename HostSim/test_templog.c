@@ -0,0 +1,351 @@
+/***************************
+ * TEST_TEMPLOG.C
+ * OutOfBox temperature log in FRAM (TempLog.c): wraparound, recovery after a reset or a torn write, reading
+ *
+ * Every sample added is also kept here, with the timestamp it must read back with (the one before + 60s).
+ * A "reset" is tempLogRecover, which rebuilds the RAM state from FRAM. After one the whole log is read
+ * with tempLogGet, newest first, and must be the newest tempLogCount samples added, then nothing:
+ *      several laps of the ring, smooth (13 samples per block) and jumpy (a block per sample)
+ *      the block sequence number wrapping at 65536
+ *      a power loss after every byte of a block rewrite (sim_fram_cut), at every block of two laps:
+ *          partial headers, block 0 torn at the start of a lap, the first block of an empty log
+ *          only a complete block keeps its sample, and at most the oldest block is lost with it
+ *      tempLogShow (S2 while paused) shows the frame displayTemp would, with an 'L' at pos1, in C and F
+ * Then reports the cost of adding, recovering, counting and reading.
+****************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "msp430fr4133.h"
+#include "sim.h"
+#include "TempLog.h"
+#include "TempSensorMode.h"
+#include "hal_LCD.h"
+
+extern TEMP_LOG_BLOCK tempLog[TEMP_LOG_BLOCKS];
+extern volatile uint16_t *degC, *degF;
+
+#define CAPACITY        (TEMP_LOG_BLOCKS * (TEMP_LOG_DELTAS + 1))
+#define HISTORY         80000
+
+typedef struct
+{
+    int16_t     deg;
+    uint32_t    time;
+} sample_t;
+
+static sample_t added[HISTORY];         //every sample in the log, oldest first
+static uint32_t n_added;
+static uint32_t blocks;                 //blocks started: tempLog[].seq of the newest + 1
+
+static sim_stat_t add_delta = SIM_STAT("tempLogAdd, delta");
+static sim_stat_t add_block = SIM_STAT("tempLogAdd, new block");
+static sim_stat_t recover = SIM_STAT("tempLogRecover");
+static sim_stat_t count = SIM_STAT("tempLogCount");
+static sim_stat_t get_new = SIM_STAT("tempLogGet, newest block");
+static sim_stat_t get_old = SIM_STAT("tempLogGet, oldest block");
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static void reset_log(void)
+{
+    memset(tempLog, 0, sizeof(tempLog));
+    tempLogRecover();
+    n_added = 0;
+    blocks = 0;
+}
+
+static int16_t newest(void)
+{
+    return n_added ? added[n_added - 1].deg : 0;
+}
+
+//Checks if adding deg starts a new block: the first sample, a change that does not fit in a delta,
+//or a full newest block
+static int starts_block(int16_t deg)
+{
+    int d = deg - newest();
+    unsigned k;
+
+    if(!n_added || d <= TEMP_LOG_EMPTY || d > 127)
+        return 1;
+    for(k = 0; k < TEMP_LOG_BLOCKS; k++)
+        if(tempLog[k].check == (tempLog[k].seq ^ TEMP_LOG_MAGIC) && tempLog[k].seq == (uint16_t)(blocks - 1))
+            return tempLog[k].delta[TEMP_LOG_DELTAS - 1] != TEMP_LOG_EMPTY;
+    return 1;
+}
+
+static void record(int16_t deg, int block)
+{
+    added[n_added].deg = deg;
+    added[n_added].time = n_added ? added[n_added - 1].time + TEMP_LOG_SECONDS : 0;
+    n_added++;
+    blocks += block;
+}
+
+static void add(int16_t deg)
+{
+    int block = starts_block(deg);
+
+    tempLogAdd(deg);
+    record(deg, block);
+}
+
+//Resets and reads the whole log back; returns its length
+static unsigned check_log(const char *what)
+{
+    unsigned age, n, bad = 0;
+    int16_t deg;
+    uint32_t time;
+
+    tempLogRecover();
+    n = tempLogCount();
+    SIM_CHECK(n <= n_added, "%s: %u samples in the log, %lu added", what, n, (unsigned long)n_added);
+    if(n > n_added)
+        n = n_added;
+    for(age = 0; age < n; age++){
+        const sample_t *s = &added[n_added - 1 - age];
+        if(!tempLogGet(age, &deg, &time)){
+            SIM_CHECK(0, "%s: sample %u of %u missing", what, age, n);
+            break;
+        }
+        if((deg != s->deg || time != s->time) && bad++ < 3)
+            SIM_CHECK(0, "%s: sample %u is %d at %lus, expected %d at %lus", what, age, deg, (unsigned long)time,
+                      s->deg, (unsigned long)s->time);
+    }
+    SIM_CHECK(!bad, "%s: %u samples wrong", what, bad);
+    SIM_CHECK(!tempLogGet(n, &deg, &time), "%s: a sample past tempLogCount", what);
+    return n;
+}
+
+//Several laps of smooth samples (full blocks, so the log keeps at least its 31 newest full blocks),
+//then of samples that often do not fit in a delta
+static void laps(void)
+{
+    uint32_t t;
+    unsigned n, least = CAPACITY;
+    int16_t deg = 250;
+
+    printf("--- wraparound: 5 laps, smooth ---\n");
+    reset_log();
+    for(t = 0; t < 5 * CAPACITY; t++){
+        deg += (int16_t)(rnd() % 7) - 3;
+        add(deg);
+        if(t % 37 == 0 || t % CAPACITY >= CAPACITY - 2){
+            n = check_log("smooth");
+            if(t >= CAPACITY && n < least)
+                least = n;
+        }
+    }
+    printf("%lu samples, %lu blocks: after the first lap the log held %u..%u samples\n", (unsigned long)n_added,
+           (unsigned long)blocks, least, tempLogCount());
+    SIM_CHECK(least > (TEMP_LOG_BLOCKS - 1) * (TEMP_LOG_DELTAS + 1), "the log shrank to %u samples", least);
+
+    printf("--- wraparound: 3 laps, jumpy ---\n");
+    for(t = 0; t < 3 * CAPACITY; t++){
+        deg = (t / 50) & 1 ? (int16_t)(rnd() % 2000) - 500 : deg + (int16_t)(rnd() % 255) - 127;
+        add(deg);
+        if(t % 23 == 0)
+            check_log("jumpy");
+    }
+    n = check_log("jumpy");
+    printf("%lu samples, %lu blocks: the log holds %u samples\n", (unsigned long)n_added, (unsigned long)blocks, n);
+    SIM_CHECK(n >= TEMP_LOG_BLOCKS, "only %u samples", n);
+}
+
+//A block per sample until seq has wrapped, reset after every sample around the wrap
+static void seq_wrap(void)
+{
+    uint32_t t;
+    unsigned resets = 0;
+
+    printf("--- sequence number wrap ---\n");
+    reset_log();
+    for(t = 0; blocks < 65536 + 3 * TEMP_LOG_BLOCKS; t++){
+        add(t & 1 ? 900 : -200);            //too far apart for a delta
+        if(blocks + 2 * TEMP_LOG_BLOCKS >= 65536 || t % 997 == 0){
+            check_log("seq wrap");
+            resets++;
+        }
+    }
+    printf("%lu blocks (newest seq %u), %u resets\n", (unsigned long)blocks, (unsigned)(uint16_t)(blocks - 1), resets);
+    SIM_CHECK(tempLogCount() == TEMP_LOG_BLOCKS, "%u samples after the wrap", tempLogCount());
+}
+
+//Power loss after `cut` FRAM bytes of adding deg (a new block), then a reset; `before` is the log length
+//Returns 1 if the sample is in the log
+static int torn_add(int16_t deg, uint32_t cut, unsigned before, const char *what)
+{
+    uint32_t was_added = n_added, was_blocks = blocks, time = 0;
+    int16_t d = 0;
+    unsigned n;
+
+    sim_fram_cut = sim_fram_writes + cut;   //sim_fram_writes is not 0 here, so neither is this
+    add(deg);
+    sim_fram_cut = 0;
+
+    tempLogRecover();
+    if(!tempLogGet(0, &d, &time) || d != deg || time != added[n_added - 1].time){
+        n_added = was_added;                //lost
+        blocks = was_blocks;
+    }
+    n = check_log(what);
+    SIM_CHECK(n + TEMP_LOG_DELTAS + 1 >= before, "%s: %u of %u samples left", what, n, before);
+    return n_added > was_added;
+}
+
+static void torn(void)
+{
+    static TEMP_LOG_BLOCK saved[TEMP_LOG_BLOCKS];
+    static sample_t saved_added[HISTORY];
+    uint32_t saved_n, saved_blocks, cut, bytes, w;
+    unsigned pos, before, lost = 0, kept = 0, lap_start = 0;
+    int16_t deg = 200;
+
+    printf("--- power loss after every byte of a block rewrite, at every block ---\n");
+
+    //FRAM bytes of a new block
+    reset_log();
+    w = sim_fram_writes;
+    add(deg);
+    bytes = sim_fram_writes - w;
+    reset_log();
+
+    for(pos = 0; pos <= 2 * TEMP_LOG_BLOCKS; pos++){
+        memcpy(saved, tempLog, sizeof(saved));
+        memcpy(saved_added, added, n_added * sizeof(sample_t));
+        saved_n = n_added;
+        saved_blocks = blocks;
+
+        for(cut = 0; cut <= bytes; cut++){
+            char what[64];
+
+            memcpy(tempLog, saved, sizeof(saved));
+            memcpy(added, saved_added, saved_n * sizeof(sample_t));
+            n_added = saved_n;
+            blocks = saved_blocks;
+            before = check_log("before the power loss");
+
+            snprintf(what, sizeof(what), "block %lu, power lost after %lu of %lu bytes",
+                     (unsigned long)(blocks % TEMP_LOG_BLOCKS), (unsigned long)cut, (unsigned long)bytes);
+            if(torn_add(deg + 300, cut, before, what))
+                kept++;
+            else{
+                lost++;
+                if(saved_blocks && saved_blocks % TEMP_LOG_BLOCKS == 0)
+                    lap_start++;
+            }
+            SIM_CHECK((n_added > saved_n) == (cut >= bytes), "%s: sample %s", what, cut >= bytes ? "lost" : "kept");
+
+            //logging goes on from the newest sample that survived
+            add(newest() + 1);
+            add(newest() - 400);
+            check_log(what);
+        }
+
+        //then the block is written completely, with a few deltas, and the next one is torn
+        memcpy(tempLog, saved, sizeof(saved));
+        memcpy(added, saved_added, saved_n * sizeof(sample_t));
+        n_added = saved_n;
+        blocks = saved_blocks;
+        tempLogRecover();
+        deg += pos & 1 ? 300 : -300;
+        add(deg);
+        for(w = rnd() % 4; w; w--)
+            add(++deg);
+    }
+    printf("%u power losses (%lu bytes per block): %u samples lost, %u kept; %u losses at block 0 of a new lap\n",
+           lost + kept, (unsigned long)bytes, lost, kept, lap_start);
+    SIM_CHECK(lap_start > 0, "block 0 was never torn at the start of a lap");
+}
+
+//The LCD frame on display (LCDMEM or LCDBMEM)
+static void shown(uint8_t *frame)
+{
+    memcpy(frame, (const void *)(sim_LCD.b + ((sim_LCDMEMCTL & LCDDISP) ? 32 : 0)), 20);
+}
+
+static void show(void)
+{
+    uint8_t want[20], got[20];
+    unsigned age, unit, i;
+    int16_t deg;
+    uint32_t time;
+
+    printf("--- tempLogShow ---\n");
+    reset_log();
+    for(age = 0; age < 40; age++)
+        add((int16_t)(rnd() % 1200) - 200);
+    tempLogRecover();
+
+    for(unit = 0; unit < 2; unit++)
+        for(age = 0; age < 40; age++){
+            tempLogGet(age, &deg, &time);
+            *tempUnit = unit;
+            *degC = (uint16_t)deg;
+            *degF = (uint16_t)((deg * 9 + (deg < 0 ? -2 : 2)) / 5 + 320);
+            displayTemp();
+            shown(want);
+
+            SIM_CHECK(tempLogShow(age), "tempLogShow(%u) found nothing", age);
+            shown(got);
+            for(i = 0; i < 20; i++)
+                if(i != pos1 && i != pos1 + 1u && got[i] != want[i])
+                    break;
+            SIM_CHECK(i == 20, "tempLogShow(%u), unit %u: LCD byte %u is 0x%02x, not 0x%02x", age, unit, i,
+                      got[i % 20], want[i % 20]);
+            SIM_CHECK(memcmp(got + pos1, want + pos1, 2), "tempLogShow(%u): no 'L'", age);
+        }
+    SIM_CHECK(!tempLogShow(40), "tempLogShow past the end of the log");
+}
+
+int main(void)
+{
+    unsigned t, n;
+    int16_t deg = 250;
+    uint32_t time;
+
+    sim_init();
+
+    laps();
+    seq_wrap();
+    torn();
+    show();
+
+    reset_log();
+    for(t = 0; t < 2 * CAPACITY; t++)
+        add(deg += (int16_t)(rnd() % 7) - 3);
+    for(t = 0; t < 52; t++){
+        int16_t d = newest() + (t % 5 == 0 ? 200 : 1);
+        int block = starts_block(d);
+
+        SIM_RUN(*(block ? &add_block : &add_delta), tempLogAdd(d));
+        record(d, block);
+    }
+    n = check_log("cost");
+    for(t = 0; t < 10; t++){
+        SIM_RUN(recover, tempLogRecover());
+        SIM_RUN(count, tempLogCount());
+        SIM_RUN(get_new, tempLogGet(t, &deg, &time));
+        SIM_RUN(get_old, tempLogGet(n - 1 - t, &deg, &time));
+    }
+    printf("--- cost (log of %u samples) ---\n", n);
+    sim_report_header();
+    sim_report(&add_delta);
+    sim_report(&add_block);
+    sim_report(&recover);
+    sim_report(&count);
+    sim_report(&get_new);
+    sim_report(&get_old);
+    if(get_new.traced && get_old.traced)        //each call walks back from the newest block
+        printf("reading the whole log with tempLogGet: about %.0f instructions per sample\n",
+               ((double)get_new.instr_sum / get_new.traced + (double)get_old.instr_sum / get_old.traced) / 2);
+
+    return sim_done();
+}
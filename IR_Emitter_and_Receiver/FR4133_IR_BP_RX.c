@@ -46,6 +46,9 @@
  * SMCLK .After successful decoding, LCD will display the letters on the pressed
  * button and one LED on P4.0 will blink.
  *
+ * The NEC decoder (NEC_Decode) only works on the time between edges and does
+ * not touch any register, so it can be driven with recorded intervals off-target.
+ *
  * Texas Instruments, Inc.
  * Ver 0.2 Aug. 2014
  ******************************************************************************/
@@ -72,6 +75,7 @@ unsigned char	IR_state;		//IR decoder state machine
 #define IR_end		0x02		//the end of IR code
 
 void BlinkLED ();
+unsigned char NEC_Decode(unsigned int time_cnt);
 
 int main( void )
 {
@@ -120,90 +124,105 @@ void BlinkLED ()
 	P4OUT &= ~BIT0;
 }
 
-//********Timer0 interrupt ISR*********//
-#pragma vector = TIMER0_A1_VECTOR
-__interrupt void TIMER0_A1_ISR (void)
+/* Function: NEC_Decode
+ * NEC decoder state machine, stepped once per captured edge.
+ * Arguments:
+ *      time_cnt: SMCLK ticks since the previous edge
+ * Returns:
+ *      1 when the address and command of a code are complete in rx_data, 0 otherwise
+ */
+unsigned char NEC_Decode(unsigned int time_cnt)
 {
-	switch( TA0IV )
+	switch(IR_state)									//IR decoder state machine
 	{
-	case  4:												//Interrupt Source: Capture 2
+	case IR_idle:										//Header of IR code
 	{
-		old_cnt = new_cnt;									//Update the counter value
-		new_cnt = TA0CCR2;
-		time_cnt = new_cnt -old_cnt;						//Time interval
-		switch(IR_state)									//IR decoder state machine
+		for(i=0; i<4; i++)
+			rx_data[i] = 0x00;							//Clear the data buffer
+		if(time_cnt > 32000 && time_cnt < 40000)		//9ms leading pulse burst, after any edge
+			header_cnt = 2;
+		else if(header_cnt == 2 && time_cnt > 14000 && time_cnt < 22000)	//4.5ms space
 		{
-		case IR_idle:										//Header of IR code
+			header_cnt = 0;
+			IR_state = IR_data;
+			edge_cnt = 1;
+		}
+		else
+			header_cnt = 1;								//this edge may be the start of the next header
+		break;
+	}
+	case IR_data:										    //Data of IR code(address + command)
+	{
+		if(time_cnt > 32000 && time_cnt < 40000)
 		{
-			for(i=0; i<4; i++)
-				rx_data[i] = 0x00;							//Clear the data buffer
-			if(header_cnt == 0)
-				header_cnt = 1;
-			else if(header_cnt == 1 && time_cnt > 32000 && time_cnt < 40000)	//9ms leading pulse burst
-				header_cnt = 2;
-			else if(header_cnt == 2 && time_cnt > 14000 && time_cnt < 22000)	//4.5ms space
-			{
-				header_cnt = 0;
-				IR_state = IR_data;
-				edge_cnt = 1;
-			}
-			else
-				header_cnt = 0;
+			edge_cnt = 0;								    //clear the counter
+			data_cnt = 0;
+			bit_cnt	 = 0;
+			header_cnt = 2;
+			IR_state = IR_idle;							    //Enter idle state and wait for new code
 			break;
 		}
-		case IR_data:										    //Data of IR code(address + command)
-		{
-			if(time_cnt > 32000 && time_cnt < 40000)
+		else{
+			edge_cnt++;										//Both rising edge and falling edge are captured
+			if(edge_cnt % 2 == 1)
 			{
-				edge_cnt = 0;								    //clear the counter
-				data_cnt = 0;
-				bit_cnt	 = 0;
-				header_cnt = 2;
-				IR_state = IR_idle;							    //Enter idle state and wait for new code
-				break;
-			}
-			else{
-				edge_cnt++;										//Both rising edge and falling edge are captured
-				if(edge_cnt % 2 == 1)
+				data_cnt = (edge_cnt-2) / 16;
+				if(time_cnt > 4500)							//Space is 1.68ms
+					rx_data[data_cnt] |= 0x80;				//Logical '1'
+				else										//Space is 0.56ms
+					rx_data[data_cnt] &= 0x7f;				//Logical '0'
+				if(bit_cnt != 7)
 				{
-					data_cnt = (edge_cnt-2) / 16;
-					if(time_cnt > 4500)							//Space is 1.68ms
-						rx_data[data_cnt] |= 0x80;				//Logical '1'
-					else										//Space is 0.56ms
-						rx_data[data_cnt] &= 0x7f;				//Logical '0'
-					if(bit_cnt != 7)
-					{
-						rx_data[data_cnt] = rx_data[data_cnt]>>1; //Shifting based on Byte
-						bit_cnt++;
-					}
-					else
-						bit_cnt = 0;							//Start a new byte
+					rx_data[data_cnt] = rx_data[data_cnt]>>1; //Shifting based on Byte
+					bit_cnt++;
 				}
-				if(edge_cnt > 64)
-					IR_state = IR_end;							//The end of address and command
-				break;
+				else
+					bit_cnt = 0;							//Start a new byte
+			}
+			if(edge_cnt > 64)
+			{
+				IR_state = IR_end;							//The end of address and command
+				return 1;
 			}
-		}
-		case IR_end:										//The end of IR code
-		{
-			edge_cnt = 0;									//clear the counter
-			data_cnt = 0;
-			bit_cnt	 = 0;
-			if(time_cnt > 2000)								//A final 0.56ms pulse burst
-				IR_state = IR_idle;							//Enter idle state and wait for new code
-			break;
-		}
-		default:
-		{
-			IR_state = IR_idle;								//Set idle state as default state
-			header_cnt = 0;									//Clear all the counter
-			edge_cnt = 0;
-			data_cnt = 0;
-			bit_cnt	 = 0;
 			break;
 		}
-		}
-		LPM3_EXIT;											//Exit low power mode
+	}
+	case IR_end:										//The end of IR code
+	{
+		edge_cnt = 0;									//clear the counter
+		data_cnt = 0;
+		bit_cnt	 = 0;
+		if(time_cnt > 2000)								//A final 0.56ms pulse burst
+			IR_state = IR_idle;							//Enter idle state and wait for new code
+		break;
+	}
+	default:
+	{
+		IR_state = IR_idle;								//Set idle state as default state
+		header_cnt = 0;									//Clear all the counter
+		edge_cnt = 0;
+		data_cnt = 0;
+		bit_cnt	 = 0;
+		break;
+	}
+	}
+	return 0;
+}
+
+//********Timer0 interrupt ISR*********//
+#pragma vector = TIMER0_A1_VECTOR
+__interrupt void TIMER0_A1_ISR (void)
+{
+	switch( TA0IV )
+	{
+	case  4:												//Interrupt Source: Capture 2
+	{
+		old_cnt = new_cnt;									//Update the counter value
+		new_cnt = TA0CCR2;
+		time_cnt = new_cnt -old_cnt;						//Time interval
+		if(NEC_Decode(time_cnt))
+			LPM3_EXIT;										//Exit low power mode once a code is complete
+		break;
 	}
 	default: break;
 	}
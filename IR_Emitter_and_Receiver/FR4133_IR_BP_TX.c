@@ -52,6 +52,11 @@
  * the letters on the button will be displayed on the LCD. One LED is used to
  * indicate the IR transmitting on the IR BoosterPack.
  *
+ * The IR code is generated from a protocol descriptor (IR_PROTOCOL), so another
+ * pulse distance/width protocol only needs a new descriptor, not new ISR code.
+ * The descriptor also says how the key code and the address are laid out in the
+ * data bits (IR_DATA_NEC, IR_DATA_SIRC).
+ *
  * Texas Instruments, Inc.
  * Ver 0.2 Aug. 2014
  ******************************************************************************/
@@ -61,13 +66,71 @@
 #include "HAL_FR4133LP_Board.h"
 
 
+/* IR protocol descriptor
+ * Every symbol is a mark followed by a space, which Timer1 generates by itself:
+ * TA1CCR0 holds the symbol period and TA1CCR2 the end of the mark (reset/set mode),
+ * so the descriptor stores the register values directly and the ISR only copies them.
+ * A header or trailer with period 0 is not sent.
+ */
+typedef struct
+{
+	unsigned int	period;			// TA1CCR0: mark + space - 1
+	unsigned int	mark;			// TA1CCR2: mark - 1
+} IR_SYMBOL;
+
+typedef struct
+{
+	IR_SYMBOL		header;			// leading pulse burst
+	IR_SYMBOL		zero;			// data "0"
+	IR_SYMBOL		one;			// data "1"
+	IR_SYMBOL		trailer;		// closing pulse burst
+	unsigned char	bits;			// number of data bits
+	unsigned char	msb_first;		// bit order within each byte
+	unsigned char	carrier_period;	// TA0CCR0
+	unsigned char	carrier_duty;	// TA0CCR2
+	unsigned char	layout;			// IR_DATA_NEC or IR_DATA_SIRC
+	unsigned char	address;		// device address sent with the key code
+} IR_PROTOCOL;
+
+// data layouts (see IR_Load_Data)
+#define IR_DATA_NEC		0			// address, ~address, code, ~code
+#define IR_DATA_SIRC	1			// 7-bit code, then the address, packed LSB first
+
+// symbol from mark and space lengths in SMCLK ticks (4MHz)
+#define IR_SYM(mark, space)		{ (mark) + (space) - 1, (mark) - 1 }
+#define IR_NONE					{ 0, 0 }
+
+// NEC: 9ms/4.5ms header, 0.562ms mark, 0.562ms/1.687ms space, 32 bits LSB first, 38kHz
+const IR_PROTOCOL IR_NEC = {
+	IR_SYM(36000, 18000), IR_SYM(2250, 2250), IR_SYM(2250, 6750), IR_SYM(2250, 2250),
+	32, 0, 104, 25, IR_DATA_NEC, 0x55
+};
+
+// Samsung: as NEC, but 4.5ms/4.5ms header
+const IR_PROTOCOL IR_SAMSUNG = {
+	IR_SYM(18000, 18000), IR_SYM(2250, 2250), IR_SYM(2250, 6750), IR_SYM(2250, 2250),
+	32, 0, 104, 25, IR_DATA_NEC, 0x55
+};
+
+// Sony SIRC: 2.4ms/0.6ms header, 0.6ms/1.2ms mark, 0.6ms space, 12 bits LSB first, 40kHz
+// 7-bit command and 5-bit address (1 = TV)
+const IR_PROTOCOL IR_SIRC12 = {
+	IR_SYM(9600, 2400), IR_SYM(2400, 2400), IR_SYM(4800, 2400), IR_NONE,
+	12, 0, 99, 24, IR_DATA_SIRC, 0x01
+};
+
+const IR_PROTOCOL	*tx_proto = &IR_NEC;	// protocol to send
+const IR_SYMBOL		*tx_next;				// symbol for the next period, 0 = end of code
+unsigned char		tx_bit;					// data bits stepped through so far
+unsigned char		tx_mask;				// current bit in *send_addr
+
 unsigned char	IR_code;
-unsigned char 	IR_flag;
 unsigned char 	IR_stop;
-unsigned char 	byte_cnt;
-unsigned int	bit_sel;
 unsigned char	*send_addr;
-unsigned char 	send_data[4]={0x55, 0xaa, 0x00, 0xff};
+unsigned char 	send_data[4];
+
+void IR_Load_Data(unsigned char code);
+const IR_SYMBOL *IR_Next_Symbol(void);
 
 
 int main( void )
@@ -87,11 +150,6 @@ int main( void )
 
 	while(1)
 	{
-		// clear the flag and counter
-		IR_flag  = 0;
-		byte_cnt = 0;
-		bit_sel = 0;
-
 		if(IR_stop == 0)
 		{
 			// Configure IR output pin
@@ -109,21 +167,25 @@ int main( void )
 			TA1CCTL2 = OUTMOD_7;				// output mode: reset/set
 			TA0CCTL2 = OUTMOD_7;        		// output mode: reset/set
 
-			// 38kHz 1/4 duty-cycle carrier waveform length setting
-			TA0CCR0 = 104;
-			TA0CCR2 = 25;
+			// carrier waveform length setting (38kHz 1/4 duty-cycle for NEC)
+			TA0CCR0 = tx_proto->carrier_period;
+			TA0CCR2 = tx_proto->carrier_duty;
 			TA1CCR0 = 640;   					//the initial time of TA0 should be longer than TA1
 			TA1CCR2 = 320;
 
+			// write button number into buffer
+			IR_Load_Data(IR_code);
+
+			// first symbol, loaded when the initial TA1 period ends
+			// (set up before the timers start, so the first TA1 interrupt finds it)
+			tx_bit = 0;
+			tx_mask = tx_proto->msb_first ? 0x80 : 0x01;
+			tx_next = tx_proto->header.period ? &tx_proto->header : IR_Next_Symbol();
+
 			// set timer operation mode
 			TA0CTL = TASSEL_2 + MC_1 + TACLR;   //SMCLK, UP mode
 			TA1CTL = TASSEL_2 + MC_1 + TACLR;	//SMCLK, UP mode
 
-			// write button number into buffer
-			send_data[2] = IR_code;
-			send_data[3] = ~IR_code;
-			send_addr = &send_data[0];
-
 			// stop until the end of IR code
 			while(IR_stop == 0);
 
@@ -148,56 +210,80 @@ int main( void )
 }
 
 
-//********Timer1 interrupt ISR*********//
-#pragma vector = TIMER1_A0_VECTOR
-__interrupt void TIMER1_A0_ISR (void)
+/* Function: IR_Load_Data
+ * Puts the key code and the protocol's address into send_data, in the protocol's layout
+ * Arguments:
+ *      code: Key code (7 bits for SIRC)
+ */
+void IR_Load_Data(unsigned char code)
 {
-	switch( TA1IV )
+	if(tx_proto->layout == IR_DATA_SIRC)
 	{
-	case  0:
+		send_data[0] = (code & 0x7F) | (tx_proto->address << 7);
+		send_data[1] = tx_proto->address >> 1;
+	}
+	else
 	{
-		if(IR_flag)
-		{
-			IR_stop=1;								// stop IR modulator
-			TA1CCTL0 &= ~CCIE;						// disable timer_A0 interrupt
-		}
+		send_data[0] = tx_proto->address;
+		send_data[1] = ~tx_proto->address;
+		send_data[2] = code;
+		send_data[3] = ~code;
+	}
+	send_addr = &send_data[0];
+}
 
-		if((byte_cnt==0)&& (bit_sel==0)) 			// leading pulse burst of IR code
-		{
-			TA1CCR0 = 53999;                        // 9ms high
-			TA1CCR2 = 35999;                        // 4.5ms low
-			byte_cnt++;						   		// byte counter
-			bit_sel++;						   		// bit counter
-		}
-		else if((byte_cnt>= 5)&& (bit_sel==1)) 		// the end of IR code
-		{
-			TA1CCR0 = 2249;  						//0.562ms pulse burst to show the end
-			TA1CCR2 = 2249;
-			IR_flag=1;
-		}
+
+/* Function: IR_Next_Symbol
+ * Steps to the symbol after the current one, a fixed amount of work per symbol:
+ * tx_mask is moved by one bit instead of shifting by the bit number.
+ * Returns:
+ *      Next data bit symbol, the trailer, or 0 at the end of the code
+ */
+const IR_SYMBOL *IR_Next_Symbol(void)
+{
+	unsigned char bit;
+
+	if(tx_bit < tx_proto->bits)
+	{
+		bit = *send_addr & tx_mask;
+		tx_bit++;
+
+		if(tx_proto->msb_first)
+			tx_mask >>= 1;
 		else
+			tx_mask <<= 1;
+		if(tx_mask == 0)						// start a new byte
 		{
-			if((*send_addr & bit_sel) == 0)			// data "0"
-			{
-				TA1CCR0 = 4499;   					// 0.562ms high  0.562ms low
-				TA1CCR2 = 2249;
-				bit_sel<<=1;
-			}
-			else									// data "1"
-			{
-				TA1CCR0 = 8999;   					// 0.562ms high  1.687ms low
-				TA1CCR2 = 2249;
-				bit_sel<<=1;
-			}
-			if(bit_sel>=256)						// start a new byte
-			{
-				send_addr++;
-				byte_cnt++;
-				bit_sel=1;
-			}
+			tx_mask = tx_proto->msb_first ? 0x80 : 0x01;
+			send_addr++;
 		}
-		break;
+
+		return bit ? &tx_proto->one : &tx_proto->zero;
+	}
+
+	if(tx_bit == tx_proto->bits && tx_proto->trailer.period)
+	{
+		tx_bit++;
+		return &tx_proto->trailer;				// pulse burst to show the end
+	}
+
+	return 0;
+}
+
+//********Timer1 interrupt ISR*********//
+//The next symbol is worked out one period ahead, so each interrupt only loads two registers
+#pragma vector = TIMER1_A0_VECTOR
+__interrupt void TIMER1_A0_ISR (void)
+{
+	if(tx_next)
+	{
+		TA1CCR0 = tx_next->period;
+		TA1CCR2 = tx_next->mark;
+		tx_next = IR_Next_Symbol();
 	}
-	default: break;
+	else
+	{
+		IR_stop=1;								// stop IR modulator
+		TA1CCTL0 &= ~CCIE;						// disable timer_A0 interrupt
 	}
 }
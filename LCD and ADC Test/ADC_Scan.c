@@ -0,0 +1,338 @@
+/***************************
+ * ADC_Scan.C
+ * Contains the ADC scan scheduler: every channel is converted at its own rate, oversampled,
+ * and its values are kept in a ring buffer for main
+ *
+ * Functions:
+ *      ADC_Scan_Init: Initializes the ADC, the reference/temperature sensor and TA1 for the scan
+ *      ADC_Scan_Wake(ch, wake): Sets if main is woken up (exits LPM3) by new values of `ch`
+ *      ADC_Scan_Fresh(ch): Number of values of `ch` not read yet
+ *      ADC_Scan_Read(ch, buf, n): Reads the newest (up to `n`) values of `ch` not read yet
+ *      ADC_Scan_Last(ch): Reads the newest value of `ch`, even if it was read before
+ *      ADC_Scan_Alarm(ch, lo, hi, hyst): Sets the alarm band of `ch` (window comparator)
+ *      ADC_Scan_Alarm_Changed(ch): Checks if the alarm state of `ch` changed since ADC_Scan_Alarm_Get
+ *      ADC_Scan_Alarm_Get(ch): Gets the alarm state of `ch`
+ *
+ * Connects to:
+ *      main.c/h
+ *      TempSensor.c/h
+****************************/
+
+#include "main.h"
+#include "ADC_Scan.h"
+
+/* SCHEDULING
+ * TA1 counts ACLK continuously, and every channel has the TA1R time of its next conversion (`due`).
+ * TA1CCR0 is always set to the earliest `due`, so the timer ISR only runs when a conversion has
+ * to start: it starts the most overdue channel (single-channel single-conversion, ADCSC) and moves
+ * CCR0 on. Channels that are due at the same time take turns, one ACLK tick apart.
+ * The ISR works from TA1R, not from the compare that woke it up: it can run late (behind another
+ * interrupt), and a compare the timer has already passed would only match after TA1 wraps, 2s later.
+ * So CCR0 is never set closer than ADC_SCAN_MIN_WAIT ticks after TA1R, and a channel that fell behind
+ * is converted as soon as possible, keeping its rate (its `due` still moves on by `interval`).
+ * Each channel also has its own reference, loaded into ADCMCTL0 together with its input:
+ * the voltmeter measures against AVCC (3.3V), the temperature sensor against the internal 1.5V
+ * reference, which is what the TLV calibration (CALADC_15V_30C/85C) was measured with.
+ *
+ * OVERSAMPLING
+ * The ADC ISR adds every conversion to the running sum of its channel. After 4^bits conversions
+ * the sum is shifted down by `bits` (10+bits bit value), pushed into the channel's ring and main
+ * is woken up, but only if it is waiting for that channel (ADC_Scan_Wake).
+ * 4^3 conversions of 10 bits still fit in the unsigned int sum.
+ *
+ * ALARMS
+ * Every conversion is also checked by the ADC window comparator, in hardware: ADCLO/ADCHI are loaded
+ * with the window of the channel together with ADCINCHx, and the ADC ISR only has to act when a
+ * conversion falls outside of it (ADCLOIFG/ADCHIIFG). The window then moves, so the band has hysteresis:
+ *      ADC_ALARM_NONE: window lo..hi
+ *      ADC_ALARM_LOW:  window 0..lo+hyst, back to NONE above it
+ *      ADC_ALARM_HIGH: window hi-hyst..ADC_MAX, back to NONE below it
+ * Every change of state wakes main up. The window is checked per conversion, not per oversampled value.
+ */
+typedef struct {
+    unsigned char mctl;                 //ADCMCTL0: reference (ADCSREFx) and input (ADCINCHx)
+    unsigned char bits;                 //oversampling bits, 4^bits conversions per value
+    unsigned int  interval;             //ACLK ticks between conversions
+    unsigned int  due;                  //TA1R time of the next conversion
+    unsigned int  sum;                  //running sum of the current value
+    unsigned char cnt;                  //conversions in sum
+    unsigned char head;                 //ring[] index of the next value
+    unsigned char fresh;                //values not read yet (at most ADC_RING_SIZE)
+    unsigned char wake;                 //TRUE: new values wake main up
+    unsigned char alarm;                //enum ADC_ALARMS
+    unsigned char alarm_changed;        //TRUE: `alarm` changed since ADC_Scan_Alarm_Get
+    unsigned int  lo, hi;               //alarm band, 10-bit conversions
+    unsigned int  lo_release, hi_release;   //lo+hyst, hi-hyst
+    unsigned int  win_lo, win_hi;       //window for the current state (ADCLO/ADCHI)
+    unsigned int  ring[ADC_RING_SIZE];
+} ADC_CHANNEL;
+
+static ADC_CHANNEL scan[ADC_SCAN_CNT] = {
+    {ADCSREF_0 | ADCINCH_3,  ADC_VOLT_BITS, ADC_VOLT_INTERVAL},     //ADC_VOLT: V+ = AVCC (3.3V)
+    {ADCSREF_1 | ADCINCH_12, ADC_TEMP_BITS, ADC_TEMP_INTERVAL}      //ADC_TEMP: V+ = internal 1.5V
+};
+
+static unsigned char active;            //channel being converted
+
+static void ADC_Scan_Window(ADC_CHANNEL *, unsigned char);
+
+//Initialize the ADC and the scan
+void ADC_Scan_Init(){
+    unsigned char i;
+
+    /*
+     * Use ADCSC (software, started by the TA1 CCR0 ISR) as sample/hold signal to start conversion
+     * Use the sampling timer, 192 ADCCLK (~38us, the temperature sensor needs 30us)
+     * USE MODOSC 5MHZ Digital Oscillator as clock source
+     * Single channel, single conversion (the channel changes from one conversion to the next)
+     */
+    ADCCTL0 &= ~(ADCON | ADCENC | ADCSC);//Set ADCENC as 0 so as to begin init.
+
+    ADCCTL0 = ADCSHT_7 | ADCON;
+    ADCCTL1 = ADCSHP | ADCSHS_0 | ADCDIV_0 | ADCSSEL_0 | ADCCONSEQ_0;
+    ADCCTL2 = ADCRES_1; //10-bit
+
+    ADCMCTL0 = ADCSREF_0; //REF0: V+ = 3.3V; REF1: V+ = 1.5V (ADCSREFx and ADCINCHx are set per conversion)
+
+    //Enable and clear all interrupts (conversion done, and below/above the window)
+    ADCIFG &= 0x0000;
+    ADCIE = ADCIE0 | ADCLOIE | ADCHIIE;
+
+    // Enable internal reference (for ADC_TEMP) and temperature sensor
+    PMMCTL0_H = PMMPW_H; //Need to set password to set the registers
+    PMMCTL2 |= INTREFEN | TSENSOREN;
+    PMMCTL0_H = 0x00;   //Reset, otherwise the FRAM will reset, and the code will start again from top.
+    __delay_cycles(3200); //Reference settling (400us at MCLK = 8MHz), before the first conversion
+
+    //*-------- INIT TA1, WHICH SCHEDULES THE CONVERSIONS ----------*//
+    for(i=0;i<ADC_SCAN_CNT;i++){
+        scan[i].due = ADC_SCAN_MIN_WAIT + i;    //first conversions right away, one tick apart
+        scan[i].sum = 0;
+        scan[i].cnt = 0;
+        scan[i].fresh = 0;
+        ADC_Scan_Alarm_Off(i);
+    }
+
+    TA1CCR0 = ADC_SCAN_MIN_WAIT;
+    TA1CCTL0 = CCIE;
+
+    TA1CTL = TASSEL__ACLK | ID__1 | MC__CONTINUOUS | TACLR;
+           // ACLK,    DIVIDER 1   CONTINUOUS_MODE,  CLEAR TIMER
+}
+
+/* Function: ADC_Scan_Wake
+ * Arguments:
+ *      ch: Channel (enum ADC_SCAN_CHANNELS)
+ *      wake: TRUE to wake main up (exit LPM3) whenever `ch` has a new value, FALSE not to
+ */
+void ADC_Scan_Wake(unsigned char ch, unsigned char wake){
+    scan[ch].wake = wake;
+}
+
+/* Function: ADC_Scan_Fresh
+ * Returns:
+ *      Number of values of `ch` that have not been read yet
+ */
+unsigned char ADC_Scan_Fresh(unsigned char ch){
+    return scan[ch].fresh;
+}
+
+/* Function: ADC_Scan_Read
+ * Arguments:
+ *      ch: Channel (enum ADC_SCAN_CHANNELS)
+ *      buf: Where to store the values, oldest first (10+bits bits each, see ADC_Scan.h)
+ *      n: Maximum number of values (ADC_RING_SIZE at most)
+ * Returns:
+ *      Number of values stored: the newest of the values not read yet, all of which are now read
+ */
+unsigned char ADC_Scan_Read(unsigned char ch, unsigned int *buf, unsigned char n){
+    ADC_CHANNEL *c = &scan[ch];
+    unsigned char i, idx;
+
+    __disable_interrupt();      //the ADC ISR must not push halfway through
+
+    if(n > c->fresh) n = c->fresh;
+    idx = c->head - n;
+    for(i=0;i<n;i++,idx++)
+        buf[i] = c->ring[idx & (ADC_RING_SIZE-1)];
+    c->fresh = 0;
+
+    __enable_interrupt();
+
+    return n;
+}
+
+/* Function: ADC_Scan_Last
+ * Returns:
+ *      The newest value of `ch` (0 if there is none yet); all its values are now read
+ */
+unsigned int ADC_Scan_Last(unsigned char ch){
+    ADC_CHANNEL *c = &scan[ch];
+    unsigned int value;
+
+    __disable_interrupt();
+
+    value = c->ring[(unsigned char)(c->head - 1) & (ADC_RING_SIZE-1)];
+    c->fresh = 0;
+
+    __enable_interrupt();
+
+    return value;
+}
+
+/* Function: ADC_Scan_Alarm
+ * Arguments:
+ *      ch: Channel (enum ADC_SCAN_CHANNELS)
+ *      lo, hi: Alarm band, as 10-bit conversions (see Volt_Alarm/Temp_Alarm for engineering units)
+ *      hyst: Hysteresis, as 10-bit conversions: how far back into the band a value has to be to end the alarm
+ * Restarts the channel in ADC_ALARM_NONE
+ */
+void ADC_Scan_Alarm(unsigned char ch, unsigned int lo, unsigned int hi, unsigned int hyst){
+    ADC_CHANNEL *c = &scan[ch];
+    unsigned short sr = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+
+    c->lo = lo;
+    c->hi = hi;
+    c->lo_release = (lo + hyst < ADC_MAX) ? lo + hyst : ADC_MAX;
+    c->hi_release = (hi > hyst) ? hi - hyst : 0;
+    ADC_Scan_Window(c, ADC_ALARM_NONE);
+    c->alarm_changed = FALSE;
+
+    if(sr) __enable_interrupt();
+}
+
+/* Function: ADC_Scan_Alarm_Changed
+ * Returns:
+ *      TRUE if the alarm state of `ch` changed since the last ADC_Scan_Alarm_Get, FALSE otherwise
+ */
+unsigned char ADC_Scan_Alarm_Changed(unsigned char ch){
+    return scan[ch].alarm_changed;
+}
+
+/* Function: ADC_Scan_Alarm_Get
+ * Returns:
+ *      Alarm state of `ch` (enum ADC_ALARMS)
+ */
+unsigned char ADC_Scan_Alarm_Get(unsigned char ch){
+    scan[ch].alarm_changed = FALSE;
+    return scan[ch].alarm;
+}
+
+//Moves the channel to alarm `state` and sets its window (loaded into ADCLO/ADCHI at its next conversion)
+static void ADC_Scan_Window(ADC_CHANNEL *c, unsigned char state){
+    c->alarm = state;
+    c->alarm_changed = TRUE;
+
+    switch(state){
+        case ADC_ALARM_LOW:
+            c->win_lo = 0;
+            c->win_hi = c->lo_release;
+            break;
+        case ADC_ALARM_HIGH:
+            c->win_lo = c->hi_release;
+            c->win_hi = ADC_MAX;
+            break;
+        default:
+            c->win_lo = c->lo;
+            c->win_hi = c->hi;
+            break;
+    }
+}
+
+/*
+ * TIMER1 CCR0 Interrupt Service Routine
+ * Starts the conversion that is due and schedules the next one
+ */
+#pragma vector = TIMER1_A0_VECTOR
+__interrupt void ADC_Scan_ISR(void)
+{
+    unsigned int now;
+    unsigned char i, next = ADC_SCAN_CNT;
+    int wait, min_wait = 0;
+
+    //TA1 counts ACLK, asynchronous to MCLK: read it until two reads agree
+    do{
+        now = TA1R;
+    }while(now != TA1R);
+
+    //Start the most overdue channel, unless the last conversion is still going (it then waits a tick)
+    if(!(ADCCTL1 & ADCBUSY)){
+        for(i=0;i<ADC_SCAN_CNT;i++){
+            wait = (int)(scan[i].due - now);
+            if(wait <= min_wait){
+                min_wait = wait;
+                next = i;
+            }
+        }
+
+        if(next < ADC_SCAN_CNT){
+            active = next;
+            scan[next].due += scan[next].interval;
+
+            ADCCTL0 &= ~ADCENC;                     //ADCMCTL0 can only change while ADCENC = 0
+            ADCMCTL0 = scan[next].mctl;             //reference and input of this channel
+            ADCLO = scan[next].win_lo;              //window comparator, for this channel's alarm
+            ADCHI = scan[next].win_hi;
+            ADCCTL0 |= ADCENC | ADCSC;
+        }
+    }
+
+    //Next compare at the earliest due time, at least ADC_SCAN_MIN_WAIT ticks after TA1R (so not in the past)
+    min_wait = 0x7FFF;
+    for(i=0;i<ADC_SCAN_CNT;i++){
+        wait = (int)(scan[i].due - now);
+        if(wait < min_wait) min_wait = wait;
+    }
+    if(min_wait < ADC_SCAN_MIN_WAIT) min_wait = ADC_SCAN_MIN_WAIT;
+
+    TA1CCR0 = now + min_wait;
+}
+
+/*
+ * ADC Interrupt Service Routine
+ * Adds the conversion to its channel, and exits LPM3 if main is waiting for the channel's new value
+ * Also moves the channel's alarm when the conversion left its window, and exits LPM3
+ */
+#pragma vector=ADC_VECTOR
+__interrupt void ADC_ISR(void) {
+    ADC_CHANNEL *c;
+
+    switch(__even_in_range(ADCIV,ADCIV_ADCIFG))
+    {
+        case ADCIV_NONE:
+            break;
+        case ADCIV_ADCOVIFG:
+            break;
+        case ADCIV_ADCTOVIFG:
+            break;
+        case ADCIV_ADCHIIFG:
+            c = &scan[active];
+            ADC_Scan_Window(c, (c->alarm == ADC_ALARM_LOW) ? ADC_ALARM_NONE : ADC_ALARM_HIGH);
+            __bic_SR_register_on_exit(LPM3_bits);                    // Exit LPM3
+            break;
+        case ADCIV_ADCLOIFG:
+            c = &scan[active];
+            ADC_Scan_Window(c, (c->alarm == ADC_ALARM_HIGH) ? ADC_ALARM_NONE : ADC_ALARM_LOW);
+            __bic_SR_register_on_exit(LPM3_bits);                    // Exit LPM3
+            break;
+        case ADCIV_ADCINIFG:
+            break;
+        case ADCIV_ADCIFG:
+            c = &scan[active];
+            c->sum += ADCMEM0;      //reading ADCMEM0 clears ADCIFG0
+
+            if(++c->cnt == (1 << (2*c->bits))){
+                c->ring[c->head++ & (ADC_RING_SIZE-1)] = c->sum >> c->bits;
+                if(c->fresh < ADC_RING_SIZE) c->fresh++;
+                c->sum = 0;
+                c->cnt = 0;
+
+                if(c->wake) __bic_SR_register_on_exit(LPM3_bits);                // Exit LPM3
+            }
+            break;
+        default:
+            break;
+    }
+}
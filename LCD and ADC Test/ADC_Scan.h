@@ -0,0 +1,42 @@
+/***************************
+ * ADC_Scan.h
+ * Use this header file to attach functions and define constants for ADC_Scan.c
+****************************/
+
+//Scanned channels (index into the scan table in ADC_Scan.c)
+enum ADC_SCAN_CHANNELS {
+    ADC_VOLT,                   //A3, digital voltmeter
+    ADC_TEMP,                   //A12, temperature sensor
+    ADC_SCAN_CNT
+};
+
+//Per channel rates: one conversion every *_INTERVAL ACLK ticks, 4^*_BITS conversions per value,
+//so each value has 10+*_BITS bits and comes every 4^*_BITS * *_INTERVAL / 32768 s
+#define ADC_VOLT_INTERVAL 32    //1024 conversions/s
+#define ADC_VOLT_BITS 2         //16 per value: 64 values/s, 12-bit
+#define ADC_TEMP_INTERVAL 512   //64 conversions/s
+#define ADC_TEMP_BITS 3         //64 per value: 1 value/s, 13-bit
+
+#define ADC_FULL_SCALE(bits) (1023 << (bits))   //value of a saturated input
+
+//Alarm states (see ADC_Scan_Alarm)
+enum ADC_ALARMS {
+    ADC_ALARM_NONE,             //in the band
+    ADC_ALARM_LOW,              //went below `lo`, until it is back above lo+hyst
+    ADC_ALARM_HIGH              //went above `hi`, until it is back below hi-hyst
+};
+
+#define ADC_MAX 1023            //largest 10-bit conversion
+#define ADC_Scan_Alarm_Off(ch) ADC_Scan_Alarm((ch), 0, ADC_MAX, 0)   //a window no conversion can leave
+
+#define ADC_RING_SIZE 8         //values kept per channel (power of 2)
+#define ADC_SCAN_MIN_WAIT 2     //ACLK ticks from TA1R in the ISR to the next compare (must outlast the ISR)
+
+extern void ADC_Scan_Init(void);
+extern void ADC_Scan_Wake(unsigned char, unsigned char);
+extern unsigned char ADC_Scan_Fresh(unsigned char);
+extern unsigned char ADC_Scan_Read(unsigned char, unsigned int *, unsigned char);
+extern unsigned int ADC_Scan_Last(unsigned char);
+extern void ADC_Scan_Alarm(unsigned char, unsigned int, unsigned int, unsigned int);
+extern unsigned char ADC_Scan_Alarm_Changed(unsigned char);
+extern unsigned char ADC_Scan_Alarm_Get(unsigned char);
@@ -4,6 +4,8 @@
  *
  * Functions:
  *      Init_Temp: Initializes ADC and timers for the temperature sensor
+ *      Temp_DegC(adc): Converts an oversampled temperature sensor reading to 0.1C
+ *      Temp_Alarm(lo, hi, hyst): Sets the temperature alarm band, in 0.1C
  *
  * Header Files:
  *      MSP430FR4133.h
@@ -14,16 +16,63 @@
 #include "msp430fr4133.h"
 #include "main.h"
 #include "TempSensor.h"
+#include "ADC_Scan.h"
+#include "MPY32.h"
 
 volatile unsigned char tempSensorRunning = FALSE;
 
+//TLV calibration, scaled to the oversampled ADC values (see Init_Temp)
+static unsigned int temp_cal30;     //reading at 30C
+static unsigned int temp_scale;     //0.1C per reading step, Q16
+
 //Initialize Temperature Sensor
 void Init_Temp(){
     //*-------- FIRST INIT ADC ----------*//
 
-    Init_ADC();
+    ADC_Scan_Init();
+
+    //Precompute the calibration once, so Temp_DegC needs no division:
+    //  degC = 300 + (adc - CAL30) * 550/(CAL85 - CAL30), in 0.1C
+    unsigned int diff = (CALADC_15V_85C - CALADC_15V_30C) << ADC_TEMP_BITS;
+
+    temp_cal30 = CALADC_15V_30C << ADC_TEMP_BITS;
+    temp_scale = (diff) ? (unsigned int)(((550UL << 16) + (diff>>1)) / diff) : 0;
 
     //Interface
     P1OUT |= BIT0;
     tempSensorRunning = TRUE;
 }
+
+/* Function: Temp_DegC
+ * Arguments:
+ *      adc: Decimated temperature sensor reading (10+ADC_TEMP_BITS bits)
+ * Returns:
+ *      Temperature in 0.1C
+ */
+long Temp_DegC(unsigned int adc){
+    return 300 + Q16_ROUND(MPY_Mul32((signed int)(adc - temp_cal30), temp_scale));
+}
+
+//n/d rounded to the nearest, for d > 0 and either sign of n (C division rounds toward 0)
+static long Temp_Div_Round(long n, long d){
+    return (n < 0) ? -((d/2 - n) / d) : (n + d/2) / d;
+}
+
+/* Function: Temp_Alarm
+ * Sets the band of the ADC window comparator alarm on the temperature sensor (see ADC_Scan_Alarm)
+ * Arguments:
+ *      lo, hi: Alarm band, in 0.1C
+ *      hyst: Hysteresis, in 0.1C
+ */
+void Temp_Alarm(long lo, long hi, long hyst){
+    //Only done by main when the band changes, so dividing is fine here: the window compares raw 10-bit conversions
+    //against the internal 1.5V reference (ADC_TEMP, see ADC_Scan.c), as the TLV calibration values are
+    long diff = CALADC_15V_85C - CALADC_15V_30C;
+    long lo_adc = CALADC_15V_30C + Temp_Div_Round((lo - 300) * diff, 550);
+    long hi_adc = CALADC_15V_30C + Temp_Div_Round((hi - 300) * diff, 550);
+
+    if(lo_adc < 0) lo_adc = 0;
+    if(hi_adc > ADC_MAX) hi_adc = ADC_MAX;
+
+    ADC_Scan_Alarm(ADC_TEMP, (unsigned int)lo_adc, (unsigned int)hi_adc, (unsigned int)Temp_Div_Round(hyst * diff, 550));
+}
@@ -4,3 +4,5 @@
 ****************************/
 
 extern void Init_Temp(void);
+extern long Temp_DegC(unsigned int);
+extern void Temp_Alarm(long, long, long);
@@ -5,26 +5,32 @@
  * Functions:
  *  	Init_GPIO: Initializes ports
  *	Init_Clock: Initializes XT1 OSC and DCO
+ *	Alarm_Toggle: Turns alarm mode on or off (S1)
  * 
  * Connects to: 
  * 		LCD.c/h
  * 		TempSensor.c/h
+ * 		ADC_Scan.c/h
+ * 		../Common/MPY32.h
 ****************************/
 
 #include "main.h"
 #include "LCD.h"
 #include "TempSensor.h"
+#include "ADC_Scan.h"
+#include "MPY32.h"
 
 extern const unsigned char POS[7];
 
-unsigned int channel = MAX_ADC_CHANNEL;
-
 long count = 0;
-signed short temp = 0;
 long voltage = 0;
 long degC = 0;
 
-long adc_val;
+unsigned int adc_val;                            //oversampled value from the ADC scan (see ADC_Scan.c)
+
+unsigned char show_temp = FALSE;                 //S2 switches between the voltmeter and the temperature
+unsigned char alarm_mode = FALSE;                //S1: only wake up when the channel on display leaves its band
+volatile unsigned char alarm_toggle = FALSE;     //S1 was pressed: main toggles alarm_mode (see Alarm_Toggle)
 
 extern volatile unsigned char tempSensorRunning;
 
@@ -38,61 +44,104 @@ int main(void)
 
     LCD_Init();
 	
+    ADC_Scan_Wake(ADC_VOLT, TRUE);
+
 	__enable_interrupt();
 	
 	while(1){
 	    //if(tempSensorRunning==FALSE) continue;
 
-	    __bis_SR_register(LPM3_bits | GIE);                       // LPM3 with interrupts enabled
-		__no_operation();                                         // Only for debugger
+	    //Sleep until the channel on display has a new value (the ADC scan only wakes us up for that one)
+	    //In alarm mode, only until it goes out of (or back into) its band
+	    __disable_interrupt();
+	    while(!alarm_toggle && !(alarm_mode ? ADC_Scan_Alarm_Changed(show_temp ? ADC_TEMP : ADC_VOLT)
+	                                        : ADC_Scan_Fresh(show_temp ? ADC_TEMP : ADC_VOLT))){
+	        __bis_SR_register(LPM3_bits | GIE);                   // LPM3 with interrupts enabled
+	        __disable_interrupt();
+	    }
+	    __enable_interrupt();
+
+	    if(alarm_toggle){
+	        alarm_toggle = FALSE;
+	        Alarm_Toggle();
+	        continue;                   //sleep again, on the new condition
+	    }
 
 		P4OUT ^= BIT0;
 
-		switch(channel+1){
-		    case 3:
-                adc_val = ADCMEM0;
-
-                if(adc_val == 1023){
-                    LCD_Letter('M',pos1);
-                    LCD_Letter('A',pos2);
-                    LCD_Letter('X',pos3);
-                    break;
-                }
-
-                voltage = adc_val*ADC_TO_V_REF_3V3;
-
-                if(voltage<100){ //0.xx voltage
-                    voltage+=100;
-                    LCD_Number(voltage);
-                    LCD_Digit(0,pos1);
-                    LCD_Decimal_Point(pos1);
-                }
-                else if(voltage<1000){ //x.yy voltage
-                    LCD_Number(voltage);
-                    LCD_Decimal_Point(pos1);
-                }
-                else{ //xx.yy voltage
-                    LCD_Number(voltage);
-                    LCD_Decimal_Point(pos2);
-                }
-                LCD_Letter('V', pos6);
-		        break;
-		    case 12:
-                //ADC is reading INCH12 (Temperature sensor)
-                temp = (ADCMEM0-CALADC_15V_30C);
-
-                degC = 300 + temp*ADC_TO_TEMP;
-
-                LCD_Number(degC);
-
-                LCD_Degree_Symbol();
-                LCD_Decimal_Point(pos2);
-                LCD_Letter('C',pos6);
-            break;
+		if(alarm_mode){
+			//Red LED on while out of the band; the LCD shows the reading at the last change
+			if(ADC_Scan_Alarm_Get(show_temp ? ADC_TEMP : ADC_VOLT) != ADC_ALARM_NONE) P1OUT |= BIT0;
+			else P1OUT &= ~BIT0;
+		}
+
+		if(!show_temp){
+			adc_val = ADC_Scan_Last(ADC_VOLT);
+
+			if(adc_val == ADC_FULL_SCALE(ADC_VOLT_BITS)){
+			    LCD_Clear();
+			    LCD_Letter('M',pos1);
+			    LCD_Letter('A',pos2);
+			    LCD_Letter('X',pos3);
+			    continue;
+			}
+
+			voltage = Q16_ROUND(MPY_Mulu16(adc_val, ADC_TO_V_REF_3V3));
+
+			LCD_Fixed_Point(voltage, 2);   //voltage is in 0.01V: 0.xx, x.yy or xx.yy
+			LCD_Letter('V', pos6);
+		}
+		else{
+			//ADC is reading INCH12 (Temperature sensor)
+			adc_val = ADC_Scan_Last(ADC_TEMP);
+			degC = Temp_DegC(adc_val);
+
+			LCD_Fixed_Point(degC, 1);      //degC is in 0.1C
+
+			LCD_Degree_Symbol();
+			LCD_Letter('C',pos6);
 		}
 	}
 }
 
+/* Function: Volt_Alarm
+ * Sets the band of the ADC window comparator alarm on the voltmeter (see ADC_Scan_Alarm)
+ * Arguments:
+ *      lo, hi: Alarm band, in 0.01V
+ *      hyst: Hysteresis, in 0.01V
+ */
+void Volt_Alarm(long lo, long hi, long hyst){
+    //0.01V to 10-bit conversions (V+ = 3.3V), rounded
+    long hi_adc = (hi * ADC_MAX + 165) / 330;
+
+    ADC_Scan_Alarm(ADC_VOLT, (unsigned int)((lo * ADC_MAX + 165) / 330),
+                   (hi_adc > ADC_MAX) ? ADC_MAX : (unsigned int)hi_adc,
+                   (unsigned int)((hyst * ADC_MAX + 165) / 330));
+}
+
+/* Function: Alarm_Toggle
+ * Turns alarm mode on or off: main then sleeps until the channel on display leaves its band (red LED)
+ * Called from main, not from PORT1_ISR: Volt_Alarm and Temp_Alarm divide 32-bit numbers, which the
+ * MSP430 does in software (no MPY32 divide), and would hold up the ADC scan ISRs
+ */
+void Alarm_Toggle(){
+    if(!alarm_mode){
+        Volt_Alarm(VOLT_ALARM_LO, VOLT_ALARM_HI, VOLT_ALARM_HYST);
+        Temp_Alarm(TEMP_ALARM_LO, TEMP_ALARM_HI, TEMP_ALARM_HYST);
+    }
+    else{
+        ADC_Scan_Alarm_Off(ADC_VOLT);
+        ADC_Scan_Alarm_Off(ADC_TEMP);
+    }
+
+    __disable_interrupt();          //PORT2_ISR sets the wakes from alarm_mode too
+    alarm_mode ^= TRUE;
+    P1OUT &= ~BIT0;
+    ADC_Scan_Wake(ADC_VOLT, !alarm_mode && !show_temp);
+    ADC_Scan_Wake(ADC_TEMP, !alarm_mode && show_temp);
+    __enable_interrupt();
+}
+
 //Initialize GPIO
 void Init_GPIO(){
 	// Configure all GPIO to Output, Low
@@ -162,68 +211,6 @@ void Init_Clock()
 											// SMCLK = MCLK/2 = 4MHz
 }
 
-//Init ADC
-void Init_ADC(){
-    //Initialize the ADC Module
-    /*
-     * Base Address for the ADC Module
-     * Use Timer trigger 1 as sample/hold signal to start conversion
-     * USE MODOSC 5MHZ Digital Oscillator as clock source
-     * Use default clock divider of 1
-     * Repeat Single channel
-     * (For digital voltmeter, use repeat multichannel)
-     */
-    ADCCTL0 &= ~(ADCON | ADCENC | ADCSC);//Set ADCENC as 0 so as to begin init.
-
-    ADCCTL1 |= ADCSHS_2 | ADCDIV_0 | ADCSSEL_0 | ADCCONSEQ_3;//ADCCONSEQ_2;
-    ADCIE &= 0x0000;
-
-    ADCCTL0 |= ADCON;
-
-    //Configure Memory Buffer
-    /*
-     * Base Address for the ADC Module
-     * Use input A12 Temp Sensor
-     * Use positive reference of Internally generated Vref
-     * Use negative reference of AVss
-     */
-
-    ADCMCTL0 |= ADCINCH_3; //Digital Voltmeter
-    ADCMCTL0 |= ADCINCH_12; //Temperature Sensor
-    ADCMCTL0 |= ADCSREF_0; //REF0: V+ = 3.3V; REF1: V+ = 1.5V
-
-    ADCCTL2 |= ADCRES_1; //10-bit
-
-    //Enable and clear all interrupts
-    ADCIE |= ADCIE0;
-    ADCIFG &= 0x0000;
-
-    //Start & Enable Conversion
-    ADCCTL0 |= ADCENC | ADCSC;
-
-    // Enable internal reference and temperature sensor
-    PMMCTL0_H = PMMPW_H; //Need to set password to set the registers
-    PMMCTL2 |= INTREFEN | TSENSOREN;
-    PMMCTL0_H = 0x00;   //Reset, otherwise the FRAM will reset, and the code will start again from top.
-
-    //*-------- INIT TA1.1 WHICH IS USED AS TIMER SOURCE FOR SAMPLING ----------*//
-    TA1CCR0 = 0x1000; //Period
-
-    TA1CTL |= TASSEL__ACLK | ID__1 | MC__UP | TACLR;
-           // ACLK,    DIVIDER 1   UP_MODE,  CLEAR TIMER
-           // ACLK/4 = 32768/1Hz ( ACLK frequency has been set under Init_Clock(). Linked to XT1)
-    TA1CTL &= ~(TAIE | TAIFG); //DISABLE INTERRUPT, CLEAR FLAG
-
-    //DISABLE INTERRUPT FOR TA1.1 and CCR0
-    TA1CCTL0 &= ~(CCIE | CCIFG);
-    TA1CCTL1 &= ~(CCIE | CCIFG);
-
-    TA1CCTL1 &= ~(CAP); //COMPARE MODE
-    TA1CCTL1 |= OUTMOD_7; //OUTPUT MODE 7 (Reset/set)
-    TA1CCTL1 &= ~(CCIE | CCIFG); //DISABLE NTERRUPTS, CLEAR FLAG
-    TA1CCR1 = 0x1000; //COMPARE VALUE
-}
-
 /*
  * PORT1 Interrupt Service Routine
  * Handles S1 button press interrupt
@@ -237,8 +224,9 @@ __interrupt void PORT1_ISR(void)
         case P1IV_P1IFG0 : break;
         case P1IV_P1IFG1 : break;
         case P1IV_P1IFG2 :
-            tempSensorRunning ^= TRUE; //toggle tempSensorRunning
-            P1OUT ^= BIT0; //toggle red LED
+            //toggle alarm mode, in main (Alarm_Toggle: setting the bands divides)
+            alarm_toggle = TRUE;
+            __bic_SR_register_on_exit(LPM3_bits);                    // Exit LPM3
             break;
         case P1IV_P1IFG3 : break;
         case P1IV_P1IFG4 : break;
@@ -265,50 +253,14 @@ __interrupt void PORT2_ISR(void)
         case P2IV_P2IFG4 : break;
         case P2IV_P2IFG5 : break;
         case P2IV_P2IFG6 :
-            //Do something on button press
+            show_temp ^= TRUE; //shown from the next value of its channel on
+            ADC_Scan_Wake(ADC_VOLT, !alarm_mode && !show_temp);
+            ADC_Scan_Wake(ADC_TEMP, !alarm_mode && show_temp);
             break;
         case P2IV_P2IFG7 : break;
     }
 }
 
-/*
- * ADC Interrupt Service Routine
- * Show the value of the temperature on the LCD Screen by exiting LPM3.
- */
-#pragma vector=ADC_VECTOR
-__interrupt void ADC_ISR(void) {
-    switch(__even_in_range(ADCIV,ADCIV_ADCIFG))
-    {
-        case ADCIV_NONE:
-            break;
-        case ADCIV_ADCOVIFG:
-            break;
-        case ADCIV_ADCTOVIFG:
-            break;
-        case ADCIV_ADCHIIFG:
-            break;
-        case ADCIV_ADCLOIFG:
-            break;
-        case ADCIV_ADCINIFG:
-            break;
-        case ADCIV_ADCIFG:
-        	    // Clear interrupt flag
-			ADCIFG &= ~(ADCIFG0);
-            if(channel) channel--;
-            else channel = MAX_ADC_CHANNEL;
-
-            switch(channel+1){
-                case 3:
-                //case 12:
-                    __bic_SR_register_on_exit(LPM3_bits);                // Exit LPM3
-                    break;
-            }
-            break;
-        default:
-            break;
-    }
-}
-
 /*
  * TIMER 0.1/0.2 Interrupt Service Routine
  * Handles timer interrupts at CCR1/2
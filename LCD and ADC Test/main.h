@@ -6,18 +6,23 @@
 #include "msp430fr4133.h"
 
 
-#define MAX_ADC_CHANNEL 15
                                                         // See device datasheet for TLV table memory mapping
 #define CALADC_15V_30C  *((unsigned int *)0x1A1A)       // Temperature Sensor Calibration-30 C
 #define CALADC_15V_85C  *((unsigned int *)0x1A1C)       // Temperature Sensor Calibration-85 C
 
-//Since the CALADC values refer to the address/registers,
-//we use the debugger to find that the difference (CALADC_15V_85C-CALADC_15V_30C) = 121
+//Fixed point (Q16) scale factors: result = (adc * SCALE + 0x8000) >> 16, no floating point needed
+//The temperature scale depends on the TLV calibration of each chip, so it is computed in Init_Temp (TempSensor.c)
+#define ADC_TO_V_REF_3V3 5285UL // = 65536 * 100*3.3/ADC_FULL_SCALE(ADC_VOLT_BITS) (0.01V per unit)
+#define ADC_TO_V_REF_1V5 2402UL // = 65536 * 100*1.5/ADC_FULL_SCALE(ADC_VOLT_BITS)
+#define Q16_ROUND(n) (((n) + 0x8000) >> 16)
 
-#define ADC_TO_TEMP 4.54 // = 10 * (85-30)/(CALADC_15V_85C-CALADC_15V_30C) ~ 550/121;
-                         // (reason for the times 10 is so that we can get the temperature to the last decimal point)
-#define ADC_TO_V_REF_3V3 0.322580645 // 100*3.3/1023
-#define ADC_TO_V_REF_1V5 0.146627566 // 100*1.5/1023
+//Alarm mode (S1): bands in display units (0.01V, 0.1C); see Volt_Alarm and Temp_Alarm
+#define VOLT_ALARM_LO 50        //0.50V
+#define VOLT_ALARM_HI 300       //3.00V
+#define VOLT_ALARM_HYST 5       //0.05V
+#define TEMP_ALARM_LO 150       //15.0C
+#define TEMP_ALARM_HI 350       //35.0C
+#define TEMP_ALARM_HYST 5       //0.5C
 
 //Number parsing
 #define TRUE 0xFF
@@ -30,4 +35,5 @@
 
 void Init_GPIO(void);
 void Init_Clock(void);
-void Init_ADC(void);
+void Volt_Alarm(long, long, long);
+void Alarm_Toggle(void);
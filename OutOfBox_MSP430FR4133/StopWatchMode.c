@@ -53,6 +53,9 @@ volatile unsigned char * count = &BAKMEM7_H;            // Count variable
 
 void stopWatch()
 {
+    // RAM (and so the LCD shadow) does not survive LPM3.5
+    loadLCDShadow();
+
     while(*stopWatchRunning)
     {
         // stays in LPM3 while stopwatch is running and wakes up every 10ms to update clock and LCD
@@ -149,68 +152,77 @@ void resetStopWatch()
     *count = 0;
 
     // Update LCD with new time
+    // (also called from the S2 interrupt, maybe right after a wakeup from LPM3.5, so load the shadow here)
+    loadLCDShadow();
     displayTime();
 }
 
+/*
+ * Draws the time into the LCD shadow, then commits it
+ * Only the positions that changed are written to the LCD memory; on most 10ms ticks that is just pos6
+ * NOTE: The shadow must be loaded first (see stopWatch and resetStopWatch)
+ */
 void displayTime()
 {
     // Display Minute, Second, Centiseconds if below 1 hour mark.
     if ((*Hours) == 0)
     {
-        showChar((*Centiseconds) % 10 + '0',pos6);
-        showChar((*Centiseconds) / 10 + '0',pos5);
-        showChar((*Seconds) % 10 + '0',pos4);
-        showChar((*Seconds) / 10 + '0',pos3);
-        showChar((*Minutes) % 10 + '0',pos2);
-        showChar((*Minutes) / 10 + '0',pos1);
+        showCharShadow((*Centiseconds) % 10 + '0',pos6);
+        showCharShadow((*Centiseconds) / 10 + '0',pos5);
+        showCharShadow((*Seconds) % 10 + '0',pos4);
+        showCharShadow((*Seconds) / 10 + '0',pos3);
+        showCharShadow((*Minutes) % 10 + '0',pos2);
+        showCharShadow((*Minutes) / 10 + '0',pos1);
     }
     // Otherwise, display Hour, Minute, Second
     else
     {
-        showChar((*Seconds) % 10 + '0',pos6);
-        showChar((*Seconds) / 10 + '0',pos5);
-        showChar((*Minutes) % 10 + '0',pos4);
-        showChar((*Minutes) / 10 + '0',pos3);
-        showChar((*Hours) % 10 + '0',pos2);
-        showChar((*Hours) / 10 + '0',pos1);
+        showCharShadow((*Seconds) % 10 + '0',pos6);
+        showCharShadow((*Seconds) / 10 + '0',pos5);
+        showCharShadow((*Minutes) % 10 + '0',pos4);
+        showCharShadow((*Minutes) / 10 + '0',pos3);
+        showCharShadow((*Hours) % 10 + '0',pos2);
+        showCharShadow((*Hours) / 10 + '0',pos1);
     }
 
 // Workaround LCDBMEM definition bug in IAR header file
 #ifdef __IAR_SYSTEMS_ICC__
     if ((*Centiseconds) == 0)
     {
-        LCDMEM[12] |= 0x08;
+        LCD_SHADOW[12] |= 0x08;
         LCDBM12 |= 0x08;
     }
     if ((*Centiseconds) == 50)
     {
-        LCDMEM[12] &= ~0x08;
+        LCD_SHADOW[12] &= ~0x08;
         LCDBM12 &= ~0x08;
     }
 
     // Display the 2 colons
-    LCDMEM[7] |= 0x04;
+    LCD_SHADOW[7] |= 0x04;
     LCDM39 |= 0x04;
 
-    LCDMEM[11] |= 0x04;
+    LCD_SHADOW[11] |= 0x04;
     LCDBM11 |= 0x04;
 #else    
     // Blink Stopwatch symbol
     if ((*Centiseconds) == 0)
     {
-        LCDMEM[12] |= 0x08;
+        LCD_SHADOW[12] |= 0x08;
         LCDBMEM[12] |= 0x08;
     }
     if ((*Centiseconds) == 50)
     {
-        LCDMEM[12] &= ~0x08;
+        LCD_SHADOW[12] &= ~0x08;
         LCDBMEM[12] &= ~0x08;
     }
 
     // Display the 2 colons
-    LCDMEM[7] |= 0x04;
+    LCD_SHADOW[7] |= 0x04;
     LCDBMEM[7] |= 0x04;
-    LCDMEM[11] |= 0x04;
+    LCD_SHADOW[11] |= 0x04;
     LCDBMEM[11] |= 0x04;
 #endif
+
+    commitLCD();
 }
@@ -0,0 +1,247 @@
+/*******************************************************************************
+ *
+ * TempLog.c
+ *
+ * Temperature log in FRAM, for unattended use of the temperature sensor mode
+ *
+ * The log is a ring of TEMP_LOG_BLOCKS blocks. Each block holds a timestamp, one
+ * full sample and up to TEMP_LOG_DELTAS one byte changes from the sample before,
+ * so a slowly changing temperature costs one byte per sample. A change that does
+ * not fit in a byte simply starts a new block.
+ *
+ * There is no head pointer in FRAM (which would be rewritten on every sample and
+ * could be left torn by a power loss). Instead every block has a sequence number,
+ * one more than the block before it, so after a reset the newest block is found
+ * by a binary search (see tempLogRecover), and the newest sample in it is the
+ * last delta slot that is not TEMP_LOG_EMPTY.
+ *
+ * A block is rewritten in this order, so that a power loss anywhere leaves it
+ * invalid rather than wrong:
+ *      check = seq ^ ~TEMP_LOG_MAGIC (invalid), seq, deltas = TEMP_LOG_EMPTY,
+ *      time, first, then check = seq ^ TEMP_LOG_MAGIC (valid)
+ * Adding a sample to a block is a single byte write.
+ *
+ * Timestamps count the seconds of logging (TEMP_LOG_SECONDS per sample); there is
+ * no calendar clock, so time stops while the log is not running.
+ *
+ * The log is read back newest first with tempLogGet; while the temperature sensor
+ * is paused, S2 steps through it on the LCD (tempLogShow in TempSensorMode.c).
+ *
+ ******************************************************************************/
+
+#include "TempLog.h"
+#include "main.h"
+
+#if defined(__TI_COMPILER_VERSION__)
+#pragma PERSISTENT(tempLog)
+TEMP_LOG_BLOCK tempLog[TEMP_LOG_BLOCKS] = {0};
+#elif defined(__IAR_SYSTEMS_ICC__)
+__persistent TEMP_LOG_BLOCK tempLog[TEMP_LOG_BLOCKS] = {0};
+#elif defined(__GNUC__)
+TEMP_LOG_BLOCK tempLog[TEMP_LOG_BLOCKS] __attribute__((section(".persistent"))) = {0};
+#else
+#error Compiler not supported!
+#endif
+
+// Position of the newest sample, rebuilt by tempLogRecover
+static unsigned int head = 0;                   // Newest block
+static unsigned char fill = 0;                  // Deltas used in the newest block
+static int last = 0;                            // Newest sample
+static unsigned char empty = 1;                 // No valid block in the log
+
+/*
+ * Checks if a block was completely written
+ */
+static unsigned char logValid(unsigned int i)
+{
+    return tempLog[i].check == (tempLog[i].seq ^ TEMP_LOG_MAGIC);
+}
+
+/*
+ * Returns the number of deltas used in a block
+ */
+static unsigned char logFill(const TEMP_LOG_BLOCK *b)
+{
+    unsigned char n = 0;
+    while (n < TEMP_LOG_DELTAS && b->delta[n] != TEMP_LOG_EMPTY)
+        n++;
+    return n;
+}
+
+static void logWrite16(unsigned int *fram, unsigned int value)
+{
+    FRAMCtl_write16(&value, fram, 1);
+}
+
+/*
+ * Starts the next block of the ring with sample deg
+ */
+static void logNewBlock(int deg)
+{
+    TEMP_LOG_BLOCK *b;
+    unsigned int seq = 0;
+    unsigned long time = 0;
+    signed char blank[TEMP_LOG_DELTAS];
+    unsigned char i;
+
+    if (!empty)
+    {
+        seq = tempLog[head].seq + 1;
+        time = tempLog[head].time + (unsigned long)(fill + 1) * TEMP_LOG_SECONDS;
+        head = (head + 1) % TEMP_LOG_BLOCKS;
+    }
+    else
+        head = 0;
+
+    b = &tempLog[head];
+
+    for (i=0; i<TEMP_LOG_DELTAS; i++)
+        blank[i] = TEMP_LOG_EMPTY;
+
+    logWrite16(&b->check, seq ^ ~TEMP_LOG_MAGIC);
+    logWrite16(&b->seq, seq);
+    FRAMCtl_write8((uint8_t *)blank, (uint8_t *)b->delta, TEMP_LOG_DELTAS);
+    FRAMCtl_write32((uint32_t *)&time, (uint32_t *)&b->time, 1);
+    logWrite16((unsigned int *)&b->first, deg);
+    logWrite16(&b->check, seq ^ TEMP_LOG_MAGIC);
+
+    fill = 0;
+    last = deg;
+    empty = 0;
+}
+
+/*
+ * Finds the newest sample of the log, eg. after a reset or LPM3.5 (RAM is lost, FRAM is not)
+ * Blocks 0..head were written in the current lap of the ring, so their seq count up from
+ * block 0's; the blocks after head are from the lap before (or not written, or torn).
+ * That makes "seq == seq of block 0 + i" true up to head and false after it: a binary search
+ * Block i always holds a seq of i modulo TEMP_LOG_BLOCKS, which 65536 is a multiple of, so block 0's
+ * seq + i does not wrap either when seq does
+ */
+void tempLogRecover()
+{
+    unsigned int lo, hi, mid;
+    unsigned int seq0;
+
+    if (logValid(0))
+    {
+        seq0 = tempLog[0].seq;
+        lo = 0;                                 // Known to be in the current lap
+        hi = TEMP_LOG_BLOCKS;                   // Known not to be
+        while (hi - lo > 1)
+        {
+            mid = (lo + hi) / 2;
+            if (logValid(mid) && tempLog[mid].seq == seq0 + mid)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        head = lo;
+    }
+    else if (logValid(TEMP_LOG_BLOCKS-1))
+        head = TEMP_LOG_BLOCKS-1;               // Block 0 was torn starting a new lap
+    else
+    {
+        empty = 1;                              // Nothing logged yet
+        head = 0;
+        fill = 0;
+        return;
+    }
+
+    empty = 0;
+    fill = logFill(&tempLog[head]);
+
+    last = tempLog[head].first;
+    for (mid=0; mid<fill; mid++)
+        last += tempLog[head].delta[mid];
+}
+
+/*
+ * Adds a sample (0.1 C) to the log
+ */
+void tempLogAdd(int deg)
+{
+    int d = deg - last;
+    signed char delta = (signed char)d;
+
+    if (empty || fill >= TEMP_LOG_DELTAS || d <= TEMP_LOG_EMPTY || d > 127)
+    {
+        logNewBlock(deg);
+        return;
+    }
+
+    FRAMCtl_write8((uint8_t *)&delta, (uint8_t *)&tempLog[head].delta[fill], 1);
+    fill++;
+    last = deg;
+}
+
+/*
+ * Returns the number of samples in the log
+ */
+unsigned int tempLogCount()
+{
+    unsigned int n, i, k;
+    unsigned int seq;
+
+    if (empty)
+        return 0;
+
+    n = fill + 1;
+    i = head;
+    seq = tempLog[head].seq;
+    for (k=1; k<TEMP_LOG_BLOCKS; k++)
+    {
+        i = i ? i-1 : TEMP_LOG_BLOCKS-1;
+        seq--;
+        if (!logValid(i) || tempLog[i].seq != seq)
+            break;
+        n += logFill(&tempLog[i]) + 1;
+    }
+    return n;
+}
+
+/*
+ * Reads a sample from the log
+ * age: 0 for the newest sample, 1 for the one before, ...
+ * deg, time: the sample (0.1 C) and its timestamp (s)
+ * Returns 1 if the sample exists, 0 if the log is shorter
+ */
+unsigned char tempLogGet(unsigned int age, int *deg, unsigned long *time)
+{
+    const TEMP_LOG_BLOCK *b;
+    unsigned int i, k;
+    unsigned int seq;
+    unsigned char n, j;
+    int value;
+
+    if (empty)
+        return 0;
+
+    i = head;
+    seq = tempLog[head].seq;
+    n = fill + 1;
+    for (k=0; k<TEMP_LOG_BLOCKS; k++)
+    {
+        b = &tempLog[i];
+        if (age < n)
+        {
+            // Sample n-1-age of the block: first plus the deltas before it
+            n -= 1 + age;
+            value = b->first;
+            for (j=0; j<n; j++)
+                value += b->delta[j];
+
+            *deg = value;
+            *time = b->time + (unsigned long)n * TEMP_LOG_SECONDS;
+            return 1;
+        }
+        age -= n;
+
+        i = i ? i-1 : TEMP_LOG_BLOCKS-1;
+        seq--;
+        if (!logValid(i) || tempLog[i].seq != seq)
+            break;
+        n = logFill(&tempLog[i]) + 1;
+    }
+    return 0;
+}
@@ -0,0 +1,38 @@
+/*******************************************************************************
+ *
+ * TempLog.h
+ *
+ * Temperature log in FRAM: a ring of delta encoded blocks that survives
+ * power loss (see TempLog.c)
+ *
+ ******************************************************************************/
+
+#include <msp430fr4133.h>
+
+#ifndef TEMPLOG_H_
+#define TEMPLOG_H_
+
+#define TEMP_LOG_BLOCKS        32      // Blocks in the ring
+#define TEMP_LOG_DELTAS        12      // Samples per block after the first (13 per block, 416 in all)
+#define TEMP_LOG_INTERVAL      240     // Temperature updates (250 ms) per logged sample = 60 s
+#define TEMP_LOG_SECONDS       60      // TEMP_LOG_INTERVAL in seconds, for the timestamps
+
+#define TEMP_LOG_EMPTY         (-128)  // Unused delta slot
+#define TEMP_LOG_MAGIC         0x5AC3  // check = seq ^ TEMP_LOG_MAGIC once a block header is complete
+
+// One block: a full sample, then the change of each next sample
+typedef struct
+{
+    unsigned int  seq;                      // Block sequence number, +1 for every block written
+    unsigned long time;                     // Timestamp of `first`, in seconds of logging
+    int           first;                    // First sample, 0.1 C
+    unsigned int  check;                    // Written last: seq ^ TEMP_LOG_MAGIC if the block is valid
+    signed char   delta[TEMP_LOG_DELTAS];   // Each next sample minus the one before, TEMP_LOG_EMPTY if not yet
+} TEMP_LOG_BLOCK;
+
+void tempLogRecover(void);
+void tempLogAdd(int);
+unsigned int tempLogCount(void);
+unsigned char tempLogGet(unsigned int, int *, unsigned long *);
+
+#endif /* TEMPLOG_H_ */
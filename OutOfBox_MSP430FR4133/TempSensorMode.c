@@ -42,16 +42,38 @@
  ******************************************************************************/
 
 #include "TempSensorMode.h"
+#include "TempLog.h"
 #include "hal_LCD.h"
 #include "main.h"
-
-                                                        // See device datasheet for TLV table memory mapping
-#define CALADC_15V_30C  *((unsigned int *)0x1A1A)       // Temperature Sensor Calibration-30 C
-#define CALADC_15V_85C  *((unsigned int *)0x1A1C)       // Temperature Sensor Calibration-85 C
+#include "MPY32.h"
 
 volatile unsigned char * tempUnit = &BAKMEM4_H;         // Temperature Unit
 volatile unsigned short *degC = (volatile unsigned short *) &BAKMEM5;                          // Celsius measurement
 volatile unsigned short *degF = (volatile unsigned short *) &BAKMEM6;                          // Fahrenheit measurement
+volatile unsigned int * tempLogAge = &BAKMEM8;          // Log sample shown while paused, +1 (0: the last reading)
+
+// Oversampling and decimation (see tempSensorAccumulate)
+static unsigned int adcSum = 0;                 // Running sum of the samples of the next value
+static unsigned char adcCount = 0;              // Number of samples in adcSum
+static volatile unsigned int adcOut = 0;        // Last decimated value, 10+TEMP_OVERSAMPLE_BITS bits
+static volatile unsigned char adcReady = 0;     // Set when adcOut has a new value
+static unsigned int logTick = 0;                // Temperature updates since the last logged sample
+
+// Temperature sensor calibration, from the TLV (see tempCalInit)
+static unsigned int cal30, cal85;               // 10-bit conversions at 30 C and 85 C
+static long gainC[TEMP_PWL_SEGMENTS], offC[TEMP_PWL_SEGMENTS];  // Q16, adcOut to 0.1 C
+static long gainF[TEMP_PWL_SEGMENTS], offF[TEMP_PWL_SEGMENTS];  // Q16, adcOut to 0.1 F
+
+// Correction (0.1 C) added to the calibrated line at each segment boundary, adcOut = i << TEMP_PWL_SHIFT,
+// and interpolated in between; all 0 for the plain two point TLV calibration
+static const signed char tempCorrection[TEMP_PWL_SEGMENTS + 1] = {0};
+
+// Temperature alarm (see tempAlarmSet), in 10-bit ADC conversions
+static volatile unsigned char tempAlarm = TEMP_ALARM_NONE;
+static unsigned int alarmLo, alarmHi;           // Alarm band
+static unsigned int alarmLoRelease, alarmHiRelease; // Band moved in by the hysteresis
+
+static void displayDeg(int, char);
 
 // TimerA UpMode Configuration Parameter
 Timer_A_initUpModeParam initUpParam_A1 =
@@ -73,6 +95,9 @@ Timer_A_initCompareModeParam initCompParam =
 };
 
 void tempSensor(){
+    // Calibration, before the alarm band is converted with it
+    tempCalInit();
+
     //Initialize the ADC Module
         /*
          * Base Address for the ADC Module
@@ -100,9 +125,10 @@ void tempSensor(){
         ADCMCTL0 |= ADCINCH_12 | ADCSREF_1;
         ADCCTL2 |= ADCRES_1; //10-bit
 
-        //Enable and clear all interrupts
-        ADCIE |= ADCIE0;
+        //Enable and clear all interrupts (conversion done, and below/above the alarm window)
+        ADCIE |= ADCIE0 | ADCLOIE | ADCHIIE;
         ADCIFG &= 0x0000;
+        tempAlarmSet(TEMP_ALARM_LO, TEMP_ALARM_HI, TEMP_ALARM_HYST);
 
         //Start & Enable Conversion
         ADCCTL0 |= ADCENC | ADCSC;
@@ -112,7 +138,8 @@ void tempSensor(){
         PMMCTL2 |= INTREFEN | TSENSOREN;
         PMMCTL0_H = 0x00;   //Reset, otherwise the FRAM will reset, and the code will start again from top.
 
-        TA1CCR0 = 0x2000; //Period
+        // One conversion per TEMP_OVERSAMPLE_CNT-th of the 0x2000 (250 ms) display period
+        TA1CCR0 = 0x2000 / TEMP_OVERSAMPLE_CNT; //Period
 
         TA1CTL |= TASSEL__ACLK | ID__1 | MC__UP | TACLR;
                // ACLK,    DIVIDER 1   UP_MODE,  CLEAR TIMER
@@ -126,34 +153,67 @@ void tempSensor(){
         TA1CCTL1 &= ~(CAP); //COMPARE MODE
         TA1CCTL1 |= OUTMOD_7; //OUTPUT MODE 7 (Reset/set)
         TA1CCTL1 &= ~(CCIE | CCIFG); //DISABLE NTERRUPTS, CLEAR FLAG
-        TA1CCR1 = 0x1000; //COMPARE VALUE
+        TA1CCR1 = 0x1000 / TEMP_OVERSAMPLE_CNT; //COMPARE VALUE
 
         // Delay for reference settling
         __delay_cycles(300000);
 
+        // Find the end of the FRAM temperature log (RAM is lost in LPM3.5)
+        tempLogRecover();
+
+        // Paused: S2 steps back through the log (see PORT2_ISR), then back to the last reading
+        if (!*tempSensorRunning && *tempLogAge)
+        {
+            if (!tempLogShow(*tempLogAge - 1))
+            {
+                *tempLogAge = 0;
+                displayTemp();
+            }
+        }
+
+        // Drop the samples taken while the reference was settling
+        __disable_interrupt();
+        adcSum = 0;
+        adcCount = 0;
+        adcReady = 0;
+        __enable_interrupt();
+
     //Enter LPM3.5 mode with interrupts enabled
     while(*tempSensorRunning)
     {
         __bis_SR_register(LPM3_bits | GIE);                       // LPM3 with interrupts enabled
         __no_operation();                                         // Only for debugger
 
-        if (*tempSensorRunning)
+        if (*tempSensorRunning && adcReady)
         {
         	// Turn LED1 on when waking up to calculate temperature and update display
             P1OUT |= BIT0;
+            adcReady = 0;
 
             // Calculate Temperature in degree C and F
-            signed short temp = (ADCMEM0 - CALADC_15V_30C);
-            *degC = ((long)temp * 10 * (85-30) * 10)/((CALADC_15V_85C-CALADC_15V_30C)*10) + 300;
-            *degF = (*degC) * 9 / 5 + 320;
+            tempConvert(adcOut);
 
             // Update temperature on LCD
             displayTemp();
 
-            P1OUT &= ~BIT0;
+            // Log one sample every TEMP_LOG_INTERVAL updates
+            if (++logTick >= TEMP_LOG_INTERVAL)
+            {
+                logTick = 0;
+                tempLogAdd((int)*degC);
+            }
         }
+
+        // LED1 stays on while the temperature is out of the alarm band
+        if (tempAlarm != TEMP_ALARM_NONE)
+            P1OUT |= BIT0;
+        else
+            P1OUT &= ~BIT0;
     }
 
+    // Back to LCDMEM for the other modes
+    endLCDBack();
+
     // Loop in LPM3 to while buttons are held down and debounce timer is running
     while(TA0CTL & MC__UP)
     {
@@ -178,9 +238,153 @@ void tempSensor(){
     }
 }
 
+/*
+ * Adds one ADC sample to the running sum; called by the ADC ISR on every conversion
+ * Every TEMP_OVERSAMPLE_CNT samples the sum is decimated into adcOut, so the CPU only
+ * has to wake up once per displayed value instead of once per conversion
+ * 4^n samples of 10 bits sum to at most 16 bits for n <= 3, so adcSum needs no long
+ * Returns 1 when adcOut has a new value
+ */
+unsigned char tempSensorAccumulate(unsigned int sample)
+{
+    adcSum += sample;
+    if (++adcCount < TEMP_OVERSAMPLE_CNT)
+        return 0;
+
+    adcOut = adcSum >> TEMP_OVERSAMPLE_BITS;
+    adcSum = 0;
+    adcCount = 0;
+    adcReady = 1;
+    return 1;
+}
+
+/*
+ * Fills gain/off of every segment: the line through (cal30, at30) with slope scale (Q16), plus
+ * tempCorrection converted by num/den (1/1 for C, 9/5 for F), rounded to nearest
+ */
+static void tempCalSegments(long *gain, long *off, int at30, unsigned long scale, int num, int den)
+{
+    long base = (long)cal30 << TEMP_OVERSAMPLE_BITS;
+    long corr, slope;
+    unsigned char i;
+
+    for (i=0; i<TEMP_PWL_SEGMENTS; i++)
+    {
+        corr = ((long)tempCorrection[i] * num << 16) / den;
+        slope = ((long)(tempCorrection[i+1] - tempCorrection[i]) * num << (16 - TEMP_PWL_SHIFT)) / den;
+
+        gain[i] = scale + slope;
+        off[i] = ((long)at30 << 16) + corr + 0x8000
+                - base * (long)scale - ((long)i << TEMP_PWL_SHIFT) * slope;
+    }
+}
+
+/*
+ * Reads the sensor calibration from the TLV (TLV_getInfo) and precomputes the conversion of adcOut,
+ * so the divisions happen once here rather than on every sample
+ * 85 C - 30 C = 550 (0.1 C) = 990 (0.1 F) over (cal85 - cal30) << TEMP_OVERSAMPLE_BITS counts
+ */
+void tempCalInit()
+{
+    struct s_TLV_ADC_Cal_Data *cal = 0;
+    uint8_t len = 0;
+    unsigned long span;
+
+    TLV_getInfo(TLV_TAG_ADCCAL, 0, &len, (uint16_t **)&cal);
+    if (cal && len >= 4 * sizeof(uint16_t) && cal->adc_ref15_85_temp > cal->adc_ref15_30_temp)
+    {
+        cal30 = cal->adc_ref15_30_temp;
+        cal85 = cal->adc_ref15_85_temp;
+    }
+    else
+    {
+        cal30 = TEMP_CAL_30C_TYP;
+        cal85 = TEMP_CAL_85C_TYP;
+    }
+
+    span = (unsigned long)(cal85 - cal30) << TEMP_OVERSAMPLE_BITS;
+    tempCalSegments(gainC, offC, 300, ((550UL << 16) + span/2) / span, 1, 1);
+    tempCalSegments(gainF, offF, 860, ((990UL << 16) + span/2) / span, 9, 5);
+}
+
+/*
+ * Converts adcOut (10+TEMP_OVERSAMPLE_BITS bits) into *degC and *degF, with the segment it is in
+ */
+void tempConvert(unsigned int adc)
+{
+    unsigned char seg = adc >> TEMP_PWL_SHIFT;
+
+    *degC = (MPY_Mul32(gainC[seg], adc) + offC[seg]) >> 16;
+    *degF = (MPY_Mul32(gainF[seg], adc) + offF[seg]) >> 16;
+}
+
+/*
+ * Converts a temperature in 0.1 C to a 10-bit ADC conversion of the sensor, using the TLV calibration
+ */
+static unsigned int tempToADC(int deg)
+{
+    long adc = cal30 + ((long)(deg - 300) * (cal85 - cal30)) / (10 * (85-30));
+
+    if (adc < 0)
+        return 0;
+    if (adc > 1023)
+        return 1023;
+    return adc;
+}
+
+/*
+ * Sets the temperature alarm band, in 0.1 C
+ * The ADC window comparator checks every conversion against it in hardware, and only interrupts
+ * (ADCLOIFG/ADCHIIFG, see tempAlarmEvent) when one falls outside; the CPU is not needed for that
+ * Once out of the band, the window moves `hyst` back into it, so the alarm does not chatter:
+ *      TEMP_ALARM_NONE: window lo..hi
+ *      TEMP_ALARM_LOW:  window 0..lo+hyst
+ *      TEMP_ALARM_HIGH: window hi-hyst..1023
+ */
+void tempAlarmSet(int lo, int hi, int hyst)
+{
+    alarmLo = tempToADC(lo);
+    alarmHi = tempToADC(hi);
+    alarmLoRelease = tempToADC(lo + hyst);
+    alarmHiRelease = tempToADC(hi - hyst);
+
+    tempAlarm = TEMP_ALARM_NONE;
+    ADCLO = alarmLo;
+    ADCHI = alarmHi;
+}
+
+/*
+ * Moves the temperature alarm when a conversion left the window; called by the ADC ISR
+ * above is 1 for ADCHIIFG, 0 for ADCLOIFG
+ */
+void tempAlarmEvent(unsigned char above)
+{
+    if (above)
+        tempAlarm = (tempAlarm == TEMP_ALARM_LOW) ? TEMP_ALARM_NONE : TEMP_ALARM_HIGH;
+    else
+        tempAlarm = (tempAlarm == TEMP_ALARM_HIGH) ? TEMP_ALARM_NONE : TEMP_ALARM_LOW;
+
+    switch (tempAlarm)
+    {
+        case TEMP_ALARM_LOW:
+            ADCLO = 0;
+            ADCHI = alarmLoRelease;
+            break;
+        case TEMP_ALARM_HIGH:
+            ADCLO = alarmHiRelease;
+            ADCHI = 1023;
+            break;
+        default:
+            ADCLO = alarmLo;
+            ADCHI = alarmHi;
+            break;
+    }
+}
+
 void tempSensorModeInit()
 {
     *tempSensorRunning = 1;
+    *tempLogAge = 0;
 
     displayScrollText("TEMPSENSOR MODE");
 
@@ -192,42 +396,77 @@ void tempSensorModeInit()
 
 void displayTemp()
 {
-    clearLCD();
-
     // Pick C or F depending on tempUnit state
     int deg;
     if (*tempUnit == 0)
-    {
-        showChar('C',pos6);
         deg = *degC;
-    }
     else
-    {
-        showChar('F',pos6);
         deg = *degF;
-    }
+
+    displayDeg(deg, 0);
+}
+
+/*
+ * Shows sample `age` of the FRAM log (0: the newest), with an 'L' in front of it
+ * The log is in 0.1 C; for F it is converted here, rounded to nearest
+ * Returns 0 if the log has no such sample
+ */
+unsigned char tempLogShow(unsigned int age)
+{
+    int deg;
+    unsigned long time;
+
+    if (!tempLogGet(age, &deg, &time))
+        return 0;
+
+    if (*tempUnit != 0)
+        deg = (deg * 9 + (deg < 0 ? -2 : 2)) / 5 + 320;
+
+    displayDeg(deg, 'L');
+    return 1;
+}
+
+/*
+ * Shows a temperature (0.1 C or F, per tempUnit); mark is shown at pos1, if not 0
+ */
+static void displayDeg(int deg, char mark)
+{
+    // Draw the whole frame into the hidden LCD memory, then flip to it (see hal_LCD.c)
+    char *lcd = LCDBACK;
+    lcd[pos1] = lcd[pos1+1] = 0;
+    lcd[pos2] = lcd[pos2+1] = 0;
+    lcd[pos3] = lcd[pos3+1] = 0;
+    lcd[pos4] = lcd[pos4+1] = 0;
+    lcd[pos5] = lcd[pos5+1] = 0;
+    lcd[12] = lcd[13] = 0;
+
+    showCharBack((*tempUnit == 0) ? 'C' : 'F', pos6);
+    if (mark)
+        showCharBack(mark, pos1);
 
     // Handle negative values
     if (deg < 0)
     {
         deg *= -1;
         // Negative sign
-        LCDMEM[pos1+1] |= 0x04;
+        lcd[pos1+1] |= 0x04;
     }
 
     // Handles displaying up to 999.9 degrees
     if (deg>=1000)
-        showChar((deg/1000)%10 + '0',pos2);
+        showCharBack((deg/1000)%10 + '0',pos2);
     if (deg>=100)
-        showChar((deg/100)%10 + '0',pos3);
+        showCharBack((deg/100)%10 + '0',pos3);
     if (deg>=10)
-        showChar((deg/10)%10 + '0',pos4);
+        showCharBack((deg/10)%10 + '0',pos4);
     if (deg>=1)
-        showChar((deg/1)%10 + '0',pos5);
+        showCharBack((deg/1)%10 + '0',pos5);
 
     // Decimal point
-    LCDMEM[pos4+1] |= 0x01;
+    lcd[pos4+1] |= 0x01;
 
     // Degree symbol
-    LCDMEM[pos5+1] |= 0x04;
+    lcd[pos5+1] |= 0x04;
+
+    flipLCD();
 }
@@ -48,10 +48,40 @@
 
 #define TEMPSENSOR_MODE        2
 
+// Oversampling: each displayed value is the sum of 4^TEMP_OVERSAMPLE_BITS samples, shifted down
+// by TEMP_OVERSAMPLE_BITS, ie. a 10+TEMP_OVERSAMPLE_BITS bit result
+#define TEMP_OVERSAMPLE_BITS   3
+#define TEMP_OVERSAMPLE_CNT    (1 << (2*TEMP_OVERSAMPLE_BITS))
+
+// Temperature alarm band (ADC window comparator), in 0.1 C; LED1 stays on while out of it
+#define TEMP_ALARM_LO          150     // 15.0 C
+#define TEMP_ALARM_HI          350     // 35.0 C
+#define TEMP_ALARM_HYST        5       // 0.5 C back into the band to end the alarm
+
+// Temperature conversion (see tempCalInit): adcOut is split into 2^(10+TEMP_OVERSAMPLE_BITS-TEMP_PWL_SHIFT)
+// segments, each with its own Q16 gain and offset, so a sample costs one multiply, an add and a shift
+#define TEMP_PWL_SHIFT         10
+#define TEMP_PWL_SEGMENTS      (1 << (10 + TEMP_OVERSAMPLE_BITS - TEMP_PWL_SHIFT))
+
+// Typical sensor conversions (1.5 V reference), only used if the TLV has no ADC calibration
+#define TEMP_CAL_30C_TYP       539
+#define TEMP_CAL_85C_TYP       638
+
+#define TEMP_ALARM_NONE        0
+#define TEMP_ALARM_LOW         1
+#define TEMP_ALARM_HIGH        2
+
 extern volatile unsigned char * tempUnit;
+extern volatile unsigned int * tempLogAge;
 
 void tempSensor(void);
 void tempSensorModeInit(void);
+void tempCalInit(void);
+void tempConvert(unsigned int);
 void displayTemp(void);
+unsigned char tempLogShow(unsigned int);
+unsigned char tempSensorAccumulate(unsigned int);
+void tempAlarmSet(int, int, int);
+void tempAlarmEvent(unsigned char);
 
 #endif /* TEMPSENSORMODE_H_ */
@@ -90,6 +90,33 @@ const char alphabetBig[26][2] =
     {0x90, 0x28}   /* "Z" */
 };
 
+// LCD memory map for showChar, indexed by ASCII code (built from digit and alphabetBig)
+// Low byte is the segments of LCDMEM[position], high byte of LCDMEM[position+1]
+// Characters other than space, numeric digits and uppercase letters turn all segments on
+const unsigned int lcdChar[128] =
+{
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,  /* 0x00-0x07: control */
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,  /* 0x08-0x0F: control */
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,  /* 0x10-0x17: control */
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,  /* 0x18-0x1F: control */
+    0x0000, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,  /* 0x20: SP ! " # $ % & ' */
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,  /* 0x28: ( ) * + , - . / */
+    0x28FC, 0x2060, 0x00DB, 0x00F3, 0x0067, 0x00B7, 0x00BF, 0x00E4,  /* 0x30: 0 1 2 3 4 5 6 7 */
+    0x00FF, 0x00F7, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,  /* 0x38: 8 9 : ; < = > ? */
+    0xFFFF, 0x00EF, 0x50F1, 0x009C, 0x50F0, 0x009F, 0x008F, 0x00BD,  /* 0x40: @ A B C D E F G */
+    0x006F, 0x5090, 0x0078, 0x220E, 0x001C, 0xA06C, 0x826C, 0x00FC,  /* 0x48: H I J K L M N O */
+    0x00CF, 0x02FC, 0x02CF, 0x00B7, 0x5080, 0x007C, 0x280C, 0x0A6C,  /* 0x50: P Q R S T U V W */
+    0xAA00, 0xB000, 0x2890, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,  /* 0x58: X Y Z [ \ ] ^ _ */
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,  /* 0x60: ` a b c d e f g */
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,  /* 0x68: h i j k l m n o */
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,  /* 0x70: p q r s t u v w */
+    0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF   /* 0x78: x y z { | } ~ DEL */
+};
+
+// RAM shadow of LCDMEM[0]~LCDMEM[19], one word per digit position
+// Draw into it with showCharShadow() (or byte access through LCD_SHADOW), then commitLCD()
+unsigned int lcdShadow[LCD_SHADOW_WORDS];
+
 void Init_LCD()
 {
     // L0~L26 & L36~L39 pins selected
@@ -128,40 +155,92 @@ void Init_LCD()
     LCD_E_on(LCD_E_BASE);
 }
 
+// Set by the WDT interval interrupt to step displayScrollText
+static volatile unsigned char scrollTick = 0;
+
+/*
+ * Draws one frame of displayScrollText into the hidden LCD memory
+ * s is the digit the first character of msg lands on (0 = pos1, may be off screen)
+ */
+static void scrollFrame(const char *msg, int length, int s)
+{
+    char buffer[6] = "      ";
+    int j;
+    for (j=0; j<length; j++)
+    {
+        if (((s+j) >= 0) && ((s+j) < 6))
+            buffer[s+j] = msg[j];
+    }
+
+    showCharBack(buffer[0], pos1);
+    showCharBack(buffer[1], pos2);
+    showCharBack(buffer[2], pos3);
+    showCharBack(buffer[3], pos4);
+    showCharBack(buffer[4], pos5);
+    showCharBack(buffer[5], pos6);
+}
+
 /*
  * Scrolls input string across LCD screen from left to right
+ * One step per WDT interval (ACLK/8192 = 250 ms); the CPU waits in LPM3 between steps
+ * Stops early if the mode changes
  */
 void displayScrollText(char *msg)
 {
     int length = strlen(msg);
     int oldmode = *mode;
     int i;
-    int s = 5;
-    char buffer[6] = "      ";
-    for (i=0; i<length+7; i++)
+
+    // Start WDT as the scroll step timer
+    WDT_A_initIntervalTimer(__MSP430_BASEADDRESS_WDT_A__, WDT_A_CLOCKSOURCE_ACLK, WDT_A_CLOCKDIVIDER_8192);
+    SFR_clearInterrupt(SFR_WATCHDOG_INTERVAL_TIMER_INTERRUPT);
+    SFR_enableInterrupt(SFR_WATCHDOG_INTERVAL_TIMER_INTERRUPT);
+    WDT_A_start(__MSP430_BASEADDRESS_WDT_A__);
+
+    // Frames are drawn into the hidden LCD memory one step ahead,
+    // so each WDT step only has to flip the display memory
+    beginLCDBack();
+    scrollFrame(msg, length, 5);
+    flipLCD();
+
+    for (i=1; i<=length+7; i++)
     {
-        if (*mode != oldmode)
-            break;
-        int t;
-        for (t=0; t<6; t++)
-            buffer[t] = ' ';
-        int j;
-        for (j=0; j<length; j++)
+        // Draw the next frame while the current one is shown
+        if (i < length+7)
+            scrollFrame(msg, length, 5-i);
+
+        // Sleep until the next step; other interrupts (RTC, buttons) may wake us up earlier
+        scrollTick = 0;
+        __disable_interrupt();
+        while (!scrollTick && *mode == oldmode)
         {
-            if (((s+j) >= 0) && ((s+j) < 6))
-                buffer[s+j] = msg[j];
+            __bis_SR_register(LPM3_bits | GIE);     // enter LPM3
+            __disable_interrupt();
         }
-        s--;
+        __enable_interrupt();
 
-        showChar(buffer[0], pos1);
-        showChar(buffer[1], pos2);
-        showChar(buffer[2], pos3);
-        showChar(buffer[3], pos4);
-        showChar(buffer[4], pos5);
-        showChar(buffer[5], pos6);
-
-        __delay_cycles(200000);
+        if (*mode != oldmode)
+            break;
+        if (i < length+7)
+            flipLCD();
     }
+
+    endLCDBack();
+
+    // Stop WDT
+    WDT_A_hold(__MSP430_BASEADDRESS_WDT_A__);
+    SFR_disableInterrupt(SFR_WATCHDOG_INTERVAL_TIMER_INTERRUPT);
+}
+
+/*
+ * WDT Interrupt Service Routine
+ * Steps displayScrollText
+ */
+#pragma vector = WDT_VECTOR
+__interrupt void WDT_ISR(void)
+{
+    scrollTick = 1;
+    __bic_SR_register_on_exit(LPM3_bits);            // exit LPM3
 }
 
 /*
@@ -170,25 +249,104 @@ void displayScrollText(char *msg)
  */
 void showChar(char c, int position)
 {
-    if (c == ' ')
-    {
-        // Display space
-        LCDMEMW[position/2] = 0;
-    }
-    else if (c >= '0' && c <= '9')
-    {
-        // Display digit
-        LCDMEMW[position/2] = digit[c-48][0] | (digit[c-48][1] << 8);
-    }
-    else if (c >= 'A' && c <= 'Z')
+    // One table lookup and one word write per character
+    if ((unsigned char)c < 128)
+        LCDMEMW[position/2] = lcdChar[(unsigned char)c];
+    else
+        LCDMEMW[position/2] = 0xFFFF;
+}
+
+/*
+ * Same as showChar, but only into lcdShadow; shows on the LCD at the next commitLCD()
+ */
+void showCharShadow(char c, int position)
+{
+    if ((unsigned char)c < 128)
+        lcdShadow[position/2] = lcdChar[(unsigned char)c];
+    else
+        lcdShadow[position/2] = 0xFFFF;
+}
+
+/*
+ * Copies the LCD memory into lcdShadow
+ * Call before drawing into the shadow whenever LCDMEM may have been written directly
+ * (eg. by showChar/clearLCD, or after a wakeup from LPM3.5, which loses RAM but not LCDMEM)
+ */
+void loadLCDShadow()
+{
+    int i;
+    for (i=0; i<LCD_SHADOW_WORDS; i++)
+        lcdShadow[i] = LCDMEMW[i];
+}
+
+/*
+ * Writes the words of lcdShadow that differ from the LCD memory, leaving the rest untouched
+ */
+void commitLCD()
+{
+    int i;
+    for (i=0; i<LCD_SHADOW_WORDS; i++)
     {
-        // Display alphabet
-        LCDMEMW[position/2] = alphabetBig[c-65][0] | (alphabetBig[c-65][1] << 8);
+        if ((unsigned int)LCDMEMW[i] != lcdShadow[i])
+            LCDMEMW[i] = lcdShadow[i];
     }
+}
+
+/*
+ * PAGE FLIPPING
+ * LCD_E has two display memories, LCDMEM and LCDBMEM, and LCDDISP selects which one drives the glass
+ * (with blinking off, as set up by Init_LCD). A frame is drawn into the hidden one (LCDBACK) and shown
+ * with one register write, so the LCD never shows a half drawn frame.
+ *
+ * Everything else (showChar, clearLCD, commitLCD, the stopwatch split) assumes LCDMEM is shown, so:
+ *      beginLCDBack() before the first frame, to start from what is on the LCD
+ *      showCharBack()/LCDBACK[] + flipLCD() for every frame
+ *      endLCDBack() when done, to move the shown frame back into LCDMEM
+ */
+
+/*
+ * Copies the displayed LCD memory into the hidden one (including the COM lines in LCDMEM[0])
+ * Call before drawing only part of a frame into LCDBACK
+ */
+void beginLCDBack()
+{
+    int *back = LCDBACKW;
+    int *front = (back == LCDMEMW) ? LCDBMEMW : LCDMEMW;
+    int i;
+    for (i=0; i<LCD_SHADOW_WORDS; i++)
+        back[i] = front[i];
+}
+
+/*
+ * Same as showChar, but into the hidden LCD memory; shows on the LCD at the next flipLCD()
+ */
+void showCharBack(char c, int position)
+{
+    if ((unsigned char)c < 128)
+        LCDBACKW[position/2] = lcdChar[(unsigned char)c];
     else
+        LCDBACKW[position/2] = 0xFFFF;
+}
+
+/*
+ * Shows the hidden LCD memory; the one that was shown becomes LCDBACK
+ */
+void flipLCD()
+{
+    LCDMEMCTL ^= LCDDISP;
+}
+
+/*
+ * Leaves the LCD showing LCDMEM again, with the frame that is on the LCD now
+ */
+void endLCDBack()
+{
+    int i;
+    if (LCDMEMCTL & LCDDISP)
     {
-        // Turn all segments on if character is not a space, digit, or uppercase letter
-        LCDMEMW[position/2] = 0xFFFF;
+        for (i=0; i<LCD_SHADOW_WORDS; i++)
+            LCDMEMW[i] = LCDBMEMW[i];
+        LCDMEMCTL &= ~LCDDISP;
     }
 }
 
@@ -62,13 +62,32 @@
 #define LCDBMEMW ((int*)LCDBMEM)
 #endif
 
+// RAM shadow of the LCD memory (see hal_LCD.c)
+#define LCD_SHADOW_WORDS 10
+#define LCD_SHADOW ((unsigned char*)lcdShadow)
+
+extern unsigned int lcdShadow[LCD_SHADOW_WORDS];
+
+// The LCD memory that is not being displayed (LCDBMEM while LCDMEM is shown and vice versa)
+// Draw the next frame into it with showCharBack() (or LCDBACK[]), then flipLCD()
+#define LCDBACKW ((LCDMEMCTL & LCDDISP) ? LCDMEMW : LCDBMEMW)
+#define LCDBACK ((char*)LCDBACKW)
+
 extern const char digit[10][2];
 extern const char alphabetBig[26][2];
+extern const unsigned int lcdChar[128];
 
 void Init_LCD(void);
 void displayScrollText(char*);
 void showChar(char, int);
 void clearLCD(void);
+void showCharShadow(char, int);
+void loadLCDShadow(void);
+void commitLCD(void);
+void beginLCDBack(void);
+void showCharBack(char, int);
+void flipLCD(void);
+void endLCDBack(void);
 
 
 #endif /* HAL_LCD_H_ */
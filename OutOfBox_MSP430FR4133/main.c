@@ -252,8 +252,9 @@ __interrupt void PORT1_ISR(void)
                 }
                 if (*mode == TEMPSENSOR_MODE)
                 {
-                    // Start/Pause temp sensor
+                    // Start/Pause temp sensor; a pause starts with the last reading, not the log
                     *tempSensorRunning ^= 0x1;
+                    *tempLogAge = 0;
                 }
 
                 // Start debounce timer
@@ -316,11 +317,17 @@ __interrupt void PORT2_ISR(void)
                         }
                         break;
                     case TEMPSENSOR_MODE:
-                        // Toggle temperature unit flag
-                        *tempUnit ^= 0x01;
-                        // Update LCD when temp sensor is not running
-                        if (!*tempSensorRunning)
-                            displayTemp();
+                        if (*tempSensorRunning)
+                        {
+                            // Toggle temperature unit flag
+                            *tempUnit ^= 0x01;
+                        }
+                        else
+                        {
+                            // Paused: show the next older sample of the FRAM log; tempSensor() draws
+                            // it, after tempLogRecover (this ISR runs first on a wakeup from LPM3.5)
+                            (*tempLogAge)++;
+                        }
                         break;
                 }
 
@@ -435,7 +442,7 @@ __interrupt void RTC_ISR(void)
 
 /*
  * ADC Interrupt Service Routine
- * Wake up from LPM3 when ADC conversion completes
+ * Wake up from LPM3 when an oversampled temperature value is ready
  */
 #if defined(__TI_COMPILER_VERSION__) || defined(__IAR_SYSTEMS_ICC__)
 #pragma vector=ADC_VECTOR
@@ -455,15 +462,23 @@ void __attribute__ ((interrupt(ADC_VECTOR))) ADC_ISR (void)
         case ADCIV_ADCTOVIFG:
             break;
         case ADCIV_ADCHIIFG:
+            // Temperature above the alarm window (or back above it, see tempAlarmSet)
+            tempAlarmEvent(1);
+            __bic_SR_register_on_exit(LPM3_bits);                // Exit LPM3
             break;
         case ADCIV_ADCLOIFG:
+            // Temperature below the alarm window (or back below it)
+            tempAlarmEvent(0);
+            __bic_SR_register_on_exit(LPM3_bits);                // Exit LPM3
             break;
         case ADCIV_ADCINIFG:
             break;
         case ADCIV_ADCIFG:
             // Clear interrupt flag
             ADC_clearInterrupt(ADC_BASE, ADC_COMPLETED_INTERRUPT_FLAG);
-            __bic_SR_register_on_exit(LPM3_bits);                // Exit LPM3
+            // Exit LPM3 only once a whole oversampled value is ready
+            if (tempSensorAccumulate(ADCMEM0))
+                __bic_SR_register_on_exit(LPM3_bits);
             break;
         default:
             break;
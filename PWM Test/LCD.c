@@ -8,6 +8,7 @@
  *      LCD_Digit(digit, pos): Outputs `digit` at `pos`
  *      LCD_Letter(letter, pos): Outputs 'letter' at `pos`
  *      LCD_Number(num): Outputs up-to-6-digit `num` (starting from left-most pos)
+ *      LCD_Fixed_Point(num, dp): Same as LCD_Number, with `dp` digits after the decimal point
  *      LCD_Negative_Sign(): Prints negative sign
  *      LCD_Decimal_Point(pos): Prints decimal point at`pos`
  *      LCD_Degree_Symbol(): Prints the degree symbol for temperature display
@@ -130,30 +131,61 @@ void LCD_Letter(char ch, unsigned char pos)
 	LCDMEM[pos+1] = alphabet[ch-'A'][1];
 }
 
+/* NUMBER FORMATTING
+ * There is no hardware divider, so n%10 and n/=10 on a long are each a call to the software divide.
+ * Instead, each digit is found by subtracting its power of ten until it no longer fits (at most 9 times),
+ * from the left-most digit. Once the number is below 10000 the rest is done in 16 bits.
+ */
+static const unsigned long POW10_HI[2] = {100000, 10000};
+static const unsigned int POW10_LO[4] = {1000, 100, 10, 1};
+
+/* Function: LCD_Fixed_Point
+ * Outputs up-to-6-digit `n` (starting from left-most pos), with `dp` of its digits after the decimal point
+ * eg. LCD_Fixed_Point(-1234, 2) shows -12.34, LCD_Fixed_Point(5, 2) shows 0.05
+ * Shows INF if it does not fit.
+ */
+void LCD_Fixed_Point(long n, unsigned char dp){
+    unsigned long hi;
+    unsigned int lo;
+    unsigned char dg[6];
+    unsigned char len = 0;
+    unsigned char i, d;
+
+    LCD_Clear();
+
+    if(n<0){
+        LCD_Negative_Sign();
+        hi = -(unsigned long)n;     //also right for the most negative long
+    }
+    else hi = n;
+
+    if(hi > 999999 || dp > 5){
+        LCD_Letter('I',pos1);
+        LCD_Letter('N',pos2);
+        LCD_Letter('F',pos3);
+        return;
+    }
+
+    //Leading zeros are skipped, except the one in front of the decimal point (and the last digit)
+    for(i=0;i<2;i++){
+        for(d=0; hi>=POW10_HI[i]; d++) hi -= POW10_HI[i];
+        if(d || len || i>=5-dp) dg[len++] = d;
+    }
+
+    lo = (unsigned int)hi;
+    for(i=0;i<4;i++){
+        for(d=0; lo>=POW10_LO[i]; d++) lo -= POW10_LO[i];
+        if(d || len || i+2>=5-dp) dg[len++] = d;
+    }
+
+    for(i=0;i<len;i++)
+        LCD_Digit(dg[i],POS[i+1]);
+
+    if(dp) LCD_Decimal_Point(POS[len-dp]);
+}
+
 void LCD_Number(long n){
-	LCD_Clear();
-	
-	if(n<0){
-		LCD_Negative_Sign();
-		n = -n;	
-	}
-	
-	unsigned int len = INT_LEN(n);
-	
-	if(len==0 || len>6){
-		LCD_Letter('I',pos1);
-		LCD_Letter('N',pos2);
-		LCD_Letter('F',pos3);
-		return;
-	}
-	
-	unsigned int i;
-	unsigned char lastDigit;
-	for(i=len;i>0;i--){
-		lastDigit = (unsigned char)(n%10);
-		LCD_Digit(lastDigit,POS[i]);
-		n/=10;
-	}
+    LCD_Fixed_Point(n, 0);
 }
 
 void LCD_Negative_Sign(){
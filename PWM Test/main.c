@@ -9,11 +9,13 @@
  * Connects to:
  *      LCD.c/h
  *      timer.c/h
+ *      ../Common/MPY32.h
 ****************************/
 
 #include "msp430fr4133.h"
 #include "main.h"
 #include "LCD.h"
+#include "MPY32.h"
 
 volatile int count = 0;
 volatile int MotorPowers[2] = {0,0};
@@ -146,26 +148,26 @@ void MotorControl(unsigned int motor, int power){
     if(power<-10)  power = -10;
     if(power>10)   power = 10;
 
-    //TODO: To conserve power by reducing multiplying consumption, create a hash table with pre-set values
-    double PWM_Duty = PWM_STOP + power*PWM_MULTIPLIER;
+    //Duty in timer counts: one 16x16 multiply on MPY32 instead of floating point
+    unsigned int PWM_Duty = PWM_CCR_STOP + MPY_Mul16(power, PWM_CCR_STEP);
 
     switch(motor){
         case 1: //TA0.1, P1.7
-            TA0CCR1 = PWM_Duty*PWM_PERIOD;
+            TA0CCR1 = PWM_Duty;
             LCD_Number(power);
 
             LCD_Letter('M',pos5);
             LCD_Digit(1,pos6);
             break;
         case 2: //TA0.2, P1.6
-            TA0CCR1 = PWM_Duty*PWM_PERIOD;
+            TA0CCR1 = PWM_Duty;
             LCD_Number(power);
 
             LCD_Letter('M',pos5);
             LCD_Digit(2,pos6);
             break;
         case 0: //Everything
-            TA0CCR1 = PWM_Duty*PWM_PERIOD;
+            TA0CCR1 = PWM_Duty;
             LCD_Number(power);
 
             LCD_Letter('M',pos5);
@@ -32,6 +32,10 @@
 #define PWM_ANTICLOCK_FULL 0.1
 #define PWM_MULTIPLIER 0.04 //(PWM_CLOCK_FULL-PWM_ANTICLOCK_FULL)/20
 
+//The same in timer counts (folded by the compiler, no floating point at run time)
+#define PWM_CCR_STOP ((unsigned int)(PWM_PERIOD*PWM_STOP))      //31250
+#define PWM_CCR_STEP ((int)(PWM_PERIOD*PWM_MULTIPLIER))         //2500 per power step
+
 void Init_GPIO(void);
 void Init_Clock(void);
 void Init_Timer(void);
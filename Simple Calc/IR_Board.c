@@ -5,6 +5,12 @@
  * Functions:
  *      Init_KeypadIO: Initializes keypad i/o
  *      Scan_Key: Scans to see which key on the matrix is pressed
+ *      scan_keys: Scans the whole matrix into a bitmap of pressed keys
+ *      Keypad_Ghost: Checks a bitmap for ghost keys
+ *      Keypad_Start_Scan: Starts the RTC-paced scan that posts key events
+ *      Key_Get_Event: Reads the next key event
+ *      Key_Pending: Checks for a waiting key press (KEY_DOWN/KEY_REPEAT)
+ *      Key_Wait: Enters LPM3 unless a key event is waiting
  *
  * Connects to:
  *      LCD.c/h
@@ -166,34 +172,308 @@ unsigned int index_to_keypad_num(unsigned char ind){
     }
 }
 
-/* NOTE: INTERESTING DEBOUNCE TIMER METHOD
- * Uses Watchdog timer as the button debouncer
- * When one of the keypad buttons are pressed (P1 and P2 interrupt, in main.c), the watchdog timer is started
- * Then 250ms later, interrupt occurs, and watchdog timer is reset.
+/* EVENT-DRIVEN KEYPAD SCAN
+ * Idle: all columns are driven low, so pressing any key pulls its row low and interrupts (P1.3-1.5, P2.7).
+ * The port ISR only calls Keypad_Start_Scan, which turns the row interrupts off and starts the RTC.
+ * Every RTC tick (KEY_SCAN_TICKS of ACLK, ~0.5ms) reads the rows of the column driven on the tick before
+ * and drives the next column, so the lines settle between ticks instead of in __delay_cycles.
+ * After the 4th column (a pass, ~2ms) every key is debounced (see KEY DEBOUNCE): keys that settle down
+ * post KEY_DOWN, keys that settle up post KEY_UP. A pass that may hold ghost keys is skipped (see Keypad_Ghost).
+ * Scanning carries on while any key is down or still bouncing (so releases and chords are seen),
+ * then the columns go back to idle and the row interrupts are turned back on.
+ *
+ * Keys are kept as a bitmap, bit (key-1), with the same key numbers as scan_key().
+ * The event queue has one writer (the RTC ISR moves key_head) and one reader (main moves key_tail),
+ * so neither side needs to turn interrupts off.
  */
+volatile unsigned int key_map = 0;          //keys down at the end of the last pass
 
-// Sets up the WDT as a button debouncer, only activated once a
-// button interrupt has occurred.
-void Buttons_startWDT()
-{
-    // WDT as 250ms interval counter
-    SFRIFG1 &= ~WDTIFG;
-    WDTCTL = WDTPW + WDTSSEL_1 + WDTTMSEL + WDTCNTCL + WDTIS_5;
-    SFRIE1 |= WDTIE;
+static volatile unsigned char scan_active = 0;
+static unsigned char scan_col = 0;          //column being driven
+static unsigned int  scan_map = 0;          //keys seen so far in this pass
+
+static unsigned char key_level[TOTAL_KEYS]; //debounce integrators, 0 (up) to KEY_DEBOUNCE (down)
+static unsigned int  key_busy = 0;          //keys with a non-zero integrator
+static unsigned char repeat_key = 0;        //key that repeats, 0 if none
+static unsigned int  repeat_cnt;            //passes until its next KEY_REPEAT
+static unsigned int  repeat_step;           //current passes between KEY_REPEATs
+
+static KEY_EVENT key_queue[KEY_QUEUE_SIZE];
+static volatile unsigned char key_head = 0; //next free slot, RTC ISR only
+static volatile unsigned char key_tail = 0; //next event to read, main only
+
+//Release all columns, then drive only `col` low
+static void Keypad_Drive_Col(unsigned char col) {
+    P8DIR &= ~(BIT0 | BIT1);
+    P1DIR &= ~BIT1;
+    P2DIR &= ~BIT5;
+
+    switch(col) {
+        case 0: P8DIR |= BIT1; break;
+        case 1: P1DIR |= BIT1; break;
+        case 2: P8DIR |= BIT0; break;
+        case 3: P2DIR |= BIT5; break;
+        default: break;
+    }
+}
+
+//Rows pulled low by the driven column, bit 0 = P1.3 ... bit 3 = P2.7
+static unsigned char Keypad_Read_Rows(void) {
+    unsigned char rows = (~P1IN >> 3) & 0x07;
+
+    if(!(P2IN & BIT7)) rows |= 0x08;
+    return rows;
+}
+
+/* KEY BITMAP AND GHOSTING
+ * scan_key() only returns the highest pressed key; scan_keys() returns all of them, bit (key-1),
+ * with the same column/row order as scan_key() but driving one column at a time.
+ * The matrix has no diodes, so when 3 keys on the corners of a rectangle are down, the 4th corner
+ * reads as pressed too (a ghost). Any map with 2 columns sharing 2 or more rows is therefore
+ * ambiguous: Keypad_Ghost() flags it, and the RTC scan keeps the last good map until it clears.
+ *
+ * NOTE: scan_keys() drives the columns itself, so do not call it while the RTC scan is running.
+ */
+unsigned int scan_keys(void) {
+    unsigned int map = 0;
+    unsigned char col;
+
+    for(col=0;col<KEYPAD_COLS;col++) {
+        Keypad_Drive_Col(col);
+        __delay_cycles(100);
+        map = (map >> 4) | ((unsigned int)Keypad_Read_Rows() << 12);
+    }
+
+    P8DIR |= (BIT0 | BIT1);                 //back to idle: all columns low
+    P1DIR |= BIT1;
+    P2DIR |= BIT5;
+
+    return map;
+}
+
+/* Function: Keypad_Ghost
+ * Returns:
+ *      1 if `map` could contain ghost keys, 0 otherwise
+ */
+unsigned char Keypad_Ghost(unsigned int map) {
+    unsigned char a, b, common;
+
+    for(a=0;a<KEYPAD_COLS-1;a++) {
+        for(b=a+1;b<KEYPAD_COLS;b++) {
+            common = (map >> (a*4)) & (map >> (b*4)) & 0x0F;
+            if(common & (common - 1)) return 1; //2 or more rows in common
+        }
+    }
+
+    return 0;
+}
+
+static void Key_Post(unsigned char type, unsigned char key) {
+    unsigned char next = (key_head + 1) & (KEY_QUEUE_SIZE - 1);
+
+    if(next == key_tail) return;            //queue full: drop the event
+
+    key_queue[key_head].type = type;
+    key_queue[key_head].key = key;
+    key_queue[key_head].map = key_map;
+    key_head = next;
+}
+
+/* Function: Keypad_Start_Scan
+ * Called from the keypad row interrupts; does nothing if a scan is already running.
+ */
+void Keypad_Start_Scan() {
+    if(scan_active) return;
+    scan_active = 1;
+
+    P1IE &= ~(BIT3 | BIT4 | BIT5);          //rows are polled until all keys are released
+    P2IE &= ~BIT7;
+
+    scan_col = 0;
+    scan_map = 0;
+    Keypad_Drive_Col(0);
+
+    RTCMOD = KEY_SCAN_TICKS - 1;
+    RTCCTL = RTCSS__XT1CLK | RTCSR | RTCIE; //ACLK, start
+}
+
+static void Keypad_Stop_Scan(void) {
+    RTCCTL = 0;
+
+    P8DIR |= (BIT0 | BIT1);                 //back to idle: all columns low
+    P1DIR |= BIT1;
+    P2DIR |= BIT5;
+
+    P1IFG &= ~(BIT3 | BIT4 | BIT5);
+    P2IFG &= ~BIT7;
+    P1IE  |= (BIT3 | BIT4 | BIT5);
+    P2IE  |= BIT7;
+
+    scan_active = 0;
+}
+
+/* KEY DEBOUNCE
+ * Every key has its own integrator: each pass it counts up while the key reads down and down while it
+ * reads up. The key only goes down when it reaches KEY_DEBOUNCE (~6ms of steady contact) and only goes
+ * up again at 0, so bounces just move it back and forth in between. One key bouncing never holds up another.
+ *
+ * KEY REPEAT
+ * While exactly one key is held, it posts KEY_REPEAT after KEY_REPEAT_DELAY passes, then every
+ * repeat_step passes. repeat_step starts at KEY_REPEAT_START and shrinks by 1/2^KEY_REPEAT_ACCEL every
+ * repeat, down to KEY_REPEAT_MIN, so a long hold speeds up. Chords never repeat.
+ *
+ * Returns:
+ *      1 if a key went down, 0 otherwise
+ */
+static unsigned char Keypad_Debounce(unsigned int raw) {
+    unsigned int todo = raw | key_busy;
+    unsigned int bit;
+    unsigned char key;
+    unsigned char pressed = 0;
+
+    for(key=1,bit=1; todo; key++,bit<<=1) {
+        if(!(todo & bit)) continue;
+        todo &= ~bit;
+
+        if(raw & bit) {
+            if(key_level[key-1] == KEY_DEBOUNCE) continue;
+
+            key_busy |= bit;
+            if(++key_level[key-1] < KEY_DEBOUNCE || (key_map & bit)) continue;
+
+            key_map |= bit;                 //settled down
+            Key_Post(KEY_DOWN, key);
+            pressed = 1;
+
+            repeat_key = key;
+            repeat_cnt = KEY_REPEAT_DELAY;
+            repeat_step = KEY_REPEAT_START;
+        }
+        else {
+            if(--key_level[key-1]) continue;
+
+            key_busy &= ~bit;
+            if(!(key_map & bit)) continue;  //was only a bounce
+
+            key_map &= ~bit;                //settled up
+            Key_Post(KEY_UP, key);
+
+            if(repeat_key == key) repeat_key = 0;
+        }
+    }
+
+    return pressed;
+}
+
+/* Function: Keypad_Scan_Step
+ * One RTC tick of the scan.
+ * Returns:
+ *      1 if a key went down or repeated (main should wake up), 0 otherwise
+ */
+static unsigned char Keypad_Scan_Step(void) {
+    unsigned char woke = 0;
+
+    scan_map = (scan_map >> 4) | ((unsigned int)Keypad_Read_Rows() << 12);
+
+    if(++scan_col < KEYPAD_COLS) {
+        Keypad_Drive_Col(scan_col);
+        return 0;
+    }
+
+    if(!Keypad_Ghost(scan_map))
+        woke = Keypad_Debounce(scan_map);
+
+    if(repeat_key && key_map == KEY_BIT(repeat_key) && --repeat_cnt == 0) {
+        Key_Post(KEY_REPEAT, repeat_key);
+        woke = 1;
+
+        repeat_cnt = repeat_step;
+        repeat_step -= repeat_step >> KEY_REPEAT_ACCEL;
+        if(repeat_step < KEY_REPEAT_MIN) repeat_step = KEY_REPEAT_MIN;
+    }
+
+    scan_col = 0;
+
+    if(scan_map || key_busy)                //keys still down or bouncing: keep scanning
+        Keypad_Drive_Col(0);
+    else
+        Keypad_Stop_Scan();
+
+    scan_map = 0;
+
+    return woke;
+}
+
+/* Function: Key_Get_Event
+ * Arguments:
+ *      ev: Where to copy the oldest key event
+ * Returns:
+ *      1 if there was an event, 0 if the queue is empty
+ */
+unsigned char Key_Get_Event(KEY_EVENT *ev) {
+    if(key_tail == key_head) return 0;
+
+    *ev = key_queue[key_tail];
+    key_tail = (key_tail + 1) & (KEY_QUEUE_SIZE - 1);
+    return 1;
+}
+
+/* Function: Key_Pending
+ * Used to cut long jobs short when a key is pressed; releases do not count.
+ * Returns:
+ *      1 if a KEY_DOWN or KEY_REPEAT is waiting, 0 otherwise (the queue is left as it is)
+ */
+unsigned char Key_Pending() {
+    unsigned char i;
+
+    for(i=key_tail; i!=key_head; i=(i+1)&(KEY_QUEUE_SIZE-1)) {
+        if(key_queue[i].type != KEY_UP) return 1;
+    }
+
+    return 0;
+}
+
+/* Function: Key_Wait
+ * Enters LPM3 until an interrupt exits it, unless a key event is already waiting.
+ * The queue is checked with interrupts off, so an event posted just before sleeping still gets handled.
+ */
+void Key_Wait() {
+    __disable_interrupt();
+    __no_operation();
+
+    if(key_tail == key_head)
+        __bis_SR_register(LPM3_bits | GIE);
+    else
+        __enable_interrupt();
+}
+
+// Handles the RTC interrupts that pace the keypad scan
+#pragma vector=RTC_VECTOR
+__interrupt void RTC_ISR(void) {
+    switch(__even_in_range(RTCIV, RTCIV_RTCIF)) {
+        case RTCIV_NONE: break;
+        case RTCIV_RTCIF:
+            if(Keypad_Scan_Step()) __bic_SR_register_on_exit(LPM3_bits); //key pressed: wake main
+            break;
+        default: break;
+    }
 }
 
+/* NOTE: LCD SCROLL TIMER
+ * The Watchdog timer, as a 250ms interval counter, steps LCD_Text scrolling (started by LCD_Text in LCD.c).
+ * It stops itself once the message is done.
+ */
 
 // Handles Watchdog Timer interrupts.
 #pragma vector=WDT_VECTOR
 __interrupt void WDT_ISR(void)
 {
-    if(buttonDebounce == 2) {
-        buttonDebounce = 1; //button has cooled down
+    if(LCD_Scroll_Step()) __bic_SR_register_on_exit(LPM3_bits); //message done: wake main
 
+    if(!LCD_Scrolling()) {
         //Reset watchdog timer
         SFRIFG1 &= ~WDTIFG;
         SFRIE1 &= ~WDTIE;
         WDTCTL = WDTPW + WDTHOLD;
     }
 }
-
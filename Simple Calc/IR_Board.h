@@ -10,4 +10,37 @@
 extern void Init_KeypadIO(void);
 extern unsigned char scan_key(void);
 unsigned int index_to_keypad_num(unsigned char);
-extern void Buttons_startWDT(void);
+
+//Keypad scanner (see IR_Board.c)
+#define KEY_SCAN_TICKS 16           //RTC (ACLK) ticks per column strobe, ~0.5ms (a pass of 4 columns is ~2ms)
+#define KEY_QUEUE_SIZE 8            //events, must be a power of 2
+
+#define KEY_DEBOUNCE 3              //passes a key must read steady to go down/up, ~6ms
+#define KEY_REPEAT_DELAY 256        //passes held before the first KEY_REPEAT, ~500ms
+#define KEY_REPEAT_START 100        //passes between the first KEY_REPEATs, ~195ms
+#define KEY_REPEAT_MIN 20           //fastest repeat, ~40ms
+#define KEY_REPEAT_ACCEL 3          //each repeat comes 1/2^KEY_REPEAT_ACCEL sooner than the last
+
+enum KEY_EVENTS {
+    KEY_DOWN,
+    KEY_UP,
+    KEY_REPEAT                      //key held down (see IR_Board.c)
+};
+
+typedef struct {
+    unsigned char type;             //enum KEY_EVENTS
+    unsigned char key;              //key number from 1 to 16, as scan_key()
+    unsigned int  map;              //all keys down at the time, bit (key-1)
+} KEY_EVENT;
+
+#define KEY_BIT(key) (1U << ((key)-1))   //bit of key number `key` in a key bitmap
+
+extern volatile unsigned int key_map;
+
+extern unsigned int scan_keys(void);
+extern unsigned char Keypad_Ghost(unsigned int);
+
+extern void Keypad_Start_Scan(void);
+extern unsigned char Key_Get_Event(KEY_EVENT *);
+extern unsigned char Key_Pending(void);
+extern void Key_Wait(void);
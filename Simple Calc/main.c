@@ -9,6 +9,7 @@
  * Connects to: 
  * 		LCD.c/h
  * 		IR_Board.c/h
+ * 		../Common/MPY32.h
  *
  *
  * 	IMPORTANT NOTE: Disconnect the UART RX Jumper on the Launchpad for the "3,6,9,Cool" column to work.
@@ -18,12 +19,12 @@
 #include "main.h"
 #include "LCD.h"
 #include "IR_Board.h"
+#include "MPY32.h"
 
 extern const unsigned char POS[7];
 
-unsigned char buttonDebounce = 1;
-
 unsigned char button_num = TOTAL_KEYS+1;     //button number
+KEY_EVENT key_event;
 unsigned int keypad_digit = 0;
 
 #pragma PERSISTENT(ans); //store ans in FRAM
@@ -51,16 +52,24 @@ int main(void)
 
 	__enable_interrupt();
 
-	while(1){
-	    LCD_Text("Cool to delete  Power to clear  OK for ans  Click any button to continue");
+	// Scroll the intro (in the background, see LCD_Text) over and over until a key is pressed
+	while(!Key_Pending()){
+	    if(!LCD_Scrolling()) LCD_Text("Cool to delete  Power to clear  OK for ans  Click any button to continue");
 
-	    if(buttonDebounce==2 || button_num!=TOTAL_KEYS+1) break;
+	    Key_Wait();     //the WDT ISR wakes main up when the message is done
 	}
 
+	while(Key_Get_Event(&key_event));  //the key that ended the intro is not an input
+
     LCD_Number(ans);
 
     while(1){
-        __bis_SR_register(LPM3_bits | GIE);     //enter low power mode, wait for keypad/button interrupts
+        Key_Wait();     //enter low power mode, wait for keypad events (posted by the RTC scan in IR_Board.c)
+
+        if(!Key_Get_Event(&key_event) || key_event.type == KEY_UP) continue;
+        button_num = key_event.key;
+
+        if(key_event.type == KEY_REPEAT && button_num != 2 && button_num != 5) continue; //only Delete repeats
 
         P4OUT &= ~BIT0;
         P1OUT &= ~BIT0;
@@ -124,7 +133,9 @@ int main(void)
                         write_ans(0);
                     }
                     else{
-                        write_ans((signed long)(ans/10));
+                        //ans/10, rounded towards 0 like `/`
+                        if(ans < 0) write_ans(-(signed long)MPY_Div(-ans, MPY_RECIP(10)));
+                        else write_ans((signed long)MPY_Div(ans, MPY_RECIP(10)));
                     }
                     //write_ans((signed long)(ans/10));
                 }
@@ -142,7 +153,7 @@ int main(void)
 
                 if(keypad_digit < 10){
                     if(ans>-100000 && ans<100000){
-                        write_ans(ans*10+index_to_keypad_num(button_num));
+                        write_ans(MPY_Mul32(ans, 10)+index_to_keypad_num(button_num));
                     }
                 }
 
@@ -273,16 +284,8 @@ __interrupt void PORT1_ISR(void)
             P1IFG &= ~(BIT3 | BIT4 | BIT5);
             P1OUT |= BIT0;
 
-            if (buttonDebounce == 1)
-            {
-                buttonDebounce = 2;
-
-                Buttons_startWDT();
-                button_num = scan_key(); // scan the keypad
-
-                __bic_SR_register_on_exit(LPM3_bits); //exit LPM3
-            }
-             break;
+            Keypad_Start_Scan();    //keys are read and posted by the RTC scan
+            break;
         case P1IV_P1IFG6 : break;
         case P1IV_P1IFG7 : break;
     }
@@ -311,15 +314,7 @@ __interrupt void PORT2_ISR(void)
             P2IFG &= ~BIT7;                                  // clear IFG
             P1OUT |= BIT0;
 
-            if (buttonDebounce == 1)
-            {
-                buttonDebounce = 2;
-
-                Buttons_startWDT();
-                button_num = scan_key(); // scan the keypad
-                //IR_Mode_Setting();
-                __bic_SR_register_on_exit(LPM3_bits); //exit LPM3
-            }
+            Keypad_Start_Scan();    //keys are read and posted by the RTC scan
             break;
     }
 }
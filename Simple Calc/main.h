@@ -24,9 +24,6 @@
 #define MAX(m,n) ((m>n)?m:n)
 #define MIN(m,n) ((m<n)?m:n)
 
-//For button debounce in WDT and P1/2 interrupts
-extern unsigned char buttonDebounce;
-
 void Init_GPIO(void);
 void Init_Clock(void);
 void Init_ADC(void);
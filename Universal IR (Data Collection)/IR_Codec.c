@@ -0,0 +1,197 @@
+/***************************
+ * IR_Codec.C
+ * Contains the encoder/decoder for the compressed IR code format
+ *
+ * Functions:
+ *      IR_Encode: Compresses captured edge intervals (known protocol if possible, else dictionary, else unit symbols)
+ *      IR_Decode: Expands the symbols back into edge intervals (SMCLK ticks)
+ *
+ * NOTE: No register access in here, so the FRAM write protection (PFWP)
+ *       must be cleared by the caller when `code` lives in FRAM.
+ *       `repeat`, `gap` and the carrier are not touched; they are set by the caller (see IR_Commit).
+ *
+ * Connects to:
+ *      main.c/h
+ *      IR_Protocol.c
+****************************/
+
+#include "IR_Codec.h"
+
+/* COMPRESSION METHOD
+ * Raw captures are stored as 2-byte SMCLK tick counts, but the intervals of an IR code
+ * are all roughly multiples of one base period (eg. 560us for NEC).
+ * A unit of 1/IR_UNIT_DIV of the shortest interval is learned per code, and every interval
+ * is stored as its rounded multiple of that unit.
+ * Almost all intervals then fit in 1 byte; only long headers/gaps need 2.
+ * Rounding error is at most unit/2, ie. 1/8 of the shortest pulse, which is well within
+ * what IR receivers tolerate.
+ *
+ * DICTIONARY METHOD
+ * Most protocols only ever use a handful of distinct durations (NEC: 9ms, 4.5ms, 560us, 1690us).
+ * The intervals are clustered (within 1/2^IR_DICT_TOL of each other) into at most IR_DICT_SIZE
+ * durations, and each interval is stored as a 3-bit index into that dictionary.
+ * If the capture needs more than IR_DICT_SIZE durations, the unit method is used instead.
+ *
+ * Before either of these, IR_Classify (IR_Protocol.c) checks for a known protocol, which only
+ * needs the address and command stored.
+ */
+
+static unsigned char IR_Encode_Unit(const unsigned int *, unsigned char, IR_CODE *);
+static unsigned char IR_Encode_Dict(const unsigned int *, unsigned char, IR_CODE *);
+
+/* Function: IR_Encode
+ * Arguments:
+ *      intervals: Edge intervals in SMCLK ticks
+ *      cnt: Number of intervals
+ *      code: Where to store the compressed code
+ * Returns:
+ *      Number of intervals stored (less than `cnt` if data[] ran out)
+ */
+unsigned char IR_Encode(const unsigned int *intervals, unsigned char cnt, IR_CODE *code){
+    if(IR_Classify(intervals, cnt, code))
+        return code->cnt;
+
+    if(IR_Encode_Dict(intervals, cnt, code))
+        return code->cnt;
+
+    return IR_Encode_Unit(intervals, cnt, code);
+}
+
+/* Function: IR_Encode_Dict
+ * Clusters the intervals into at most IR_DICT_SIZE durations and stores 3-bit indices.
+ * Returns:
+ *      Non-zero if the capture fit the dictionary, 0 otherwise (`code` untouched)
+ */
+static unsigned char IR_Encode_Dict(const unsigned int *intervals, unsigned char cnt, IR_CODE *code){
+    unsigned long sum[IR_DICT_SIZE];
+    unsigned int  center[IR_DICT_SIZE];
+    unsigned char members[IR_DICT_SIZE];
+    unsigned char n = 0;
+    unsigned char i, k, best;
+    unsigned int  diff, best_diff, bit;
+
+    //Pass 1: build the clusters, each center being the running mean of its members
+    for(i=0;i<cnt;i++){
+        for(k=0;k<n;k++){
+            diff = (intervals[i] > center[k]) ? intervals[i]-center[k] : center[k]-intervals[i];
+            if(diff <= (center[k] >> IR_DICT_TOL)) break;
+        }
+
+        if(k == n){
+            if(n == IR_DICT_SIZE) return 0; //too many distinct durations
+            sum[n] = 0;
+            members[n] = 0;
+            n++;
+        }
+
+        sum[k] += intervals[i];
+        members[k]++;
+        center[k] = (unsigned int)(sum[k] / members[k]);
+    }
+
+    //Pass 2: pack the index of the nearest center for every interval
+    for(i=0;i<IR_CODE_BYTES;i++) code->data[i] = 0;
+
+    for(i=0,bit=0;i<cnt;i++,bit+=3){
+        best = 0;
+        best_diff = 0xFFFF;
+        for(k=0;k<n;k++){
+            diff = (intervals[i] > center[k]) ? intervals[i]-center[k] : center[k]-intervals[i];
+            if(diff < best_diff){
+                best_diff = diff;
+                best = k;
+            }
+        }
+
+        code->data[bit>>3] |= best << (bit&7);
+        if((bit&7) > 5) code->data[(bit>>3)+1] |= best >> (8-(bit&7)); //index straddles 2 bytes
+    }
+
+    for(k=0;k<n;k++) code->dict[k] = center[k];
+
+    code->fmt = IR_FMT_DICT;
+    code->dict_cnt = n;
+    code->unit = 0;
+    code->cnt = cnt;
+    code->len = (unsigned char)((bit+7)>>3);
+
+    return 1;
+}
+
+/* Function: IR_Encode_Unit
+ * Quantizes the intervals to a learned unit and stores variable-length symbols.
+ * Returns:
+ *      Number of intervals stored
+ */
+static unsigned char IR_Encode_Unit(const unsigned int *intervals, unsigned char cnt, IR_CODE *code){
+    unsigned int unit = 0xFFFF;
+    unsigned int q;
+    unsigned char i;
+    unsigned char len = 0;
+
+    //Learn the unit from the shortest interval
+    for(i=0;i<cnt;i++){
+        if(intervals[i] < unit) unit = intervals[i];
+    }
+    unit /= IR_UNIT_DIV;
+    if(unit < IR_MIN_UNIT) unit = IR_MIN_UNIT;
+
+    for(i=0;i<cnt;i++){
+        q = intervals[i] / unit;
+        if(intervals[i] - q*unit >= ((unit+1)>>1)) q++; //round to nearest unit (an odd unit's half rounds down)
+        if(q == 0) q = 1;                           //0 would stop the timer on playback
+        if(q > 0xFFFF/unit) q = 0xFFFF/unit;        //rounding up must not overflow on decode
+
+        if(q < IR_SYM_LONG){
+            if(len >= IR_CODE_BYTES) break;
+            code->data[len++] = (unsigned char)q;
+        }
+        else{
+            if(len+1 >= IR_CODE_BYTES) break;
+            code->data[len++] = IR_SYM_LONG | (unsigned char)(q>>8);
+            code->data[len++] = (unsigned char)q;
+        }
+    }
+
+    code->fmt = IR_FMT_UNIT;
+    code->dict_cnt = 0;
+    code->unit = unit;
+    code->cnt = i;
+    code->len = len;
+
+    return i;
+}
+
+/* Function: IR_Decode
+ * Arguments:
+ *      code: Compressed code
+ *      intervals: Where to store the expanded intervals (at least MAX_IR_CNT entries)
+ * Returns:
+ *      Number of intervals
+ */
+unsigned char IR_Decode(const IR_CODE *code, unsigned int *intervals){
+    const unsigned char *sym = code->data;
+    unsigned int q, bit;
+    unsigned char i;
+
+    if(code->fmt >= IR_FMT_NEC)
+        return IR_Synth(code, intervals);
+
+    if(code->fmt == IR_FMT_DICT){
+        for(i=0,bit=0;i<code->cnt;i++,bit+=3){
+            q = sym[bit>>3] | (sym[(bit>>3)+1] << 8);   //pair of bytes holding the index
+            intervals[i] = code->dict[(q >> (bit&7)) & 0x07];
+        }
+        return code->cnt;
+    }
+
+    for(i=0;i<code->cnt;i++){
+        q = *sym++;
+        if(q & IR_SYM_LONG)
+            q = ((q & ~IR_SYM_LONG) << 8) | *sym++;
+
+        intervals[i] = q * code->unit;
+    }
+
+    return code->cnt;
+}
@@ -0,0 +1,75 @@
+/***************************
+ * IR_Codec.h
+ * Use this header file to attach functions and define constants for IR_Codec.c and IR_Protocol.c
+****************************/
+
+#define MAX_IR_CNT 255          //maximum number of edge intervals captured per code
+#define IR_CODE_BYTES 133       //bytes of symbol data stored per code (sizeof(IR_CODE) = 160)
+
+#define IR_UNIT_DIV 4           //learned unit = shortest interval / IR_UNIT_DIV
+#define IR_MIN_UNIT 8           //smallest unit allowed, in SMCLK ticks (filters glitches)
+#define IR_SYM_LONG 0x80        //first byte of a 2-byte symbol: 0x80 | upper 7 bits, then lower 8 bits
+
+#define IR_DICT_SIZE 8          //maximum number of distinct durations in a dictionary code (3-bit indices)
+#define IR_DICT_TOL 3           //intervals within 1/2^IR_DICT_TOL (12.5%) of a duration share its index
+
+//Storage formats
+enum IR_FORMATS {
+    IR_FMT_UNIT,                //variable-length multiples of `unit`
+    IR_FMT_DICT,                //3-bit indices into `dict`
+    IR_FMT_NEC,                 //recognized protocols (see IR_Protocol.c): address + command in data[]
+    IR_FMT_NECX,
+    IR_FMT_SIRC,
+    IR_FMT_RC5,
+    IR_FMT_RC6
+};
+
+#define IR_PROTO_BYTES 4        //bytes of data[] used by a recognized protocol
+
+#define IR_REPEAT_NEC 0x80      //`repeat` flag: the repeats are NEC repeat codes rather than the frame
+#define IR_NEC_REPEAT_CNT 3     //intervals in an NEC repeat code
+
+/* Compressed IR code
+ *      unit: SMCLK ticks per symbol step, learned from the capture itself (IR_FMT_UNIT)
+ *      gap:  space between repeated frames, in 16 SMCLK tick (4us) steps
+ *            (with IR_REPEAT_NEC: the repeat period, from the start of one frame to the start of the next)
+ *      cnt:  number of edge intervals stored
+ *      len:  number of bytes of data[] in use
+ *      fmt:  enum IR_FORMATS
+ *      dict_cnt: number of durations in dict[] (IR_FMT_DICT)
+ *      dict: the distinct durations in SMCLK ticks, learned by clustering the capture (IR_FMT_DICT)
+ *      repeat: number of times the frame is sent again after the first, `gap` apart
+ *            IR_REPEAT_NEC set: an NEC repeat code is sent each time instead of the frame
+ *      carrier: learned carrier period as a TA1CCR0 value (SMCLK ticks - 1), 0 if not measured (38kHz is used)
+ *      carrier_duty: learned carrier on time as a TA1CCR2 value
+ *      data:
+ *          IR_FMT_UNIT: one symbol per interval, each symbol is the interval as a multiple of `unit`
+ *              0x01-0x7F: 1 byte
+ *              0x80-0x7FFF: 2 bytes, IR_SYM_LONG set in the first byte
+ *          IR_FMT_DICT: 3-bit dict[] index per interval, packed LSB first
+ *          IR_FMT_NEC and up: address (low, high), command, then
+ *              SIRC: number of bits (12/15/20)
+ *              RC5:  toggle bit
+ *              RC6:  mode (bits 0-2), toggle (bit 3)
+ */
+typedef struct {
+    unsigned int  unit;
+    unsigned int  gap;
+    unsigned char cnt;
+    unsigned char len;
+    unsigned char fmt;
+    unsigned char dict_cnt;
+    unsigned int  dict[IR_DICT_SIZE];
+    unsigned char repeat;
+    unsigned char carrier;
+    unsigned char carrier_duty;
+    unsigned char data[IR_CODE_BYTES];
+} IR_CODE;
+
+extern unsigned char IR_Encode(const unsigned int *, unsigned char, IR_CODE *);
+extern unsigned char IR_Decode(const IR_CODE *, unsigned int *);
+
+extern unsigned char IR_Classify(const unsigned int *, unsigned char, IR_CODE *);
+extern unsigned char IR_Synth(const IR_CODE *, unsigned int *);
+extern unsigned char IR_Is_Repeat(const unsigned int *, unsigned char);
+extern unsigned char IR_Synth_Repeat(unsigned int *);
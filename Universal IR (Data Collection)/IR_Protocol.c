@@ -0,0 +1,363 @@
+/***************************
+ * IR_Protocol.C
+ * Contains the protocol classifier for learned IR codes, and the waveform synthesizer for playback
+ *
+ * Functions:
+ *      IR_Classify: Recognizes NEC, extended NEC, SIRC, RC5 and RC6 captures and stores address + command
+ *      IR_Synth: Rebuilds the edge intervals (SMCLK ticks) of a recognized code
+ *      IR_Is_Repeat: Recognizes the NEC repeat code that follows a frame while the key is held
+ *      IR_Synth_Repeat: Rebuilds the NEC repeat code
+ *
+ * NOTE: Like IR_Codec.c, there is no register access in here, so the caller unlocks FRAM (PFWP).
+ *
+ * Connects to:
+ *      IR_Codec.c/h
+****************************/
+
+#include "IR_Codec.h"
+
+/* RECOGNITION
+ * A capture is a list of intervals that alternate mark, space, mark, ... and end on a mark.
+ * Almost every remote uses one of a few well-known protocols, and for those the whole frame
+ * follows from the protocol, an address and a command, so only those are stored (data[0..3])
+ * instead of one symbol per interval.
+ *
+ *  NEC/NECX: 9ms mark, 4.5ms space, 32 bits LSB first, 560us mark + 560us (0) / 1690us (1) space, 560us trailer
+ *            NEC:  address, ~address, command, ~command
+ *            NECX: 16-bit address, command, ~command
+ *            Repeat code: 9ms mark, 2.25ms space, 560us mark, sent every 108ms (start to start)
+ *            after the frame for as long as the key is held
+ *  SIRC:     2.4ms mark, 600us space, 12/15/20 bits LSB first, 600us (0) / 1200us (1) mark + 600us space
+ *            7 bit command, then 5/8/13 bit address
+ *  RC5:      Manchester, 889us half bits, 14 bits MSB first: 1, ~command bit 6, toggle, 5 bit address, 6 bit command
+ *            1 is space then mark
+ *  RC6:      Manchester, 444us half bits, 2.67ms mark + 889us space leader, then MSB first:
+ *            start bit (1), 3 mode bits, toggle (double length), 8 bit address, 8 bit command
+ *            1 is mark then space
+ *
+ * For the Manchester protocols the capture is first cut into half bits (IR_Halves), rounding the
+ * time of each edge since the first one, so a receiver that stretches marks (and so shortens
+ * spaces) does not push the later edges out of place.
+ *
+ * Anything else (or a capture that breaks the protocol anywhere) is left to the dictionary/unit formats.
+ */
+
+//Timings in SMCLK ticks (4MHz)
+#define NEC_HDR_MARK    36000
+#define NEC_HDR_SPACE   18000
+#define NEC_MARK        2240
+#define NEC_ONE_SPACE   6760
+#define NEC_ZERO_SPACE  2240
+#define NEC_CNT         67      //header + 32 bits + trailer
+#define NEC_REP_SPACE   9000    //repeat code: NEC_HDR_MARK, NEC_REP_SPACE, NEC_MARK
+
+#define SIRC_HDR_MARK   9600
+#define SIRC_ONE_MARK   4800
+#define SIRC_ZERO_MARK  2400
+#define SIRC_SPACE      2400
+
+#define RC5_T           3556    //half bit
+#define RC5_BITS        14
+
+#define RC6_T           1778    //half bit
+#define RC6_LEADER      6       //leader mark, in half bits
+#define RC6_HALVES      52      //leader (8) + start (2) + mode (6) + toggle (4) + address/command (32)
+
+#define IR_MAX_HALVES   64
+
+static unsigned char IR_Classify_NEC(const unsigned int *, unsigned char, IR_CODE *);
+static unsigned char IR_Classify_SIRC(const unsigned int *, unsigned char, IR_CODE *);
+static unsigned char IR_Classify_RC5(const unsigned int *, unsigned char, IR_CODE *);
+static unsigned char IR_Classify_RC6(const unsigned int *, unsigned char, IR_CODE *);
+static unsigned char IR_Halves(const unsigned int *, unsigned char, unsigned int, unsigned char, unsigned char *);
+static void IR_Synth_Level(unsigned char, unsigned int);
+
+//Half bit levels of a Manchester frame, 1 = mark, packed LSB first
+#define HALF(h, i)  (((h)[(i)>>3] >> ((i)&7)) & 1)
+
+/* Function: IR_Near
+ * Returns:
+ *      Non-zero if `ticks` is within 1/4 of `ref`
+ */
+static unsigned char IR_Near(unsigned int ticks, unsigned int ref){
+    unsigned int diff = (ticks > ref) ? ticks-ref : ref-ticks;
+    return diff <= (ref >> 2);
+}
+
+/* Function: IR_Classify
+ * Arguments:
+ *      intervals: Edge intervals of one frame, in SMCLK ticks
+ *      cnt: Number of intervals
+ *      code: Where to store the recognized code
+ * Returns:
+ *      Non-zero if the capture is a known protocol (`code` filled in), 0 otherwise (`code` untouched)
+ */
+unsigned char IR_Classify(const unsigned int *intervals, unsigned char cnt, IR_CODE *code){
+    if(IR_Classify_NEC(intervals, cnt, code)
+    || IR_Classify_SIRC(intervals, cnt, code)
+    || IR_Classify_RC6(intervals, cnt, code)
+    || IR_Classify_RC5(intervals, cnt, code)){
+        code->unit = 0;
+        code->dict_cnt = 0;
+        code->cnt = cnt;        //a valid frame is synthesized back to the same number of intervals
+        code->len = IR_PROTO_BYTES;
+        return 1;
+    }
+
+    return 0;
+}
+
+static unsigned char IR_Classify_NEC(const unsigned int *intervals, unsigned char cnt, IR_CODE *code){
+    unsigned char b[4];
+    unsigned char i;
+
+    if(cnt != NEC_CNT || !IR_Near(intervals[0], NEC_HDR_MARK) || !IR_Near(intervals[1], NEC_HDR_SPACE))
+        return 0;
+
+    for(i=0;i<32;i++){
+        if(!IR_Near(intervals[2+2*i], NEC_MARK)) return 0;
+
+        b[i>>3] >>= 1;
+        if(intervals[3+2*i] > (NEC_ZERO_SPACE + NEC_ONE_SPACE)/2) b[i>>3] |= 0x80;  //Logical '1'
+    }
+
+    if(b[2] != (unsigned char)~b[3]) return 0;
+
+    code->fmt = (b[0] == (unsigned char)~b[1]) ? IR_FMT_NEC : IR_FMT_NECX;
+    code->data[0] = b[0];
+    code->data[1] = b[1];
+    code->data[2] = b[2];
+    code->data[3] = 0;
+    return 1;
+}
+
+static unsigned char IR_Classify_SIRC(const unsigned int *intervals, unsigned char cnt, IR_CODE *code){
+    unsigned char bits = (cnt-1)/2;
+    unsigned long val = 0;
+    unsigned char i;
+
+    if((bits != 12 && bits != 15 && bits != 20) || cnt != 2*bits+1 || !IR_Near(intervals[0], SIRC_HDR_MARK) || !IR_Near(intervals[1], SIRC_SPACE))
+        return 0;
+
+    for(i=0;i<bits;i++){
+        if(i+1 < bits && !IR_Near(intervals[3+2*i], SIRC_SPACE)) return 0;
+
+        if(IR_Near(intervals[2+2*i], SIRC_ONE_MARK)) val |= 1UL << i;
+        else if(!IR_Near(intervals[2+2*i], SIRC_ZERO_MARK)) return 0;
+    }
+
+    code->fmt = IR_FMT_SIRC;
+    code->data[2] = (unsigned char)(val & 0x7F);
+    val >>= 7;
+    code->data[0] = (unsigned char)val;
+    code->data[1] = (unsigned char)(val >> 8);
+    code->data[3] = bits;
+    return 1;
+}
+
+static unsigned char IR_Classify_RC5(const unsigned int *intervals, unsigned char cnt, IR_CODE *code){
+    unsigned char h[IR_MAX_HALVES/8];
+    unsigned char n, i;
+    unsigned int val = 0;
+
+    if(cnt > 2*RC5_BITS) return 0;
+
+    //The first half of the start bit is a space, which the capture cannot see
+    n = IR_Halves(intervals, cnt, RC5_T, 1, h);
+    if(n < 2*RC5_BITS-1 || n > 2*RC5_BITS) return 0;  //a trailing space half is not captured either
+
+    for(i=0;i<RC5_BITS;i++){
+        if(HALF(h, 2*i) == HALF(h, 2*i+1)) return 0;  //not Manchester
+        val = (val << 1) | HALF(h, 2*i+1);
+    }
+
+    if(!(val & 0x2000)) return 0;   //start bit
+
+    code->fmt = IR_FMT_RC5;
+    code->data[0] = (val >> 6) & 0x1F;
+    code->data[1] = 0;
+    code->data[2] = (val & 0x3F) | ((val & 0x1000) ? 0 : 0x40);
+    code->data[3] = (val >> 11) & 1;    //toggle
+    return 1;
+}
+
+static unsigned char IR_Classify_RC6(const unsigned int *intervals, unsigned char cnt, IR_CODE *code){
+    unsigned char h[IR_MAX_HALVES/8];
+    unsigned char n, i;
+    unsigned char mode = 0;
+    unsigned int val = 0;
+
+    if(!IR_Near(intervals[0], RC6_LEADER*RC6_T)) return 0;
+
+    n = IR_Halves(intervals, cnt, RC6_T, 0, h);
+    if(n < RC6_HALVES-1 || n > RC6_HALVES) return 0;
+
+    for(i=0;i<RC6_HALVES;i++){
+        if(HALF(h, i) != (i < RC6_LEADER)) break;
+    }
+    if(i < RC6_LEADER+2 || !HALF(h, 8) || HALF(h, 9)) return 0; //leader, start bit
+
+    for(i=10;i<16;i+=2){
+        if(HALF(h, i) == HALF(h, i+1)) return 0;
+        mode = (mode << 1) | HALF(h, i);
+    }
+
+    if(HALF(h, 16) != HALF(h, 17) || HALF(h, 18) != HALF(h, 19) || HALF(h, 16) == HALF(h, 18)) return 0;
+
+    for(i=20;i<RC6_HALVES;i+=2){
+        if(HALF(h, i) == HALF(h, i+1)) return 0;
+        val = (val << 1) | HALF(h, i);
+    }
+
+    code->fmt = IR_FMT_RC6;
+    code->data[0] = val >> 8;
+    code->data[1] = 0;
+    code->data[2] = val & 0xFF;
+    code->data[3] = mode | (HALF(h, 16) << 3);
+    return 1;
+}
+
+/* Function: IR_Halves
+ * Cuts a Manchester capture into half bits of `t` ticks.
+ * Arguments:
+ *      start: Number of (space) half bits before the first edge
+ *      h: Where to store the levels (IR_MAX_HALVES bits)
+ * Returns:
+ *      Number of half bits up to the last edge, 0 if an interval is not at least one half bit
+ *      or the frame is too long
+ */
+static unsigned char IR_Halves(const unsigned int *intervals, unsigned char cnt, unsigned int t, unsigned char start, unsigned char *h){
+    unsigned long time = 0;
+    unsigned char pos = start;
+    unsigned char end, i;
+
+    for(i=0;i<IR_MAX_HALVES/8;i++) h[i] = 0;
+
+    for(i=0;i<cnt;i++){
+        time += intervals[i];
+        end = start + (unsigned char)((time + t/2) / t);
+
+        if(end <= pos || end > IR_MAX_HALVES) return 0;
+
+        if(!(i & 1)){   //mark
+            for(;pos<end;pos++) h[pos>>3] |= 1 << (pos&7);
+        }
+        pos = end;
+    }
+
+    return pos;
+}
+
+/* SYNTHESIS
+ * The frame is rebuilt one level at a time with IR_Synth_Level, which merges runs of the same
+ * level into one interval, and drops the spaces before the first mark and after the last one.
+ */
+static unsigned int  *syn_out;
+static unsigned char syn_cnt;
+static unsigned char syn_level;
+
+static void IR_Synth_Level(unsigned char level, unsigned int ticks){
+    if(syn_cnt && level == syn_level)
+        syn_out[syn_cnt-1] += ticks;
+    else if(syn_cnt || level){
+        syn_out[syn_cnt++] = ticks;
+        syn_level = level;
+    }
+}
+
+/* Function: IR_Synth
+ * Arguments:
+ *      code: Recognized code (IR_FMT_NEC and up)
+ *      intervals: Where to store the edge intervals (at least NEC_CNT entries)
+ * Returns:
+ *      Number of intervals
+ */
+unsigned char IR_Synth(const IR_CODE *code, unsigned int *intervals){
+    const unsigned char *d = code->data;
+    unsigned long val;
+    unsigned char i, bits;
+
+    syn_out = intervals;
+    syn_cnt = 0;
+
+    switch(code->fmt){
+        case IR_FMT_NEC:
+        case IR_FMT_NECX:
+            val = d[0] | ((unsigned long)d[1] << 8) | ((unsigned long)d[2] << 16) | ((unsigned long)(unsigned char)~d[2] << 24);
+
+            IR_Synth_Level(1, NEC_HDR_MARK);
+            IR_Synth_Level(0, NEC_HDR_SPACE);
+            for(i=0;i<32;i++){
+                IR_Synth_Level(1, NEC_MARK);
+                IR_Synth_Level(0, ((val >> i) & 1) ? NEC_ONE_SPACE : NEC_ZERO_SPACE);
+            }
+            IR_Synth_Level(1, NEC_MARK);
+            break;
+        case IR_FMT_SIRC:
+            bits = d[3];
+            val = (d[2] & 0x7F) | ((unsigned long)(d[0] | (d[1] << 8)) << 7);
+
+            IR_Synth_Level(1, SIRC_HDR_MARK);
+            for(i=0;i<bits;i++){
+                IR_Synth_Level(0, SIRC_SPACE);
+                IR_Synth_Level(1, ((val >> i) & 1) ? SIRC_ONE_MARK : SIRC_ZERO_MARK);
+            }
+            break;
+        case IR_FMT_RC5:
+            val = 0x2000 | ((d[2] & 0x40) ? 0 : 0x1000) | ((unsigned int)(d[3] & 1) << 11) | ((unsigned int)(d[0] & 0x1F) << 6) | (d[2] & 0x3F);
+
+            for(i=RC5_BITS;i--;){
+                IR_Synth_Level(!((val >> i) & 1), RC5_T);
+                IR_Synth_Level((val >> i) & 1, RC5_T);
+            }
+            break;
+        case IR_FMT_RC6:
+            val = ((unsigned long)(d[3] & 0x07) << 16) | ((unsigned long)d[0] << 8) | d[2];
+
+            IR_Synth_Level(1, RC6_LEADER*RC6_T);
+            IR_Synth_Level(0, 2*RC6_T);
+            IR_Synth_Level(1, RC6_T);    //start bit
+            IR_Synth_Level(0, RC6_T);
+            for(i=19;i--;){             //mode, then address and command, toggle in between
+                IR_Synth_Level((val >> i) & 1, RC6_T);
+                IR_Synth_Level(!((val >> i) & 1), RC6_T);
+
+                if(i == 16){
+                    IR_Synth_Level((d[3] >> 3) & 1, 2*RC6_T);
+                    IR_Synth_Level(!((d[3] >> 3) & 1), 2*RC6_T);
+                }
+            }
+            break;
+        default: break;
+    }
+
+    if(syn_cnt && !syn_level) syn_cnt--;    //the trailing space is the gap
+
+    return syn_cnt;
+}
+
+/* Function: IR_Is_Repeat
+ * Arguments:
+ *      intervals: Edge intervals of one frame, in SMCLK ticks
+ *      cnt: Number of intervals
+ * Returns:
+ *      Non-zero if the frame is an NEC repeat code
+ */
+unsigned char IR_Is_Repeat(const unsigned int *intervals, unsigned char cnt){
+    return cnt == IR_NEC_REPEAT_CNT && IR_Near(intervals[0], NEC_HDR_MARK)
+        && IR_Near(intervals[1], NEC_REP_SPACE) && IR_Near(intervals[2], NEC_MARK);
+}
+
+/* Function: IR_Synth_Repeat
+ * Arguments:
+ *      intervals: Where to store the edge intervals (IR_NEC_REPEAT_CNT entries)
+ * Returns:
+ *      Number of intervals
+ */
+unsigned char IR_Synth_Repeat(unsigned int *intervals){
+    intervals[0] = NEC_HDR_MARK;
+    intervals[1] = NEC_REP_SPACE;
+    intervals[2] = NEC_MARK;
+
+    return IR_NEC_REPEAT_CNT;
+}
@@ -8,10 +8,14 @@
  *      LCD_Digit(digit, pos): Outputs `digit` at `pos`
  *      LCD_Letter(letter, pos): Outputs 'letter' at `pos`
  *      LCD_Number(num): Outputs up-to-6-digit `num` (starting from left-most pos)
+ *      LCD_Fixed_Point(num, dp): Same as LCD_Number, with `dp` digits after the decimal point
  *      LCD_Negative_Sign(): Prints negative sign
  *      LCD_Decimal_Point(pos): Prints decimal point at`pos`
  *      LCD_Degree_Symbol(): Prints the degree symbol for temperature display
  *      LCD_IR_Keypad(btn): Prints the corresponding button that is pressed
+ *      LCD_Text(msg): Outputs `msg`, scrolling it in the background if it does not fit
+ *      LCD_Scroll_Step(): Scrolls the LCD_Text message by one letter (WDT ISR)
+ *      LCD_Scrolling(): Checks if LCD_Text is still scrolling
  *
  * Header Files:
  *      MSP430FR4133.h
@@ -26,6 +30,11 @@
 
 static const unsigned char POS[7] = {0, pos1, pos2, pos3, pos4, pos5, pos6};
 
+//LCD_Text scrolling (see TEXT SCROLLING)
+static const char * volatile scroll_msg = 0;    //message being scrolled, 0 if none
+static unsigned char scroll_pos;                //letter shown at pos1
+static unsigned char scroll_len;
+
 //LCD digit display table
 static const char digit[10] =
 {
@@ -41,37 +50,27 @@ static const char digit[10] =
 		0xF7   /* "9" */
 };
 
-//LCD alphabet display table
-static const char alphabet[28][2] =
+//LCD character table for LCD_Letter, indexed by ASCII code
+//Low byte goes to LCDMEM[pos], high byte to LCDMEM[pos+1] (one word write, see LCDMEMW)
+//Lowercase letters show as uppercase; characters the LCD cannot show are blank
+static const unsigned int glyph[128] =
 {
-		{0xEF, 0x00},  /* "A" */ //0
-		{0xF1, 0x50},  /* "B" */ //1
-		{0x9C, 0x00},  /* "C" */ //2
-		{0xF0, 0x50},  /* "D" */ //3
-		{0x9F, 0x00},  /* "E" */ //4
-		{0x8F, 0x00},  /* "F" */ //5
-		{0xBD, 0x00},  /* "G" */ //6
-		{0x6F, 0x00},  /* "H" */ //7
-		{0x90, 0x50},  /* "I" */ //8
-		{0x78, 0x00},  /* "J" */ //9
-		{0x0E, 0x22},  /* "K" */ //10
-		{0x1C, 0x00},  /* "L" */ //11
-		{0x6C, 0xA0},  /* "M" */ //12
-		{0x6C, 0x82},  /* "N" */ //13
-		{0xFC, 0x00},  /* "O" */ //14
-		{0xCF, 0x00},  /* "P" */ //15
-		{0xFC, 0x02},  /* "Q" */ //16
-		{0xCF, 0x02},  /* "R" */ //17
-		{0xB7, 0x00},  /* "S" */ //18
-		{0x80, 0x50},  /* "T" */ //19
-		{0x7C, 0x00},  /* "U" */ //20
-		{0x0C, 0x28},  /* "V" */ //21
-		{0x6C, 0x0A},  /* "W" */ //22
-		{0x00, 0xAA},  /* "X" */ //23
-		{0x00, 0xB0},  /* "Y" */ //24
-		{0x90, 0x28},  /* "Z" */ //25
-		{0x03, 0x50},  /* "+" */ //26
-		{0x03, 0x00}   /* "-" */ //27
+		0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  /* 0x00-0x07: control */
+		0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  /* 0x08-0x0F: control */
+		0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  /* 0x10-0x17: control */
+		0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  /* 0x18-0x1F: control */
+		0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  /* 0x20: SP ! " # $ % & ' */
+		0x0000, 0x0000, 0x0000, 0x5003, 0x0000, 0x0003, 0x0100, 0x0000,  /* 0x28: ( ) * + , - . / */
+		0x00FC, 0x0060, 0x00DB, 0x00F3, 0x0067, 0x00B7, 0x00BF, 0x00E4,  /* 0x30: 0 1 2 3 4 5 6 7 */
+		0x00FF, 0x00F7, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  /* 0x38: 8 9 : ; < = > ? */
+		0x0000, 0x00EF, 0x50F1, 0x009C, 0x50F0, 0x009F, 0x008F, 0x00BD,  /* 0x40: @ A B C D E F G */
+		0x006F, 0x5090, 0x0078, 0x220E, 0x001C, 0xA06C, 0x826C, 0x00FC,  /* 0x48: H I J K L M N O */
+		0x00CF, 0x02FC, 0x02CF, 0x00B7, 0x5080, 0x007C, 0x280C, 0x0A6C,  /* 0x50: P Q R S T U V W */
+		0xAA00, 0xB000, 0x2890, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  /* 0x58: X Y Z [ \ ] ^ _ */
+		0x0000, 0x00EF, 0x50F1, 0x009C, 0x50F0, 0x009F, 0x008F, 0x00BD,  /* 0x60: ` a b c d e f g */
+		0x006F, 0x5090, 0x0078, 0x220E, 0x001C, 0xA06C, 0x826C, 0x00FC,  /* 0x68: h i j k l m n o */
+		0x00CF, 0x02FC, 0x02CF, 0x00B7, 0x5080, 0x007C, 0x280C, 0x0A6C,  /* 0x70: p q r s t u v w */
+		0xAA00, 0xB000, 0x2890, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000   /* 0x78: x y z { | } ~ DEL */
 };
 
 // Initialize LCD
@@ -112,6 +111,8 @@ void LCD_Init()
 void LCD_Clear()
 {
 	unsigned char i = 18;
+
+    scroll_msg = 0;                             //stops LCD_Text scrolling
 	while(i--)
 		LCDMEM[i+2] = 0x00;
 
@@ -125,66 +126,67 @@ void LCD_Digit(unsigned char dg, unsigned char pos)
 }
 
 // LCD letter display function
+// Sets both bytes of `pos` (pos1-pos6), so whatever was there before is overwritten
 void LCD_Letter(char ch, unsigned char pos)
 {
-    switch(ch){
-        case ' ':
-            LCDMEM[pos] = 0x00;
-            LCDMEM[pos+1] = 0x00;
-            break;
-        case '.':
-            LCDMEM[pos+1] = 0x01;
-            break;
-        case '+':
-            LCDMEM[pos]   = alphabet[26][0];
-            LCDMEM[pos+1] = alphabet[26][1];
-            break;
-        case '-':
-            LCDMEM[pos]   = alphabet[27][0];
-            LCDMEM[pos+1] = alphabet[27][1];
-            break;
-        case 'a': case 'b': case 'c': case 'd': case 'e': case 'f': case 'g': case 'h': case 'i': case 'j': case 'k': case 'l': case 'm': case 'n': case 'o': case 'p': case 'q': case 'r': case 's': case 't': case 'u': case 'v': case 'w': case 'x': case 'y': case 'z':
-            LCDMEM[pos]   = alphabet[ch-'a'][0];
-            LCDMEM[pos+1] = alphabet[ch-'a'][1];
-            break;
-        case 'A': case 'B': case 'C': case 'D': case 'E': case 'F': case 'G': case 'H': case 'I': case 'J': case 'K': case 'L': case 'M': case 'N': case 'O': case 'P': case 'Q': case 'R': case 'S': case 'T': case 'U': case 'V': case 'W': case 'X': case 'Y': case 'Z':
-            LCDMEM[pos]   = alphabet[ch-'A'][0];
-            LCDMEM[pos+1] = alphabet[ch-'A'][1];
-            break;
-        case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
-            LCDMEM[pos] = digit[ch-'0'];
-            break;
-        default:
-            LCDMEM[pos] = 0x00;
-            LCDMEM[pos+1] = 0x00;
-            break;
+    LCDMEMW[pos>>1] = ((unsigned char)ch < 128) ? glyph[(unsigned char)ch] : 0;
+}
+
+/* NUMBER FORMATTING
+ * There is no hardware divider, so n%10 and n/=10 on a long are each a call to the software divide.
+ * Instead, each digit is found by subtracting its power of ten until it no longer fits (at most 9 times),
+ * from the left-most digit. Once the number is below 10000 the rest is done in 16 bits.
+ */
+static const unsigned long POW10_HI[2] = {100000, 10000};
+static const unsigned int POW10_LO[4] = {1000, 100, 10, 1};
+
+/* Function: LCD_Fixed_Point
+ * Outputs up-to-6-digit `n` (starting from left-most pos), with `dp` of its digits after the decimal point
+ * eg. LCD_Fixed_Point(-1234, 2) shows -12.34, LCD_Fixed_Point(5, 2) shows 0.05
+ * Shows INF if it does not fit.
+ */
+void LCD_Fixed_Point(long n, unsigned char dp){
+    unsigned long hi;
+    unsigned int lo;
+    unsigned char dg[6];
+    unsigned char len = 0;
+    unsigned char i, d;
+
+    LCD_Clear();
+
+    if(n<0){
+        LCD_Negative_Sign();
+        hi = -(unsigned long)n;     //also right for the most negative long
     }
+    else hi = n;
+
+    if(hi > 999999 || dp > 5){
+        LCD_Letter('I',pos1);
+        LCD_Letter('N',pos2);
+        LCD_Letter('F',pos3);
+        return;
+    }
+
+    //Leading zeros are skipped, except the one in front of the decimal point (and the last digit)
+    for(i=0;i<2;i++){
+        for(d=0; hi>=POW10_HI[i]; d++) hi -= POW10_HI[i];
+        if(d || len || i>=5-dp) dg[len++] = d;
+    }
+
+    lo = (unsigned int)hi;
+    for(i=0;i<4;i++){
+        for(d=0; lo>=POW10_LO[i]; d++) lo -= POW10_LO[i];
+        if(d || len || i+2>=5-dp) dg[len++] = d;
+    }
+
+    for(i=0;i<len;i++)
+        LCD_Digit(dg[i],POS[i+1]);
+
+    if(dp) LCD_Decimal_Point(POS[len-dp]);
 }
 
 void LCD_Number(long n){
-	LCD_Clear();
-	
-	if(n<0){
-		LCD_Negative_Sign();
-		n = -n;	
-	}
-	
-	unsigned int len = INT_LEN(n);
-	
-	if(len==0 || len>6){
-		LCD_Letter('I',pos1);
-		LCD_Letter('N',pos2);
-		LCD_Letter('F',pos3);
-		return;
-	}
-	
-	unsigned int i = len;
-	unsigned char lastDigit;
-	while(i--){
-		lastDigit = (unsigned char)(n%10);
-		LCD_Digit(lastDigit,POS[i+1]);
-		n/=10;
-	}
+    LCD_Fixed_Point(n, 0);
 }
 
 void LCD_Negative_Sign(){
@@ -273,12 +275,29 @@ void LCD_IR_Buttons(unsigned char btn) {
     }
 }
 
+/* TEXT SCROLLING
+ * Messages of 7 letters or more scroll one letter per WDT interval (ACLK/8192 = 250ms).
+ * LCD_Text only draws the first frame and starts the WDT; LCD_Scroll_Step (WDT ISR, IR_Board.c) draws
+ * the others, so the CPU sleeps in LPM3 between frames instead of spinning in __delay_cycles.
+ * Calling LCD_Text again replaces the message, and LCD_Clear (ie. any other full redraw) cancels it.
+ *
+ * NOTE: `msg` is read until the scroll is over, so it must stay valid (eg. a string literal).
+ */
+//Draws the 6 letters of `msg` starting at scroll_pos
+static void LCD_Scroll_Frame(const char *msg){
+    unsigned char j = 6;
+
+    while(j--){
+        LCD_Letter( (scroll_pos+j<scroll_len)?msg[scroll_pos+j]:' ', POS[j+1]);
+    }
+}
+
 void LCD_Text(char *msg){
     //unsigned int len = strlen(msg);
     unsigned int len = 0;
     while(msg[len]!='\0') len++; //gets length of string (didn't want to include heavy string.h library just for strlen)
 
-    unsigned char i,j;
+    unsigned char i;
 
     LCD_Clear();
 
@@ -289,20 +308,42 @@ void LCD_Text(char *msg){
         return;
     }
 
-    for (i=0; i<len; i++){
-        if(buttonDebounce == BUTTON_PRESSED) return;
+    scroll_pos = 0;
+    scroll_len = (len > 255) ? 255 : len;
+    LCD_Scroll_Frame(msg);
+    scroll_msg = msg;                           //set last: the WDT ISR may step it from here on
 
-        j=6;
-        while(j--){
-            LCD_Letter( (i+j<len)?msg[i+j]:' ', POS[j+1]);
-        }
+    if(!(SFRIE1 & WDTIE)){                      //start the WDT, unless it is already running
+        SFRIFG1 &= ~WDTIFG;
+        WDTCTL = WDTPW + WDTSSEL_1 + WDTTMSEL + WDTCNTCL + WDTIS_5;
+        SFRIE1 |= WDTIE;
+    }
+}
+
+/* Function: LCD_Scroll_Step
+ * Shows the next frame of the message from LCD_Text; call once per WDT interval.
+ * Returns:
+ *      1 if the message has just scrolled off (the screen is left clear), 0 otherwise
+ */
+unsigned char LCD_Scroll_Step(){
+    const char *msg = scroll_msg;
 
-        //TODO: Instead of delay cycles, use a timer.
-        __delay_cycles(2000000); //8000000 delay is 1s => this delay is 0.25s
+    if(!msg) return 0;
 
-        LCD_Clear();
+    if(++scroll_pos >= scroll_len){
+        LCD_Clear();                            //also ends the scroll
+        return 1;
     }
 
-    __delay_cycles(1000000); //8000000 delay is 1s => this delay is 0.125s
+    LCD_Scroll_Frame(msg);
+    return 0;
+}
+
+/* Function: LCD_Scrolling
+ * Returns:
+ *      1 while a message from LCD_Text is still scrolling, 0 otherwise
+ */
+unsigned char LCD_Scrolling(){
+    return scroll_msg != 0;
 }
 
@@ -6,11 +6,14 @@
  *  	Init_GPIO: Initializes ports
  *	Init_Clock: Initializes XT1 OSC and DCO
  *
+ *	Dispatch_Event: Acts on an event posted by the ISRs (keypad, S1/S2)
  *	IR_Mode_Setting: Sets mode for IR mode accordingly
  * 
  * Connects to: 
  * 		LCD.c/h
  * 		IR_Board.c/h
+ * 		IR_Codec.c/h
+ * 		IR_Protocol.c
  *
  *
  * 	NOTE: Disconnect the UART RX Jumper on the Launchpad for the "3,6,9,Cool" column to work.
@@ -24,19 +27,20 @@
 #include "main.h"
 #include "LCD.h"
 #include "IR_Board.h"
+#include "IR_Codec.h"
 
 //IR Keypad Buttons
 unsigned char button_num = TOTAL_KEYS+1;     //button number
 unsigned char buttonDebounce = BUTTON_READY;
-
-/*  TODO: Somehow allow for at least 3 modes by compressing the TX data
- *      - Change the time difference to unsigned char
- *      - Store the time difference as a fraction/multiple of the period, thus allowing for storing as unsigned char
- *      - Compress the format by which it is sent?
- */
+unsigned int  button_map = 0;   //all keys down with button_num, for chords
+KEY_EVENT     key_event;
 
 #define TOTAL_CODES 14
-#define MAX_IR_CNT 255
+#define TOTAL_MODES 3
+
+//Appliance modes (cycled with S1)
+static const char* MODE_NAMES[] = { "MODE 1", "MODE 2", "MODE 3" };
+unsigned char   mode = 0;
 
 //IR mode/status
 enum IR_STATE {
@@ -51,25 +55,107 @@ unsigned char   code_num = 0;
 boolean copy_mode;
 
 //RX,TX and Timer Counters
-#pragma PERSISTENT(rx_cnt);     //store rx_cnt in FRAM | TODO: Better partition memory
-unsigned char    rx_cnt[TOTAL_CODES]={0}; //received bit counter (unsigned char is good enough since the max size of the count is 255
-unsigned char    tx_cnt=1;          //transmitted bit counter
-
-unsigned int    old_cnt=0;      //old timer counter
+unsigned char    ir_cnt=0;          //number of intervals in ir_buf to transmit
+unsigned char    tx_cnt=0;          //transmitted bit counter
+unsigned char    rx_head=1;         //next free slot in the capture ring
+
+//Repeated frames on playback (see TIMER0_A0_ISR)
+unsigned char    tx_rep=0;          //repeats left to send
+unsigned int     tx_gap_hi=0;       //0x8000-tick chunks in the gap between repeats
+unsigned int     tx_gap_lo=0;       //rest of the gap, in ticks
+unsigned int     tx_gap_n=0;        //gap chunks sent so far
+unsigned char    tx_rep_at=0;       //first interval of ir_buf sent again on a repeat
+unsigned char    tx_rep_end=0;      //ir_cnt for the repeats
+unsigned int     tx_rgap_hi=0;      //gap before the second and later repeats, as tx_gap_hi/lo
+unsigned int     tx_rgap_lo=0;
+
+/* IR code RAM buffer
+ * RX: Capture ring of raw TA0.2 timestamps, indexed by the 8-bit rx_head so it wraps by itself.
+ *     ir_buf[0] holds the TACLR time (0) so the first edge has something to be subtracted from.
+ *     The ISR only stores the timestamp; the intervals are worked out and compressed into FRAM
+ *     in one batch once the burst is over (see IR_Commit).
+ *     The ring wrapping back to 0 means it is full (255 edges), which also ends the burst.
+ * TX: The FRAM code is decoded back into here, so the TA0.0 ISR just reads ticks.
+ *     An NEC repeat code, if the code has one, goes straight after the frame (see IR_Tx_Load).
+ */
+#define IR_RING_SIZE 256
+unsigned int ir_buf[IR_RING_SIZE];
+unsigned int *ir_ptr = &ir_buf[0];
+
+/* End of frame and repeat detection
+ * TA0.1 is re-armed IR_FRAME_GAP after every edge from the second one on (it measures the carrier
+ * before that); if it fires, the line has been idle for longer than any mark/space inside a frame
+ * (NEC's 9ms header is the longest), so the frame is over.
+ * The capture then carries on to record the repeats of a held key (up to IR_MAX_FRAMES frames),
+ * and ends once no new frame has started for IR_BURST_GAP TA0 overflows (16.4ms each at 4MHz).
+ * Gaps are longer than the 16-bit timer, so they are measured from the TA0.1 compare time plus
+ * the overflows counted since. IR_Commit folds identical repeats, or the NEC repeat codes sent
+ * after the frame, into a repeat count and gap.
+ * Until the first edge, overflows are counted too, and the learn session is given up after
+ * IR_LEARN_TIMEOUT of them.
+ */
+#define IR_FRAME_GAP 48000          //12ms at SMCLK = 4MHz
+#define IR_BURST_GAP 10             //10 * 16.4ms = 164ms, longer than the repeat period of NEC/RC5/RC6/SIRC
+#define IR_LEARN_TIMEOUT 305        //305 * 16.4ms = 5s
+#define IR_MAX_FRAMES 8
+
+unsigned int  rx_ovf = 0;                   //TA0 overflows since the start / since the last frame ended
+unsigned int  rx_gap_ref = 0;               //TA0 time at which the current gap was detected
+boolean       rx_gap_open = FALSE;          //frame over, waiting for a repeat
+boolean       rx_carrier = FALSE;           //TA0.1 is still on the carrier, not timing the gap
+unsigned char rx_frames = 1;                //frames captured so far
+unsigned char rx_frame[IR_MAX_FRAMES];      //ring index of the first edge of each frame
+unsigned long rx_gap[IR_MAX_FRAMES];        //gap before each frame, in SMCLK ticks
+
+/* Carrier measurement
+ * The receiver on P1.6 strips the carrier, so it is measured on a second input, TA0.1
+ * (pin P1.7/TA0.1/TDO/A7, which is CCI1A with P1SEL0.7 set; TDO only in 4-wire JTAG), wired to an unfiltered IR detector (eg. a TSMP58000
+ * learning receiver, whose output is low while IR is on). TA0.1 shares the TA0 timebase with the
+ * receiver, and is only needed for the frame gap once the first mark is over, so:
+ *  - From the start of the capture, TA0.1 captures CARRIER_EDGES edges, switching between the edge
+ *    that turns the carrier on (CARRIER_EDGE) and the one that turns it off, so even entries of
+ *    carrier_buf are pulse starts and odd ones pulse ends.
+ *  - The second TA0.2 edge (end of the first mark) switches TA0.1 over to the gap compare. If it
+ *    does not come, the first TA0 overflow after the first edge does (see TIMER0_A1_ISR).
+ * CARRIER_EDGES edges take well under the shortest first mark of any protocol (RC5's 889us).
+ * IR_Carrier turns them into the TA1CCR0/TA1CCR2 values for playback.
+ * With nothing connected (pulled up), no edges arrive and the code is played back at 38kHz.
+ */
+#define CARRIER_DIR     P1DIR
+#define CARRIER_SEL     P1SEL0
+#define CARRIER_REN     P1REN
+#define CARRIER_OUT     P1OUT
+#define CARRIER_PIN     BIT7        //P1.7: TA0.1 input (CCI1A)
+#define CARRIER_EDGE    CM_2        //edge at which the carrier turns on (falling for active low detectors)
+#define CARRIER_EDGES   32          //16 carrier cycles, well inside the first mark of any protocol
+#define CARRIER_MIN     66          //60kHz, shortest period accepted, in SMCLK ticks
+#define CARRIER_MAX     200         //20kHz, longest period accepted
+#define CARRIER_PERIOD  104         //default TA1CCR0: 38kHz
+#define CARRIER_DUTY    25          //default TA1CCR2: 1/4 duty
+
+unsigned int  carrier_buf[CARRIER_EDGES];   //TA0.1 capture times
+unsigned char carrier_cnt = 0;
 
 //FRAM Writing and Reading
-//const unsigned int FRAM_START_ADDRESSES[] = { 0xC400, 0xDFE4, 0xFBC8 };
-/* IMPORTANT NOTE: FRAM supports only from address 0xC400 to 0xFF80,
- *       thus the last mode will not be supported/have data truncated/truncate other's data
- *       Difference of exactly 2 * 255 * 14 = 7140 bytes/addresses between each address
- *          (2 bytes for unsigned int, 255 maximum entries per code_num and 14 TOTAL_CODES)
- *       This ensures that when writing the IR signals, they don't override that of another mode.
+/* IMPORTANT NOTE: FRAM supports only from address 0xC400 to 0xFF80 (15232 bytes)
+ *       Raw storage needed 2 * 255 * 14 = 7140 bytes per mode, so only 2 modes could fit.
+ *       Compressed codes (see IR_Codec.c) take sizeof(IR_CODE) = 160 bytes each,
+ *       ie. 160 * 14 * 3 = 6720 bytes for all 3 modes.
  */
-#pragma PERSISTENT(tx_data);
-unsigned int tx_data[TOTAL_CODES][MAX_IR_CNT] = {0};
+#pragma PERSISTENT(ir_codes);
+IR_CODE ir_codes[TOTAL_MODES][TOTAL_CODES] = {0};
 
-unsigned int *FRAM_write_ptr = (unsigned int *)(&tx_data[0]);
-unsigned int *FRAM_read_ptr  = (unsigned int *)(&tx_data[0]);
+IR_CODE *rx_code = &ir_codes[0][0];     //code being captured
+
+void IR_Commit(void);
+void IR_Tx_Load(const IR_CODE *);
+static unsigned long IR_Duration(const unsigned int *, unsigned int);
+static void IR_Gap_Split(unsigned long, unsigned int *, unsigned int *);
+static boolean IR_Frame_Match(const unsigned int *, const unsigned int *, unsigned int);
+static void IR_Frame_Start(void);
+static boolean IR_Frame_End(unsigned int, unsigned int);
+static void IR_End_Capture(void);
+static void IR_Carrier(unsigned char *, unsigned char *);
 
 int main(void){
     WDTCTL = WDTPW | WDTHOLD;   // Stop watchdog timer
@@ -91,21 +177,42 @@ int main(void){
     P1DIR &= ~BIT6;                             //Set P1.6 as input
     P1SEL0|=  BIT6;                             //Set P1.6 as TA0.2 input
 
+    // Configure carrier input pin
+    CARRIER_DIR &= ~CARRIER_PIN;                //Set as input, pulled up when nothing is connected
+    CARRIER_REN |= CARRIER_PIN;
+    CARRIER_OUT |= CARRIER_PIN;
+    CARRIER_SEL |= CARRIER_PIN;                 //TA0.1 input
+
     copy_mode = FALSE;
     IR_status = DISABLED;
 
     while(1) {
+        // Events posted by the ISRs: keypad (RTC scan, IR_Board.c) and S1/S2 (port ISRs)
+        while(Key_Get_Event(&key_event)) Dispatch_Event();
+
         if(copy_mode == TRUE){
             if(IR_status == RECEIVING) {
                 /* USER ASKS TO RECEIVE; BEGIN COPYING OVER THE SIGNAL
-                 * 1. Start TA0.2 timer to enable the receive
-                 * 2. Write to FRAM in the TA0.2 interrupt
+                 * 1. Start TA0.2 timer to enable the receive, and TA0.1 to measure the carrier
+                 * 2. Store edge timestamps in the RAM ring in the TA0.2 interrupt
                  * 3. Enter LPM3 to pause until the receive is complete
-                 * 4. In the TA0.2 interrupt, when receiving is maxed out, or a button is pressed, it will flag as IR_status = disabled, and exit LPM3
-                 * 5. Timer stops and code continues (actually it just enters LPM3 again).
+                 * 4. When the repeats stop (TA0.1 gap + TA0 overflows), the ring is full, nothing arrives, or a button is pressed,
+                 *    IR_status = disabled, and LPM3 is exited
+                 * 5. Timer stops, repeats are folded and the capture is compressed into FRAM in one go.
                  */
 
-                TA0CTL      =   TASSEL_2 | MC__CONTINUOUS | TACLR;   //SMCLK, Continuous mode
+                rx_code = &ir_codes[mode][code_num];
+                ir_buf[0] = 0;
+                rx_head = 1;
+                rx_ovf = 0;
+                rx_gap_open = FALSE;
+                rx_frames = 1;
+                rx_frame[0] = 1;
+                carrier_cnt = 0;
+                rx_carrier = TRUE;
+
+                TA0CTL      =   TASSEL_2 | MC__CONTINUOUS | TACLR | TAIE;   //SMCLK, Continuous mode, overflow interrupt for timeout
+                TA0CCTL1    =   CARRIER_EDGE | SCS | CCIS_0 | CAP | CCIE;   //TA0.1 CCI1A: carrier, until the first mark is over
                 TA0CCTL2    =   CM_3 | SCS | CCIS_0 | CAP | CCIE;  //set TA0.2 control register choose CCIxA, both edges, synchronized
 
                 // Pause by entering LPM3 until receiving complete.
@@ -114,7 +221,13 @@ int main(void){
                 __bis_SR_register(LPM3_bits | GIE);     //enter LPM3
 
                 TA0CTL = 0;
+                TA0CCTL1 = 0;
                 TA0CCTL2 = 0;
+
+                IR_Commit();
+
+                // A key was pressed during the capture: handle its event straight away (eg. copy to another button)
+                if(IR_status == RECEIVING) continue;
             }
             else{
                 //Waiting for user to press button to copy signal to
@@ -125,19 +238,24 @@ int main(void){
         {
             /* USER ASKS TO TRANSMIT; BEGIN SENDING THE SIGNAL
              * 1. Configure IR output pins
-             * 2. Disable all P1/2 interrupts: Prevents unwanted exit of LPM3 in the middle of signal send
+             * 2. Disable the S1/S2 interrupts: Prevents the signal send being cancelled halfway
              * 3. Configure IR modulation using ASK protocol
              * 3. Enter LPM3 to pause until the transmit is complete
              * 4. In the TA0.0 interrupt, when transmit is complete, exits LPM3.
              * 5. Stop all timers, renable interrupts and continue code (actually enters LPM3 again).
              */
 
+            // Expand the stored code into ticks before starting, so the TA0.0 ISR stays short
+            IR_Tx_Load(&ir_codes[mode][code_num]);
+
+            P4OUT |= BIT0;                       // LED on while transmitting
+
             // Configure IR output pin
             P1SEL0 |= BIT0;                      // use internal IR modulator
 
-            // Disable Port1 & Port2 interrupt
-            P1IE = 0;
-            P2IE = 0;
+            // Disable push button interrupts; keypad events wait in the queue until the code is sent
+            P1IE &= ~BIT2;
+            P2IE &= ~BIT6;
 
             // Configure IR modulation: ASK
             SYSCFG1 = IRDSSEL + IREN;
@@ -145,9 +263,15 @@ int main(void){
             TA0CCTL2 = OUTMOD_0;                // output mode: output
             TA1CCTL2 = OUTMOD_7;                // output mode: reset/set
 
-            // 38kHz 1/4 duty-cycle carrier waveform length setting
-            TA1CCR0 = 104;
-            TA1CCR2 = 25;
+            // carrier waveform length setting, as learned (38kHz 1/4 duty-cycle if not measured)
+            if(ir_codes[mode][code_num].carrier){
+                TA1CCR0 = ir_codes[mode][code_num].carrier;
+                TA1CCR2 = ir_codes[mode][code_num].carrier_duty;
+            }
+            else{
+                TA1CCR0 = CARRIER_PERIOD;
+                TA1CCR2 = CARRIER_DUTY;
+            }
 
             // envelope signal length setting
             TA0CCR0 = 640;                      //the initial time of TA0 should be longer than TA1
@@ -157,8 +281,13 @@ int main(void){
             TA0CTL = TASSEL_2 + MC_1 + TACLR;   //SMCLK, UP mode
 
             // stop until the end of IR code by entering LPM3
-            // button interrupts MUST be disabled so it doesn't accidentally cause LPM3 exit
-            __bis_SR_register(LPM3_bits | GIE);
+            // a key press also exits LPM3, so go back to sleep until the TA0.0 ISR says it is done
+            __disable_interrupt();
+            while(IR_status == TRANSMITTING){
+                __bis_SR_register(LPM3_bits | GIE);
+                __disable_interrupt();
+            }
+            __enable_interrupt();
 
             // Transmission complete: disable timer TA0 and TA1
             TA0CCTL0 = 0;
@@ -172,9 +301,9 @@ int main(void){
             TA1CCR0 = 0;
             TA1CCR2 = 0;
 
-            // Renable push button and keypad interrupt
-            P1IE |= (BIT2 | BIT3 | BIT4 | BIT5);
-            P2IE |= (BIT6 | BIT7);
+            // Renable push button interrupt
+            P1IE |= BIT2;
+            P2IE |= BIT6;
         }
 
         if(IR_status == DISABLED){
@@ -182,14 +311,295 @@ int main(void){
             //__delay_cycles(1600000);
         }
 
-        __bis_SR_register(LPM3_bits | GIE);     //enter low power mode
+        Key_Wait();     //enter low power mode, unless a key event is waiting
+    }
+}
+
+
+/* Function: IR_Commit
+ * Turns the timestamps in the capture ring into intervals and saves them to FRAM in one batch,
+ * so FRAM is unlocked once per capture rather than on every edge.
+ *
+ * REPEAT FOLDING
+ * Frame k's intervals are ir_buf[rx_frame[k]+1] up to the first edge of frame k+1.
+ * (ir_buf[1] is the idle time before the first edge, and the interval at a frame's first edge
+ * spans the gap, which does not fit 16 bits; both are dropped.)
+ * Every following frame that matches the first one is folded into `repeat`, with the average gap.
+ * NEC remotes send a short repeat code (IR_Is_Repeat) instead of the frame while the key is held;
+ * those are folded the same way, with IR_REPEAT_NEC set. A repeat code is much shorter than the
+ * frame, so the gap after it is longer: the average period (start to start) is stored instead.
+ * A frame that differs (or one cut off by a full ring) stops the folding, and the rest of the
+ * capture is dropped.
+ */
+void IR_Commit(){
+    unsigned int n = rx_head ? rx_head : IR_RING_SIZE;  //rx_head == 0: the ring wrapped, ie. it is full
+    unsigned int i = n;
+    unsigned int len, end, cnt;
+    unsigned long gap = 0;
+    unsigned long dur = 0;      //NEC repeat codes: length of the last frame, in ticks
+    unsigned char k, carrier, duty;
+    unsigned char nec_rep = 0;
+
+    //Timestamps -> intervals, from the back so each one is still intact when it is subtracted
+    while(--i) ir_buf[i] -= ir_buf[i-1];
+
+    len = ((rx_frames > 1) ? rx_frame[1] : n) - 2;
+
+    for(k=1;k<rx_frames;k++){
+        end = (k+1 < rx_frames) ? rx_frame[k+1] : n;
+        cnt = end - rx_frame[k] - 1;
+
+        if(!nec_rep && cnt == len && IR_Frame_Match(&ir_buf[2], &ir_buf[rx_frame[k]+1], len))
+            gap += rx_gap[k];
+        else if((k == 1 || nec_rep) && len <= MAX_IR_CNT - IR_NEC_REPEAT_CNT
+             && IR_Is_Repeat(&ir_buf[rx_frame[k]+1], (unsigned char)cnt)){
+            if(k == 1) dur = IR_Duration(&ir_buf[2], len);
+            gap += dur + rx_gap[k];
+            dur = IR_Duration(&ir_buf[rx_frame[k]+1], cnt);
+            nec_rep = IR_REPEAT_NEC;
+        }
+        else break;
+    }
+    k--; //number of repeats
+
+    if(n > 2){
+        if(k) gap = (gap/k + 8) >> 4;  //average, in 16-tick steps
+        if(gap > 0xFFFF) gap = 0xFFFF;
+
+        IR_Carrier(&carrier, &duty);
+
+        SYSCFG0 &= ~PFWP;
+        IR_Encode(&ir_buf[2], (unsigned char)len, rx_code);
+        rx_code->repeat = k | nec_rep;
+        rx_code->gap = (unsigned int)gap;
+        rx_code->carrier = carrier;
+        rx_code->carrier_duty = duty;
+        SYSCFG0 |= PFWP;
     }
+
+    rx_head = 1;
 }
 
+/* Function: IR_Tx_Load
+ * Gets `code` ready for the TA0.0 ISR: decodes it into ir_buf, and works out the repeats.
+ * With IR_REPEAT_NEC, the repeat code is put after the frame in ir_buf and sent on the repeats
+ * instead of the frame, and the gaps before the first and the later repeats are worked out
+ * from the stored period.
+ */
+void IR_Tx_Load(const IR_CODE *code){
+    unsigned long period = (unsigned long)code->gap << 4;
+    unsigned long dur;
+
+    ir_cnt = IR_Decode(code, ir_buf);
+    ir_ptr = &ir_buf[0];
+    tx_cnt = 0;
+
+    tx_rep = code->repeat & ~IR_REPEAT_NEC;
+    tx_gap_n = 0;
 
+    if(code->repeat & IR_REPEAT_NEC){
+        dur = IR_Duration(ir_buf, ir_cnt);
+        IR_Gap_Split((period > dur) ? period - dur : 0, &tx_gap_hi, &tx_gap_lo);
+
+        tx_rep_at = ir_cnt;
+        tx_rep_end = ir_cnt + IR_Synth_Repeat(&ir_buf[ir_cnt]);
+        dur = IR_Duration(&ir_buf[tx_rep_at], IR_NEC_REPEAT_CNT);
+        IR_Gap_Split((period > dur) ? period - dur : 0, &tx_rgap_hi, &tx_rgap_lo);
+    }
+    else{
+        IR_Gap_Split(period, &tx_gap_hi, &tx_gap_lo);
+        tx_rgap_hi = tx_gap_hi;
+        tx_rgap_lo = tx_gap_lo;
+        tx_rep_at = 0;
+        tx_rep_end = ir_cnt;
+    }
+}
+
+/* Function: IR_Gap_Split
+ * Splits a gap of `ticks` into what fits TA0CCR0: `hi` periods of 0x8000 ticks and one of `lo`
+ */
+static void IR_Gap_Split(unsigned long ticks, unsigned int *hi, unsigned int *lo){
+    *hi = ticks >> 15;
+    *lo = ticks & 0x7FFF;
+    if(*lo < 16) *lo = 16;
+}
+
+/* Function: IR_Duration
+ * Returns:
+ *      Total of `cnt` intervals, in ticks
+ */
+static unsigned long IR_Duration(const unsigned int *intervals, unsigned int cnt){
+    unsigned long sum = 0;
+
+    while(cnt--) sum += *intervals++;
+
+    return sum;
+}
+
+/* Function: IR_Carrier
+ * Works out the carrier from the TA0.1 captures in carrier_buf.
+ * The period is the average time between pulse starts, counting only the pairs within 1/4 of the
+ * shortest one, so a capture missed by a late interrupt does not count double.
+ * The on time of each pulse is taken modulo the period for the same reason.
+ * Arguments:
+ *      period: Where to store the TA1CCR0 value, 0 if there is no usable carrier
+ *      duty: Where to store the TA1CCR2 value
+ */
+static void IR_Carrier(unsigned char *period, unsigned char *duty){
+    unsigned int  est = 0xFFFF;
+    unsigned int  sum = 0;
+    unsigned int  d, p;
+    unsigned char i, n = 0;
+
+    *period = 0;
+    *duty = 0;
+
+    for(i=2;i<carrier_cnt;i+=2){
+        d = carrier_buf[i] - carrier_buf[i-2];
+        if(d < est) est = d;
+    }
+    if(est < CARRIER_MIN || est > CARRIER_MAX) return;
+
+    for(i=2;i<carrier_cnt;i+=2){
+        d = carrier_buf[i] - carrier_buf[i-2];
+        if(d - est <= (est >> 2)){
+            sum += d;
+            n++;
+        }
+    }
+    p = (sum + (n>>1)) / n;
+
+    sum = 0;
+    n = 0;
+    for(i=1;i<carrier_cnt;i+=2){
+        d = (unsigned int)(carrier_buf[i] - carrier_buf[i-1]) % p;
+        sum += d;
+        n++;
+    }
+    if(!n) return;
+
+    *period = p - 1;
+    *duty = (sum + (n>>1)) / n;
+    if(*duty == 0) *duty = 1;
+}
+
+/* Function: IR_Frame_Match
+ * Returns:
+ *      TRUE if every interval of `b` is within 1/2^IR_DICT_TOL of the one in `a`
+ */
+static boolean IR_Frame_Match(const unsigned int *a, const unsigned int *b, unsigned int len){
+    unsigned int diff;
+
+    while(len--){
+        diff = (*a > *b) ? *a-*b : *b-*a;
+        if(diff > (*a >> IR_DICT_TOL)) return FALSE;
+        a++;
+        b++;
+    }
+
+    return TRUE;
+}
+
+/* Function: IR_Frame_Start
+ * Called from the TA0.2 ISR when the first edge after a frame gap has been stored at ir_buf[rx_head].
+ * Records where the new frame starts and how long the gap before it was.
+ */
+static void IR_Frame_Start(){
+    unsigned int ts = ir_buf[rx_head];
+    unsigned long gap = ((unsigned long)rx_ovf << 16) + ts - rx_gap_ref;
+
+    if((TA0CTL & TAIFG) && ts < 0x8000) gap += 0x10000; //wrapped before this edge, but not counted yet
+
+    rx_gap[rx_frames] = gap + IR_FRAME_GAP;
+    rx_frame[rx_frames++] = rx_head;
+    rx_gap_open = FALSE;
+}
+
+/* Function: IR_Frame_End
+ * Called from the TA0 ISR once the line has been idle for IR_FRAME_GAP: waits for a repeat,
+ * or ends the capture when IR_MAX_FRAMES frames are in.
+ * Arguments:
+ *      at: TA0 time at which the gap was detected
+ *      ovf: TA0 overflows since `at` that have already been counted (0xFFFF for a pending one
+ *           that came before `at`, so that it does not count)
+ * Returns:
+ *      TRUE if the capture is over; the calling ISR must then exit LPM3 so that main() commits it
+ */
+static boolean IR_Frame_End(unsigned int at, unsigned int ovf){
+    TA0CCTL1 = 0;
+
+    if(rx_frames < IR_MAX_FRAMES){ //wait for a repeat
+        rx_gap_ref = at;
+        rx_ovf = ovf;
+        rx_gap_open = TRUE;
+        return FALSE;
+    }
+
+    IR_End_Capture();
+    return TRUE;
+}
+
+/* Function: IR_End_Capture
+ * Stops the TA0.1/TA0.2 capture interrupts and ends the learn session.
+ * The calling ISR must still exit LPM3 so that main() commits the capture.
+ */
+static void IR_End_Capture(){
+    TA0CCTL1 = 0;
+    TA0CCTL2 &= ~CCIE;
+    TA0CTL &= ~TAIE;
+    IR_status = DISABLED;
+    P4OUT &= ~BIT0;
+}
+
+/* Function: Dispatch_Event
+ * Acts on `key_event`, outside of interrupt context.
+ *      KEY_DOWN: Keypad button (see IR_Mode_Setting)
+ *      BUTTON_DOWN: S1 goes to the next mode, S2 leaves copy mode
+ */
+void Dispatch_Event(){
+    switch(key_event.type){
+        case KEY_DOWN:
+            button_num = key_event.key;
+            button_map = key_event.map;
+            IR_Mode_Setting();
+            break;
+        case BUTTON_DOWN:
+            copy_mode = FALSE;
+            IR_status = DISABLED;
+
+            if(key_event.key == BUTTON_S1){
+                mode++;
+                if(mode>=TOTAL_MODES) mode = 0;
+
+                LCD_Text( (char*)(MODE_NAMES[mode]) );
+            }
+            break;
+        default: break;
+    }
+}
+
+/* Function: IR_Mode_Setting
+ * Acts on keypad button `button_num`.
+ * Chords (see button_map):
+ *      OK + 1/2/3: Go straight to that mode (like S1)
+ */
 void IR_Mode_Setting(){
+    unsigned char digit;
+
     LCD_Clear();
 
+    if(button_num != 1 && (button_map & KEY_BIT(1))) {  //OK held down
+        digit = index_to_keypad_num(button_num);
+
+        if(digit >= 1 && digit <= TOTAL_MODES) {
+            mode = digit - 1;
+            copy_mode = FALSE;
+            IR_status = DISABLED;
+            LCD_Text( (char*)(MODE_NAMES[mode]) );
+            return;
+        }
+    }
+
     if(button_num == 2) {
         copy_mode = TRUE;
         LCD_Text("COPY");
@@ -211,16 +621,10 @@ void IR_Mode_Setting(){
 
         if(copy_mode == TRUE){  //copy mode => Perform copy
             P4OUT |= (BIT0);
-            FRAM_write_ptr = &tx_data[code_num][0];
-
-            SYSCFG0 &= ~PFWP;
-            rx_cnt[code_num] = 0;
-            SYSCFG0 |= PFWP;
-
             IR_status = RECEIVING;
         }
         else{ //transmit mode => Perform transmit
-            if(rx_cnt[code_num] > 0) {  // valid IR code
+            if(ir_codes[mode][code_num].cnt > 0) {  // valid IR code
                 LCD_IR_Buttons(button_num);
                 IR_status = TRANSMITTING;
             }
@@ -228,12 +632,10 @@ void IR_Mode_Setting(){
                 LCD_Text("NONE");
                 IR_status = DISABLED;
             }
-
-            FRAM_read_ptr = &tx_data[code_num][0];
         }
     }
     else{
-        //LCD_Text( (char*)(MODE_NAMES[mode]) );
+        LCD_Text( (char*)(MODE_NAMES[mode]) );
         IR_status = DISABLED;
     }
 }
@@ -334,8 +736,7 @@ __interrupt void PORT1_ISR(void)
                 P1OUT |= BIT0;
                 Buttons_startWDT();
 
-                copy_mode = FALSE;
-                IR_status = DISABLED;
+                Key_Post(BUTTON_DOWN, BUTTON_S1);  //handled in main (Dispatch_Event)
             }
             __bic_SR_register_on_exit(LPM3_bits); //exit LPM3
             break;
@@ -343,17 +744,8 @@ __interrupt void PORT1_ISR(void)
         case P1IV_P1IFG4:
         case P1IV_P1IFG5:
             P1IFG &= ~(BIT3 | BIT4 | BIT5);
-
-            if (buttonDebounce == BUTTON_READY){
-                buttonDebounce = BUTTON_PRESSED;
-
-                Buttons_startWDT();
-                button_num = scan_key(); // scan the keypad
-                IR_Mode_Setting();
-
-                __bic_SR_register_on_exit(LPM3_bits); //exit LPM3
-            }
-             break;
+            Keypad_Start_Scan();    //keys are read and posted by the RTC scan
+            break;
         case P1IV_P1IFG6 : break;
         case P1IV_P1IFG7 : break;
     }
@@ -384,59 +776,66 @@ __interrupt void PORT2_ISR(void)
                 P1OUT |= BIT0;
                 Buttons_startWDT();
 
-                copy_mode = FALSE;
-                IR_status = DISABLED;
+                Key_Post(BUTTON_DOWN, BUTTON_S2);  //handled in main (Dispatch_Event)
             }
             __bic_SR_register_on_exit(LPM3_bits); //exit LPM3
             break;
         case P2IV_P2IFG7:
             P2IFG &= ~BIT7;                                  // clear IFG
-            if (buttonDebounce == BUTTON_READY){
-                buttonDebounce = BUTTON_PRESSED;
-
-                Buttons_startWDT();
-                button_num = scan_key(); // scan the keypad
-                IR_Mode_Setting();
-
-                __bic_SR_register_on_exit(LPM3_bits); //exit LPM3
-            }
+            Keypad_Start_Scan();    //keys are read and posted by the RTC scan
             break;
     }
 }
 
 /* CONTROLLING OF IR TX AND RX
  * -    TA 0.0: TX
+ * -    TA 0.1: RX carrier, then the end of frame gap
  * -    TA 0.2: RX
- * -
  */
 
 //********Timer0.0 interrupt ISR*********//
+//NOTE: TA0IV is not read here; CCR0 has its own vector, and reading TA0IV would clear the TA0.2 compare flag
+//      (and then skip this tick)
 #pragma vector = TIMER0_A0_VECTOR
 __interrupt void TIMER0_A0_ISR (void)
 {
-    switch( TA0IV )
-    {
-        case TA0IV_NONE:
-            if(tx_cnt < rx_cnt[code_num]){ //Transmitting
-                P4OUT |= BIT0;
-
-                TA0CCTL2 ^= OUT;
-                TA0CCR0 = *(FRAM_read_ptr+1);   //update emitting IR code
-                *FRAM_read_ptr++;
-                tx_cnt++;
-            }
-            else{ //Complete
-                P4OUT &= ~BIT0;
+    if(tx_cnt < ir_cnt){ //Transmitting
+        TA0CCTL2 ^= OUT;
+        TA0CCR0 = *ir_ptr++;    //update emitting IR code
+        tx_cnt++;
+    }
+    else if(tx_rep){ //Frame sent, but it repeats: hold the line for the gap, then send it again
+        if(tx_gap_n == 0){          //end of the last mark, start of the gap
+            TA0CCTL2 ^= OUT;
+            TA0CCR0 = tx_gap_lo;
+            tx_gap_n++;
+        }
+        else if(tx_gap_n <= tx_gap_hi){
+            TA0CCR0 = 0x8000;
+            tx_gap_n++;
+        }
+        else{                       //gap over: first edge of the repeat (the frame, or the NEC repeat code)
+            tx_gap_n = 0;
+            tx_rep--;
+            tx_gap_hi = tx_rgap_hi;
+            tx_gap_lo = tx_rgap_lo;
+
+            ir_ptr = &ir_buf[tx_rep_at];
+            ir_cnt = tx_rep_end;
+            TA0CCTL2 ^= OUT;
+            TA0CCR0 = *ir_ptr++;
+            tx_cnt = tx_rep_at + 1;
+        }
+    }
+    else{ //Complete
+        P4OUT &= ~BIT0;
 
-                IR_status = DISABLED;   //disable IR
-                TA0CCTL0 &= ~CCIE;      // disable timer_A0 interrupt
-                tx_cnt = 1;
+        IR_status = DISABLED;   //disable IR
+        TA0CCTL0 &= ~CCIE;      // disable timer_A0 interrupt
+        tx_cnt = 0;
 
-                //TODO: Start a timer and use the timer interrupt to exit LPM3 instead
-                __bic_SR_register_on_exit(LPM3_bits);                // Exit LPM3
-            }
-            break;
-        default: break;
+        //TODO: Start a timer and use the timer interrupt to exit LPM3 instead
+        __bic_SR_register_on_exit(LPM3_bits);                // Exit LPM3
     }
 }
 
@@ -446,24 +845,30 @@ __interrupt void TIMER0_A1_ISR (void) {
     switch(__even_in_range(TA0IV,TA0IV_TAIFG)) {
         case TA0IV_NONE: break;
         case TA0IV_TACCR1: //TA0.1
+            if(TA0CCTL1 & CAP){ //carrier edge, during the first mark
+                carrier_buf[carrier_cnt++] = TA0CCR1;
+                TA0CCTL1 ^= CM_3;               //carrier on <-> off edge
+
+                if(carrier_cnt >= CARRIER_EDGES) TA0CCTL1 = 0;
+            }
+            //no edge for IR_FRAME_GAP, end of frame
+            //an overflow still pending from before the compare time must not count towards the gap
+            else if(IR_Frame_End(TA0CCR1, ((TA0CTL & TAIFG) && TA0CCR1 < 0x8000) ? 0xFFFF : 0))
+                __bic_SR_register_on_exit(LPM3_bits); //Exit LPM3 to commit
             break;
         case TA0IV_TACCR2: //TA0.2
             if(IR_status == RECEIVING) {
-                if(rx_cnt[code_num] < MAX_IR_CNT){
-                    SYSCFG0 &= ~PFWP;
-                    rx_cnt[code_num]++;
-                    SYSCFG0 |= PFWP;
-
-                    SYSCFG0 &= ~PFWP;
-                    *FRAM_write_ptr = TA0CCR2-old_cnt;    //write FRAM to store data
-                    SYSCFG0 |= PFWP;
+                ir_buf[rx_head] = TA0CCR2;      //timestamp only; see IR_Commit
+                if(rx_gap_open) IR_Frame_Start();
 
-                    old_cnt = TA0CCR2;
-
-                    FRAM_write_ptr++;
+                if(rx_head != 1){               //TA0.1 is on the carrier until the first mark is over
+                    TA0CCR1 = ir_buf[rx_head] + IR_FRAME_GAP;
+                    TA0CCTL1 = CCIE;            //(re)arm the gap timeout, clearing any old CCIFG (and capture mode)
+                }
 
-                    P4OUT |= BIT0;
-                    P1OUT &= ~BIT0;
+                if(!++rx_head){ //ring full: end the burst
+                    IR_End_Capture();
+                    __bic_SR_register_on_exit(LPM3_bits); //Exit LPM3 to commit
                 }
             }
             else{
@@ -475,7 +880,26 @@ __interrupt void TIMER0_A1_ISR (void) {
                 //__bic_SR_register_on_exit(LPM3_bits); //Exit LPM3
             }
             break;
-        case TA0IV_TAIFG:
+        case TA0IV_TAIFG: //TA0 overflow
+            rx_ovf++;
+
+            if(rx_carrier && rx_head == 2){ //one edge, but the first mark has not ended: time the gap from that edge
+                rx_carrier = FALSE;
+                TA0CCR1 = ir_buf[1] + IR_FRAME_GAP;
+                TA0CCTL1 = CCIE;
+
+                //already idle for IR_FRAME_GAP: the frame is over (before this overflow, if TA0 has not got there again)
+                if((unsigned int)(TA0R - ir_buf[1]) >= IR_FRAME_GAP && IR_Frame_End(TA0CCR1, TA0CCR1 > TA0R)){
+                    __bic_SR_register_on_exit(LPM3_bits); //Exit LPM3 to commit
+                    break;
+                }
+            }
+
+            if( (rx_gap_open && rx_ovf >= IR_BURST_GAP)             //no more repeats
+             || (rx_head == 1 && rx_ovf >= IR_LEARN_TIMEOUT) ){     //nothing received at all
+                IR_End_Capture();
+                __bic_SR_register_on_exit(LPM3_bits); //Exit LPM3 to commit
+            }
             break;
         default: break;
     }
@@ -30,3 +30,4 @@ void Init_Clock(void);
 void Init_ADC(void);
 
 void IR_Mode_Setting(void);
+void Dispatch_Event(void);
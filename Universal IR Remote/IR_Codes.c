@@ -5,44 +5,42 @@
 
 #include "main.h"
 #include "IR_Codes.h"
+#include "IR_Board.h"
 
-//TODO: Use pragmas? Or use #define to inline the function
-/* Function: CODE_GET_COUNT_OR_TIME
+//Code table for TV1; the digit codes are in keypad number order (see index_to_keypad_num)
+static const IR_CODE TV1_POWER = { DICT_TV1_POWER, CODES_TV1_POWER, 26 };
+static const IR_CODE TV1_NUMBERS[10] = {
+    { DICT_TV1_NUMBERS, CODES_TV1_NUMBERS[0], 35 },
+    { DICT_TV1_NUMBERS, CODES_TV1_NUMBERS[1], 35 },
+    { DICT_TV1_NUMBERS, CODES_TV1_NUMBERS[2], 35 },
+    { DICT_TV1_NUMBERS, CODES_TV1_NUMBERS[3], 35 },
+    { DICT_TV1_NUMBERS, CODES_TV1_NUMBERS[4], 35 },
+    { DICT_TV1_NUMBERS, CODES_TV1_NUMBERS[5], 35 },
+    { DICT_TV1_NUMBERS, CODES_TV1_NUMBERS[6], 35 },
+    { DICT_TV1_NUMBERS, CODES_TV1_NUMBERS[7], 35 },
+    { DICT_TV1_NUMBERS, CODES_TV1_NUMBERS[8], 35 },
+    { DICT_TV1_NUMBERS, CODES_TV1_NUMBERS[9], 35 }
+};
+
+/* Function: IR_Code_Get
  * Arguments:
  *      curr_mode [enum MODES]: What is the current mode?
  *      curr_num  [enum KEYPAD]: What keypad button is pressed?
- *      code [0 to MAX_OF_127]:
- *          0: Implies we actually want the COUNT not the time
- *          1-127: We want the TIME not the count; `time` then represents the actual time converted from the code.
+ * Returns:
+ *      The IR code to transmit, or 0 (NULL) if there is none for that button
+ *
+ * NOTE: Only called once per key press; the TA0.0 ISR then just does `dict[*sym]` per edge.
  */
-unsigned int CODE_GET_COUNT_OR_TIME(enum MODES curr_mode, enum KEYPAD curr_num, unsigned char time){
+const IR_CODE* IR_Code_Get(enum MODES curr_mode, enum KEYPAD curr_num){
     switch(curr_mode){
         case AIRCON:
             break;
         case TV1:
             switch(curr_num){
                 case KEY_0: case KEY_1: case KEY_2: case KEY_3: case KEY_4: case KEY_5: case KEY_6: case KEY_7: case KEY_8: case KEY_9:
-                    switch(time){
-                        case 0: return 35; //count
-                        case 1: return 740; //actual time from coded 1...
-                        case 2: return 855;
-                        case 3: return 1030;
-                        case 4: return 1585;
-                        case 5: return 1855;
-                        case 6: return 2260;
-                        case 7: return 2940;
-                        default: return 0;
-                    }
+                    return &TV1_NUMBERS[index_to_keypad_num((unsigned char)(curr_num))];
                 case POWER:
-                    switch(time){
-                        case 0: return 26; //count
-                        case 1: return 2212; //actual time from coded 1...
-                        case 2: return 2568;
-                        case 3: return 4967;
-                        case 4: return 9748;
-                        case 5: return 36712;
-                        default: return 0;
-                    }
+                    return &TV1_POWER;
                 default: break; //will return 0 anyway
             }
             break;
@@ -52,3 +50,19 @@ unsigned int CODE_GET_COUNT_OR_TIME(enum MODES curr_mode, enum KEYPAD curr_num,
 
     return 0;
 }
+
+/* Function: IR_Code_Plan
+ * Arguments:
+ *      code: IR code to transmit
+ *      plan: Where to write the playback plan (at least MAX_IR_CNT+1 entries)
+ *
+ * Expands the dictionary indices into the CCR0 value of every edge, ending with a 0.
+ * The TA0.0 ISR then only loads the next value and stores it into TA0CCR0.
+ */
+void IR_Code_Plan(const IR_CODE *code, unsigned int *plan){
+    const unsigned char *sym = code->sym;
+    unsigned char i = code->cnt;
+
+    while(i--) *plan++ = code->dict[*sym++];
+    *plan = 0; //end of code
+}
@@ -4,7 +4,6 @@
 ****************************/
 
 //Appliance modes
-static const char* MODE_NAMES[] = { "AIRCON", "TV 1", "TV 2" };
 enum MODES {
     AIRCON,
     TV1,
@@ -12,7 +11,21 @@ enum MODES {
 };
 #define TOTAL_MODES 3
 
-//IR Codes
+/* IR Codes
+ * Every code is a dictionary of at most 8 durations (in SMCLK ticks) plus one index into it per edge.
+ * Index 0 is unused, so the symbols below are 1-based.
+ */
+typedef struct {
+    const unsigned int  *dict;      //durations in SMCLK ticks
+    const unsigned char *sym;       //dict index per edge
+    unsigned char       cnt;        //number of edges
+} IR_CODE;
+
+#define MAX_IR_CNT 64       //edges in the longest code (size of the playback plan)
+
+static const unsigned int DICT_TV1_POWER[8]   = { 0, 2212, 2568, 4967, 9748, 36712, 0, 0 };
+static const unsigned int DICT_TV1_NUMBERS[8] = { 0, 740, 855, 1030, 1585, 1855, 2260, 2940 };
+
 static const unsigned char CODES_TV1_POWER[26] = { 4, 1, 3, 1, 2, 1, 3, 1, 2, 1, 3, 1, 2, 1, 2, 1, 3, 1, 2, 1, 2, 1, 2, 1, 2, 5 };
 static const unsigned char CODES_TV1_NUMBERS[10][35] = {
     { 5, 3, 1, 3, 1, 6, 2, 3, 1, 4, 2, 6, 2, 4, 2, 3, 1, 3, 1, 6, 2, 6, 2, 4, 2, 6, 2, 3, 1, 3, 1, 3, 1, 3, 1 },
@@ -28,4 +41,5 @@ static const unsigned char CODES_TV1_NUMBERS[10][35] = {
 };
 
 //Functions
-unsigned int CODE_GET_COUNT_OR_TIME(enum MODES, enum KEYPAD, unsigned char);
+const IR_CODE* IR_Code_Get(enum MODES, enum KEYPAD);
+void IR_Code_Plan(const IR_CODE*, unsigned int*);
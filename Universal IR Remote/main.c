@@ -6,6 +6,7 @@
  *  	Init_GPIO: Initializes ports
  *	Init_Clock: Initializes XT1 OSC and DCO
  *
+ *	Dispatch_Event: Acts on an event posted by the ISRs (keypad, S1/S2)
  *	IR_Mode_Setting: Sets mode for IR mode accordingly
  * 
  * Connects to: 
@@ -30,9 +31,12 @@
 //IR Keypad Buttons
 enum KEYPAD button_num = NONE;     //button number
 unsigned char buttonDebounce = BUTTON_READY;
+unsigned int button_map = 0;   //all keys down with button_num, for chords
+KEY_EVENT key_event;
 
 //NOTE: All IR codes and data is under IR_codes.h
 enum MODES mode = AIRCON;
+static const char* MODE_NAMES[] = { "AIRCON", "TV 1", "TV 2" };
 
 //Remote status
 enum REMOTE_STATUSES {
@@ -40,8 +44,12 @@ enum REMOTE_STATUSES {
     TRANSMITTING
 } remote_status;
 
-unsigned char tx_cnt = 0;
-unsigned char *FRAM_ptr  = (unsigned char *)(&CODES_TV1_POWER[0]);
+/* Playback plan
+ * CCR0 values of the code being transmitted, 0-terminated.
+ * Filled by IR_Mode_Setting so that the TA0.0 ISR is just one load and one store per edge.
+ */
+unsigned int tx_plan[MAX_IR_CNT+1] = {0};
+unsigned int *tx_ptr = &tx_plan[0];
 
 int main(void){
     WDTCTL = WDTPW | WDTHOLD;   // Stop watchdog timer
@@ -69,10 +77,13 @@ int main(void){
     LCD_Text( (char *)(MODE_NAMES[mode]) );
 
     while(1) {
+        // Events posted by the ISRs: keypad (RTC scan, IR_Board.c) and S1/S2 (port ISRs)
+        while(Key_Get_Event(&key_event)) Dispatch_Event();
+
         if(remote_status == TRANSMITTING) {
             /* USER ASKS TO TRANSMIT; BEGIN SENDING THE SIGNAL
              * 1. Configure IR output pins
-             * 2. Disable all P1/2 interrupts: Prevents unwanted exit of LPM3 in the middle of signal send
+             * 2. Disable the S1/S2 interrupts: Prevents the signal send being cancelled halfway
              * 3. Configure IR modulation using ASK protocol
              * 3. Enter LPM3 to pause until the transmit is complete
              * 4. In the TA0.0 interrupt, when transmit is complete, exits LPM3.
@@ -81,10 +92,11 @@ int main(void){
 
             // Configure IR output pin
             P1SEL0 |= BIT0;                      // use internal IR modulator
+            P4OUT |= BIT0;                       // LED on while transmitting
 
-            // Disable Port1 & Port2 interrupt
-            P1IE = 0;
-            P2IE = 0;
+            // Disable push button interrupts; keypad events wait in the queue until the code is sent
+            P1IE &= ~BIT2;
+            P2IE &= ~BIT6;
 
             // Configure IR modulation: ASK
             SYSCFG1 = IRDSSEL + IREN;
@@ -104,8 +116,13 @@ int main(void){
             TA0CTL = TASSEL_2 + MC_1 + TACLR;   //SMCLK, UP mode
 
             // stop until the end of IR code by entering LPM3
-            // button interrupts MUST be disabled so it doesn't accidentally cause LPM3 exit
-            __bis_SR_register(LPM3_bits | GIE);
+            // a key press also exits LPM3, so go back to sleep until the TA0.0 ISR says it is done
+            __disable_interrupt();
+            while(remote_status == TRANSMITTING){
+                __bis_SR_register(LPM3_bits | GIE);
+                __disable_interrupt();
+            }
+            __enable_interrupt();
 
             // Transmission complete: disable timer TA0 and TA1
             TA0CCTL0 = 0;
@@ -119,9 +136,9 @@ int main(void){
             TA1CCR0 = 0;
             TA1CCR2 = 0;
 
-            // Renable push button and keypad interrupt
-            P1IE |= (BIT2 | BIT3 | BIT4 | BIT5);
-            P2IE |= (BIT6 | BIT7);
+            // Renable push button interrupt
+            P1IE |= BIT2;
+            P2IE |= BIT6;
         }
         else if(remote_status == IDLE){
             /* IDLE
@@ -132,46 +149,67 @@ int main(void){
             LCD_Text( (char*)(MODE_NAMES[mode]) );
         }
 
-        __bis_SR_register(LPM3_bits | GIE);     //enter low power mode
+        Key_Wait();     //enter low power mode, unless a key event is waiting
     }
 }
 
 
+/* Function: Dispatch_Event
+ * Acts on `key_event`, outside of interrupt context.
+ *      KEY_DOWN/KEY_REPEAT: Keypad button (see IR_Mode_Setting); a repeat sends the code again, like holding a real remote
+ *      BUTTON_DOWN: S1/S2 go to the next mode
+ */
+void Dispatch_Event(){
+    switch(key_event.type){
+        case KEY_DOWN:
+        case KEY_REPEAT:
+            button_num = (enum KEYPAD)key_event.key;
+            button_map = key_event.map;
+            IR_Mode_Setting();
+            break;
+        case BUTTON_DOWN:
+            remote_status = IDLE;
+
+            mode++;
+            if(mode>=TOTAL_MODES) mode = 0;
+            break;
+        default: break;
+    }
+}
+
+/* Function: IR_Mode_Setting
+ * Acts on keypad button `button_num`.
+ * Chords (see button_map):
+ *      OK + 1/2/3: Go straight to that mode (like S1/S2) instead of sending
+ */
 void IR_Mode_Setting(){
+    unsigned char digit;
+
     LCD_Clear();
 
+    if(button_num != OK && (button_map & KEY_BIT(OK))) {  //OK held down
+        digit = index_to_keypad_num(button_num);
+
+        if(digit >= 1 && digit <= TOTAL_MODES) {
+            mode = (enum MODES)(digit - 1);
+            LCD_Text( (char*)(MODE_NAMES[mode]) );
+            return;
+        }
+    }
+
     if(remote_status != TRANSMITTING){
-        tx_cnt = CODE_GET_COUNT_OR_TIME(mode, button_num, 0); //get count
+        const IR_CODE *code = IR_Code_Get(mode, button_num);
 
         LCD_IR_Buttons(button_num);
 
         //Check if there's a valid IR code first...
-        if(!tx_cnt) return;
+        //TODO: Set an alternative for AC power off and on
+        if(!code) return;
 
-        //If so, then start transmission process...
+        //If so, then resolve it into CCR0 values and start transmission process...
+        IR_Code_Plan(code, tx_plan);
+        tx_ptr = &tx_plan[0];
         remote_status = TRANSMITTING;
-
-        switch(mode){
-            case AIRCON:
-                //FRAM_ptr = &tx_data_aircon[code_num][0];
-                //TODO: Set an alternative for AC power off and on
-                break;
-            case TV1:
-                switch(button_num){
-                    case KEY_0: case KEY_1: case KEY_2: case KEY_3: case KEY_4: case KEY_5: case KEY_6: case KEY_7: case KEY_8: case KEY_9:
-                        FRAM_ptr = &CODES_TV1_NUMBERS[index_to_keypad_num((unsigned char)(button_num))][0];
-                        break;
-                    case POWER:
-                        FRAM_ptr = &CODES_TV1_POWER[0];
-                        break;
-                    default: break; //will return 0 anyway
-                }
-                break;
-            case TV2:
-                //FRAM_ptr = &tx_data_tv[1][code_num][0];
-                break;
-            default: return;
-        }
     }
 }
 
@@ -271,10 +309,7 @@ __interrupt void PORT1_ISR(void)
                 P1OUT |= BIT0;
                 Buttons_startWDT();
 
-                remote_status = IDLE;
-
-                mode++;
-                if(mode>=TOTAL_MODES) mode = 0;
+                Key_Post(BUTTON_DOWN, BUTTON_S1);  //handled in main (Dispatch_Event)
             }
             __bic_SR_register_on_exit(LPM3_bits); //exit LPM3
             break;
@@ -282,17 +317,8 @@ __interrupt void PORT1_ISR(void)
         case P1IV_P1IFG4:
         case P1IV_P1IFG5:
             P1IFG &= ~(BIT3 | BIT4 | BIT5);
-
-            if (buttonDebounce == BUTTON_READY){
-                buttonDebounce = BUTTON_PRESSED;
-
-                Buttons_startWDT();
-                button_num = scan_key(); // scan the keypad
-                IR_Mode_Setting();
-
-                __bic_SR_register_on_exit(LPM3_bits); //exit LPM3
-            }
-             break;
+            Keypad_Start_Scan();    //keys are read and posted by the RTC scan
+            break;
         case P1IV_P1IFG6 : break;
         case P1IV_P1IFG7 : break;
     }
@@ -323,26 +349,13 @@ __interrupt void PORT2_ISR(void)
                 P1OUT |= BIT0;
                 Buttons_startWDT();
 
-                remote_status = IDLE;
-
-                mode++;
-                if(mode>=TOTAL_MODES) mode = 0;
-
-                //LCD_Text( (char*)(MODE_NAMES[mode]) );
+                Key_Post(BUTTON_DOWN, BUTTON_S2);  //handled in main (Dispatch_Event)
             }
             __bic_SR_register_on_exit(LPM3_bits); //exit LPM3
             break;
         case P2IV_P2IFG7:
             P2IFG &= ~BIT7;                                  // clear IFG
-            if (buttonDebounce == BUTTON_READY){
-                buttonDebounce = BUTTON_PRESSED;
-
-                Buttons_startWDT();
-                button_num = scan_key(); // scan the keypad
-                IR_Mode_Setting();
-
-                __bic_SR_register_on_exit(LPM3_bits); //exit LPM3
-            }
+            Keypad_Start_Scan();    //keys are read and posted by the RTC scan
             break;
     }
 }
@@ -353,36 +366,25 @@ __interrupt void PORT2_ISR(void)
 
 //********Timer0.0 interrupt ISR*********//
 //For transmission of signals
+//NOTE: TA0IV is not read here; CCR0 has its own vector, and reading TA0IV would clear the TA0.1/TA0.2 flags
 #pragma vector = TIMER0_A0_VECTOR
 __interrupt void TIMER0_A0_ISR (void)
 {
-    switch( TA0IV )
-    {
-        case TA0IV_NONE:
-            //TODO: instead of using this method, let tx_cnt = CODE_GET_COUNT_OR_TIME when transmission is first triggered, then count down
-            if(tx_cnt>0){ //Transmitting
-                P4OUT |= BIT0;
-
-                TA0CCTL2 ^= OUT;
-
-                TA0CCR0 = CODE_GET_COUNT_OR_TIME(mode,button_num,*FRAM_ptr); //Emit appropriate IR code
-                *FRAM_ptr++;
+    unsigned int next = *tx_ptr++;  //precomputed in IR_Mode_Setting
 
-                tx_cnt--;
-            }
-            else{ //Complete
-                P4OUT &= ~BIT0;
+    if(next){ //Transmitting
+        TA0CCTL2 ^= OUT;
+        TA0CCR0 = next;             //Emit appropriate IR code
+    }
+    else{ //Complete
+        P4OUT &= ~BIT0;
 
-                TA0CCTL0 &= ~CCIE;      // disable timer_A0 interrupt
-                tx_cnt = 0;
+        TA0CCTL0 &= ~CCIE;      // disable timer_A0 interrupt
 
-                //TODO: Start a timer and use the timer interrupt to exit LPM3 instead
+        //TODO: Start a timer and use the timer interrupt to exit LPM3 instead
 
-                remote_status = IDLE;   //disable IR
-                __bic_SR_register_on_exit(LPM3_bits);                // Exit LPM3
-            }
-            break;
-        default: break;
+        remote_status = IDLE;   //disable IR
+        __bic_SR_register_on_exit(LPM3_bits);                // Exit LPM3
     }
 }
 
@@ -52,3 +52,4 @@ void Init_GPIO(void);
 void Init_Clock(void);
 
 void IR_Mode_Setting(void);
+void Dispatch_Event(void);